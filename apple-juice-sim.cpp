@@ -0,0 +1,721 @@
+/*
+    Simulador sem interface gráfica (headless) da placa Apple Juice.
+
+    Usa o mesmo modelo de chips do simulador gráfico, mas avança a placa em tempo virtual: simular uma hora de placa não
+    custa uma hora de relógio. Serve para validar e corrigir configurações de laboratório em lote.
+
+    Uso:
+        ./apple-juice-sim [--leds N] [--digitos N] [--r1 OHMS] [--r2 OHMS] [--c FARADS] [--tempo SEGUNDOS | --ciclos N] [--tempo-real | --salto]
+
+    Exemplo (uma hora de placa com os valores padrão do simulador gráfico):
+        ./apple-juice-sim --tempo 3600
+
+    Exemplo (o que a placa mostra após 10^9 ciclos, calculado em forma fechada):
+        ./apple-juice-sim --ciclos 1000000000 --salto
+
+    Exemplo (contador de eventos de 12 dígitos ligado por uma semana):
+        ./apple-juice-sim --digitos 12 --tempo 604800 --salto
+
+    Exemplo (555 analógico a 5 V: tempos exatos, primeiro ciclo mais longo e a tensão do capacitor em CSV):
+        ./apple-juice-sim --analogico --vcc 5 --ciclos 1000 --forma-de-onda capacitor.csv
+
+    Exemplo (formas de onda de 1000 ciclos para o GTKWave):
+        ./apple-juice-sim --ciclos 1000 --vcd placa.vcd
+
+    Exemplo (24 h de placa a ~1 kHz guardadas em poucos kilobytes, com consulta a um ciclo qualquer):
+        ./apple-juice-sim --c 6.86e-8 --tempo 86400 --historico --estado-em 12345678
+
+    Exemplo (placa descrita por netlist: chips, pinos e redes; ver simulacao/netlist.hpp e netlists/):
+        ./apple-juice-sim --netlist netlists/cronometro.net --tempo 86400
+
+    Exemplo (varredura em todos os núcleos; as faixas são inicio:fim:passos, com ':log' opcional):
+        ./apple-juice-sim --varredura --r1 1e3:1e5:20:log --r2 1e3:1e5:20:log --c 1e-6:1e-4:10:log --leds 1:10 --saida varredura.csv
+
+    Exemplo (por eventos: clock externo de 1 kHz no display, chave virando para EXT aos 10 s e reset aos 30 s):
+        ./apple-juice-sim --eventos --tempo 60 --ext-hz 1000 --chave-em 10 --reset-em 30
+
+    Exemplo (clock externo lido de um arquivo de instantes, convertido antes para o formato binário compacto):
+        ./apple-juice-sim --clock-externo bordas.txt --clock-binario bordas.ajck
+        ./apple-juice-sim --clock-externo bordas.ajck --chave ext --tempo 60
+
+    Exemplo (atrasos de propagação dos CD40xx em 5 V, pior caso, com o 555 analógico: glitches e violações de tempo):
+        ./apple-juice-sim --atrasos --vcc 5 --pior-caso --tempo 60 --reset-em 10
+
+    Exemplo (10 milhões de placas com resistores de 5% e eletrolítico de 20%: percentis e histogramas da frequência):
+        ./apple-juice-sim --monte-carlo 10000000 --tolerancia-r 5 --tolerancia-c 20 --saida tolerancias.csv
+*/
+
+#include <iostream>               // Entrada e saída padrão (cout, cerr, etc.)
+#include <string>                 // Manipulação de strings (std::string, std::stod, etc.)
+#include <bitset>                 // Exibição dos LEDs em binário
+#include <cstdint>                // Tipos inteiros com tamanho fixo
+#include <stdexcept>              // Exceções padrão (std::invalid_argument)
+#include <cstdlib>                // EXIT_SUCCESS / EXIT_FAILURE
+#include <chrono>                 // Medição do tempo gasto
+#include <memory>                 // std::unique_ptr do gravador VCD
+#include <vector>                 // Ciclos consultados no histórico
+#include <algorithm>              // std::max
+#include <fstream>                // Forma de onda do 555 analógico em CSV
+#include <iomanip>                // Tabela de percentis do Monte Carlo
+
+#include "simulacao/chips.hpp"
+#include "simulacao/motorVirtual.hpp"
+#include "simulacao/varredura.hpp"
+#include "simulacao/poolThreads.hpp"
+#include "simulacao/instrumentacao.hpp"
+#include "simulacao/vcd.hpp"
+#include "simulacao/rastroPeriodico.hpp"
+#include "simulacao/netlist.hpp"
+#include "simulacao/analogico555.hpp"
+#include "simulacao/monteCarlo.hpp"
+#include "simulacao/placaEventos.hpp"
+#include "simulacao/clockExterno.hpp"
+#include "simulacao/atrasos.hpp"
+
+
+// Parâmetros da linha de comando (os padrões são os mesmos do main() do simulador gráfico)
+struct ParametrosSim {
+    unsigned leds = 4;
+    unsigned digitos = 2;       // CD4026 em cascata no display
+    double R1 = 1000.0;
+    double R2 = 10000.0;
+    double C  = 7.37e-6;
+    double tempo = 3600.0;      // segundos simulados
+    uint64_t ciclos = 0;        // se > 0, tem prioridade sobre 'tempo'
+    bool tempoReal = false;
+    bool passoAPasso = false;
+    bool salto = false;         // calcula o estado final em forma fechada, sem simular ciclo a ciclo
+    std::string metricas;       // arquivo (.json ou .csv) com o erro do clock no modo de tempo real
+    std::string vcd;            // arquivo com as formas de onda de todos os sinais (GTKWave)
+    bool historico = false;     // guarda o histórico compacto de todos os ciclos
+    std::vector<uint64_t> consultas;    // ciclos cujo estado é lido do histórico ao final
+    std::string netlist;        // arquivo que descreve a placa (substitui --leds, --r1, --r2 e --c)
+    bool analogico = false;     // tempos do 555 pelo modelo analógico (exponenciais exatas) em vez do 0.693
+    ParametrosAnalogicos555 eletrica;
+    std::string formaDeOnda;    // arquivo CSV com a tensão do capacitor nos primeiros ciclos
+
+    // Varredura de parâmetros
+    bool varredura = false;
+    Faixa faixaR1, faixaR2, faixaC;
+    unsigned ledsMax = 4;       // junto com 'leds', forma a faixa de LimitReset
+    std::string saida;          // vazio = varredura.csv na varredura; no Monte Carlo, só grava se for informado
+    unsigned threads = 0;       // 0 = todos os núcleos
+
+    // Simulação por eventos discretos (555, clock externo e botões na mesma linha do tempo)
+    bool eventos = false;
+    double extHz = 0.0;         // frequência do clock externo (0 = entrada desligada)
+    std::string clockExterno;   // arquivo, FIFO ou "-" com os instantes das bordas do clock externo
+    std::string clockBinario;   // se não vazio, só converte 'clockExterno' para o formato binário nesse arquivo
+    ChaveClock chave = ChaveClock::Interno555;
+    std::vector<double> chaveEm;        // instantes em que a chave muda de posição
+    std::vector<double> resetEm;        // instantes em que o botão R é apertado
+
+    // Atrasos de propagação dos CD40xx (com --vcc como VDD; o 555 analógico entra junto)
+    bool atrasos = false;
+    bool piorCaso = false;
+
+    // Monte Carlo das tolerâncias
+    uint64_t monteCarlo = 0;    // placas sorteadas (0 = desligado)
+    double tolR = 5.0;          // % dos resistores
+    double tolC = 20.0;         // % do capacitor
+    Distribuicao distribuicao = Distribuicao::Normal;
+    uint64_t semente = 1;
+
+    ParametrosSim() {
+        faixaR1 = Faixa::ler("1000");
+        faixaR2 = Faixa::ler("10000");
+        faixaC  = Faixa::ler("7.37e-6");
+    }
+};
+
+
+static void ajuda() {
+    std::cout <<
+        "Uso: apple-juice-sim [opções]\n"
+        "  --leds N         número de LEDs (padrão 4); acima de 10, vários CD4017 em cascata\n"
+        "  --digitos N      número de CD4026 em cascata no display (padrão 2)\n"
+        "  --r1 OHMS        resistor R1 do 555 (padrão 1000)\n"
+        "  --r2 OHMS        resistor R2 do 555 (padrão 10000)\n"
+        "  --c FARADS       capacitor do 555 (padrão 7.37e-6)\n"
+        "  --tempo S        segundos de placa a simular (padrão 3600)\n"
+        "  --ciclos N       número de ciclos do 555 a simular (substitui --tempo)\n"
+        "  --tempo-real     respeita os tempos do 555 (como a interface gráfica)\n"
+        "  --salto          calcula o estado final em tempo constante (advance)\n"
+        "  --metricas ARQ   com --tempo-real, grava o histograma do erro do clock (.json ou .csv)\n"
+        "  --vcd ARQ        grava CLK, saídas do CD4017, dígitos e carry em VCD (abre no GTKWave)\n"
+        "  --historico      guarda todos os ciclos num histórico compacto e mostra o tamanho\n"
+        "  --estado-em C    mostra o estado da placa no ciclo C, lido do histórico (pode repetir)\n"
+        "  --netlist ARQ    simula a placa descrita no arquivo (chips, pinos e redes) em vez da Apple Juice\n"
+        "\n"
+        "555 analógico (tensão do capacitor com exponenciais exatas em vez da aproximação 0.693):\n"
+        "  --analogico      usa os tempos do modelo analógico\n"
+        "  --vcc V          tensão de alimentação (padrão 9)\n"
+        "  --rdescarga OHMS resistência do transistor de descarga (padrão 15)\n"
+        "  --vcontrole V    tensão no pino CTRL (padrão: divisor interno, 2/3 Vcc)\n"
+        "  --forma-de-onda ARQ  grava em CSV a tensão do capacitor e a saída nos 3 primeiros ciclos\n"
+        "\n"
+        "Varredura de parâmetros (--r1, --r2 e --c aceitam inicio:fim:passos[:log], --leds aceita min:max):\n"
+        "  --varredura      simula todos os pontos da grade em paralelo\n"
+        "  --saida ARQ      arquivo de saída: .csv ou .bin (padrão varredura.csv)\n"
+        "  --threads N      número de threads (padrão: todos os núcleos)\n"
+        "  --passo-a-passo  simula cada ponto ciclo a ciclo em vez de usar advance()\n"
+        "\n"
+        "Simulação por eventos discretos (várias fontes de clock numa linha do tempo; usa --tempo):\n"
+        "  --eventos        simula a placa com a roda de tempo em vez do MotorVirtual\n"
+        "  --ext-hz F       liga na entrada de clock externo uma onda quadrada de F Hz\n"
+        "  --clock-externo ARQ  liga na entrada de clock externo os instantes lidos de ARQ (arquivo, FIFO ou - para\n"
+        "                   a entrada padrão): um por linha em segundos, ou o formato binário de --clock-binario\n"
+        "  --clock-binario ARQ  só converte o fluxo de --clock-externo para o formato binário compacto em ARQ\n"
+        "  --chave P        posição inicial da chave do display: 555 ou ext (padrão 555)\n"
+        "  --chave-em T     vira a chave no instante T (pode repetir)\n"
+        "  --reset-em T     aperta o botão R no instante T (pode repetir)\n"
+        "\n"
+        "Atrasos de propagação (placa original com até 10 LEDs; usa --tempo, --reset-em e --vcc como VDD):\n"
+        "  --atrasos        simula os atrasos dos CD4017/CD4026 e mostra glitches e violações de tempo\n"
+        "  --pior-caso      usa os atrasos máximos do datasheet em vez dos típicos\n"
+        "\n"
+        "Monte Carlo das tolerâncias (usa --r1, --r2, --c como valores nominais e --threads):\n"
+        "  --monte-carlo N  sorteia N conjuntos de componentes e mostra os percentis de f, T e duty\n"
+        "  --tolerancia-r P tolerância dos resistores em % (padrão 5)\n"
+        "  --tolerancia-c P tolerância do capacitor em % (padrão 20)\n"
+        "  --distribuicao D normal (tolerância = 3 desvios padrão) ou uniforme (padrão normal)\n"
+        "  --semente S      semente dos números aleatórios (padrão 1; mesmo resultado com qualquer número de threads)\n"
+        "  --saida ARQ      grava os histogramas em CSV\n";
+}
+
+
+// Lê o valor que segue uma opção; lança invalid_argument se estiver faltando
+static std::string valorDe(int& i, int argc, char** argv) {
+    if (i + 1 >= argc) {
+        throw std::invalid_argument(std::string("faltou o valor de ") + argv[i]);
+    }
+    return argv[++i];
+}
+
+
+static ParametrosSim lerParametros(int argc, char** argv) {
+    ParametrosSim p;
+    for (int i = 1; i < argc; ++i) {
+        std::string op = argv[i];
+        if (op == "--leds") {
+            std::string v = valorDe(i, argc, argv);
+            size_t sep = v.find(':');
+            p.leds = static_cast<unsigned>(std::stoul(v.substr(0, sep)));
+            p.ledsMax = (sep == std::string::npos) ? p.leds : static_cast<unsigned>(std::stoul(v.substr(sep + 1)));
+        }
+        else if (op == "--digitos")    p.digitos = static_cast<unsigned>(std::stoul(valorDe(i, argc, argv)));
+        else if (op == "--r1")         { p.faixaR1 = Faixa::ler(valorDe(i, argc, argv)); p.R1 = p.faixaR1.inicio; }
+        else if (op == "--r2")         { p.faixaR2 = Faixa::ler(valorDe(i, argc, argv)); p.R2 = p.faixaR2.inicio; }
+        else if (op == "--c")          { p.faixaC  = Faixa::ler(valorDe(i, argc, argv)); p.C  = p.faixaC.inicio; }
+        else if (op == "--tempo")      p.tempo = std::stod(valorDe(i, argc, argv));
+        else if (op == "--ciclos")     p.ciclos = std::stoull(valorDe(i, argc, argv));
+        else if (op == "--tempo-real") p.tempoReal = true;
+        else if (op == "--salto")      p.salto = true;
+        else if (op == "--metricas")   p.metricas = valorDe(i, argc, argv);
+        else if (op == "--vcd")        p.vcd = valorDe(i, argc, argv);
+        else if (op == "--historico")  p.historico = true;
+        else if (op == "--estado-em")  { p.consultas.push_back(std::stoull(valorDe(i, argc, argv))); p.historico = true; }
+        else if (op == "--netlist")    p.netlist = valorDe(i, argc, argv);
+        else if (op == "--analogico")  p.analogico = true;
+        else if (op == "--vcc")        { p.eletrica.vcc = std::stod(valorDe(i, argc, argv)); p.analogico = true; }
+        else if (op == "--rdescarga")  { p.eletrica.rDescarga = std::stod(valorDe(i, argc, argv)); p.analogico = true; }
+        else if (op == "--vcontrole")  { p.eletrica.vControle = std::stod(valorDe(i, argc, argv)); p.analogico = true; }
+        else if (op == "--forma-de-onda") { p.formaDeOnda = valorDe(i, argc, argv); p.analogico = true; }
+        else if (op == "--varredura")  p.varredura = true;
+        else if (op == "--saida")      p.saida = valorDe(i, argc, argv);
+        else if (op == "--threads")    p.threads = static_cast<unsigned>(std::stoul(valorDe(i, argc, argv)));
+        else if (op == "--passo-a-passo") p.passoAPasso = true;
+        else if (op == "--eventos")    p.eventos = true;
+        else if (op == "--ext-hz")     { p.extHz = std::stod(valorDe(i, argc, argv)); p.eventos = true; }
+        else if (op == "--clock-externo") { p.clockExterno = valorDe(i, argc, argv); p.eventos = true; }
+        else if (op == "--clock-binario") p.clockBinario = valorDe(i, argc, argv);
+        else if (op == "--chave-em")   { p.chaveEm.push_back(std::stod(valorDe(i, argc, argv))); p.eventos = true; }
+        else if (op == "--reset-em")   { p.resetEm.push_back(std::stod(valorDe(i, argc, argv))); p.eventos = true; }
+        else if (op == "--atrasos")    p.atrasos = true;
+        else if (op == "--pior-caso")  { p.piorCaso = true; p.atrasos = true; }
+        else if (op == "--chave") {
+            std::string c = valorDe(i, argc, argv);
+            if (c == "555")      p.chave = ChaveClock::Interno555;
+            else if (c == "ext") p.chave = ChaveClock::Externo;
+            else throw std::invalid_argument("posição da chave desconhecida: " + c + " (use 555 ou ext)");
+            p.eventos = true;
+        }
+        else if (op == "--monte-carlo") p.monteCarlo = std::stoull(valorDe(i, argc, argv));
+        else if (op == "--tolerancia-r") p.tolR = std::stod(valorDe(i, argc, argv));
+        else if (op == "--tolerancia-c") p.tolC = std::stod(valorDe(i, argc, argv));
+        else if (op == "--semente")    p.semente = std::stoull(valorDe(i, argc, argv));
+        else if (op == "--distribuicao") {
+            std::string d = valorDe(i, argc, argv);
+            if (d == "normal")        p.distribuicao = Distribuicao::Normal;
+            else if (d == "uniforme") p.distribuicao = Distribuicao::Uniforme;
+            else throw std::invalid_argument("distribuição desconhecida: " + d + " (use normal ou uniforme)");
+        }
+        else if (op == "--ajuda" || op == "-h") {
+            ajuda();
+            std::exit(EXIT_SUCCESS);
+        }
+        else {
+            throw std::invalid_argument("opção desconhecida: " + op);
+        }
+    }
+
+    if (!p.metricas.empty() && !p.tempoReal) {
+        throw std::invalid_argument("--metricas mede o clock de tempo real: use junto com --tempo-real");
+    }
+
+    if (!p.netlist.empty() && (p.varredura || p.tempoReal || p.salto || p.historico || !p.vcd.empty() || p.digitos != 2 || p.analogico)) {
+        throw std::invalid_argument("--netlist simula em tempo virtual, ciclo a ciclo: use só com --tempo ou --ciclos");
+    }
+
+    if (p.analogico && p.varredura) {
+        throw std::invalid_argument("a varredura usa o 555 ideal: --analogico não pode ser usado com --varredura");
+    }
+
+    if (p.monteCarlo && (p.varredura || !p.netlist.empty() || p.analogico)) {
+        throw std::invalid_argument("--monte-carlo usa as fórmulas do Chip555: não combina com --varredura, --netlist ou --analogico");
+    }
+
+    if (p.atrasos && (p.varredura || p.monteCarlo || !p.netlist.empty() || p.tempoReal || p.salto || p.historico
+                      || !p.vcd.empty() || p.ciclos > 0 || p.digitos != 2 || p.leds > 10 || p.extHz > 0
+                      || !p.clockExterno.empty() || !p.chaveEm.empty() || p.chave != ChaveClock::Interno555)) {
+        throw std::invalid_argument("--atrasos simula a placa original (até 10 LEDs, 2 dígitos, 555 no display) até --tempo, "
+                                    "só com --reset-em e --vcc");
+    }
+    if (p.eventos && !p.atrasos && (p.varredura || p.monteCarlo || !p.netlist.empty() || p.tempoReal || p.salto || p.historico
+                      || !p.vcd.empty() || p.ciclos > 0 || p.analogico)) {
+        throw std::invalid_argument("--eventos simula em tempo virtual até --tempo: não combina com os outros modos");
+    }
+    if (p.extHz < 0) {
+        throw std::invalid_argument("--ext-hz precisa ser >= 0");
+    }
+    if (p.extHz > 0 && !p.clockExterno.empty()) {
+        throw std::invalid_argument("a entrada de clock externo recebe --ext-hz ou --clock-externo, não os dois");
+    }
+    if (!p.clockBinario.empty() && p.clockExterno.empty()) {
+        throw std::invalid_argument("--clock-binario converte o fluxo de --clock-externo: informe os dois");
+    }
+
+    bool temFaixa = p.faixaR1.passos > 1 || p.faixaR2.passos > 1 || p.faixaC.passos > 1 || p.ledsMax != p.leds;
+    if (temFaixa && !p.varredura) {
+        throw std::invalid_argument("faixas de valores só podem ser usadas com --varredura");
+    }
+    return p;
+}
+
+
+// Roda a grade de parâmetros em paralelo e grava um ponto por linha (CSV) ou registro (binário)
+static void varrer(const ParametrosSim& p) {
+    ConfigVarredura cfg;
+    cfg.r1 = p.faixaR1;
+    cfg.r2 = p.faixaR2;
+    cfg.c = p.faixaC;
+    cfg.limiteMin = p.leds;
+    cfg.limiteMax = p.ledsMax;
+    cfg.tempo = p.tempo;
+    cfg.passoAPasso = p.passoAPasso;
+
+    PoolThreads pool(p.threads);
+    auto inicio = std::chrono::steady_clock::now();
+    std::vector<PontoVarredura> pontos = executarVarredura(cfg, pool);
+    std::chrono::duration<double> gasto = std::chrono::steady_clock::now() - inicio;
+
+    const std::string saida = p.saida.empty() ? "varredura.csv" : p.saida;
+    bool binario = saida.size() >= 4 && saida.compare(saida.size() - 4, 4, ".bin") == 0;
+    if (binario) {
+        salvarBinario(pontos, saida);
+    } else {
+        salvarCsv(pontos, saida);
+    }
+
+    std::cout << "Pontos simulados: " << pontos.size() << " (" << pool.size() << " threads)\n";
+    std::cout << "Tempo real:       " << gasto.count() << " s\n";
+    std::cout << "Desempenho:       " << pontos.size() / gasto.count() << " pontos/s\n";
+    std::cout << "Resultados em:    " << saida << "\n";
+}
+
+
+// Sorteia as placas em paralelo e mostra a distribuição de f, T e duty em relação ao valor nominal
+static void monteCarlo(const ParametrosSim& p) {
+    ConfigMonteCarlo cfg;
+    cfg.r1 = p.R1;
+    cfg.r2 = p.R2;
+    cfg.c = p.C;
+    cfg.tolR1 = cfg.tolR2 = p.tolR / 100.0;
+    cfg.tolC = p.tolC / 100.0;
+    cfg.distribuicao = p.distribuicao;
+    cfg.amostras = p.monteCarlo;
+    cfg.semente = p.semente;
+
+    PoolThreads pool(p.threads);
+    auto inicio = std::chrono::steady_clock::now();
+    ResultadoMonteCarlo r = executarMonteCarlo(cfg, pool);
+    std::chrono::duration<double> gasto = std::chrono::steady_clock::now() - inicio;
+
+    std::cout << "Monte Carlo:      " << r.amostras << " placas (R ±" << p.tolR << "%, C ±" << p.tolC << "%, "
+              << (p.distribuicao == Distribuicao::Normal ? "normal" : "uniforme") << ", semente " << p.semente << ")\n";
+    std::cout << "Tempo real:       " << gasto.count() << " s (" << pool.size() << " threads, "
+              << r.amostras / gasto.count() << " placas/s)\n\n";
+
+    const double ps[] = {0.01, 0.05, 0.50, 0.95, 0.99};
+    // cabeçalho escrito à mão: setw conta bytes, e os acentos ocupam dois
+    std::cout << std::string(16, ' ') << "    nominal      média     desvio        mín         p1         p5"
+                                         "        p50        p95        p99        máx\n";
+    auto linha = [&ps](const char* nome, const EstatisticaMonteCarlo& e) {
+        std::cout << std::left << std::setw(16) << nome << std::right << std::setprecision(5)
+                  << std::setw(11) << e.nominal << std::setw(11) << e.media << std::setw(11) << e.desvioPadrao
+                  << std::setw(11) << e.histograma.getMinimo();
+        for (double q : ps) {
+            std::cout << std::setw(11) << e.percentile(q);
+        }
+        std::cout << std::setw(11) << e.histograma.getMaximo() << "\n";
+    };
+    linha("f (Hz)", r.frequencia);
+    linha("T (s)", r.periodo);
+    linha("duty", r.duty);
+    std::cout << std::setprecision(6);
+
+    double largura = 100.0 * (r.frequencia.percentile(0.95) - r.frequencia.percentile(0.05)) / r.frequencia.nominal;
+    std::cout << "\n90% das placas ficam numa faixa de " << largura << "% da frequência nominal\n";
+    if (!p.saida.empty()) {
+        salvarHistogramasCsv(r, p.saida);
+        std::cout << "Histogramas em:   " << p.saida << "\n";
+    }
+}
+
+
+// Grava 'ciclos' ciclos da forma de onda do 555 analógico desde que a placa foi ligada (tempo, tensão, saída)
+static void gravarFormaDeOnda(const Modelo555Analogico& modelo, const std::string& caminho, unsigned ciclos) {
+    std::ofstream out(caminho);
+    if (!out) {
+        throw std::runtime_error("não foi possível criar " + caminho);
+    }
+    const size_t n = 400 * ciclos;
+    const double fim = modelo.getFirstHigh() + ciclos * modelo.getPeriod();
+    const double dt = fim / n;
+    std::vector<double> v(n);
+    modelo.sample(0.0, dt, n, v.data());
+    out << "tempo_s,tensao_v,saida\n";
+    out.precision(9);
+    for (size_t i = 0; i < n; ++i) {
+        out << i * dt << ',' << v[i] << ',' << (modelo.output(i * dt) ? 1 : 0) << '\n';
+    }
+}
+
+
+// Converte o fluxo de instantes de --clock-externo (texto ou binário) para o formato binário
+static void converterClock(const ParametrosSim& p) {
+    auto inicio = std::chrono::steady_clock::now();
+    LeitorBordas entrada(p.clockExterno);
+    EscritorBordas saida(p.clockBinario);
+    std::vector<uint64_t> lote(ClockExterno::TamanhoLote);
+    while (size_t n = entrada.read(lote.data(), lote.size())) {
+        for (size_t i = 0; i < n; ++i) {
+            saida.write(lote[i]);
+        }
+    }
+    saida.close();
+    std::chrono::duration<double> gasto = std::chrono::steady_clock::now() - inicio;
+    std::cout << "Clock externo:    " << entrada.count() << " bordas de " << p.clockExterno << " ("
+              << (entrada.isBinary() ? "binário" : "texto") << ") gravadas em " << p.clockBinario << "\n";
+    std::cout << "Tempo real:       " << gasto.count() << " s ("
+              << ((gasto.count() > 0) ? entrada.count() / gasto.count() : 0.0) << " bordas/s)\n";
+}
+
+
+// Simula a placa por eventos: 555, clock externo, chave e botão R numa única linha do tempo
+static void simularEventos(const ParametrosSim& p) {
+    PlacaEventos placa(p.leds, p.R1, p.R2, p.C, p.digitos);
+    const ClockExterno* fluxo = nullptr;
+    if (p.extHz > 0) {
+        placa.setExternalClock(std::make_unique<Oscilador>(0.5 / p.extHz, 1.0 / p.extHz));
+    } else if (!p.clockExterno.empty()) {
+        auto clock = std::make_unique<ClockExterno>(p.clockExterno);
+        fluxo = clock.get();
+        placa.setExternalClock(std::move(clock));
+    }
+    placa.setSwitch(p.chave);
+
+    // cada --chave-em vira a chave em relação à posição anterior
+    std::vector<double> viradas = p.chaveEm;
+    std::sort(viradas.begin(), viradas.end());
+    ChaveClock posicao = p.chave;
+    for (double t : viradas) {
+        posicao = (posicao == ChaveClock::Interno555) ? ChaveClock::Externo : ChaveClock::Interno555;
+        placa.scheduleSwitch(t, posicao);
+    }
+    for (double t : p.resetEm) {
+        placa.scheduleReset(t);
+    }
+
+    auto inicio = std::chrono::steady_clock::now();
+    uint64_t n = placa.runUntil(p.tempo);
+    std::chrono::duration<double> gasto = std::chrono::steady_clock::now() - inicio;
+
+    const char* nomeChave = (placa.getSwitch() == ChaveClock::Interno555) ? "555" : "EXT";
+    std::cout << "555: f=" << placa.getChip555().getFrequency() << " Hz | clock externo: ";
+    if (p.extHz > 0) {
+        std::cout << p.extHz << " Hz\n";
+    } else if (fluxo) {
+        std::cout << p.clockExterno << " (" << (fluxo->isBinary() ? "binário" : "texto") << ", "
+                  << fluxo->getLidas() << " bordas lidas, " << placa.getSubidas(1) << " até o fim)\n";
+    } else {
+        std::cout << "desligado\n";
+    }
+    std::cout << "Eventos:          " << n << " (" << placa.getFontes() << " fontes de clock, "
+              << viradas.size() + p.resetEm.size() << " eventos de botão e chave)\n";
+    std::cout << "Tempo simulado:   " << placa.getTime() << " s\n";
+    std::cout << "Tempo real:       " << gasto.count() << " s\n";
+    std::cout << "Desempenho:       " << ((gasto.count() > 0) ? n / gasto.count() : 0.0) << " eventos/s\n";
+    std::cout << "Pulsos:           " << placa.getPulsosSequencial() << " no CD4017 | " << placa.getPulsosContador()
+              << " nos CD4026 (chave em " << nomeChave << " no fim)\n";
+    const Cascata4017& anel = placa.getChip4017();
+    if (p.leds <= 10) {
+        std::cout << "LEDs:    0b" << std::bitset<10>(anel.getOut()).to_string().substr(10 - p.leds) << "\n";
+    } else {
+        std::cout << "LEDs:    L" << anel.getPosition() + 1 << " aceso\n";
+    }
+    std::cout << "Display: " << placa.getDisplay() << "\n";
+}
+
+
+// Simula a placa com os atrasos de propagação e mostra o que um osciloscópio veria de errado
+static void simularAtrasos(const ParametrosSim& p) {
+    PlacaComAtrasos placa(p.leds, p.R1, p.R2, p.C, p.eletrica.vcc, p.piorCaso ? CantoAtrasos::Maximo : CantoAtrasos::Tipico);
+    if (p.analogico) {
+        Modelo555Analogico modelo(p.R1, p.R2, p.C, p.eletrica);
+        placa.setClock(std::make_unique<Oscilador>(modelo.getTHigh(), modelo.getPeriod()));
+    }
+    for (double t : p.resetEm) {
+        placa.scheduleReset(t);
+    }
+
+    auto inicio = std::chrono::steady_clock::now();
+    uint64_t n = placa.runUntil(p.tempo);
+    std::chrono::duration<double> gasto = std::chrono::steady_clock::now() - inicio;
+
+    const AtrasosCmos& a = placa.getAtrasos();
+    std::cout << "CD40xx em " << a.vdd << " V (" << (p.piorCaso ? "pior caso" : "típico") << "): CLOCK->saída do CD4017 "
+              << a.clockSaida4017 * 1e9 << " ns | CLOCK->segmentos " << a.clockSegmentos4026 * 1e9
+              << " ns | CLOCK->carry " << a.clockCarry4026 * 1e9 << " ns\n";
+    std::cout << "Subidas do clock: " << placa.getSubidas() << " (" << n << " eventos)\n";
+    std::cout << "Tempo simulado:   " << placa.getTime() << " s\n";
+    std::cout << "Tempo real:       " << gasto.count() << " s ("
+              << ((gasto.count() > 0) ? placa.getSubidas() / gasto.count() : 0.0) << " ciclos/s)\n";
+    std::cout << "Acomodação:       LEDs " << placa.getAcomodacaoLeds() * 1e9 << " ns | display "
+              << placa.getAcomodacaoDisplay() * 1e9 << " ns depois da subida do clock\n";
+
+    using Sinal = PlacaComAtrasos::Sinal;
+    using Violacao = PlacaComAtrasos::Violacao;
+    std::cout << "Glitches:         " << placa.getTotalGlitches() << "\n";
+    for (unsigned s = 0; s < PlacaComAtrasos::QtSinais; ++s) {
+        if (uint64_t g = placa.getGlitches(static_cast<Sinal>(s))) {
+            std::cout << "  " << PlacaComAtrasos::nome(static_cast<Sinal>(s)) << ": " << g << "\n";
+        }
+    }
+    // o primeiro de cada sinal, como exemplo
+    bool mostrado[PlacaComAtrasos::QtSinais] = {};
+    for (const PlacaComAtrasos::Glitch& g : placa.getRegistroGlitches()) {
+        unsigned s = static_cast<unsigned>(g.sinal);
+        if (!mostrado[s]) {
+            mostrado[s] = true;
+            std::cout << "    em " << g.instante << " s: " << PlacaComAtrasos::nome(g.sinal) << " mostra "
+                      << static_cast<unsigned>(g.valor) << " por " << g.largura * 1e9 << " ns\n";
+        }
+    }
+    std::cout << "Violações:        " << placa.getTotalViolacoes() << "\n";
+    for (unsigned v = 0; v < PlacaComAtrasos::QtViolacoes; ++v) {
+        if (uint64_t k = placa.getViolacoes(static_cast<Violacao>(v))) {
+            std::cout << "  " << PlacaComAtrasos::nome(static_cast<Violacao>(v)) << ": " << k << "\n";
+        }
+    }
+    const std::vector<PlacaComAtrasos::RegistroViolacao>& registro = placa.getRegistroViolacoes();
+    for (size_t i = 0; i < std::min<size_t>(registro.size(), 5); ++i) {
+        const PlacaComAtrasos::RegistroViolacao& v = registro[i];
+        std::cout << "    em " << v.instante << " s: " << PlacaComAtrasos::nome(v.chip) << ", " << PlacaComAtrasos::nome(v.tipo)
+                  << " (" << v.medido * 1e9 << " ns, mínimo " << v.minimo * 1e9 << " ns)\n";
+    }
+    std::cout << "LEDs:    0b" << std::bitset<10>(placa.getLeds()).to_string().substr(10 - p.leds) << "\n";
+    std::cout << "Display: " << placa.getDisplay() << "\n";
+}
+
+
+// Compila a netlist e avança todos os chips dela em tempo virtual
+static void simularNetlist(const ParametrosSim& p) {
+    CircuitoCompilado circuito(Netlist::readFile(p.netlist));
+    uint64_t n = (p.ciclos > 0) ? p.ciclos : static_cast<uint64_t>(p.tempo / circuito.getPeriod());
+
+    std::cout << "Netlist:          " << p.netlist << " (" << circuito.size() << " chips, cascata de "
+              << circuito.levels() << " níveis)\n";
+    std::cout << "555: f=" << 1.0 / circuito.getPeriod() << " Hz | T=" << circuito.getPeriod() << " s\n";
+
+    double gasto = 0.0;
+    {
+        auto inicio = std::chrono::steady_clock::now();
+        circuito.stepCycles(n);
+        std::chrono::duration<double> d = std::chrono::steady_clock::now() - inicio;
+        gasto = d.count();
+    }
+
+    std::cout << "Ciclos simulados: " << n << "\n";
+    std::cout << "Tempo simulado:   " << n * circuito.getPeriod() << " s\n";
+    std::cout << "Tempo real:       " << gasto << " s\n";
+    std::cout << "Desempenho:       " << ((gasto > 0) ? n / gasto : 0.0) << " ciclos/s\n";
+    for (size_t i = 0; i < circuito.size(); ++i) {
+        std::cout << "  " << circuito.name(i) << ": ";
+        if (circuito.type(i) == CircuitoCompilado::TipoChip::Chip4017) {
+            std::cout << "LEDs 0b" << std::bitset<10>(circuito.value(i)).to_string().substr(10 - circuito.limit(i)) << "\n";
+        } else {
+            std::cout << "display " << circuito.value(i) << "\n";
+        }
+    }
+}
+
+
+int main(int argc, char** argv) {
+    try {
+        ParametrosSim p = lerParametros(argc, argv);
+        if (p.varredura) {
+            varrer(p);
+            return EXIT_SUCCESS;
+        }
+        if (p.monteCarlo) {
+            monteCarlo(p);
+            return EXIT_SUCCESS;
+        }
+        if (!p.clockBinario.empty()) {
+            converterClock(p);
+            return EXIT_SUCCESS;
+        }
+        if (p.atrasos) {
+            simularAtrasos(p);
+            return EXIT_SUCCESS;
+        }
+        if (p.eventos) {
+            simularEventos(p);
+            return EXIT_SUCCESS;
+        }
+        if (!p.netlist.empty()) {
+            simularNetlist(p);
+            return EXIT_SUCCESS;
+        }
+
+        MotorVirtual simulacao(p.leds, p.R1, p.R2, p.C, p.tempoReal ? ModoTempo::TempoReal : ModoTempo::Virtual, p.digitos);
+        const Chip555& chip555 = simulacao.getChip555();
+
+        if (p.analogico) {
+            double fIdeal = chip555.getFrequency();
+            Modelo555Analogico modelo = simulacao.setModelo555(p.eletrica);
+            std::cout << "555 analógico:    Vcc=" << p.eletrica.vcc << " V | capacitor entre " << modelo.getVDisparo()
+                      << " e " << modelo.getVLimiar() << " V | tH=" << modelo.getTHigh() << " s | tL=" << modelo.getTLow()
+                      << " s | duty " << 100.0 * modelo.getDutyCycle() << "%\n";
+            std::cout << "                  primeiro nível alto " << modelo.getFirstHigh() << " s | f="
+                      << modelo.getFrequency() << " Hz (" << 100.0 * (modelo.getFrequency() - fIdeal) / fIdeal
+                      << "% em relação à aproximação 0.693)\n";
+            if (!p.formaDeOnda.empty()) {
+                gravarFormaDeOnda(modelo, p.formaDeOnda, 3);
+                std::cout << "Forma de onda em: " << p.formaDeOnda << "\n";
+            }
+        }
+        std::cout << "555: f=" << chip555.getFrequency() << " Hz | T=" << chip555.getPeriod() << " s\n";
+
+        Instrumentacao medidas;
+        if (!p.metricas.empty()) {
+            simulacao.setHistogramaPulso(&medidas.erroPulso);
+        }
+
+        // No modo virtual o rastro precisa ser completo: o motor espera a gravação quando a fila enche.
+        // No tempo real o clock tem prioridade e os eventos que não couberem são descartados (e contados).
+        std::unique_ptr<GravadorVcd> vcd;
+        if (!p.vcd.empty()) {
+            vcd = std::make_unique<GravadorVcd>(p.vcd, p.leds, chip555.getPeriod(), chip555.getTHigh(),
+                                                p.tempoReal ? GravadorVcd::Politica::Descartar : GravadorVcd::Politica::Bloquear);
+            simulacao.setRastro(vcd.get());
+        }
+
+        RastroPeriodico historico;
+        if (p.historico) {
+            simulacao.setHistorico(&historico);
+        }
+
+        RelatorioSimulacao r;
+        uint64_t estouros = 0;
+        if (p.salto) {
+            auto inicio = std::chrono::steady_clock::now();
+            estouros = (p.ciclos > 0) ? simulacao.advance(p.ciclos) : simulacao.advanceFor(p.tempo);
+            std::chrono::duration<double> gasto = std::chrono::steady_clock::now() - inicio;
+
+            r.ciclos = simulacao.getCiclos();
+            r.tempoSimulado = simulacao.getTempoSimulado();
+            r.tempoReal = gasto.count();
+            r.ciclosPorSegundo = (r.tempoReal > 0) ? (r.ciclos / r.tempoReal) : 0.0;
+        } else {
+            r = (p.ciclos > 0) ? simulacao.runCycles(p.ciclos) : simulacao.runFor(p.tempo);
+        }
+
+        if (vcd) {
+            simulacao.setRastro(nullptr);
+            vcd->close();
+        }
+
+        std::cout << "Ciclos simulados: " << r.ciclos << "\n";
+        std::cout << "Tempo simulado:   " << r.tempoSimulado << " s\n";
+        std::cout << "Tempo real:       " << r.tempoReal << " s\n";
+        std::cout << "Desempenho:       " << r.ciclosPorSegundo << " ciclos/s";
+        if (r.tempoReal > 0) {
+            std::cout << " (" << r.tempoSimulado / r.tempoReal << "x o tempo real)";
+        }
+        std::cout << "\n";
+
+        const Cascata4017& anel = simulacao.getChip4017();
+        if (p.leds <= 10) {
+            std::cout << "LEDs:    0b" << std::bitset<10>(anel.getOut()).to_string().substr(10 - p.leds) << "\n";
+        } else {
+            std::cout << "LEDs:    L" << anel.getPosition() + 1 << " aceso (CD4017 " << anel.getChipAtivo() + 1 << " de "
+                      << anel.getChips() << ", Q" << anel.getSaidaNoChip() << ")\n";
+        }
+        std::cout << "Display: " << simulacao.getDisplay() << "\n";
+        if (p.salto) {
+            std::cout << "Estouros do display (" << std::string(p.digitos, '9') << " -> " << std::string(p.digitos, '0')
+                      << "): " << estouros << "\n";
+        }
+
+        if (vcd) {
+            std::cout << "VCD:              " << p.vcd << " (" << vcd->written() << " eventos";
+            if (vcd->dropped()) {
+                std::cout << ", " << vcd->dropped() << " descartados";
+            }
+            std::cout << ")\n";
+        }
+
+        if (p.historico) {
+            simulacao.setHistorico(nullptr);
+            uint64_t bruto = historico.size() * sizeof(AmostraPlaca);
+            std::cout << "Histórico:        " << historico.bytes() << " bytes para " << historico.size() << " ciclos ("
+                      << historico.segments() << " trechos; " << bruto / std::max<size_t>(historico.bytes(), 1)
+                      << "x menor que " << bruto << " bytes sem compressão)\n";
+            for (uint64_t c : p.consultas) {
+                AmostraPlaca a = historico.at(c);
+                std::cout << "  ciclo " << c << ": LEDs 0b" << std::bitset<10>(a.leds).to_string().substr(10 - p.leds)
+                          << " | display " << int(a.dezena) << int(a.unidade) << " | carry " << a.carry << "\n";
+            }
+        }
+
+        if (!p.metricas.empty()) {
+            ResumoHistograma e = medidas.erroPulso.summary();
+            std::cout << "Erro do clock:    p50 " << e.p50 << " us | p99 " << e.p99 << " us | max " << e.maximo
+                      << " us (" << e.contagem << " intervalos)\n";
+            salvarMetricas(medidas, p.metricas, "apple-juice-sim leds=" + std::to_string(p.leds)
+                                                + " f=" + std::to_string(chip555.getFrequency()) + " Hz");
+            std::cout << "Métricas em:      " << p.metricas << "\n";
+        }
+    }
+    catch (const std::invalid_argument& e) {
+        std::cerr << "Erro nos parâmetros do simulador: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Erro inesperado: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
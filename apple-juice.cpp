@@ -29,12 +29,27 @@
 #include <string>                 // Manipulação de strings (std::string, std::to_string, etc.)
 #include <cmath>                  // Funções matemáticas (pow, sin, etc.)
 #include <cstdint>                // Tipos inteiros com tamanho fixo (uint32_t, int64_t, etc.)
-#include <mutex>                  // Controle de exclusão mútua para threads (std::mutex, std::lock_guard)
 #include <atomic>                 // Variáveis atômicas para comunicação segura entre threads (std::atomic)
 #include <stdexcept>              // Exceções padrão (std::invalid_argument)
 #include <thread>                 // Threads do C++ (std::thread)
+#include <mutex>                  // Mutex usado apenas para adormecer/acordar a thread do motor
+#include <condition_variable>     // Espera da thread do motor enquanto a placa está desligada
 #include <chrono>                 // Controle de tempo e delays (std::chrono::duration, sleep_for)
 #include <cstdlib>                // Funções utilitárias gerais da biblioteca C (std::exit, std::rand, std::abs, etc.)
+#include <vector>                 // Pixels do atlas de LEDs (std::vector)
+#include <algorithm>              // std::min, std::max, std::clamp
+#include <memory>                 // std::unique_ptr do gravador VCD
+
+// Tempo de CPU do processo. No Windows, sem NOGDI/NOUSER o <windows.h> colide com nomes da raylib (Rectangle, DrawText...)
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI
+    #define NOUSER
+    #define NOMINMAX
+    #include <windows.h>            // GetProcessTimes
+#else
+    #include <sys/resource.h>       // getrusage
+#endif
 
 
 /*
@@ -46,81 +61,23 @@
 */
 namespace ray{
     #include <raylib.h>
+    #include <rlgl.h>       // apenas para o blend separado de cor/alpha das camadas em RenderTexture
 }
 
 
+// Modelos dos chips (CD4026, NE555 e CD4017) e motor de simulação, compartilhados com o apple-juice-sim e os testes
+#include "simulacao/chips.hpp"
+#include "simulacao/motorVirtual.hpp"
+#include "simulacao/contadorBcd.hpp"
+#include "simulacao/analogico555.hpp"
+#include "simulacao/seqlock.hpp"
+#include "simulacao/instrumentacao.hpp"
+#include "simulacao/vcd.hpp"
+#include "simulacao/analisador.hpp"
+#include "simulacao/anelSpsc.hpp"
+#include "simulacao/clockExterno.hpp"
 
-/*
-    Classe base que simula o funcionamento de um display decodificador CD4026, responsável por incrementar a contagem 
-    de 0 a 9 e gerar um sinal de carry quando a contagem reinicia (Out volta a 0). 
-
-    A aplicação do modificador 'virtual' permite o polimorfismo, possibilitando que métodos da classe base sejam 
-    sobrescritos pelas classes derivadas.
-*/
-class Chip4026 {
-protected:
-    bool carryOut = false;      // Indica se houve estouro da contagem (Out voltou a 0)
-    unsigned int Out = 0;       // Valor atual do display (0 a 9)
 
-public:
-    virtual ~Chip4026() = default;
-
-    // Incrementa a contagem. Se atingir 9, reinicia e ativa carryOut
-    virtual void add() {
-        if (Out == 9) {
-            Out = 0;
-            carryOut = true;
-        } else {
-            Out++;
-            carryOut = false;
-        }
-    }
-
-    // Reseta o display e desativa o carry
-    virtual void reset() {
-        Out = 0;
-        carryOut = false;
-    }
-
-    // Retorna o valor atual do display
-    unsigned int getOut() const { 
-        return Out; 
-    }
-
-    // Retorna se houve carry na última contagem
-    bool getCarryOut() const { 
-        return carryOut; 
-    }
-};
-
-
-
-/*
-    Classe que representa o display das unidades.
-    Herda Chip4026 e mantém comportamento padrão da contagem de 0 a 9.
-*/
-class Unidade : public Chip4026 {
-public:
-    // O override indica que este método sobrescreve uma função virtual da classe base, assim o polimorfismo funciona em tempo de execução
-    void add() override {
-        Chip4026::add();
-    }
-};
-
-
-
-/*
-    Classe que representa o display das dezenas.
-    Herda Chip4026 e adiciona a funcionalidade de incrementar apenas quando recebe um carry da unidade anterior.
-*/
-class Dezena : public Chip4026 {
-public:
-    void addOnCarry(bool carryIn) {
-        if (carryIn) {
-            add(); 
-        }
-    }
-};
 
 /*  
     ------------------------------------------------------------------------------------
@@ -139,11 +96,9 @@ static void DrawSegment(ray::Vector2 pos, float width, float height, bool on, ra
 
 
 /*
-    static_cast<size_t>(Segment::A) converte o valor do enum class Segment para um índice válido de array.
-    O array seg[] armazena quais segmentos do display estão ligados (true) ou desligados (false).
-
-    Essa abordagem é mais segura e legível, garantindo que cada segmento seja referenciado corretamente pelo seu nome.
     Os segmentos são listados em seus datasheets por ordem alfabética, portanto, usar enum class garante melhor desenvolvimento.
+    A decodificação do valor para os segmentos acesos é a mesma do CD4026 (decodificarSegmentos, em simulacao/chips.hpp):
+    uma máscara com um bit por segmento, na ordem deste enum.
 */
 
 
@@ -154,104 +109,21 @@ enum class segments{
 };
 
 
-// Desenha um display de 7 segmentos com base no valor (0-9)
-static void DrawSevenSegment(ray::Vector2 pos, float size, unsigned int value, ray::Color color) {
+// Desenha um display de 7 segmentos a partir da máscara de segmentos acesos (bit 0 = a ... bit 6 = g)
+static void DrawSegmentMask(ray::Vector2 pos, float size, uint8_t acesos, ray::Color color) {
     float w = size * 0.2f;
     float h = size * 0.05f;
     float gap = size * 0.02f;
 
-    bool seg[7] = {false}; // definindo o valor de todos os elementos para "false"
-    switch(value) {
-        case 0: 
-            seg[static_cast<size_t>(segments::a)] = true;
-            seg[static_cast<size_t>(segments::b)] = true;
-            seg[static_cast<size_t>(segments::c)] = true;
-            seg[static_cast<size_t>(segments::d)] = true;
-            seg[static_cast<size_t>(segments::e)] = true;
-            seg[static_cast<size_t>(segments::f)] = true;
-            break;
-
-        case 1: 
-            seg[static_cast<size_t>(segments::b)] = true;
-            seg[static_cast<size_t>(segments::c)] = true;
-            break;
-
-        case 2: 
-            seg[static_cast<size_t>(segments::a)] = true;
-            seg[static_cast<size_t>(segments::b)] = true;
-            seg[static_cast<size_t>(segments::d)] = true;
-            seg[static_cast<size_t>(segments::e)] = true;
-            seg[static_cast<size_t>(segments::g)] = true;
-            break;
-
-        case 3: 
-            seg[static_cast<size_t>(segments::a)] = true;
-            seg[static_cast<size_t>(segments::b)] = true;
-            seg[static_cast<size_t>(segments::c)] = true;
-            seg[static_cast<size_t>(segments::d)] = true;
-            seg[static_cast<size_t>(segments::g)] = true;
-            break;
-
-        case 4: 
-            seg[static_cast<size_t>(segments::b)] = true;
-            seg[static_cast<size_t>(segments::c)] = true;
-            seg[static_cast<size_t>(segments::f)] = true;
-            seg[static_cast<size_t>(segments::g)] = true; 
-            break;
-
-        case 5: 
-            seg[static_cast<size_t>(segments::a)] = true;
-            seg[static_cast<size_t>(segments::c)] = true;
-            seg[static_cast<size_t>(segments::d)] = true;
-            seg[static_cast<size_t>(segments::f)] = true;
-            seg[static_cast<size_t>(segments::g)] = true;
-            break;
-
-        case 6: 
-            seg[static_cast<size_t>(segments::a)] = true;
-            seg[static_cast<size_t>(segments::c)] = true;
-            seg[static_cast<size_t>(segments::d)] = true;
-            seg[static_cast<size_t>(segments::e)] = true;
-            seg[static_cast<size_t>(segments::f)] = true;
-            seg[static_cast<size_t>(segments::g)] = true;
-            
-            break;
-
-        case 7: 
-            seg[static_cast<size_t>(segments::a)] = true;
-            seg[static_cast<size_t>(segments::b)] = true;
-            seg[static_cast<size_t>(segments::c)] = true;
-            break;
-
-        case 8: 
-            seg[static_cast<size_t>(segments::a)] = true;
-            seg[static_cast<size_t>(segments::b)] = true; 
-            seg[static_cast<size_t>(segments::c)] = true;
-            seg[static_cast<size_t>(segments::d)] = true; 
-            seg[static_cast<size_t>(segments::e)] = true;
-            seg[static_cast<size_t>(segments::f)] = true; 
-            seg[static_cast<size_t>(segments::g)] = true;
-            break;
-
-        case 9:  
-            seg[static_cast<size_t>(segments::a)] = true;
-            seg[static_cast<size_t>(segments::b)] = true; 
-            seg[static_cast<size_t>(segments::c)] = true;
-            seg[static_cast<size_t>(segments::d)] = true; 
-            seg[static_cast<size_t>(segments::f)] = true; 
-            seg[static_cast<size_t>(segments::g)] = true;
-            break;
-    }
-
     // vetor que armazena as posições dos segmentos
     ray::Vector2 positions[7] = {
         {pos.x + w + gap, pos.y},                        // A
         {pos.x + size - h, pos.y + w + gap},             // B
         {pos.x + size - h, pos.y + size - w - gap},      // C
-        {pos.x + w + gap, pos.y + size - h + 35},        // D
-        {pos.x, pos.y + size - w - gap},                 // E
-        {pos.x, pos.y + w + gap},                        // F
-        {pos.x + w + gap, pos.y + size/2 - h/2 + 20}     // G
+        {pos.x + w + gap, pos.y + size - h + size * (35.0f / 120.0f)},       // D
+        {pos.x, pos.y + size - w - gap},                                     // E
+        {pos.x, pos.y + w + gap},                                            // F
+        {pos.x + w + gap, pos.y + size/2 - h/2 + size * (20.0f / 120.0f)}    // G
     };
 
     // vetor que armazena as dimensões dos segmentos
@@ -266,112 +138,34 @@ static void DrawSevenSegment(ray::Vector2 pos, float size, unsigned int value, r
     };
 
     
-    for(int i=0; i<7; i++) {
-        DrawSegment(positions[i], dims[i].x, dims[i].y, seg[i], color);
+    for(size_t i = static_cast<size_t>(segments::a); i <= static_cast<size_t>(segments::g); i++) {
+        DrawSegment(positions[i], dims[i].x, dims[i].y, (acesos >> i) & 1u, color);
     }
 }
 
 
 /*
-    Simulação do Chip555 configurado em modo astável
-    Consulte a seção de Astable Mode (Free‑Running) no datasheet do NE555 / LM555 aproximadamente nas páginas 7–8, onde são apresentadas as
-    fórmulas e explicações para tHigh, tLow, período e frequência da oscilação.
+    Desenha a fileira de displays da esquerda (dígito mais significativo) para a direita (unidades).
+    Unidades e dezenas acendem os pinos a..g que os CD4026 da simulação entregam (EstadoPlaca::segUnidade e
+    segDezena, com o DISPLAY ENABLE já aplicado). Os dígitos acima das dezenas chegam em BCD compactado
+    (EstadoPlaca::altos): cada nibble vai direto para a tabela de segmentos, sem converter o contador para texto nem
+    para números a cada quadro.
 */
-class Chip555 {
-private:
-    double R1, R2, C;
-    double tHigh = 0.0;
-    double tLow  = 0.0;
-    double period = 0.0;
-    double freq   = 0.0;
-
-    // logarítmo natural de 2
-    const double Ln2    = 0.693;
-    std::atomic<bool> stateHigh{false};
-
-    void calcTimings() {
-        // Modo astável (aprox): tH = 0.693*(R1+R2)*C; tL = 0.693*R2*C
-        tHigh = Ln2 * (R1 + R2) * C;
-        tLow  = Ln2 * (R2) * C;
-        period = tHigh + tLow;
-        freq = (period > 0) ? (1.0 / period) : 0.0;
-    }
-
-public:
-    /*
-        Esse construtor cria um objeto Chip555, inicializa seus parâmetros R1, R2 e C, verifica 
-        se eles são válidos, e calcula os tempos de pulso e frequência para o sinal astável.
-    */
-    Chip555(double r1Ohms, double r2Ohms, double cFarads)
-        : R1(r1Ohms), R2(r2Ohms), C(cFarads) {
-        if (R1 <= 0 || R2 <= 0 || C <= 0) {
-            throw std::invalid_argument("R1, R2 e C precisam ser > 0");
-        }
-        calcTimings();
-    }
-
-    // Simula um ciclo de clock (HIGH e LOW) com delays
-    void pulse() {
-        stateHigh = true;
-        std::this_thread::sleep_for(std::chrono::duration<double>(tHigh));
-
-        stateHigh = false;
-        std::this_thread::sleep_for(std::chrono::duration<double>(tLow));
-    }
-
-    // estes métodos apenas acessam os valores sem alterá-los (const foi usado aqui como uma aplicação de segurança)
-    bool isHigh() const { 
-        return stateHigh; 
-    }
-
-    double getFrequency() const { 
-        return freq; 
-    }
-
-    double getPeriod() const { 
-        return period; 
-    }
-};
-
-
-// Chip4017 (contador johnsson)
-// Consulte o datasheet do CD4017 para informações mais detalhadas a respeito de seu funcionamento.
-class Chip4017 {
-private:
-    unsigned LimitReset;
-    uint32_t Out{0};
-
-public:
-    explicit Chip4017(unsigned limitReset)
-        : LimitReset(limitReset) {
-        if (LimitReset < 1 || LimitReset > 10) {
-            throw std::invalid_argument("LimitReset precisa estar entre 1 e 10.");
-        }
-        reset();
-    }
-
-    // método que reage ao pulso do clock deslocando o bit mais significativo para a direita
-    void shift() {
-        Out >>= 1;
-        if (Out == 0) {
-            Out = 1u << (LimitReset - 1);
-        }
-    }
-
-    // método para aplicar o reset no chips
-    void reset() {
-        Out = 1u << (LimitReset - 1);
+static void DrawDisplayRow(ray::Vector2 pos, float size, float passo, unsigned digitos, const EstadoPlaca& placa, ray::Color color) {
+    for (unsigned i = 0; i < digitos; ++i) {
+        unsigned d = digitos - 1 - i;       // posição do dígito (0 = unidades)
+        uint8_t acesos = (d == 0) ? placa.segUnidade
+                       : (d == 1) ? placa.segDezena
+                       : TabelaSegmentos[(placa.altos >> (4 * (d - 2))) & 0xFu];
+        DrawSegmentMask((ray::Vector2){ pos.x + i * passo, pos.y }, size, acesos, color);
     }
+}
 
-    // apenas retornam - não podem alterar o valor
-    uint32_t getOut() const { 
-        return Out;
-    }
 
-    unsigned getLimitReset() const { 
-        return LimitReset;                          
-    }
-};
+// Ajustes finos do glow (compartilhados pelo desenho direto e pelo atlas)
+static const int   GlowRings = 18;
+static const float GlowStep  = 1.5f;
+static const float GlowGamma = 1.5f;
 
 
 /*
@@ -379,9 +173,9 @@ public:
 */
 static void DrawLedGlow(ray::Vector2 center, float radius, ray::Color core, ray::Color glow) {
     // Ajustes finos do glow
-    const int rings = 18;        
-    const float step = 1.5f;     
-    const float gamma = 1.5f;    
+    const int rings = GlowRings;
+    const float step = GlowStep;
+    const float gamma = GlowGamma;
 
     for (int i = rings; i >= 1; --i) {
         float t = (float)i / (float)rings;      
@@ -409,6 +203,126 @@ static void DrawLedGlow(ray::Vector2 center, float radius, ray::Color core, ray:
 }
 
 
+/*
+    Atlas com os LEDs já rasterizados: o mesmo desenho do DrawLedGlow, mas feito uma única vez por raio e cor.
+
+    A célula 0 guarda o LED apagado e as demais guardam o LED aceso em cada nível da "respiração" do brilho;
+    a cada quadro, cada LED vira um único quad texturizado (DrawTexturePro) em vez de ~22 círculos com powf.
+    Os pixels são compostos na CPU com o operador "over", assim a transparência do brilho sai correta na textura.
+*/
+class LedGlowAtlas {
+private:
+    static const int NiveisBrilho = 16;         // quantização da respiração (suficiente para não ver degraus)
+
+    ray::Texture2D atlas{};
+    bool carregado = false;
+    float raio = 0.0f;
+    int celula = 0;                             // lado de cada célula em pixels
+
+    // Compõe 'cor' com a cobertura dada sobre o pixel rgba (valores de 0 a 1, sem pré-multiplicação)
+    static void compor(float* px, ray::Color cor, float cobertura) {
+        float sa = (cor.a / 255.0f) * cobertura;
+        if (sa <= 0.0f) {
+            return;
+        }
+        float da = px[3];
+        float oa = sa + da * (1.0f - sa);
+        px[0] = (cor.r / 255.0f * sa + px[0] * da * (1.0f - sa)) / oa;
+        px[1] = (cor.g / 255.0f * sa + px[1] * da * (1.0f - sa)) / oa;
+        px[2] = (cor.b / 255.0f * sa + px[2] * da * (1.0f - sa)) / oa;
+        px[3] = oa;
+    }
+
+    // Cobertura (com 1 px de suavização) de um círculo cheio de raio 'r' num pixel à distância 'd' do centro
+    static float cobreCirculo(float r, float d) {
+        return std::clamp(r - d + 0.5f, 0.0f, 1.0f);
+    }
+
+    // Rasteriza um LED (mesmas camadas do DrawLedGlow) na célula que começa na coluna 'x0'
+    void rasterizar(std::vector<unsigned char>& pixels, int largura, int x0, ray::Color core, ray::Color glow) const {
+        float cx = celula * 0.5f;
+        float cy = celula * 0.5f;
+        float hx = cx - raio * 0.25f;
+        float hy = cy - raio * 0.25f;
+
+        ray::Color hi = core;
+        hi.a = 90;
+        ray::Color borda = ray::Fade(ray::BLACK, 0.30f);
+
+        for (int y = 0; y < celula; ++y) {
+            for (int x = 0; x < celula; ++x) {
+                float px[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                float d = std::hypot(x + 0.5f - cx, y + 0.5f - cy);
+
+                for (int i = GlowRings; i >= 1; --i) {
+                    float t = (float)i / (float)GlowRings;
+                    ray::Color c = glow;
+                    c.a = (unsigned char)(glow.a * powf(t, GlowGamma) * 0.2f);
+                    compor(px, c, cobreCirculo(raio + i * GlowStep, d));
+                }
+                compor(px, core, cobreCirculo(raio, d));
+                compor(px, hi, cobreCirculo(raio * 0.45f, std::hypot(x + 0.5f - hx, y + 0.5f - hy)));
+                compor(px, borda, std::clamp(1.0f - std::fabs(d - raio), 0.0f, 1.0f));
+
+                unsigned char* dst = &pixels[4 * ((size_t)y * largura + x0 + x)];
+                for (int k = 0; k < 4; ++k) {
+                    dst[k] = (unsigned char)std::lround(px[k] * 255.0f);
+                }
+            }
+        }
+    }
+
+public:
+    // Gera (ou regenera, se o raio mudou) o atlas; precisa de uma janela aberta
+    void build(float radius, ray::Color onCore, ray::Color onGlow, ray::Color offCore, ray::Color offGlow) {
+        if (carregado && radius == raio) {
+            return;
+        }
+        unload();
+
+        raio = radius;
+        celula = (int)std::ceil(2.0f * (radius + GlowRings * GlowStep + 1.0f));
+        int largura = celula * (NiveisBrilho + 1);
+        std::vector<unsigned char> pixels((size_t)largura * celula * 4, 0);
+
+        rasterizar(pixels, largura, 0, offCore, offGlow);
+        for (int n = 0; n < NiveisBrilho; ++n) {
+            float breathe = (float)n / (float)(NiveisBrilho - 1);
+            ray::Color glow = onGlow;
+            glow.a = (unsigned char)(70 + 90 * breathe);        // mesma curva do laço de LEDs em run()
+            rasterizar(pixels, largura, celula * (n + 1), onCore, glow);
+        }
+
+        ray::Image img = { pixels.data(), largura, celula, 1, ray::PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+        atlas = ray::LoadTextureFromImage(img);                 // a textura é copiada; 'pixels' pode ser liberado
+        ray::SetTextureFilter(atlas, ray::TEXTURE_FILTER_BILINEAR);
+        carregado = true;
+    }
+
+    // Célula do atlas usada por um LED: só vale a pena redesenhar a animação quando ela muda
+    static int level(bool on, float breathe) {
+        return on ? 1 + (int)(std::clamp(breathe, 0.0f, 1.0f) * (NiveisBrilho - 1) + 0.5f) : 0;
+    }
+
+    // Desenha um LED centrado em 'center'; 'breathe' vai de 0 a 1
+    void draw(ray::Vector2 center, bool on, float breathe) const {
+        int n = level(on, breathe);
+        float lado = (float)celula;
+        ray::Rectangle origem  = { lado * n, 0.0f, lado, lado };
+        ray::Rectangle destino = { center.x - lado * 0.5f, center.y - lado * 0.5f, lado, lado };
+        ray::DrawTexturePro(atlas, origem, destino, (ray::Vector2){ 0.0f, 0.0f }, 0.0f, ray::WHITE);
+    }
+
+    // Libera a textura (antes de fechar a janela)
+    void unload() {
+        if (carregado) {
+            ray::UnloadTexture(atlas);
+            carregado = false;
+        }
+    }
+};
+
+
 // Desenha a placa: fundo escuro, retângulo arredondado e linhas verticais como textura
 static void DrawPanel(ray::Rectangle rec) {
     // fundo geral
@@ -425,31 +339,518 @@ static void DrawPanel(ray::Rectangle rec) {
 }
 
 
+/*
+    Camada estática da interface: tudo que não muda de um quadro para o outro (fundo, placa, rótulos dos LEDs,
+    informações do 555, botão e dica) é desenhado uma única vez num RenderTexture2D e, nos quadros seguintes,
+    vira um único DrawTextureRec. A camada só é refeita quando a janela muda de tamanho ou quando invalidate()
+    é chamado (mudança de configuração).
+
+    Ao desenhar numa textura, o blend padrão também multiplica o alpha do destino e deixa "buracos" sob textos
+    semitransparentes; por isso a camada é desenhada com blend separado (cor: alpha normal; alpha: soma). O resultado
+    fica com a cor pré-multiplicada pelo alpha, então a camada é colocada na tela com BLEND_ALPHA_PREMULTIPLY; assim
+    a mesma classe serve para camadas opacas (o fundo) e transparentes (os rótulos, por cima dos LEDs).
+*/
+class CamadaEstatica {
+private:
+    ray::RenderTexture2D alvo{};
+    bool carregada = false;
+    bool valida = false;
+
+public:
+    void invalidate() {
+        valida = false;
+    }
+
+    // Refaz a camada se preciso, chamando 'desenhar' dentro do modo textura; fora de BeginDrawing/EndDrawing
+    template<typename Desenho>
+    void update(Desenho desenhar) {
+        int w = ray::GetScreenWidth();
+        int h = ray::GetScreenHeight();
+        if (carregada && (ray::IsWindowResized() || alvo.texture.width != w || alvo.texture.height != h)) {
+            unload();
+        }
+        if (!carregada) {
+            alvo = ray::LoadRenderTexture(w, h);
+            carregada = true;
+            valida = false;
+        }
+        if (valida) {
+            return;
+        }
+
+        ray::BeginTextureMode(alvo);
+            ray::ClearBackground(ray::BLANK);
+            ray::rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+            ray::BeginBlendMode(ray::BLEND_CUSTOM_SEPARATE);
+                desenhar();
+            ray::EndBlendMode();
+        ray::EndTextureMode();
+        valida = true;
+    }
+
+    // Texturas de RenderTexture ficam de cabeça para baixo no OpenGL: a altura negativa desvira
+    void draw() const {
+        ray::Rectangle origem = { 0.0f, 0.0f, (float)alvo.texture.width, -(float)alvo.texture.height };
+        ray::BeginBlendMode(ray::BLEND_ALPHA_PREMULTIPLY);
+            ray::DrawTextureRec(alvo.texture, origem, (ray::Vector2){ 0.0f, 0.0f }, ray::WHITE);
+        ray::EndBlendMode();
+    }
+
+    void unload() {
+        if (carregada) {
+            ray::UnloadRenderTexture(alvo);
+            carregada = false;
+            valida = false;
+        }
+    }
+};
+
+
+/*
+    Analisador lógico sob a placa: CLK, Q0..Q9 e carry numa janela que rola com o tempo simulado.
+
+    Os pulsos chegam do motor por uma fila SPSC e vão para um TracoMipmap; cada coluna de pixels faz uma única
+    consulta (E/OU de todos os sinais no intervalo dela), então o custo do quadro depende da largura do painel e
+    não de quantos ciclos cabem na janela. Colunas vizinhas iguais viram um único traço. O CLK não é gravado:
+    sai do período e do tHigh do 555 (sobe em k * T e desce em k * T + tHigh).
+
+    Roda do mouse: zoom em torno do cursor; arrastar ou setas: rola para o passado; END: volta a acompanhar o tempo.
+*/
+class PainelAnalisador {
+private:
+    static constexpr unsigned BitCarry = 10;        // bits 0..9: Q0..Q9; bit 10: carry
+
+    ray::Rectangle area;
+    unsigned qtLeds;
+    double periodo, tHigh;
+
+    TracoMipmap traco;
+    std::vector<FaixaSinais> colunas;   // resultado da consulta de cada coluna (reaproveitado entre quadros)
+    std::vector<int> niveis;
+    double segundosPorPixel;
+    double fimJanela = 0.0;             // tempo simulado na borda direita (s)
+    bool aoVivo = true;
+    double relogioUltimoPulso = 0.0;    // GetTime() de quando o último pulso chegou
+
+    float xDados() const { return area.x + 70.0f; }
+    float larguraDados() const { return area.width - 80.0f; }
+    int linhas() const { return (int)qtLeds + 2; }
+    float alturaLinha() const { return (area.height - 30.0f) / linhas(); }
+
+    // Tempo simulado do fim do traço; com a placa ligada rola suave entre um pulso e outro
+    double fimAoVivo(bool ligado) const {
+        double t = (traco.endCycle() - 1) * periodo;
+        return t + (ligado ? std::min(ray::GetTime() - relogioUltimoPulso, periodo) : periodo);
+    }
+
+    // Palavra do analisador a partir de um evento do motor (Q0 é o primeiro LED, o bit mais alto do CD4017)
+    uint32_t palavra(const EventoVcd& e) const {
+        uint32_t w = 0;
+        for (unsigned i = 0; i < qtLeds; ++i) {
+            w |= ((e.leds >> (qtLeds - 1 - i)) & 1u) << i;
+        }
+        return w | (uint32_t(e.carry != 0) << BitCarry);
+    }
+
+    // Nível do CLK no intervalo [ta, tb): 0, 1 ou 2 (tem borda dentro)
+    int nivelClk(double ta, double tb) const {
+        if (tb - ta >= periodo) {
+            return 2;
+        }
+        double k = std::floor(ta / periodo);
+        double fase = ta - k * periodo;
+        bool alto = fase < tHigh;
+        double proximaBorda = alto ? k * periodo + tHigh : (k + 1) * periodo;
+        return (proximaBorda < tb) ? 2 : (alto ? 1 : 0);
+    }
+
+    static const char* unidadeTempo(double s, double& escala) {
+        if (s >= 3600.0) { escala = 1.0 / 3600.0; return "h"; }
+        if (s >= 60.0)   { escala = 1.0 / 60.0;   return "min"; }
+        if (s >= 1.0)    { escala = 1.0;          return "s"; }
+        if (s >= 1e-3)   { escala = 1e3;          return "ms"; }
+        if (s >= 1e-6)   { escala = 1e6;          return "us"; }
+        escala = 1e9;
+        return "ns";
+    }
+
+    // Desenha uma linha do painel a partir do nível de cada coluna (0, 1, 2 = mudou, 3 = sem dados)
+    void desenharLinha(const std::vector<int>& niveis, float y0, ray::Color cor) const {
+        const float alto = y0 + 3.0f;
+        const float baixo = y0 + alturaLinha() - 4.0f;
+        int x = 0;
+        const int n = (int)niveis.size();
+        while (x < n) {
+            int v = niveis[x];
+            int fim = x + 1;
+            while (fim < n && niveis[fim] == v) {
+                fim++;
+            }
+            float xa = xDados() + x;
+            float largura = (float)(fim - x);
+            if (v == 0 || v == 1) {
+                ray::DrawRectangleV((ray::Vector2){ xa, v ? alto : baixo - 1.0f }, (ray::Vector2){ largura, 2.0f }, cor);
+            } else if (v == 2) {
+                ray::DrawRectangleV((ray::Vector2){ xa, alto }, (ray::Vector2){ largura, baixo - alto + 1.0f }, ray::Fade(cor, 0.35f));
+            }
+            // transição entre alto e baixo: traço vertical
+            if (fim < n && v < 2 && niveis[fim] < 2 && niveis[fim] != v) {
+                ray::DrawRectangleV((ray::Vector2){ xDados() + fim - 1.0f, alto }, (ray::Vector2){ 1.5f, baixo - alto + 1.0f }, cor);
+            }
+            x = fim;
+        }
+    }
+
+public:
+    PainelAnalisador(ray::Rectangle r, unsigned leds, double periodoSegundos, double tHighSegundos)
+        : area(r), qtLeds(leds), periodo(periodoSegundos), tHigh(tHighSegundos) {
+        segundosPorPixel = 8.0 * periodo / larguraDados();       // começa mostrando 8 ciclos
+        colunas.resize((size_t)larguraDados());
+        niveis.resize((size_t)larguraDados());
+    }
+
+    // Tira os eventos da fila do motor; retorna true se chegou algum
+    bool drain(AnelSpsc<EventoVcd>& fila) {
+        EventoVcd lote[256];
+        bool chegou = false;
+        while (size_t n = fila.popBatch(lote, 256)) {
+            for (size_t i = 0; i < n; ++i) {
+                const EventoVcd& e = lote[i];
+                if (e.tipo == TipoEventoVcd::Reset) {
+                    traco.replaceLast(palavra(e));
+                } else if (e.tipo == TipoEventoVcd::Lote && e.lote > 1 && e.ciclo >= e.lote) {
+                    // lote em forma fechada: todos os LEDs acenderam no caminho; o ciclo final entra com o estado exato
+                    const uint32_t carry = uint32_t(1) << BitCarry;
+                    const uint32_t ultimo = palavra(e);
+                    uint32_t eLote = (qtLeds == 1) ? 1u : 0u;
+                    uint32_t ouLote = (1u << qtLeds) - 1;
+                    if (e.carryVariou) {
+                        ouLote |= carry;
+                    } else {
+                        eLote |= ultimo & carry;
+                        ouLote |= ultimo & carry;
+                    }
+                    traco.appendBlock(e.ciclo - e.lote + 1, e.lote - 1, eLote, ouLote);
+                    traco.append(e.ciclo, ultimo);
+                } else {
+                    traco.append(e.ciclo, palavra(e));
+                }
+            }
+            chegou = true;
+        }
+        if (chegou) {
+            relogioUltimoPulso = ray::GetTime();
+        }
+        return chegou;
+    }
+
+    // Zoom, rolagem e volta ao vivo; retorna true se a janela mudou
+    bool handleInput() {
+        bool mudou = false;
+        ray::Vector2 mouse = ray::GetMousePosition();
+        bool dentro = ray::CheckCollisionPointRec(mouse, area);
+        double largura = larguraDados();
+
+        float roda = dentro ? ray::GetMouseWheelMove() : 0.0f;
+        if (roda != 0.0f) {
+            // mantém parado o instante sob o cursor (ao vivo, a borda direita)
+            double xRel = aoVivo ? largura : std::clamp((double)(mouse.x - xDados()), 0.0, largura);
+            double tCursor = fimJanela - (largura - xRel) * segundosPorPixel;
+            segundosPorPixel = std::clamp(segundosPorPixel * std::pow(0.8, (double)roda), 1e-9, 1e3);
+            fimJanela = tCursor + (largura - xRel) * segundosPorPixel;
+            mudou = true;
+        }
+        if (dentro && ray::IsMouseButtonDown(ray::MOUSE_LEFT_BUTTON)) {
+            float dx = ray::GetMouseDelta().x;
+            if (dx != 0.0f) {
+                fimJanela -= dx * segundosPorPixel;
+                aoVivo = false;
+                mudou = true;
+            }
+        }
+        if (ray::IsKeyPressed(ray::KEY_LEFT) || ray::IsKeyPressed(ray::KEY_RIGHT)) {
+            double passo = 0.25 * largura * segundosPorPixel;
+            fimJanela += ray::IsKeyPressed(ray::KEY_LEFT) ? -passo : passo;
+            aoVivo = false;
+            mudou = true;
+        }
+        if (ray::IsKeyPressed(ray::KEY_END)) {
+            aoVivo = true;
+            mudou = true;
+        }
+        return mudou;
+    }
+
+    bool isLive() const {
+        return aoVivo;
+    }
+
+    /*
+        Acompanhando ao vivo, diz se a borda direita já andou pelo menos um pixel desde o último quadro desenhado:
+        antes disso redesenhar o painel não muda nada na tela.
+    */
+    bool needsScroll(bool ligado) const {
+        return aoVivo && !traco.empty() && std::abs(fimAoVivo(ligado) - fimJanela) >= segundosPorPixel;
+    }
+
+    // Moldura e nomes dos sinais (camada estática)
+    void drawStatic() const {
+        ray::DrawRectangleRounded(area, 0.04f, 8, (ray::Color){ 24, 27, 33, 255 });
+        ray::DrawRectangleRoundedLinesEx(area, 0.04f, 8, 1.0f, ray::Fade(ray::RAYWHITE, 0.10f));
+        const float h = alturaLinha();
+        for (int l = 0; l < linhas(); ++l) {
+            const char* nome = (l == 0) ? "CLK" : (l == linhas() - 1) ? "carry" : ray::TextFormat("Q%d", l - 1);
+            ray::DrawText(nome, (int)area.x + 12, (int)(area.y + 8 + l * h + h / 2 - 7), 14, ray::Fade(ray::RAYWHITE, 0.55f));
+        }
+    }
+
+    void draw(bool ligado) {
+        if (traco.empty()) {
+            return;
+        }
+        const int largura = (int)larguraDados();
+        const double tInicioTraco = traco.firstCycle() * periodo;
+        const double tFimTraco = fimAoVivo(ligado);
+        if (aoVivo) {
+            fimJanela = tFimTraco;
+        }
+        const double inicioJanela = fimJanela - largura * segundosPorPixel;
+
+        // uma consulta por coluna para todos os sinais; o CLK vem direto do período
+        for (int x = 0; x < largura; ++x) {
+            double ta = inicioJanela + x * segundosPorPixel;
+            double tb = ta + segundosPorPixel;
+            if (tb <= tInicioTraco || ta >= tFimTraco) {
+                colunas[x] = FaixaSinais();
+                niveis[x] = 3;
+                continue;
+            }
+            ta = std::max(ta, tInicioTraco);
+            tb = std::min(tb, tFimTraco);
+            uint64_t c0 = (uint64_t)std::floor(ta / periodo);
+            uint64_t c1 = std::max<uint64_t>((uint64_t)std::ceil(tb / periodo), c0 + 1);
+            colunas[x] = traco.query(c0, c1);
+            niveis[x] = nivelClk(ta, tb);
+        }
+
+        const float h = alturaLinha();
+        const float y0 = area.y + 8.0f;
+        const ray::Color corClk = (ray::Color){ 240, 200, 80, 255 };
+        const ray::Color corQ = (ray::Color){ 70, 255, 130, 255 };
+        const ray::Color corCarry = (ray::Color){ 120, 170, 255, 255 };
+
+        desenharLinha(niveis, y0, corClk);
+        for (int l = 1; l < linhas(); ++l) {
+            unsigned bit = (l == linhas() - 1) ? BitCarry : (unsigned)(l - 1);
+            for (int x = 0; x < largura; ++x) {
+                niveis[x] = colunas[x].nivel(bit);
+            }
+            desenharLinha(niveis, y0 + l * h, (l == linhas() - 1) ? corCarry : corQ);
+        }
+
+        double escala = 1.0;
+        const char* unidade = unidadeTempo(largura * segundosPorPixel, escala);
+        ray::DrawText(
+            ray::TextFormat("janela: %.3g %s | %s | roda: zoom, arrastar/setas: rolar, END: ao vivo, W: esconder",
+                            largura * segundosPorPixel * escala, unidade, aoVivo ? "ao vivo" : "pausado"),
+            (int)xDados(), (int)(area.y + area.height - 20), 14, ray::Fade(ray::RAYWHITE, 0.45f)
+        );
+    }
+};
+
+
+/*
+    HUD de medidas (tecla F3): uma linha por histograma com contagem, mediana, p99 e máximo, em microssegundos.
+*/
+static void DrawHud(const Instrumentacao& medidas, int x, int y) {
+    const int linha = 18;
+    const int colunas[] = { 0, 130, 185, 240, 295 };      // a fonte padrão não é monoespaçada: cada coluna tem seu x
+    const ray::Color cor = ray::Fade(ray::RAYWHITE, 0.80f);
+    auto todos = medidas.todos();
+
+    ray::DrawRectangle(x - 8, y - 6, 360, linha * ((int)todos.size() + 1) + 10, ray::Fade(ray::BLACK, 0.70f));
+    const char* titulos[] = { "medida (us)", "n", "p50", "p99", "max" };
+    for (int c = 0; c < 5; ++c) {
+        ray::DrawText(titulos[c], x + colunas[c], y, 14, cor);
+    }
+    for (size_t i = 0; i < todos.size(); ++i) {
+        ResumoHistograma r = todos[i].second->summary();
+        int yi = y + linha * ((int)i + 1);
+        ray::DrawText(todos[i].first.c_str(), x + colunas[0], yi, 14, cor);
+        ray::DrawText(ray::TextFormat("%llu", (unsigned long long)r.contagem), x + colunas[1], yi, 14, cor);
+        ray::DrawText(ray::TextFormat("%.1f", r.p50), x + colunas[2], yi, 14, cor);
+        ray::DrawText(ray::TextFormat("%.1f", r.p99), x + colunas[3], yi, 14, cor);
+        ray::DrawText(ray::TextFormat("%.1f", r.maximo), x + colunas[4], yi, 14, cor);
+    }
+}
+
+
+/*
+    Gráfico do 555 analógico: tensão do capacitor desde que a placa é ligada (o primeiro nível alto é mais longo) e,
+    embaixo, a saída. As linhas tracejadas são o limiar (2/3 Vcc) e o disparo (1/3 Vcc). Não muda durante a
+    execução, então é desenhado uma vez na camada estática.
+*/
+static void DrawFormaDeOnda(ray::Rectangle area, const Modelo555Analogico& modelo) {
+    const ray::Color cor = (ray::Color){ 70, 255, 130, 255 };
+    const ray::Color texto = ray::Fade(ray::RAYWHITE, 0.55f);
+    const float vcc = (float)modelo.getParametros().vcc;
+    const float yTensao = area.y + 20, hTensao = area.height - 60;
+    const float ySaida = area.y + area.height - 30, hSaida = 20;
+
+    ray::DrawRectangleRec(area, ray::Fade(ray::BLACK, 0.35f));
+    ray::DrawText(ray::TextFormat("555 analógico: Vcc=%.1f V | duty %.1f%% | f=%.3f Hz", vcc, 100.0 * modelo.getDutyCycle(), modelo.getFrequency()),
+                  (int)area.x + 6, (int)area.y + 4, 14, texto);
+
+    auto yDe = [&](double v) {
+        return yTensao + hTensao * (1.0f - (float)v / vcc);
+    };
+    for (double limiar : { modelo.getVLimiar(), modelo.getVDisparo() }) {
+        for (float x = area.x; x < area.x + area.width; x += 8) {
+            ray::DrawLineV((ray::Vector2){ x, yDe(limiar) }, (ray::Vector2){ x + 4, yDe(limiar) }, ray::Fade(ray::RAYWHITE, 0.25f));
+        }
+    }
+
+    // uma amostra por pixel, de 0 até o fim do terceiro ciclo
+    const int n = (int)area.width;
+    const double fim = modelo.getFirstHigh() + 3 * modelo.getPeriod();
+    const double dt = fim / n;
+    std::vector<double> v((size_t)n);
+    modelo.sample(0.0, dt, (size_t)n, v.data());
+    std::vector<ray::Vector2> tensao((size_t)n), saida((size_t)n);
+    for (int i = 0; i < n; ++i) {
+        tensao[i] = (ray::Vector2){ area.x + i, yDe(v[i]) };
+        saida[i] = (ray::Vector2){ area.x + i, modelo.output(i * dt) ? ySaida : ySaida + hSaida };
+    }
+    ray::DrawLineStrip(tensao.data(), n, cor);
+    ray::DrawLineStrip(saida.data(), n, ray::Fade(cor, 0.6f));
+}
+
+
 /*
     Esta classe é responsável pela parte principal do simulador: Ele simula o conjunto de todos os circuitos integrados em uma única classe
     Também é responsável pela interface gráfica
 */
 class BoardAppleJuice {
+public:
+    // Dígitos que cabem no estado publicado: unidades, dezenas e uma palavra de ContadorBcd
+    static constexpr unsigned MaxDigitos = 2 + ContadorBcd::DigitosPorPalavra;
+
 private:
     unsigned qtLeds;
+    unsigned qtDigitos;
     double R1, R2, C;
 
+    /*
+        Modo ocioso: a tela só é redesenhada quando o estado publicado, a entrada do usuário ou o nível da
+        animação dos LEDs mudam. Nos outros quadros apenas os eventos são lidos e a thread dorme.
+    */
+    bool sempreRedesenhar = false;  // comportamento antigo: redesenha tudo a 60 FPS
+    int fpsOcioso = 30;             // frequência de leitura da entrada quando nada muda
+    int fpsAnimacao = 15;           // orçamento de quadros por segundo para a respiração dos LEDs e a rolagem do analisador (0 desliga)
+
+    // Medidas de tempo (clock, quadros, leitura do estado, latência da entrada): F3 mostra o HUD
+    bool mostrarHud = false;
+    std::string arquivoMetricas;    // se não vazio, as medidas são gravadas aí ao sair (.json ou .csv)
+    std::string arquivoVcd;         // se não vazio, os sinais da placa são gravados aí em VCD
+
+    // 555 analógico (exponenciais exatas): muda os tempos do clock e mostra a tensão do capacitor
+    bool analogico = false;
+    ParametrosAnalogicos555 eletrica;
+
+    /*
+        Entrada de clock externo: os instantes vêm de um arquivo, FIFO ou da entrada padrão e uma thread própria os
+        confere com o relógio de parede, somando em 'pulsos' as subidas vencidas; a thread do motor repassa a soma ao
+        MotorVirtual. A thread só mexe nesta estrutura compartilhada, então pode ser solta ao fechar a janela mesmo
+        parada num pipe sem dados.
+    */
+    struct FluxoClockExterno {
+        std::unique_ptr<LeitorBordas> leitor;
+        std::atomic<bool> ativo{true};
+        std::atomic<bool> terminou{false};
+        std::atomic<uint64_t> pulsos{0};
+    };
+    std::shared_ptr<FluxoClockExterno> clockExterno;
+    std::string arquivoClockExterno;
+
+    // Tempo de CPU do processo (todas as threads), em segundos. std::clock() não serve: no MinGW ele mede tempo de parede
+    static double tempoCpu() {
+#ifdef _WIN32
+        FILETIME criacao, saida, kernel, usuario;
+        if (!GetProcessTimes(GetCurrentProcess(), &criacao, &saida, &kernel, &usuario)) {
+            return 0.0;
+        }
+        auto segundos = [](const FILETIME& t) {    // FILETIME conta intervalos de 100 ns
+            return (double)(((uint64_t)t.dwHighDateTime << 32) | t.dwLowDateTime) * 1e-7;
+        };
+        return segundos(kernel) + segundos(usuario);
+#else
+        struct rusage uso;
+        if (getrusage(RUSAGE_SELF, &uso) != 0) {
+            return 0.0;
+        }
+        return (uso.ru_utime.tv_sec + uso.ru_stime.tv_sec) + (uso.ru_utime.tv_usec + uso.ru_stime.tv_usec) * 1e-6;
+#endif
+    }
+
 public:
-    BoardAppleJuice(unsigned leds, double r1, double r2, double c)
-        : qtLeds(leds), R1(r1), R2(r2), C(c) {}
+    BoardAppleJuice(unsigned leds, double r1, double r2, double c, unsigned digitos = 2)
+        : qtLeds(leds), qtDigitos(digitos), R1(r1), R2(r2), C(c) {
+        if (digitos < 2 || digitos > MaxDigitos) {
+            throw std::invalid_argument("O display precisa ter de 2 a " + std::to_string(MaxDigitos) + " dígitos.");
+        }
+    }
+
+    void setRenderizacao(bool sempre, int fpsAnim) {
+        sempreRedesenhar = sempre;
+        fpsAnimacao = std::max(0, fpsAnim);
+    }
+
+    void setMetricas(const std::string& arquivo, bool hud) {
+        arquivoMetricas = arquivo;
+        mostrarHud = hud;
+    }
+
+    void setVcd(const std::string& arquivo) {
+        if (!arquivo.empty() && qtLeds > 10) {
+            throw std::invalid_argument("o VCD grava de 1 a 10 saídas do CD4017");
+        }
+        arquivoVcd = arquivo;
+    }
+
+    void setAnalogico(bool ligar, const ParametrosAnalogicos555& parametros) {
+        analogico = ligar;
+        eletrica = parametros;
+    }
+
+    // Abre já o fluxo do clock externo ("-" = entrada padrão), para que um arquivo inválido seja avisado antes da janela
+    void setClockExterno(const std::string& arquivo) {
+        arquivoClockExterno = arquivo;
+        clockExterno.reset();
+        if (!arquivo.empty()) {
+            clockExterno = std::make_shared<FluxoClockExterno>();
+            clockExterno->leitor = std::make_unique<LeitorBordas>(arquivo);
+        }
+    }
 
     void run() {
         // criando a janela do simulador e limitando em 60 FPS
-        ray::InitWindow(1200, 700, "Simulador do Apple Juice");
+        ray::InitWindow(1200, 900, "Simulador do Apple Juice");
         ray::SetTargetFPS(60); 
 
-        // criando os objetos e passando os parâmetros para os construtores
-        Chip4017 chip4017(qtLeds);
-        Chip555  chip555(R1, R2, C);
+        // Cores dos LEDs e atlas com os LEDs pré-rasterizados (um quad por LED a cada quadro)
+        const ray::Color offCore = (ray::Color){ 120, 125, 135, 255 };
+        const ray::Color offGlow = (ray::Color){ 120, 125, 135, 0 };
+        const ray::Color onCore  = (ray::Color){ 70, 255, 130, 220 };
+        const ray::Color onGlow  = (ray::Color){ 70, 255, 130, 255 };
+
+        LedGlowAtlas leds;
 
-        // criando o objeto de cada chip 4026: Um responsável por mostrar as dezenas e outra responsável por mostrar as unidades
-        Unidade unidade;
-        Dezena dezena;
+        // criando o motor da placa em tempo real: ele contém o 555, o CD4017 e os CD4026 (unidades, dezenas e os de cima)
+        MotorVirtual simulacao(qtLeds, R1, R2, C, ModoTempo::TempoReal, qtDigitos);
+        std::unique_ptr<Modelo555Analogico> modelo555;
+        if (analogico) {
+            modelo555 = std::make_unique<Modelo555Analogico>(simulacao.setModelo555(eletrica));
+        }
 
 
         /*
@@ -461,31 +862,229 @@ public:
         */
 
         // Variáveis atômicas para controlar o estado do simulador (running e ligado)
-        // e mutex para proteger o acesso aos chips compartilhados entre threads
         std::atomic<bool> running{true};
         std::atomic<bool> ligado{false};
 
-        std::mutex mtx; 
+        /*
+            Apenas a thread do motor mexe nos chips. Ela publica cada mudança em 'estado' (seqlock) e a renderização
+            lê uma cópia consistente sem travar; os resets da interface viram pedidos aplicados pelo motor.
+        */
+        SeqLock<EstadoPlaca> estado;
+        simulacao.setPublicador(&estado);
+
+        // Histogramas de tempo: o erro do clock é escrito pela thread do motor, o resto pelo laço de renderização
+        Instrumentacao medidas;
+        simulacao.setHistogramaPulso(&medidas.erroPulso);
+
+        // Rastro VCD gravado por uma thread de fundo; se a fila encher, o evento é descartado para o clock não atrasar
+        std::unique_ptr<GravadorVcd> vcd;
+        if (!arquivoVcd.empty()) {
+            vcd = std::make_unique<GravadorVcd>(arquivoVcd, qtLeds, simulacao.getChip555().getPeriod(),
+                                                simulacao.getChip555().getTHigh(), GravadorVcd::Politica::Descartar);
+            simulacao.setRastro(vcd.get());
+        }
+
+        // Pulsos para o analisador lógico (fila SPSC: o motor nunca espera; se ela encher, o painel repete o último estado).
+        // O analisador mostra as saídas de um CD4017: com uma cascata de vários ele fica desligado
+        const bool temAnalisador = qtLeds <= 10;
+        AnelSpsc<EventoVcd> sonda(1 << 16);
+        if (temAnalisador) {
+            simulacao.setSonda(&sonda);
+        }
+        PainelAnalisador analisador({ 60, 640, 1080, 240 }, std::min(qtLeds, 10u), simulacao.getChip555().getPeriod(), simulacao.getChip555().getTHigh());
+        bool mostrarAnalisador = temAnalisador;
+
+        // Com a placa desligada, a thread do motor dorme aqui até ser ligada, receber um reset ou o programa fechar
+        std::mutex mtxMotor;
+        std::condition_variable acordaMotor;
+        auto acordarMotor = [&]() {
+            { std::lock_guard<std::mutex> lock(mtxMotor); }
+            acordaMotor.notify_one();
+        };
 
         // Thread responsável pelo pulso do 555 e atualização do CD4017
         std::thread motor([&]{
             while (running.load()) {
                 if (!ligado.load()) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+                    simulacao.processRequests();
+                    std::unique_lock<std::mutex> lock(mtxMotor);
+                    acordaMotor.wait(lock, [&] { return !running.load() || ligado.load() || simulacao.hasRequests(); });
+
+                    // o relógio recomeça de agora: o tempo em que a placa ficou desligada não vira pulsos atrasados
+                    simulacao.resync();
+                    if (clockExterno) {
+                        clockExterno->pulsos.exchange(0);   // nem as bordas externas que chegaram com ela desligada
+                    }
                     continue;
                 }
-                // Clock interno do 555 (modo astável)
-                chip555.pulse(); // alterna entre HIGH/LOW internamente
-
-                // Atualiza os chips e displays a cada pulso
-                std::lock_guard<std::mutex> lock(mtx);
-                chip4017.shift();
-                unidade.add();
-                dezena.addOnCarry(unidade.getCarryOut());
+                if (clockExterno) {
+                    uint64_t n = clockExterno->pulsos.exchange(0, std::memory_order_relaxed);
+                    if (n) {
+                        simulacao.addExternalPulses(n);
+                    }
+                }
+                // Clock interno do 555 (modo astável) e atualização dos chips; em frequências altas vários
+                // pulsos vencidos são aplicados de uma vez, sem deriva em relação ao relógio real
+                simulacao.step();
             }
         });
 
+        // Thread do clock externo: lê os instantes em lotes e entrega as subidas quando o relógio de parede chega nelas
+        std::thread alimentador;
+        if (clockExterno) {
+            alimentador = std::thread([fluxo = clockExterno] {
+                using Relogio = std::chrono::steady_clock;
+                std::vector<uint64_t> lote(ClockExterno::TamanhoLote);
+                const auto inicio = Relogio::now();
+                try {
+                    while (fluxo->ativo.load()) {
+                        size_t n = fluxo->leitor->read(lote.data(), lote.size());
+                        if (n == 0) {
+                            break;
+                        }
+                        for (size_t i = 0; i < n && fluxo->ativo.load(); ) {
+                            uint64_t agora = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Relogio::now() - inicio).count());
+                            size_t j = std::upper_bound(lote.begin() + i, lote.begin() + n, agora) - lote.begin();
+                            if (j > i) {
+                                fluxo->pulsos.fetch_add(j - i, std::memory_order_relaxed);
+                                i = j;
+                            } else {
+                                // dorme até a próxima borda, no máximo 10 ms para perceber o fechamento da janela
+                                std::this_thread::sleep_for(std::chrono::nanoseconds(std::min<uint64_t>(lote[i] - agora, 10000000)));
+                            }
+                        }
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "Clock externo: " << e.what() << std::endl;
+                }
+                fluxo->terminou.store(true);
+            });
+        }
+
+
+
+        /*
+            Layout da placa (fixo durante a execução). Até 10 LEDs ficam numa linha, como na placa real; uma cascata
+            de CD4017 vira uma grade que ocupa a placa, com um rótulo por linha em vez de um por LED.
+        */
+        const ray::Rectangle panel = { 60, 80, 1080, 320 };
+        const bool grade = qtLeds > 10;
+        const float baseY = 280.0f;
+        const float margem = 120.0f;
+        const float areaUtil = 1200.0f - 2 * margem;
+        const float gap = areaUtil / std::max(1u, qtLeds - 1);
+        const float startX = margem;
+
+        const ray::Rectangle areaGrade = { 130, 115, 990, 230 };
+        const unsigned colunasGrade = grade ? std::min(qtLeds, (unsigned)std::ceil(std::sqrt(qtLeds * areaGrade.width / areaGrade.height))) : qtLeds;
+        const unsigned linhasGrade = (qtLeds + colunasGrade - 1) / colunasGrade;
+        const float passoGrade = std::min(areaGrade.width / colunasGrade, areaGrade.height / linhasGrade);
+        const float radius = grade ? std::max(2.0f, passoGrade * 0.3f) : 32.0f;
+
+        // centro do LED na posição 'k' do anel (0 = L1, o primeiro depois do reset)
+        auto centroLed = [&](unsigned k) {
+            if (!grade) {
+                return (ray::Vector2){ startX + k * gap, baseY };
+            }
+            return (ray::Vector2){ areaGrade.x + (k % colunasGrade + 0.5f) * passoGrade,
+                                   areaGrade.y + (k / colunasGrade + 0.5f) * passoGrade };
+        };
+
+        // Displays de 7 segmentos (encolhem para caber antes do botão) e botão de reset dos displays
+        const ray::Vector2 posDisplays = { 800-740, 450 };
+        const float passoDisplay = std::min(150.0f, 320.0f / qtDigitos);
+        const float displaySize = passoDisplay * 0.8f;
+        const ray::Rectangle btnReset = { 400, 450, 140, 40 };
+        const ray::Rectangle btnChave = { 400, 500, 140, 40 };      // chave do clock dos CD4026: 555 ou EXT
+
+        // Textos formatados uma única vez
+        const std::string info555 = ray::TextFormat("555: f=%.2f Hz | T=%.3f s", simulacao.getChip555().getFrequency(), simulacao.getChip555().getPeriod());
+        const int xFreqMedida = 60 + ray::MeasureText(info555.c_str(), 18) + 16;
+        const std::string statusLigado    = "Status: LIGADO  |  ENTER liga/desliga  |  R reset all  |  E clock 555/EXT";
+        const std::string statusDesligado = "Status: DESLIGADO  |  ENTER liga/desliga  |  R reset all  |  E clock 555/EXT";
+
+        // só rasteriza uma vez (ou se o raio mudar)
+        leds.build(radius, onCore, onGlow, offCore, offGlow);
+
+        // Tudo o que não muda entre quadros
+        CamadaEstatica fundo;
+        auto desenharFundo = [&]() {
+            DrawPanel(panel);
 
+            ray::DrawText("CLK", 845, 24, 16, ray::Fade(ray::RAYWHITE, 0.70f));
+
+            ray::DrawText(info555.c_str(), 60, 80, 18, ray::Fade(ray::RAYWHITE, 0.55f));
+
+            // Botão de reset 
+            ray::DrawRectangleRec(btnReset, ray::LIGHTGRAY);
+            ray::DrawText("Reset Display", (int)(btnReset.x + 5), (int)(btnReset.y + 5), 18, ray::BLACK);
+            ray::DrawRectangleRec(btnChave, ray::LIGHTGRAY);
+
+            // Mensagem de apoio
+            ray::DrawText("Dica: aumente C (ex.: 47uF) para ficar mais lento; diminua C (ex.: 10uF) para acelerar.", 60, 360, 16, ray::Fade(ray::RAYWHITE, 0.45f));
+
+            if (mostrarAnalisador) {
+                analisador.drawStatic();
+            }
+
+            if (modelo555) {
+                DrawFormaDeOnda({ 580, 430, 560, 180 }, *modelo555);
+            }
+
+            // LEDs apagados: não mudam nem respiram, então ficam no fundo; a cada quadro só o aceso é desenhado
+            for (unsigned k = 0; k < qtLeds; ++k) {
+                leds.draw(centroLed(k), false, 0.0f);
+            }
+        };
+
+        // Números dos LEDs: também estáticos, mas ficam por cima do brilho, então vão numa camada transparente própria
+        CamadaEstatica rotulos;
+        auto desenharRotulos = [&]() {
+            if (grade) {
+                // um rótulo por linha da grade (o primeiro LED dela)
+                const int fonte = (int)std::clamp(passoGrade, 8.0f, 16.0f);
+                for (unsigned k = 0; k < qtLeds; k += colunasGrade) {
+                    ray::Vector2 c = centroLed(k);
+                    const std::string texto = "L" + std::to_string(k + 1);
+                    ray::DrawText(texto.c_str(), (int)(areaGrade.x - 8 - ray::MeasureText(texto.c_str(), fonte)),
+                                  (int)(c.y - fonte / 2), fonte, ray::Fade(ray::RAYWHITE, 0.60f));
+                }
+                return;
+            }
+            for (unsigned k = 0; k < qtLeds; ++k) {
+                ray::Vector2 c = centroLed(k);
+                const std::string texto = "L" + std::to_string(k + 1);
+                ray::DrawText(texto.c_str(), (int)(c.x - 14), (int)(c.y + 52), 18, ray::Fade(ray::RAYWHITE, 0.60f));
+            }
+        };
+
+        // Controle do modo ocioso (ver sempreRedesenhar / fpsOcioso / fpsAnimacao)
+        uint64_t ultimaVersao = ~0ull;
+        int ultimoNivel = -1;
+        double ultimaAnimacao = 0.0;
+        double ultimaRolagem = 0.0;
+        bool forcarQuadro = true;
+
+        // Medição do uso de CPU: [0] = desligado, [1] = ligado
+        double inicioJanelaCpu = ray::GetTime();
+        double cpuJanela = tempoCpu();
+        double cpuAtual = 0.0;
+        double cpuAcumulada[2] = { 0.0, 0.0 };
+        double tempoAcumulado[2] = { 0.0, 0.0 };
+
+        // Instrumentação do laço: início do quadro anterior (se foi desenhado) e momento da entrada ainda não exibida
+        using RelogioLaco = std::chrono::steady_clock;
+        RelogioLaco::time_point quadroAnterior;
+        bool quadroSeguido = false;
+        RelogioLaco::time_point momentoEntrada;
+        bool entradaPendente = false;
+        double ultimoHud = 0.0;
+
+        // A chave vale a partir do próximo pulso; a posição é lida a cada quadro para o rótulo do botão
+        auto alternarChave = [&]() {
+            bool externo = simulacao.getSwitch() == ChaveClock::Externo;
+            simulacao.setSwitch(externo ? ChaveClock::Interno555 : ChaveClock::Externo);
+        };
 
         // colocando a condição "&&" junto ao running.load(), foi possível resolver o problema do loop infinito do programa que impedia o mesmo de ser fechado adequadamente
         while (running.load() && !ray::WindowShouldClose()) {
@@ -493,13 +1092,16 @@ public:
             // condicionais responsáveis pelo controle do simulador
             if (ray::IsKeyPressed(ray::KEY_ENTER)) {
                 ligado.store(!ligado.load());
+                acordarMotor();
             }
 
             if (ray::IsKeyPressed(ray::KEY_R)) {
-                std::lock_guard<std::mutex> lock(mtx);
-                chip4017.reset();
-                unidade.reset();
-                dezena.reset();
+                simulacao.requestReset();
+                acordarMotor();
+            }
+
+            if (ray::IsKeyPressed(ray::KEY_E)) {
+                alternarChave();
             }
 
             if (ray::IsKeyPressed(ray::KEY_ZERO)) {
@@ -507,18 +1109,26 @@ public:
                 break;
             }
 
-            uint32_t bits = 0;
-            {
-                std::lock_guard<std::mutex> lock(mtx);
-                bits = chip4017.getOut();
+            if (ray::IsKeyPressed(ray::KEY_F3)) {
+                mostrarHud = !mostrarHud;
             }
 
+            if (temAnalisador && ray::IsKeyPressed(ray::KEY_W)) {
+                mostrarAnalisador = !mostrarAnalisador;
+                fundo.invalidate();
+            }
 
-            // Cor padrão para os botões
-            ray::Color btnColor = ray::LIGHTGRAY;
+            // a fila do analisador é esvaziada mesmo com o painel escondido, para o traço não ter buracos
+            analisador.drain(sonda);
+            if (mostrarAnalisador && analisador.handleInput()) {
+                forcarQuadro = true;
+            }
+
+            // cópia consistente do estado da placa para este quadro
+            auto inicioLeitura = RelogioLaco::now();
+            EstadoPlaca placa = estado.load();
+            medidas.leituraEstado.recordDuration(RelogioLaco::now() - inicioLeitura);
 
-            // Botão de reset dos displays
-            ray::Rectangle btnReset = { 400, 450, 140, 40 };
 
             // Responsável por identificar se o botão esquerdo do mouse foi pressionado
             if (ray::IsMouseButtonPressed(ray::MOUSE_LEFT_BUTTON)) {
@@ -526,118 +1136,332 @@ public:
 
                 if (mouse.x >= btnReset.x && mouse.x <= btnReset.x + btnReset.width &&
                     mouse.y >= btnReset.y && mouse.y <= btnReset.y + btnReset.height) {
-                    std::lock_guard<std::mutex> lock(mtx);
-                    unidade.reset();
-                    dezena.reset();
+                    simulacao.requestResetDisplays();
+                    acordarMotor();
+                }
+
+                if (mouse.x >= btnChave.x && mouse.x <= btnChave.x + btnChave.width &&
+                    mouse.y >= btnChave.y && mouse.y <= btnChave.y + btnChave.height) {
+                    alternarChave();
                 }
             }
 
-            // renderizando as imagens na tela:
-            ray::BeginDrawing();
-                ray::Rectangle panel = { 60, 80, 1080, 320 };
-                DrawPanel(panel);
+            double agora = ray::GetTime();
+            float breathe = (fpsAnimacao > 0) ? 0.5f + 0.5f * sinf((float)agora * 3.2f) : 1.0f;
 
+            // acompanhando ao vivo com a placa ligada, a janela rola dentro do orçamento de animação e só quando
+            // a borda direita andou um pixel; sem orçamento, o painel só avança com os quadros dos pulsos
+            if (mostrarAnalisador && ligado.load() && fpsAnimacao > 0 && agora - ultimaRolagem >= 1.0 / fpsAnimacao
+                && analisador.needsScroll(true)) {
+                forcarQuadro = true;
+                ultimaRolagem = agora;
+            }
 
-                // Status para feedback do usuário 
-                const char* status = ligado.load() ? "LIGADO" : "DESLIGADO";
-                ray::DrawText(
-                    ray::TextFormat("Status: %s  |  ENTER liga/desliga  |  R reset all", status),
-                    40, 20, 18, ray::Fade(ray::RAYWHITE, 0.85f)
-                );
+            // Uso de CPU do processo, medido a cada segundo e acumulado separadamente para ligado e desligado
+            if (agora - inicioJanelaCpu >= 1.0) {
+                double cpu = tempoCpu();
+                cpuAtual = 100.0 * (cpu - cpuJanela) / (agora - inicioJanelaCpu);
+                int k = ligado.load() ? 1 : 0;
+                cpuAcumulada[k] += cpu - cpuJanela;
+                tempoAcumulado[k] += agora - inicioJanelaCpu;
+                cpuJanela = cpu;
+                inicioJanelaCpu = agora;
+                forcarQuadro = true;                        // atualiza o número exibido
+            }
 
-                ray::Color clk = chip555.isHigh() ? (ray::Color){ 50, 220, 130, 255 } : (ray::Color){ 200, 60, 60, 255 };
-                ray::DrawCircle(830, 30, 7, clk);
-                ray::DrawText("CLK", 845, 24, 16, ray::Fade(ray::RAYWHITE, 0.70f));
+            /*
+                Decide se este quadro precisa ser redesenhado: estado da placa publicado, entrada do usuário,
+                redimensionamento ou mudança no nível de brilho dos LEDs acesos (limitada pelo orçamento de animação).
+            */
+            uint64_t versao = estado.version();
+            int nivel = (fpsAnimacao > 0) ? LedGlowAtlas::level(true, breathe) : -1;
+            bool animar = nivel != ultimoNivel && (agora - ultimaAnimacao) >= 1.0 / fpsAnimacao;
+            bool entrada = ray::GetKeyPressed() != 0 || ray::IsMouseButtonPressed(ray::MOUSE_LEFT_BUTTON) || ray::IsWindowResized();
+            if (entrada && !entradaPendente) {
+                momentoEntrada = inicioLeitura;
+                entradaPendente = true;
+            }
 
-                ray::DrawText(
-                    ray::TextFormat("555: f=%.2f Hz | T=%.3f s", chip555.getFrequency(), chip555.getPeriod()),
-                    60, 80, 18, ray::Fade(ray::RAYWHITE, 0.55f)
-                );
+            // com o HUD aberto, os números são atualizados 4 vezes por segundo mesmo sem mudanças na placa
+            if (mostrarHud && agora - ultimoHud >= 0.25) {
+                forcarQuadro = true;
+                ultimoHud = agora;
+            }
 
+            if (!sempreRedesenhar && !forcarQuadro && !entrada && !animar && versao == ultimaVersao) {
+                // nada mudou: não desenha nem troca os buffers; só lê os eventos e dorme até a próxima leitura
+                ray::PollInputEvents();
+                std::this_thread::sleep_for(std::chrono::duration<double>(1.0 / fpsOcioso));
+                quadroSeguido = false;
+                continue;
+            }
+            forcarQuadro = false;
+            ultimaVersao = versao;
+            if (animar) {
+                ultimoNivel = nivel;
+                ultimaAnimacao = agora;
+            }
 
-                // LEDs existentes
-                float baseY = 280.0f;
-                float radius = 32.0f;
-                float margem = 120.0f;
-                float areaUtil = 1200.0f - 2 * margem;
-                float gap = areaUtil / (qtLeds - 1);
-                float startX = margem;
+            // refaz a camada estática só se ela foi invalidada (fora do BeginDrawing, pois usa outro alvo)
+            fundo.update(desenharFundo);
+            rotulos.update(desenharRotulos);
 
-                float t = (float)ray::GetTime();
-                float breathe = 0.5f + 0.5f * sinf(t * 3.2f);
+            // renderizando as imagens na tela: camada estática + o que muda (status, clock, LEDs e displays)
+            ray::BeginDrawing();
+                fundo.draw();
 
-                /*
-                    Loop que percorre todos os LEDs, desenhando cada um com brilho se estiver aceso e exibindo 
-                    seu número correspondente abaixo.
-                */
-                for (int i = (int)qtLeds - 1; i >= 0; --i) {
-                    bool on = ((bits >> i) & 1u) != 0;
-                    int idx = (int)qtLeds - 1 - i;
-                    ray::Vector2 c = { startX + idx * gap, baseY };
+                // Status para feedback do usuário 
+                ray::DrawText(ligado.load() ? statusLigado.c_str() : statusDesligado.c_str(), 40, 20, 18, ray::Fade(ray::RAYWHITE, 0.85f));
+                ray::DrawText(ray::TextFormat("CPU %.1f%%", cpuAtual), 1060, 24, 16, ray::Fade(ray::RAYWHITE, 0.55f));
 
-                    ray::Color offCore = (ray::Color){ 120, 125, 135, 255 };
-                    ray::Color offGlow = (ray::Color){ 120, 125, 135, 0 };
+                // frequência efetiva medida pelo motor, ao lado do f nominal (que está na camada estática)
+                ray::DrawText(ray::TextFormat("medido: %.2f Hz", placa.frequenciaMedida), xFreqMedida, 80, 18, ray::Fade(ray::RAYWHITE, 0.55f));
 
-                    unsigned char aGlow = (unsigned char)(70 + 90 * breathe);
-                    ray::Color onCore = (ray::Color){ 70, 255, 130, 220 };
-                    ray::Color onGlow = (ray::Color){ 70, 255, 130, aGlow };
+                ray::Color clk = placa.clock ? (ray::Color){ 50, 220, 130, 255 } : (ray::Color){ 200, 60, 60, 255 };
+                ray::DrawCircle(830, 30, 7, clk);
 
-                    if(on) {
-                        DrawLedGlow(c, radius, onCore, onGlow);
-                    } else {
-                        DrawLedGlow(c, radius, offCore, offGlow);
-                    } 
-
-                    ray::DrawText(
-                        ray::TextFormat("L%d", idx + 1),
-                        (int)(c.x - 14),
-                        (int)(c.y + 52),
-                        18,
-                        ray::Fade(ray::RAYWHITE, 0.60f)
-                    );
+                /*
+                    Os LEDs apagados já estão no fundo: só o aceso (um por vez, mesmo numa cascata de milhares) é
+                    desenhado, cobrindo antes o apagado com a cor da placa; os números vêm da camada de rótulos.
+                */
+                ray::Vector2 aceso = centroLed(placa.ledAceso);
+                ray::DrawCircleV(aceso, radius + 1.5f, (ray::Color){ 30, 34, 42, 255 });
+                leds.draw(aceso, true, breathe);
+                rotulos.draw();
+
+                DrawDisplayRow(posDisplays, displaySize, passoDisplay, qtDigitos, placa, (ray::Color){70, 255, 130, 255});
+
+                // rótulo da chave; em EXT sem fluxo ligado, o display fica parado (a entrada está em aberto)
+                const bool chaveExterna = simulacao.getSwitch() == ChaveClock::Externo;
+                ray::DrawText(chaveExterna ? "Clock: EXT" : "Clock: 555", (int)(btnChave.x + 5), (int)(btnChave.y + 5), 18, ray::BLACK);
+                if (chaveExterna && !clockExterno) {
+                    ray::DrawText("sem --clock-externo", (int)btnChave.x, (int)(btnChave.y + 44), 14, ray::Fade(ray::RAYWHITE, 0.55f));
                 }
 
-                // Displays de 7 segmentos
-                ray::Vector2 posUnidade = { 950-740, 450 };
-                ray::Vector2 posDezena  = { 800-740, 450 };
-                float displaySize = 120.0f;
-
-                DrawSevenSegment(posDezena, displaySize, dezena.getOut(), (ray::Color){70, 255, 130, 255});
-                DrawSevenSegment(posUnidade, displaySize, unidade.getOut(), (ray::Color){70, 255, 130, 255});
-
-                // Botão de reset 
-                ray::DrawRectangleRec(btnReset, btnColor);
-                ray::DrawText("Reset Display", (int)(btnReset.x + 5), (int)(btnReset.y + 5), 18, ray::BLACK);
+                if (mostrarAnalisador) {
+                    analisador.draw(ligado.load());
+                }
 
-                // Mensagem de apoio
-                ray::DrawText("Dica: aumente C (ex.: 47uF) para ficar mais lento; diminua C (ex.: 10uF) para acelerar.", 60, 360, 16, ray::Fade(ray::RAYWHITE, 0.45f));
+                if (mostrarHud) {
+                    DrawHud(medidas, 840, 440);
+                }
             
             ray::EndDrawing();
+
+            // tempo de quadro só entre quadros desenhados em sequência (os saltos do modo ocioso não contam)
+            auto fimQuadro = RelogioLaco::now();
+            if (quadroSeguido) {
+                medidas.tempoQuadro.recordDuration(fimQuadro - quadroAnterior);
+            }
+            quadroAnterior = fimQuadro;
+            quadroSeguido = true;
+            if (entradaPendente) {
+                medidas.latenciaEntrada.recordDuration(fimQuadro - momentoEntrada);
+                entradaPendente = false;
+            }
         }
 
         // Para a thread definindo 'running' como falso e aguarda sua finalização com join se ainda estiver ativa.
         running.store(false);
+        acordarMotor();
         if(motor.joinable()) {
             motor.join();
         }
+        if (alimentador.joinable()) {
+            clockExterno->ativo.store(false);
+            // parada num pipe sem dados, a leitura não volta: a thread é solta (só usa o fluxo compartilhado)
+            if (clockExterno->terminou.load()) {
+                alimentador.join();
+            } else {
+                alimentador.detach();
+            }
+        }
+        leds.unload();
+        fundo.unload();
+        rotulos.unload();
         ray::CloseWindow();
+
+        // Relatório de CPU desta instância (útil quando várias rodam na mesma máquina do laboratório)
+        for (int k = 0; k < 2; ++k) {
+            if (tempoAcumulado[k] > 0) {
+                std::cout << "CPU média " << (k ? "ligado:    " : "desligado: ")
+                          << 100.0 * cpuAcumulada[k] / tempoAcumulado[k] << "% (" << tempoAcumulado[k] << " s)\n";
+            }
+        }
+
+        if (vcd) {
+            simulacao.setRastro(nullptr);
+            vcd->close();
+            std::cout << "VCD em: " << arquivoVcd << " (" << vcd->written() << " eventos, " << vcd->dropped() << " descartados)\n";
+        }
+
+        if (!arquivoMetricas.empty()) {
+            std::string descricao = "apple-juice leds=" + std::to_string(qtLeds) + " f=" + std::to_string(simulacao.getChip555().getFrequency())
+                                  + " Hz threads=" + std::to_string(std::thread::hardware_concurrency());
+            salvarMetricas(medidas, arquivoMetricas, descricao);
+            std::cout << "Métricas em: " << arquivoMetricas << "\n";
+        }
     }
 };
 
 
+/*
+    Comparação do tempo de quadro entre o desenho direto (DrawLedGlow), o atlas (LedGlowAtlas) e o atlas com os LEDs
+    apagados numa camada estática (o caminho de run()), com 10 e 1000 LEDs.
+    Roda com o FPS destravado e imprime a média de milissegundos por quadro de cada caso.
+*/
+static void BenchGlow() {
+    ray::InitWindow(1200, 700, "Simulador do Apple Juice - benchmark dos LEDs");
+    ray::SetTargetFPS(0);
+
+    const ray::Color offCore = (ray::Color){ 120, 125, 135, 255 };
+    const ray::Color offGlow = (ray::Color){ 120, 125, 135, 0 };
+    const ray::Color onCore  = (ray::Color){ 70, 255, 130, 220 };
+    const ray::Color onGlow  = (ray::Color){ 70, 255, 130, 255 };
+    const int quadros = 300;
+
+    for (int qt : {10, 1000}) {
+        // grade de LEDs que caiba na janela: 10 LEDs ficam numa linha como na placa; 1000 ficam em 40 colunas
+        int colunas = (qt <= 10) ? qt : 40;
+        float raio = (qt <= 10) ? 32.0f : 6.0f;
+        float passoX = 1100.0f / colunas;
+        float passoY = (qt <= 10) ? 0.0f : 650.0f / ((qt + colunas - 1) / colunas);
+
+        LedGlowAtlas atlas;
+        atlas.build(raio, onCore, onGlow, offCore, offGlow);
+        auto centro = [&](int i) {
+            return (ray::Vector2){ 50.0f + (i % colunas) * passoX, (qt <= 10 ? 350.0f : 25.0f + (i / colunas) * passoY) };
+        };
+
+        // modo 2: os apagados numa camada estática (como em run()) e, a cada quadro, só os acesos
+        CamadaEstatica apagados;
+        auto desenharApagados = [&]() {
+            ray::ClearBackground((ray::Color){ 18, 20, 24, 255 });
+            for (int i = 0; i < qt; ++i) {
+                atlas.draw(centro(i), false, 0.0f);
+            }
+        };
+
+        for (int usarAtlas = 0; usarAtlas <= 2; ++usarAtlas) {
+            double inicio = 0.0;
+            for (int q = -10; q < quadros; ++q) {           // 10 quadros de aquecimento
+                if (q == 0) {
+                    inicio = ray::GetTime();
+                }
+                float breathe = 0.5f + 0.5f * sinf((float)ray::GetTime() * 3.2f);
+                ray::Color glow = onGlow;
+                glow.a = (unsigned char)(70 + 90 * breathe);
+
+                if (usarAtlas == 2) {
+                    apagados.update(desenharApagados);
+                }
+                ray::BeginDrawing();
+                ray::ClearBackground((ray::Color){ 18, 20, 24, 255 });
+                if (usarAtlas == 2) {
+                    apagados.draw();
+                }
+                for (int i = 0; i < qt; ++i) {
+                    ray::Vector2 c = centro(i);
+                    bool on = ((i + q) % 4) == 0;
+                    if (usarAtlas == 2) {
+                        if (on) {
+                            ray::DrawCircleV(c, raio + 1.5f, (ray::Color){ 18, 20, 24, 255 });
+                            atlas.draw(c, true, breathe);
+                        }
+                    } else if (usarAtlas) {
+                        atlas.draw(c, on, breathe);
+                    } else if (on) {
+                        DrawLedGlow(c, raio, onCore, glow);
+                    } else {
+                        DrawLedGlow(c, raio, offCore, offGlow);
+                    }
+                }
+                ray::EndDrawing();
+            }
+            double ms = (ray::GetTime() - inicio) * 1000.0 / quadros;
+            const char* nome[] = { "DrawLedGlow  ", "atlas        ", "fundo+acesos " };
+            std::cout << qt << " LEDs | " << nome[usarAtlas] << ": " << ms << " ms/quadro\n";
+        }
+        apagados.unload();
+        atlas.unload();
+    }
+    ray::CloseWindow();
+}
+
+
 // Função main: cria e executa o simulador Apple Juice
 // Uso do try e catch são ótimos para debug
-int main() {
+int main(int argc, char** argv) {
     try {
+        if (argc > 1 && std::string(argv[1]) == "--bench-glow") {
+            BenchGlow();
+            return EXIT_SUCCESS;
+        }
+
+        // Opções de renderização: --sempre-redesenhar (60 FPS fixos) e --fps-animacao N (0 desliga a respiração);
+        // medidas de tempo: --metricas ARQ (.json ou .csv, gravado ao sair) e --hud (abre com o HUD visível, F3 alterna);
+        // --vcd ARQ grava os sinais da placa para o GTKWave; --digitos N liga N CD4026 em cascata no display;
+        // --leds N troca o número de LEDs (acima de 10, vários CD4017 em cascata);
+        // --analogico usa o modelo analógico do 555 e mostra a tensão do capacitor (--vcc V muda a alimentação);
+        // --clock-externo ARQ liga na entrada de clock externo os instantes de ARQ (arquivo, FIFO ou - para a entrada
+        // padrão, em texto ou binário; a chave 555/EXT fica no botão ao lado do reset ou na tecla E)
+        bool sempre = false;
+        int fpsAnim = 15;
+        bool hud = false;
+        std::string metricas;
+        std::string vcd;
+        unsigned digitos = 2;
+        unsigned ledsOpcao = 4;
+        bool analogico = false;
+        ParametrosAnalogicos555 eletrica;
+        std::string clockExterno;
+        for (int i = 1; i < argc; ++i) {
+            std::string op = argv[i];
+            if (op == "--sempre-redesenhar") {
+                sempre = true;
+            } else if (op == "--fps-animacao" && i + 1 < argc) {
+                fpsAnim = std::stoi(argv[++i]);
+            } else if (op == "--metricas" && i + 1 < argc) {
+                metricas = argv[++i];
+            } else if (op == "--vcd" && i + 1 < argc) {
+                vcd = argv[++i];
+            } else if (op == "--analogico") {
+                analogico = true;
+            } else if (op == "--vcc" && i + 1 < argc) {
+                eletrica.vcc = std::stod(argv[++i]);
+                analogico = true;
+            } else if (op == "--leds" && i + 1 < argc) {
+                ledsOpcao = static_cast<unsigned>(std::stoul(argv[++i]));
+            } else if (op == "--digitos" && i + 1 < argc) {
+                digitos = static_cast<unsigned>(std::stoul(argv[++i]));
+            } else if (op == "--clock-externo" && i + 1 < argc) {
+                clockExterno = argv[++i];
+            } else if (op == "--hud") {
+                hud = true;
+            } else {
+                throw std::invalid_argument("opção desconhecida: " + op);
+            }
+        }
+
+        // Combinações que a linha de comando já mostra inválidas são recusadas antes de abrir a janela
+        if (!vcd.empty() && ledsOpcao > 10) {
+            throw std::invalid_argument("--vcd grava de 1 a 10 saídas do CD4017: não combina com --leds acima de 10");
+        }
+
         // Adicione os valores para simulação aqui:
         
-        unsigned leds = 4;      // Número total de LEDs para o 4017
+        unsigned leds = ledsOpcao;  // Número total de LEDs para o 4017 (padrão 4)
         double R1 = 1000.0;     // Resistor R1 do 555
         double R2 = 10000.0;    // Resistor R2 do 555
         double C  = 7.37e-6;    // Capacitor do 555
 
         // Cria o simulador e o executa
-        BoardAppleJuice appleJuice(leds, R1, R2, C); 
+        BoardAppleJuice appleJuice(leds, R1, R2, C, digitos); 
+        appleJuice.setRenderizacao(sempre, fpsAnim);
+        appleJuice.setMetricas(metricas, hud);
+        appleJuice.setVcd(vcd);
+        appleJuice.setAnalogico(analogico, eletrica);
+        appleJuice.setClockExterno(clockExterno);
         appleJuice.run();                             
     }
     catch (const std::invalid_argument& e) {
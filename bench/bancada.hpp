@@ -0,0 +1,249 @@
+/*
+    Bancada de medição dos benchmarks.
+
+    Cada caso roda uma vez para aquecer (caches, preditor de desvios, frequência da CPU) e depois 'repeticoes' vezes.
+    O resultado é a mediana do tempo por operação, que não se deixa levar por uma repetição interrompida pelo
+    sistema, junto com o mínimo, o máximo e o desvio absoluto mediano (MAD), em porcentagem da mediana, para mostrar
+    quanto a medida oscilou. Os resultados podem ser gravados em CSV ou JSON e comparados com uma execução anterior
+    (por exemplo, a da última versão) para acusar regressões.
+*/
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+// Impede o compilador de descartar um cálculo cujo resultado ninguém usa
+template<typename T>
+inline void naoOtimizar(const T& valor) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(&valor) : "memory");
+#else
+    static volatile const void* destino;
+    destino = &valor;
+#endif
+}
+
+
+// Resultado de um caso; tempos em nanossegundos por operação
+struct MedidaBench {
+    std::string grupo;
+    std::string nome;
+    double operacoes = 0.0;     // operações por repetição
+    unsigned repeticoes = 0;
+    double mediana = 0.0;
+    double minimo = 0.0;
+    double maximo = 0.0;
+    double mad = 0.0;           // desvio absoluto mediano, em % da mediana
+
+    double opsPorSegundo() const {
+        return (mediana > 0) ? 1e9 / mediana : 0.0;
+    }
+};
+
+
+class Bancada {
+private:
+    unsigned repeticoes;
+    std::string filtro;
+    std::vector<MedidaBench> medidas;
+
+    // Nome do caso alinhado em 'largura' colunas (conta caracteres UTF-8, não bytes, por causa dos acentos)
+    static std::string coluna(const std::string& texto, size_t largura) {
+        size_t caracteres = 0;
+        for (unsigned char ch : texto) {
+            caracteres += ((ch & 0xC0) != 0x80) ? 1 : 0;
+        }
+        return texto + std::string(caracteres < largura ? largura - caracteres : 1, ' ');
+    }
+
+    static double medianaDe(std::vector<double> v) {
+        std::sort(v.begin(), v.end());
+        size_t n = v.size();
+        return (n % 2) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+    }
+
+public:
+    explicit Bancada(unsigned qtRepeticoes = 11, const std::string& filtroGrupos = "")
+        : repeticoes(qtRepeticoes), filtro(filtroGrupos) {
+        if (repeticoes < 1) {
+            throw std::invalid_argument("é preciso pelo menos uma repetição");
+        }
+    }
+
+    // O grupo passa no filtro da linha de comando? (filtro vazio aceita todos)
+    bool selected(const std::string& grupo) const {
+        return filtro.empty() || grupo.find(filtro) != std::string::npos;
+    }
+
+    /*
+        Mede 'corpo', que executa 'operacoes' operações a cada chamada, e retorna a mediana em ns por operação.
+        Retorna 0 se o grupo foi excluído pelo filtro.
+    */
+    template<typename Corpo>
+    double measure(const std::string& grupo, const std::string& nome, double operacoes, Corpo corpo) {
+        if (!selected(grupo)) {
+            return 0.0;
+        }
+        corpo();
+
+        std::vector<double> tempos;
+        tempos.reserve(repeticoes);
+        for (unsigned r = 0; r < repeticoes; ++r) {
+            auto inicio = std::chrono::steady_clock::now();
+            corpo();
+            std::chrono::duration<double, std::nano> gasto = std::chrono::steady_clock::now() - inicio;
+            tempos.push_back(gasto.count() / operacoes);
+        }
+
+        MedidaBench m;
+        m.grupo = grupo;
+        m.nome = nome;
+        m.operacoes = operacoes;
+        m.repeticoes = repeticoes;
+        m.mediana = medianaDe(tempos);
+        m.minimo = *std::min_element(tempos.begin(), tempos.end());
+        m.maximo = *std::max_element(tempos.begin(), tempos.end());
+        std::vector<double> desvios;
+        for (double t : tempos) {
+            desvios.push_back(std::abs(t - m.mediana));
+        }
+        m.mad = (m.mediana > 0) ? 100.0 * medianaDe(desvios) / m.mediana : 0.0;
+        medidas.push_back(m);
+
+        std::ostringstream linha;
+        linha << "  " << coluna(grupo + "/" + nome, 46)
+              << std::setw(11) << std::setprecision(4) << m.mediana << " ns/op  ±" << std::setw(5)
+              << std::setprecision(2) << std::fixed << m.mad << "%" << std::defaultfloat
+              << "  (min " << std::setprecision(4) << m.minimo << ", " << std::setprecision(3) << m.opsPorSegundo() << " op/s)";
+        std::cout << linha.str() << "\n";
+        return m.mediana;
+    }
+
+    const std::vector<MedidaBench>& results() const {
+        return medidas;
+    }
+
+    // Uma linha por caso; é também o formato lido por readCsv() para comparar versões
+    void saveCsv(const std::string& caminho) const {
+        std::ofstream out(caminho);
+        if (!out) {
+            throw std::runtime_error("não foi possível criar " + caminho);
+        }
+        out << "grupo,nome,operacoes,repeticoes,mediana_ns,min_ns,max_ns,mad_pct,ops_por_s\n";
+        out << std::setprecision(9);
+        for (const MedidaBench& m : medidas) {
+            out << m.grupo << ',' << m.nome << ',' << m.operacoes << ',' << m.repeticoes << ',' << m.mediana << ','
+                << m.minimo << ',' << m.maximo << ',' << m.mad << ',' << m.opsPorSegundo() << '\n';
+        }
+    }
+
+    // 'descricao' identifica a máquina e a compilação (os números só valem comparados na mesma máquina)
+    void saveJson(const std::string& caminho, const std::string& descricao) const {
+        std::ofstream out(caminho);
+        if (!out) {
+            throw std::runtime_error("não foi possível criar " + caminho);
+        }
+        std::string desc;
+        for (char ch : descricao) {
+            if (ch == '"' || ch == '\\') {
+                desc += '\\';
+            }
+            desc += ch;
+        }
+        out << std::setprecision(9);
+        out << "{\n  \"descricao\": \"" << desc << "\",\n  \"unidade\": \"ns/op\",\n  \"medidas\": [";
+        for (size_t i = 0; i < medidas.size(); ++i) {
+            const MedidaBench& m = medidas[i];
+            out << (i ? ",\n" : "\n") << "    {\"grupo\": \"" << m.grupo << "\", \"nome\": \"" << m.nome
+                << "\", \"operacoes\": " << m.operacoes << ", \"repeticoes\": " << m.repeticoes
+                << ", \"mediana\": " << m.mediana << ", \"min\": " << m.minimo << ", \"max\": " << m.maximo
+                << ", \"mad_pct\": " << m.mad << ", \"ops_por_s\": " << m.opsPorSegundo() << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    // Escolhe o formato pela extensão (.csv ou .json)
+    void save(const std::string& caminho, const std::string& descricao) const {
+        bool csv = caminho.size() >= 4 && caminho.compare(caminho.size() - 4, 4, ".csv") == 0;
+        if (csv) {
+            saveCsv(caminho);
+        } else {
+            saveJson(caminho, descricao);
+        }
+    }
+
+    // Lê um CSV gravado por saveCsv()
+    static std::vector<MedidaBench> readCsv(const std::string& caminho) {
+        std::ifstream in(caminho);
+        if (!in) {
+            throw std::runtime_error("não foi possível abrir " + caminho);
+        }
+        std::vector<MedidaBench> r;
+        std::string linha;
+        std::getline(in, linha);        // cabeçalho
+        while (std::getline(in, linha)) {
+            if (linha.empty()) {
+                continue;
+            }
+            std::vector<std::string> campos;
+            std::istringstream ss(linha);
+            std::string campo;
+            while (std::getline(ss, campo, ',')) {
+                campos.push_back(campo);
+            }
+            if (campos.size() < 8) {
+                throw std::invalid_argument("linha inválida em " + caminho + ": " + linha);
+            }
+            MedidaBench m;
+            m.grupo = campos[0];
+            m.nome = campos[1];
+            m.operacoes = std::stod(campos[2]);
+            m.repeticoes = static_cast<unsigned>(std::stoul(campos[3]));
+            m.mediana = std::stod(campos[4]);
+            m.minimo = std::stod(campos[5]);
+            m.maximo = std::stod(campos[6]);
+            m.mad = std::stod(campos[7]);
+            r.push_back(m);
+        }
+        return r;
+    }
+
+    /*
+        Compara com uma execução anterior: mostra a variação da mediana de cada caso presente nas duas e retorna
+        quantos ficaram mais lentos que a base por mais de 'tolerancia' % (além da oscilação medida nas duas), tanto
+        na mediana quanto no mínimo.
+    */
+    unsigned compare(const std::vector<MedidaBench>& base, double tolerancia) const {
+        unsigned regressoes = 0;
+        std::cout << "\n[Comparação com a base (tolerância " << tolerancia << "%)]\n";
+        for (const MedidaBench& m : medidas) {
+            auto b = std::find_if(base.begin(), base.end(), [&](const MedidaBench& x) {
+                return x.grupo == m.grupo && x.nome == m.nome;
+            });
+            if (b == base.end() || b->mediana <= 0) {
+                continue;
+            }
+            double variacao = 100.0 * (m.mediana - b->mediana) / b->mediana;
+            double variacaoMinimo = (b->minimo > 0) ? 100.0 * (m.minimo - b->minimo) / b->minimo : variacao;
+            // o mínimo também precisa ter piorado: uma mediana alta com mínimo igual costuma ser só ruído da máquina
+            bool regressao = variacao > tolerancia + m.mad + b->mad && variacaoMinimo > tolerancia;
+            regressoes += regressao ? 1 : 0;
+            std::ostringstream linha;
+            linha << "  " << coluna(m.grupo + "/" + m.nome, 46)
+                  << std::showpos << std::fixed << std::setprecision(1) << std::setw(8) << variacao << "%"
+                  << (regressao ? "  REGRESSÃO" : "");
+            std::cout << linha.str() << "\n";
+        }
+        return regressoes;
+    }
+};
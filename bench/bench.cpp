@@ -0,0 +1,1052 @@
+/*
+    Benchmarks do simulador Apple Juice (não precisa da raylib).
+
+    Mede o custo por operação de cada caminho quente: os chips isolados, a decodificação dos segmentos do display,
+    um pulso da placa inteira em cada forma de montá-la e a vazão do lote e da varredura. Os números saem em
+    ns/op (mediana de várias repetições, ver bench/bancada.hpp) e podem ser gravados em CSV ou JSON e comparados
+    com uma execução anterior para acusar regressões entre versões.
+
+    Compilação e execução: make bench
+    Uso:
+        ./bench/bench [--filtro GRUPO] [--repeticoes N] [--saida ARQ.json|ARQ.csv] [--comparar BASE.csv] [--tolerancia PCT]
+
+    Exemplo (guarda a base da versão atual e, depois de mudar o código, compara com ela):
+        make bench BENCH_ARGS="--saida base.csv"
+        make bench BENCH_ARGS="--comparar base.csv"
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <queue>
+#include <functional>
+#include <utility>
+#include <fstream>
+#include <cstdio>
+
+#include "bancada.hpp"
+#include "../simulacao/motorVirtual.hpp"
+#include "../simulacao/lote.hpp"
+#include "../simulacao/netlist.hpp"
+#include "../simulacao/chipsEstaticos.hpp"
+#include "../simulacao/contadorBcd.hpp"
+#include "../simulacao/cascata4017.hpp"
+#include "../simulacao/analogico555.hpp"
+#include "../simulacao/varredura.hpp"
+#include "../simulacao/monteCarlo.hpp"
+#include "../simulacao/rodaTempo.hpp"
+#include "../simulacao/placaEventos.hpp"
+#include "../simulacao/clockExterno.hpp"
+#include "../simulacao/portas4017.hpp"
+#include "../simulacao/portas4026.hpp"
+#include "../simulacao/atrasos.hpp"
+#include "../simulacao/analisador.hpp"
+#include "../simulacao/poolThreads.hpp"
+
+
+// Parâmetros da linha de comando
+struct ParametrosBench {
+    std::string filtro;
+    unsigned repeticoes = 11;
+    std::string saida;
+    std::string comparar;
+    double tolerancia = 10.0;       // % acima da base que conta como regressão
+};
+
+
+static ParametrosBench lerParametros(int argc, char** argv) {
+    ParametrosBench p;
+    for (int i = 1; i < argc; ++i) {
+        std::string op = argv[i];
+        auto valor = [&]() {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("faltou o valor de " + op);
+            }
+            return std::string(argv[++i]);
+        };
+        if (op == "--filtro")          p.filtro = valor();
+        else if (op == "--repeticoes") p.repeticoes = static_cast<unsigned>(std::stoul(valor()));
+        else if (op == "--saida")      p.saida = valor();
+        else if (op == "--comparar")   p.comparar = valor();
+        else if (op == "--tolerancia") p.tolerancia = std::stod(valor());
+        else {
+            throw std::invalid_argument("opção desconhecida: " + op);
+        }
+    }
+    return p;
+}
+
+
+/*
+    Decodificação que DrawSevenSegment fazia antes da tabela do CD4026: um switch preenchendo um vetor de 7 bools.
+    Mantida aqui só como referência de desempenho para decodificarSegmentos().
+*/
+static void segmentosPorSwitch(unsigned int value, bool seg[7]) {
+    for (int i = 0; i < 7; ++i) {
+        seg[i] = false;
+    }
+    switch (value) {
+        case 0: seg[0] = seg[1] = seg[2] = seg[3] = seg[4] = seg[5] = true; break;
+        case 1: seg[1] = seg[2] = true; break;
+        case 2: seg[0] = seg[1] = seg[3] = seg[4] = seg[6] = true; break;
+        case 3: seg[0] = seg[1] = seg[2] = seg[3] = seg[6] = true; break;
+        case 4: seg[1] = seg[2] = seg[5] = seg[6] = true; break;
+        case 5: seg[0] = seg[2] = seg[3] = seg[5] = seg[6] = true; break;
+        case 6: seg[0] = seg[2] = seg[3] = seg[4] = seg[5] = seg[6] = true; break;
+        case 7: seg[0] = seg[1] = seg[2] = true; break;
+        case 8: seg[0] = seg[1] = seg[2] = seg[3] = seg[4] = seg[5] = seg[6] = true; break;
+        case 9: seg[0] = seg[1] = seg[2] = seg[3] = seg[5] = seg[6] = true; break;
+    }
+}
+
+
+// Chips isolados: o custo de cada método chamado a cada pulso
+static bool benchChips(Bancada& b) {
+    const uint64_t n = 4000000;
+
+    Chip4017 anel(10);
+    b.measure("chips", "Chip4017::shift", n, [&] {
+        for (uint64_t i = 0; i < n; ++i) {
+            anel.shift();
+        }
+        naoOtimizar(anel.getOut());
+    });
+
+    // Cascatas de CD4017: o pulso só toca a palavra com o bit aceso, então o custo não cresce com o número de LEDs
+    for (unsigned saidas : {10u, 1000u, 100000u}) {
+        Cascata4017 cascata(saidas);
+        b.measure("chips", "Cascata4017::shift " + std::to_string(saidas) + " saídas", n, [&] {
+            for (uint64_t i = 0; i < n; ++i) {
+                cascata.shift();
+            }
+            naoOtimizar(cascata.getPosition());
+        });
+    }
+
+    // Unidade::add() pela classe concreta: o carry aparece a cada 10 chamadas
+    Unidade unidade;
+    b.measure("chips", "Chip4026::add (carry 1 em 10)", n, [&] {
+        for (uint64_t i = 0; i < n; ++i) {
+            unidade.add();
+        }
+        naoOtimizar(unidade.getOut());
+    });
+
+    // A mesma chamada por ponteiro para a base, como faria um motor genérico
+    std::unique_ptr<Chip4026> base = std::make_unique<Unidade>();
+    b.measure("chips", "Chip4026::add virtual", n, [&] {
+        Chip4026* c = base.get();
+        for (uint64_t i = 0; i < n; ++i) {
+            c->add();
+        }
+        naoOtimizar(c->getOut());
+    });
+
+    // Dezena recebendo os carries da placa (1 a cada 10 pulsos) e recebendo carry em todo pulso
+    std::vector<uint8_t> carries(4096);
+    for (size_t i = 0; i < carries.size(); ++i) {
+        carries[i] = (i % 10 == 9);
+    }
+    Dezena dezena;
+    b.measure("chips", "Dezena::addOnCarry (carry 1 em 10)", n, [&] {
+        for (uint64_t i = 0; i < n; ++i) {
+            dezena.addOnCarry(carries[i & 4095] != 0);
+        }
+        naoOtimizar(dezena.getOut());
+    });
+    b.measure("chips", "Dezena::addOnCarry (carry sempre)", n, [&] {
+        for (uint64_t i = 0; i < n; ++i) {
+            dezena.addOnCarry(true);
+        }
+        naoOtimizar(dezena.getOut());
+    });
+
+    // Forma fechada: o custo não depende de quantos ciclos são saltados
+    const uint64_t saltos = 500000;
+    MotorVirtual salto(7, 1000.0, 10000.0, 7.37e-6);
+    b.measure("chips", "MotorVirtual::advance (10^9 ciclos)", saltos, [&] {
+        for (uint64_t i = 0; i < saltos; ++i) {
+            salto.advance(1000000000ull + i);
+        }
+        naoOtimizar(salto.getCiclos());
+    });
+    return true;
+}
+
+
+// Decodificação de 7 segmentos: tabela constexpr do CD4026 contra o switch antigo, com dígitos em ordem aleatória
+static bool benchSegmentos(Bancada& b) {
+    const uint64_t n = 2000000;
+    std::vector<uint8_t> digitos(4096);
+    uint32_t x = 12345;
+    for (auto& d : digitos) {
+        x = x * 1664525u + 1013904223u;
+        d = static_cast<uint8_t>((x >> 16) % 10);
+    }
+
+    uint64_t acesosTabela = 0, acesosSwitch = 0;
+    b.measure("segmentos", "decodificarSegmentos (tabela)", n, [&] {
+        uint64_t soma = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            uint8_t m = decodificarSegmentos(digitos[i & 4095]);
+            for (unsigned s = 0; s < 7; ++s) {
+                soma += (m >> s) & 1u;
+            }
+        }
+        acesosTabela = soma;
+        naoOtimizar(soma);
+    });
+    b.measure("segmentos", "switch do DrawSevenSegment antigo", n, [&] {
+        uint64_t soma = 0;
+        bool seg[7];
+        for (uint64_t i = 0; i < n; ++i) {
+            segmentosPorSwitch(digitos[i & 4095], seg);
+            naoOtimizar(seg);
+            for (unsigned s = 0; s < 7; ++s) {
+                soma += seg[s];
+            }
+        }
+        acesosSwitch = soma;
+        naoOtimizar(soma);
+    });
+
+    if (b.selected("segmentos") && acesosTabela != acesosSwitch) {
+        std::cout << "    ERRO: a tabela e o switch acendem segmentos diferentes\n";
+        return false;
+    }
+    return true;
+}
+
+
+/*
+    Um pulso da placa inteira (LimitReset 7), em cada forma de montá-la:
+        MotorVirtual    step() da API usada pela interface e pelo simulador sem interface; com o publicador (SeqLock
+                        lido por outra thread, como na interface) precisa sustentar mais de MinPublicacao pulsos/s
+        polimórfica     Chip4017 + CD4026 por ponteiro para a base (add() virtual, como num motor genérico)
+        estática        PlacaEstatica<7>, sem chamadas virtuais
+        netlist         CircuitoCompilado da netlist equivalente
+*/
+static bool benchPlaca(Bancada& b) {
+    const uint64_t n = 2000000;
+    const double MinPublicacao = 1e6;
+
+    MotorVirtual motor(7, 1000.0, 10000.0, 7.37e-6);
+    b.measure("placa", "MotorVirtual::step", n, [&] {
+        for (uint64_t i = 0; i < n; ++i) {
+            motor.step();
+        }
+        naoOtimizar(motor.getCiclos());
+    });
+
+    MotorVirtual publicando(7, 1000.0, 10000.0, 7.37e-6);
+    SeqLock<EstadoPlaca> estado;
+    publicando.setPublicador(&estado);
+    std::atomic<bool> lendo{b.selected("placa")};
+    std::thread leitor([&] {
+        uint64_t soma = 0;
+        while (lendo.load(std::memory_order_relaxed)) {
+            soma += estado.load().ciclos;
+        }
+        naoOtimizar(soma);
+    });
+    double tPublicando = b.measure("placa", "MotorVirtual::step publicando", n, [&] {
+        for (uint64_t i = 0; i < n; ++i) {
+            publicando.step();
+        }
+        naoOtimizar(publicando.getCiclos());
+    });
+    lendo.store(false);
+    leitor.join();
+    if (b.selected("placa") && tPublicando > 1e9 / MinPublicacao) {
+        std::cout << "    ERRO: publicação abaixo de " << MinPublicacao / 1e6 << " M pulsos/s\n";
+        return false;
+    }
+
+    Chip4017 anel(7);
+    std::unique_ptr<Chip4026> unidade = std::make_unique<Unidade>();
+    std::unique_ptr<Dezena> dezena = std::make_unique<Dezena>();
+    b.measure("placa", "polimórfica (virtual)", n, [&] {
+        for (uint64_t i = 0; i < n; ++i) {
+            anel.shift();
+            unidade->add();
+            dezena->addOnCarry(unidade->getCarryOut());
+        }
+        naoOtimizar(dezena->getOut());
+    });
+
+    PlacaEstatica<7> estatica;
+    b.measure("placa", "PlacaEstatica<7>::step", n, [&] {
+        estatica.stepCycles(n);
+        naoOtimizar(estatica.getDezena().getOut());
+    });
+
+    CircuitoCompilado circuito(Netlist::readText("555 osc out=clk r1=1000 r2=10000 c=7.37e-6\n"
+                                                 "4017 leds clk=clk limite=7\n"
+                                                 "4026 unidade clk=clk co=carry\n"
+                                                 "4026 dezena clk=carry\n"));
+    b.measure("placa", "CircuitoCompilado::step", n, [&] {
+        circuito.stepCycles(n);
+        naoOtimizar(circuito.getCiclos());
+    });
+
+    // Todas rodaram o mesmo número de pulsos (aquecimento + repetições): precisam terminar no mesmo estado
+    bool iguais = motor.getChip4017().getOut() == anel.getOut() && anel.getOut() == estatica.getChip4017().getOut()
+               && anel.getOut() == circuito.value(circuito.find("leds"))
+               && motor.getUnidade().getOut() == unidade->getOut() && unidade->getOut() == estatica.getUnidade().getOut()
+               && unidade->getOut() == circuito.value(circuito.find("unidade"))
+               && motor.getDezena().getOut() == dezena->getOut() && dezena->getOut() == estatica.getDezena().getOut()
+               && dezena->getOut() == circuito.value(circuito.find("dezena"));
+    if (b.selected("placa") && !iguais) {
+        std::cout << "    ERRO: estados finais diferentes entre as formas de montar a placa\n";
+        return false;
+    }
+    return true;
+}
+
+
+/*
+    Compara o lote SoA vetorizado com o laço sobre objetos MotorVirtual (um objeto por placa, como no simulador gráfico).
+    A operação é um pulso de uma placa.
+*/
+static bool benchLote(Bancada& b, size_t qtPlacas, uint64_t ciclos) {
+    std::vector<unsigned> limites(qtPlacas);
+    for (size_t i = 0; i < qtPlacas; ++i) {
+        limites[i] = 1 + static_cast<unsigned>(i % 10);
+    }
+
+    std::vector<std::unique_ptr<MotorVirtual>> objetos;
+    objetos.reserve(qtPlacas);
+    for (unsigned limite : limites) {
+        objetos.push_back(std::make_unique<MotorVirtual>(limite, 1000.0, 10000.0, 7.37e-6));
+    }
+    LotePlacas lote(limites);
+
+    const double passos = static_cast<double>(qtPlacas) * static_cast<double>(ciclos);
+    const std::string sufixo = " " + std::to_string(qtPlacas) + " placas";
+    double tObjetos = b.measure("lote", "objetos MotorVirtual" + sufixo, passos, [&] {
+        for (uint64_t c = 0; c < ciclos; ++c) {
+            for (auto& placa : objetos) {
+                placa->step();
+            }
+        }
+    });
+    double tLote = b.measure("lote", std::string("SoA ") + LotePlacas::kernel() + sufixo, passos, [&] {
+        lote.stepCycles(ciclos);
+    });
+    if (!b.selected("lote")) {
+        return true;
+    }
+
+    // Os dois caminhos precisam terminar no mesmo estado, senão a comparação não vale
+    bool iguais = true;
+    for (size_t i = 0; i < qtPlacas; ++i) {
+        iguais = iguais && objetos[i]->getChip4017().getOut() == lote.getOut(i)
+                        && objetos[i]->getUnidade().getOut()  == lote.getUnidade(i)
+                        && objetos[i]->getDezena().getOut()   == lote.getDezena(i);
+    }
+    std::cout << "    lote " << std::setprecision(3) << tObjetos / tLote << std::setprecision(6) << "x mais rápido\n";
+    if (!iguais) {
+        std::cout << "    ERRO: estados finais diferentes entre objetos e lote\n";
+    }
+    return iguais;
+}
+
+
+/*
+    Compara a netlist compilada com a fiação escrita à mão (a mesma sequência de MotorVirtual::applyPulse(), sem
+    rastros nem publicação), para uma cascata com 'digitos' CD4026 e dois CD4017. A operação é um pulso.
+*/
+static bool benchNetlist(Bancada& b, unsigned digitos, uint64_t ciclos) {
+    std::string texto = "555 osc out=clk r1=1000 r2=10000 c=7.37e-6\n"
+                        "4017 leds clk=clk co=volta limite=4\n"
+                        "4017 voltas clk=volta\n";
+    for (unsigned d = 0; d < digitos; ++d) {
+        texto += "4026 d" + std::to_string(d) + " clk=" + (d ? "c" + std::to_string(d - 1) : std::string("clk"))
+               + " co=c" + std::to_string(d) + "\n";
+    }
+    CircuitoCompilado circuito(Netlist::readText(texto));
+
+    Chip4017 leds(4), voltas(10);
+    std::vector<Chip4026> displays(digitos);
+    const std::string sufixo = " " + std::to_string(digitos) + " dígitos";
+    double tMao = b.measure("netlist", "fiação à mão" + sufixo, static_cast<double>(ciclos), [&] {
+        for (uint64_t c = 0; c < ciclos; ++c) {
+            uint32_t antes = leds.getOut();
+            leds.shift();
+            if (leds.getOut() > antes) {
+                voltas.shift();
+            }
+            bool carry = true;
+            for (auto& d : displays) {
+                if (!carry) {
+                    break;
+                }
+                d.add();
+                carry = d.getCarryOut();
+            }
+        }
+    });
+    double tCompilado = b.measure("netlist", "compilada" + sufixo, static_cast<double>(ciclos), [&] {
+        circuito.stepCycles(ciclos);
+    });
+    if (!b.selected("netlist")) {
+        return true;
+    }
+
+    bool iguais = circuito.value(circuito.find("leds")) == leds.getOut()
+               && circuito.value(circuito.find("voltas")) == voltas.getOut();
+    for (unsigned d = 0; d < digitos; ++d) {
+        iguais = iguais && circuito.value(circuito.find("d" + std::to_string(d))) == displays[d].getOut();
+    }
+    std::cout << "    compilada a " << std::setprecision(3) << tMao / tCompilado << std::setprecision(6) << "x da fiação à mão\n";
+    if (!iguais) {
+        std::cout << "    ERRO: estados finais diferentes entre a netlist e a fiação à mão\n";
+    }
+    return iguais;
+}
+
+
+/*
+    Placas com LimitReset de 1 a 10 em três formas, cada uma avançando 'ciclos' pulsos por placa; a operação é um
+    pulso de uma placa. A estática escolhe a especialização uma vez por placa com comPlacaEstatica().
+*/
+static bool benchChipsEstaticos(Bancada& b, size_t qtPlacas, uint64_t ciclos) {
+    struct PlacaPolimorfica {
+        Chip4017 anel;
+        std::unique_ptr<Chip4026> unidade;
+        std::unique_ptr<Dezena> dezena;
+    };
+    std::vector<PlacaPolimorfica> polimorficas;
+    std::vector<std::unique_ptr<MotorVirtual>> motores;
+    std::vector<unsigned> limites(qtPlacas);
+    for (size_t i = 0; i < qtPlacas; ++i) {
+        limites[i] = 1 + static_cast<unsigned>(i % 10);
+        polimorficas.push_back({Chip4017(limites[i]), std::make_unique<Unidade>(), std::make_unique<Dezena>()});
+        motores.push_back(std::make_unique<MotorVirtual>(limites[i], 1000.0, 10000.0, 7.37e-6));
+    }
+
+    const double passos = static_cast<double>(qtPlacas) * static_cast<double>(ciclos);
+    const std::string sufixo = " " + std::to_string(qtPlacas) + " placas";
+    double tPolimorfica = b.measure("estatico", "polimórfica" + sufixo, passos, [&] {
+        for (auto& p : polimorficas) {
+            for (uint64_t c = 0; c < ciclos; ++c) {
+                p.anel.shift();
+                p.unidade->add();
+                p.dezena->addOnCarry(p.unidade->getCarryOut());
+            }
+        }
+    });
+    b.measure("estatico", "MotorVirtual" + sufixo, passos, [&] {
+        for (auto& m : motores) {
+            for (uint64_t c = 0; c < ciclos; ++c) {
+                m->step();
+            }
+        }
+    });
+
+    // Cada repetição recomeça as placas estáticas; as outras acumulam: compara só o estado depois de uma repetição
+    std::vector<uint32_t> estaticas(qtPlacas * 3);
+    double tEstatica = b.measure("estatico", "PlacaEstatica" + sufixo, passos, [&] {
+        for (size_t i = 0; i < qtPlacas; ++i) {
+            comPlacaEstatica(limites[i], [&](auto& placa) {
+                placa.stepCycles(ciclos);
+                estaticas[3 * i] = placa.getChip4017().getOut();
+                estaticas[3 * i + 1] = placa.getUnidade().getOut();
+                estaticas[3 * i + 2] = placa.getDezena().getOut();
+            });
+        }
+    });
+    if (!b.selected("estatico")) {
+        return true;
+    }
+
+    bool iguais = true;
+    for (size_t i = 0; i < qtPlacas; ++i) {
+        MotorVirtual referencia(limites[i], 1000.0, 10000.0, 7.37e-6);
+        referencia.advance(ciclos);
+        iguais = iguais && referencia.getChip4017().getOut() == estaticas[3 * i]
+                        && referencia.getUnidade().getOut() == estaticas[3 * i + 1]
+                        && referencia.getDezena().getOut() == estaticas[3 * i + 2];
+    }
+    std::cout << "    estática " << std::setprecision(3) << tPolimorfica / tEstatica << std::setprecision(6) << "x mais rápida que a polimórfica\n";
+    if (!iguais) {
+        std::cout << "    ERRO: PlacaEstatica diferente do MotorVirtual\n";
+    }
+    return iguais;
+}
+
+
+/*
+    Display de 12 dígitos: um objeto Chip4026 por dígito (o carry anda de objeto em objeto), a cascata composta na
+    compilação e o contador em BCD compactado (o carry atravessa a palavra numa soma). A operação é um pulso.
+*/
+static bool benchDisplay(Bancada& b, uint64_t pulsos) {
+    const unsigned digitos = 12;
+    std::vector<std::unique_ptr<Chip4026>> objetos;
+    objetos.push_back(std::make_unique<Unidade>());
+    for (unsigned i = 1; i < digitos; ++i) {
+        objetos.push_back(std::make_unique<Dezena>());
+    }
+    CascataBcd<12> cascata;
+    ContadorBcd bcd(digitos);
+
+    const double n = static_cast<double>(pulsos);
+    b.measure("display", "12 objetos Chip4026", n, [&] {
+        for (uint64_t i = 0; i < pulsos; ++i) {
+            objetos[0]->add();
+            for (unsigned d = 1; d < digitos && objetos[d - 1]->getCarryOut(); ++d) {
+                objetos[d]->add();
+            }
+        }
+    });
+    b.measure("display", "CascataBcd<12>", n, [&] {
+        for (uint64_t i = 0; i < pulsos; ++i) {
+            cascata.add();
+        }
+    });
+    b.measure("display", "ContadorBcd 12 dígitos", n, [&] {
+        for (uint64_t i = 0; i < pulsos; ++i) {
+            bcd.add();
+        }
+    });
+
+    // Um quadro da interface: segmentos de todos os dígitos
+    std::vector<uint8_t> segs;
+    b.measure("display", "segmentos dos 12 dígitos", 1.0e5, [&] {
+        for (int i = 0; i < 100000; ++i) {
+            bcd.segments(segs);
+            naoOtimizar(segs[0]);
+        }
+    });
+    if (!b.selected("display")) {
+        return true;
+    }
+
+    // As três contaram o mesmo número de pulsos (aquecimento + repetições)
+    bool iguais = true;
+    for (unsigned d = 0; d < digitos; ++d) {
+        iguais = iguais && objetos[d]->getOut() == bcd.digit(d) && cascata[d].getOut() == bcd.digit(d);
+    }
+    if (!iguais) {
+        std::cout << "    ERRO: ContadorBcd diferente da cascata de Chip4026\n";
+    }
+    return iguais;
+}
+
+
+// Amostragem da forma de onda do 555 analógico: uma exponencial por amostra vs o laço vetorizado de sample()
+static bool benchAnalogico(Bancada& b) {
+    ParametrosAnalogicos555 params;
+    Modelo555Analogico modelo(1000.0, 10000.0, 7.37e-6, params);
+    const size_t n = 100000;
+    const double dt = 20 * modelo.getPeriod() / n;
+    std::vector<double> porAmostra(n), vetorizado(n);
+
+    b.measure("analogico", "voltage() por amostra", static_cast<double>(n), [&] {
+        for (size_t i = 0; i < n; ++i) {
+            porAmostra[i] = modelo.voltage(i * dt);
+        }
+        naoOtimizar(porAmostra[n - 1]);
+    });
+    b.measure("analogico", "sample() (8 faixas)", static_cast<double>(n), [&] {
+        modelo.sample(0.0, dt, n, vetorizado.data());
+        naoOtimizar(vetorizado[n - 1]);
+    });
+
+    // O clock com os tempos exatos custa o mesmo por pulso que com a aproximação 0.693
+    MotorVirtual motor(10, 1000.0, 10000.0, 7.37e-6);
+    motor.setModelo555(params);
+    b.measure("analogico", "step() com o 555 analógico", 1.0e6, [&] {
+        for (int i = 0; i < 1000000; ++i) {
+            motor.step();
+        }
+        naoOtimizar(motor.getCiclos());
+    });
+    if (!b.selected("analogico")) {
+        return true;
+    }
+
+    bool iguais = true;
+    for (size_t i = 0; i < n; ++i) {
+        iguais = iguais && std::abs(porAmostra[i] - vetorizado[i]) < 1e-9;
+    }
+    if (!iguais) {
+        std::cout << "    ERRO: sample() diferente de voltage()\n";
+    }
+    return iguais;
+}
+
+
+// Vazão do Monte Carlo das tolerâncias em todos os núcleos: a operação é uma placa sorteada
+static bool benchMonteCarlo(Bancada& b) {
+    ConfigMonteCarlo cfg;
+    cfg.amostras = 4000000;
+    PoolThreads pool;
+    PoolThreads uma(1);
+    b.measure("montecarlo", "placas (1 thread)", static_cast<double>(cfg.amostras), [&] {
+        naoOtimizar(executarMonteCarlo(cfg, uma).frequencia.media);
+    });
+    b.measure("montecarlo", "placas (" + std::to_string(pool.size()) + " threads)", static_cast<double>(cfg.amostras), [&] {
+        naoOtimizar(executarMonteCarlo(cfg, pool).frequencia.media);
+    });
+    return true;
+}
+
+
+// Simulação por eventos: a operação é um evento (borda de clock) retirado e reagendado
+static bool benchEventos(Bancada& b) {
+    // 1000 temporizadores periódicos com períodos diferentes: roda de tempo vs heap binário da biblioteca padrão
+    const unsigned fontes = 1000;
+    const int n = 1000000;
+    RodaDeTempo roda;
+    std::vector<uint64_t> periodos(fontes);
+    for (unsigned i = 0; i < fontes; ++i) {
+        periodos[i] = 1000 + 37 * i;
+        RodaDeTempo::No* no = roda.acquire();
+        no->fonte = i;
+        roda.schedule(no, periodos[i]);
+    }
+    uint64_t somaRoda = 0;
+    b.measure("eventos", "RodaDeTempo, 1000 fontes", n, [&] {
+        for (int k = 0; k < n; ++k) {
+            RodaDeTempo::No* no = roda.popUntil(UINT64_MAX);
+            somaRoda += no->fonte;
+            roda.schedule(no, no->tempo + periodos[no->fonte]);
+        }
+    });
+
+    using Item = std::pair<uint64_t, unsigned>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+    for (unsigned i = 0; i < fontes; ++i) {
+        heap.push({periodos[i], i});
+    }
+    uint64_t somaHeap = 0;
+    b.measure("eventos", "std::priority_queue, 1000 fontes", n, [&] {
+        for (int k = 0; k < n; ++k) {
+            Item e = heap.top();
+            heap.pop();
+            somaHeap += e.second;
+            heap.push({e.first + periodos[e.second], e.second});
+        }
+    });
+
+    // A placa inteira: só o 555 (duas bordas por ciclo) e com 100 osciladores extras
+    PlacaEventos placa(10, 1000.0, 10000.0, 7.37e-6);
+    double periodo = placa.getChip555().getPeriod();
+    b.measure("eventos", "PlacaEventos, só o 555", 2.0e6, [&] {
+        placa.runUntil(placa.getTime() + 1e6 * periodo);
+    });
+    PlacaEventos muitas(10, 1000.0, 10000.0, 7.37e-6);
+    for (int k = 0; k < 100; ++k) {
+        muitas.addSource(std::make_unique<Oscilador>(1e-4, 2e-4 + k * 1e-6, k * 1e-6), DestinoContador);
+    }
+    uint64_t feitos = 0;
+    b.measure("eventos", "PlacaEventos, 555 + 100 osciladores", 1.0e6, [&] {
+        uint64_t antes = muitas.getEventos();
+        while (muitas.getEventos() - antes < 1000000) {
+            muitas.step();
+        }
+        feitos += muitas.getEventos() - antes;
+    });
+    if (!b.selected("eventos")) {
+        return true;
+    }
+
+    // A roda e o heap entregaram os mesmos eventos na mesma ordem de fontes (empates à parte, a soma bate)
+    bool iguais = somaRoda == somaHeap;
+    if (!iguais) {
+        std::cout << "    ERRO: roda de tempo e heap entregaram eventos diferentes\n";
+    }
+    return iguais;
+}
+
+
+/*
+    Modo com atrasos de propagação contra a placa por eventos sem atrasos, as duas só com o 555 (4 LEDs, para o
+    RESET da realimentação entrar em cada volta do anel). A operação é um ciclo do 555; o custo do modo com atrasos
+    precisa ficar em até FatorAtrasos vezes o da PlacaEventos, como o cabeçalho de atrasos.hpp promete.
+*/
+static bool benchAtrasos(Bancada& b) {
+    const double FatorAtrasos = 3.0;
+    const double ciclos = 1e6;
+    PlacaEventos semAtrasos(4, 1000.0, 10000.0, 7.37e-6);
+    PlacaComAtrasos comAtrasos(4, 1000.0, 10000.0, 7.37e-6, 9.0);
+    const double periodo = semAtrasos.getChip555().getPeriod();
+
+    double tSem = b.measure("atrasos", "PlacaEventos, sem atrasos", ciclos, [&] {
+        semAtrasos.runUntil(semAtrasos.getTime() + ciclos * periodo);
+    });
+    double tCom = b.measure("atrasos", "PlacaComAtrasos, 9 V", ciclos, [&] {
+        comAtrasos.runUntil(comAtrasos.getTime() + ciclos * periodo);
+    });
+    if (!b.selected("atrasos")) {
+        return true;
+    }
+
+    // O mesmo número de ciclos nas duas, com os atrasos já assentados: mesmo estado e nenhuma violação
+    semAtrasos.runUntil(semAtrasos.getTime() + periodo / 2);
+    comAtrasos.runUntil(comAtrasos.getTime() + periodo / 2);
+    bool iguais = comAtrasos.getLeds() == semAtrasos.getChip4017().getOut() && comAtrasos.getDisplay() == semAtrasos.getDisplay()
+               && comAtrasos.getTotalViolacoes() == 0;
+    std::cout << "    com atrasos a " << std::setprecision(3) << tCom / tSem << std::setprecision(6) << "x do custo sem atrasos ("
+              << comAtrasos.getEventos() / static_cast<double>(comAtrasos.getSubidas()) << " eventos por ciclo)\n";
+    if (!iguais) {
+        std::cout << "    ERRO: estados diferentes entre a placa com e sem atrasos\n";
+    }
+    if (tCom > FatorAtrasos * tSem) {
+        std::cout << "    ERRO: modo com atrasos acima de " << FatorAtrasos << "x o custo sem atrasos\n";
+        iguais = false;
+    }
+    return iguais;
+}
+
+
+/*
+    Analisador lógico: um quadro do painel são 1080 consultas ao TracoMipmap, uma por coluna de pixels. A operação é
+    uma consulta; com 2^20 ciclos por coluna o quadro inteiro precisa caber em MaxQuadro, como com 8 ciclos.
+*/
+static bool benchAnalisador(Bancada& b) {
+    const double MaxQuadro = 5e6;       // ns
+    const int colunas = 1080;
+    const uint64_t total = 1ull << 21;
+    TracoMipmap traco;
+    for (uint64_t i = 0; i < total; ++i) {
+        traco.append(i, (uint32_t)(i & 1));
+    }
+    auto quadro = [&](uint64_t janela) {
+        uint32_t soma = 0;
+        for (int k = 0; k < colunas; ++k) {
+            uint64_t a = (uint64_t)k * (total - janela) / colunas;
+            soma += traco.query(a, a + janela).ou;
+        }
+        naoOtimizar(soma);
+    };
+    double pequena = b.measure("analisador", "TracoMipmap::query 8 ciclos", colunas, [&] { quadro(8); });
+    double grande = b.measure("analisador", "TracoMipmap::query 2^20 ciclos", colunas, [&] { quadro(1ull << 20); });
+
+    // Salto do motor com a sonda ligada: um evento Lote por chamada, sem passar ciclo a ciclo
+    const uint64_t saltos = 100000;
+    MotorVirtual motor(10, 1000.0, 10000.0, 7.37e-6);
+    AnelSpsc<EventoVcd> sonda(1 << 10);
+    motor.setSonda(&sonda);
+    b.measure("analisador", "advance com sonda (10^9 ciclos)", saltos, [&] {
+        EventoVcd lote[64];
+        for (uint64_t i = 0; i < saltos; ++i) {
+            motor.advance(1000000000ull + i);
+            if ((i & 63) == 63) {
+                while (sonda.popBatch(lote, 64)) {
+                }
+            }
+        }
+        naoOtimizar(motor.getCiclos());
+    });
+    if (!b.selected("analisador")) {
+        return true;
+    }
+
+    std::cout << "    quadro de " << colunas << " colunas: " << std::setprecision(3) << pequena * colunas / 1e3
+              << " us com 8 ciclos, " << grande * colunas / 1e3 << " us com 2^20" << std::setprecision(6) << "\n";
+    if (grande * colunas > MaxQuadro) {
+        std::cout << "    ERRO: quadro do analisador acima de " << MaxQuadro / 1e6 << " ms\n";
+        return false;
+    }
+    return true;
+}
+
+
+/*
+    CD4017 em portas lógicas fatiado em bits (64 placas por palavra) contra 64 Chip4017 comportamentais. A operação é
+    um pulso numa placa.
+*/
+static bool benchPortas4017(Bancada& b) {
+    const uint64_t pulsos = 200000;
+    std::vector<unsigned> limites(Lote4017Portas::Placas);
+    std::vector<Chip4017> chips;
+    for (unsigned i = 0; i < Lote4017Portas::Placas; ++i) {
+        limites[i] = 1 + i % 10;
+        chips.emplace_back(limites[i]);
+    }
+    Lote4017Portas lote(limites);
+    const double operacoes = static_cast<double>(pulsos) * Lote4017Portas::Placas;
+
+    b.measure("portas", "Chip4017::shift, 64 objetos", operacoes, [&] {
+        for (uint64_t p = 0; p < pulsos; ++p) {
+            for (Chip4017& c : chips) {
+                c.shift();
+            }
+        }
+        naoOtimizar(chips[7].getOut());
+    });
+    b.measure("portas", "Lote4017Portas::pulse, 64 placas em portas", operacoes, [&] {
+        for (uint64_t p = 0; p < pulsos; ++p) {
+            lote.pulse();
+        }
+        naoOtimizar(lote.stage(0));
+    });
+    if (!b.selected("portas")) {
+        return true;
+    }
+
+    // Mesmo número de pulsos nos dois: as saídas precisam bater
+    bool iguais = true;
+    for (unsigned i = 0; i < Lote4017Portas::Placas; ++i) {
+        iguais = iguais && lote.getOut(i) == chips[i].getOut();
+    }
+    if (!iguais) {
+        std::cout << "    ERRO: CD4017 em portas e Chip4017 divergiram\n";
+    }
+    return iguais;
+}
+
+
+/*
+    Displays das 64 placas: unidades e dezenas em cascata e os pinos a..g dos dois CD4026 a cada pulso, nos objetos
+    Unidade/Dezena (um getSegments() por chip) e no CD4026 em portas (os 7 segmentos de 64 chips por palavra).
+*/
+static bool benchPortas4026(Bancada& b) {
+    const uint64_t pulsos = 200000;
+    const unsigned placas = Lote4026Portas::Chips;
+    std::vector<Unidade> unidades(placas);
+    std::vector<Dezena> dezenas(placas);
+    Cascata4026Portas cascata(placas);
+    const double operacoes = static_cast<double>(pulsos) * placas;
+
+    b.measure("portas", "Unidade/Dezena + getSegments, 64 placas", operacoes, [&] {
+        uint32_t acesos = 0;
+        for (uint64_t p = 0; p < pulsos; ++p) {
+            for (unsigned i = 0; i < placas; ++i) {
+                unidades[i].add();
+                dezenas[i].addOnCarry(unidades[i].getCarryOut());
+                acesos += unidades[i].getSegments() + dezenas[i].getSegments();
+            }
+        }
+        naoOtimizar(acesos);
+    });
+    b.measure("portas", "Cascata4026Portas::pulse + segments, 64 placas", operacoes, [&] {
+        uint64_t seg[2 * Lote4026Portas::Segmentos];
+        uint64_t acesos = 0;
+        for (uint64_t p = 0; p < pulsos; ++p) {
+            cascata.pulse();
+            cascata.unidades().segments(seg);
+            cascata.dezenas().segments(seg + Lote4026Portas::Segmentos);
+            acesos += seg[0] ^ seg[13];
+        }
+        naoOtimizar(acesos);
+    });
+    if (!b.selected("portas")) {
+        return true;
+    }
+
+    bool iguais = true;
+    for (unsigned i = 0; i < placas; ++i) {
+        iguais = iguais && cascata.unidades().getSegments(i) == unidades[i].getSegments()
+               && cascata.dezenas().getSegments(i) == dezenas[i].getSegments();
+    }
+    if (!iguais) {
+        std::cout << "    ERRO: CD4026 em portas e Unidade/Dezena divergiram\n";
+    }
+    return iguais;
+}
+
+
+/*
+    Entrada de clock externo: leitura dos instantes (binário e texto) e a placa inteira consumindo o fluxo com a chave
+    em EXT. A operação é uma subida do clock externo; os arquivos são gerados antes e ficam no cache do sistema.
+*/
+static bool benchClockExterno(Bancada& b) {
+    if (!b.selected("clockexterno")) {
+        return true;
+    }
+    const uint64_t bordas = 10000000;
+    const uint64_t linhas = 2000000;
+    const char* binario = "bench_clock.ajck";
+    const char* texto = "bench_clock.txt";
+
+    // ~10 MHz com jitter: distâncias de 90 a 110 ns (1 byte cada em LEB128)
+    std::vector<uint64_t> instantes(bordas);
+    uint64_t t = 0;
+    for (uint64_t k = 0; k < bordas; ++k) {
+        t += 90 + (k * 2654435761u) % 21;
+        instantes[k] = t;
+    }
+    {
+        EscritorBordas escritor(binario);
+        for (uint64_t i : instantes) {
+            escritor.write(i);
+        }
+        std::ofstream out(texto);
+        char linha[32];
+        for (uint64_t k = 0; k < linhas; ++k) {
+            std::snprintf(linha, sizeof(linha), "%llu.%09llu\n", static_cast<unsigned long long>(instantes[k] / 1000000000),
+                          static_cast<unsigned long long>(instantes[k] % 1000000000));
+            out << linha;
+        }
+    }
+
+    std::vector<uint64_t> lote(ClockExterno::TamanhoLote);
+    uint64_t somaBinario = 0;
+    b.measure("clockexterno", "LeitorBordas, binário LEB128", static_cast<double>(bordas), [&] {
+        LeitorBordas leitor(binario);
+        while (size_t n = leitor.read(lote.data(), lote.size())) {
+            somaBinario = lote[n - 1];
+        }
+    });
+    uint64_t somaTexto = 0;
+    b.measure("clockexterno", "LeitorBordas, texto em segundos", static_cast<double>(linhas), [&] {
+        LeitorBordas leitor(texto);
+        while (size_t n = leitor.read(lote.data(), lote.size())) {
+            somaTexto = lote[n - 1];
+        }
+    });
+
+    // Fluxo inteiro nos CD4026: as bordas entre dois eventos do 555 entram em lote
+    std::string display;
+    b.measure("clockexterno", "PlacaEventos + ClockExterno, chave em EXT", static_cast<double>(bordas), [&] {
+        PlacaEventos placa(10, 1000.0, 10000.0, 7.37e-6);
+        placa.setExternalClock(std::make_unique<ClockExterno>(binario));
+        placa.setSwitch(ChaveClock::Externo);
+        placa.runUntil(instantes.back() * 1e-9);
+        display = placa.getDisplay();
+        naoOtimizar(placa.getPulsosContador());
+    });
+    std::remove(binario);
+    std::remove(texto);
+
+    // O leitor devolveu os mesmos instantes do gerador e a placa contou todas as subidas
+    std::string esperado = std::to_string(bordas % 100 / 10) + std::to_string(bordas % 10);
+    bool ok = somaBinario == instantes.back() && somaTexto == instantes[linhas - 1] && display == esperado;
+    if (!ok) {
+        std::cout << "    ERRO: o clock externo não entregou as bordas geradas\n";
+    }
+    return ok;
+}
+
+
+// Vazão da varredura de parâmetros em todos os núcleos: a operação é um ponto da grade
+static bool benchVarredura(Bancada& b) {
+    ConfigVarredura cfg;
+    cfg.r1 = Faixa::ler("1e3:1e5:20:log");
+    cfg.r2 = Faixa::ler("1e3:1e5:20:log");
+    cfg.c = Faixa::ler("1e-6:1e-4:10:log");
+    cfg.limiteMin = 1;
+    cfg.limiteMax = 10;
+    cfg.tempo = 3600.0;
+
+    PoolThreads pool;
+    const double pontos = static_cast<double>(cfg.totalPontos());
+    b.measure("varredura", "forma fechada (" + std::to_string(pool.size()) + " threads)", pontos, [&] {
+        naoOtimizar(executarVarredura(cfg, pool).back().leds);
+    });
+
+    ConfigVarredura passo = cfg;
+    passo.passoAPasso = true;
+    passo.r1 = Faixa::ler("1e3:1e5:4:log");
+    passo.r2 = Faixa::ler("1e3:1e5:4:log");
+    passo.c = Faixa::ler("1e-6:1e-5:2:log");
+    b.measure("varredura", "passo a passo (" + std::to_string(pool.size()) + " threads)",
+              static_cast<double>(passo.totalPontos()), [&] {
+        naoOtimizar(executarVarredura(passo, pool).back().leds);
+    });
+    return true;
+}
+
+
+// Título de uma seção, omitido quando o filtro exclui todos os grupos dela
+static void secao(bool algumSelecionado, const char* titulo) {
+    if (algumSelecionado) {
+        std::cout << titulo;
+    }
+}
+
+
+int main(int argc, char** argv) {
+    try {
+        ParametrosBench p = lerParametros(argc, argv);
+        Bancada b(p.repeticoes, p.filtro);
+
+        std::cout << "=== Benchmarks — Simulador Apple Juice ===\n";
+        std::cout << "(mediana de " << p.repeticoes << " repetições, ± desvio absoluto mediano)\n";
+
+        bool ok = true;
+        secao(b.selected("chips") || b.selected("segmentos"), "\n[Chips]\n");
+        ok = benchChips(b) && ok;
+        ok = benchSegmentos(b) && ok;
+
+        secao(b.selected("placa"), "\n[Pulso da placa inteira]\n");
+        ok = benchPlaca(b) && ok;
+
+        secao(b.selected("lote"), "\n[Lote de placas vs objetos]\n");
+        ok = benchLote(b, 64, 20000) && ok;
+        ok = benchLote(b, 4096, 400) && ok;
+        ok = benchLote(b, 65536, 20) && ok;
+
+        secao(b.selected("estatico"), "\n[Chips com despacho estático vs polimórficos]\n");
+        ok = benchChipsEstaticos(b, 10, 200000) && ok;
+        ok = benchChipsEstaticos(b, 1000, 2000) && ok;
+
+        secao(b.selected("display"), "\n[Display de 12 dígitos]\n");
+        ok = benchDisplay(b, 2000000) && ok;
+
+        secao(b.selected("analogico"), "\n[555 analógico]\n");
+        ok = benchAnalogico(b) && ok;
+
+        secao(b.selected("eventos"), "\n[Eventos discretos: roda de tempo]\n");
+        ok = benchEventos(b) && ok;
+
+        secao(b.selected("atrasos"), "\n[Atrasos de propagação]\n");
+        ok = benchAtrasos(b) && ok;
+
+        secao(b.selected("clockexterno"), "\n[Clock externo por fluxo de instantes]\n");
+        ok = benchClockExterno(b) && ok;
+
+        secao(b.selected("analisador"), "\n[Analisador lógico]\n");
+        ok = benchAnalisador(b) && ok;
+
+        secao(b.selected("portas"), "\n[Chips em portas lógicas, fatiados em bits]\n");
+        ok = benchPortas4017(b) && ok;
+        ok = benchPortas4026(b) && ok;
+
+        secao(b.selected("netlist"), "\n[Netlist compilada vs fiação à mão]\n");
+        ok = benchNetlist(b, 2, 1000000) && ok;
+        ok = benchNetlist(b, 8, 1000000) && ok;
+        ok = benchNetlist(b, 32, 1000000) && ok;
+
+        secao(b.selected("varredura") || b.selected("montecarlo"), "\n[Varredura e Monte Carlo]\n");
+        ok = benchVarredura(b) && ok;
+        ok = benchMonteCarlo(b) && ok;
+
+        if (!p.saida.empty()) {
+            std::string descricao = std::string("kernel do lote ") + LotePlacas::kernel()
+                                  + ", " + std::to_string(std::thread::hardware_concurrency()) + " núcleos"
+#if defined(__VERSION__)
+                                  + ", compilador " + __VERSION__
+#endif
+                                  ;
+            b.save(p.saida, descricao);
+            std::cout << "\nResultados em: " << p.saida << "\n";
+        }
+
+        if (!p.comparar.empty()) {
+            unsigned regressoes = b.compare(Bancada::readCsv(p.comparar), p.tolerancia);
+            if (regressoes) {
+                std::cout << regressoes << " caso(s) mais lento(s) que a base\n";
+                ok = false;
+            }
+        }
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch (const std::invalid_argument& e) {
+        std::cerr << "Erro nos parâmetros do benchmark: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Erro inesperado: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
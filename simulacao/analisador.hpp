@@ -0,0 +1,264 @@
+/*
+    Traço multirresolução para o analisador lógico da interface.
+
+    Cada ciclo vira uma palavra de bits (um bit por sinal). Acima do nível 0 (um ciclo por entrada), cada nível
+    junta 8 entradas do nível de baixo guardando o E e o OU das palavras: um bit com E = 1 ficou alto o tempo todo,
+    com OU = 0 ficou baixo o tempo todo, e com E = 0 e OU = 1 mudou dentro do intervalo. Uma consulta de qualquer
+    intervalo combina no máximo ~16 entradas por nível, então desenhar uma coluna de pixels custa o mesmo com a
+    janela mostrando nanossegundos ou horas.
+
+    Cada nível é um anel de capacidade fixa: os níveis finos guardam só o passado recente e os grossos, horas e
+    dias, com memória limitada. Quando o nível fino já esqueceu um trecho, a consulta usa o nível grosso que ainda
+    o tem (o intervalo fica um pouco maior que o pedido, o que não aparece na tela nessa escala).
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+
+// Resultado de uma consulta: E e OU das palavras do intervalo; 'valido' é falso se não havia dados
+struct FaixaSinais {
+    uint32_t e = ~0u;
+    uint32_t ou = 0;
+    bool valido = false;
+    unsigned entradas = 0;      // entradas dos anéis combinadas: o custo da consulta
+
+    void juntar(uint32_t eOutro, uint32_t ouOutro) {
+        e &= eOutro;
+        ou |= ouOutro;
+        valido = true;
+        entradas++;
+    }
+
+    // 0 = baixo, 1 = alto, 2 = mudou no intervalo, 3 = sem dados
+    int nivel(unsigned bit) const {
+        if (!valido) {
+            return 3;
+        }
+        bool todoAlto = (e >> bit) & 1u;
+        bool algumAlto = (ou >> bit) & 1u;
+        return todoAlto ? 1 : (algumAlto ? 2 : 0);
+    }
+};
+
+
+class TracoMipmap {
+public:
+    static constexpr unsigned Fator = 8;        // entradas de um nível juntadas no nível de cima
+    static constexpr unsigned Niveis = 10;      // o nível 9 junta 8^9 (~134 milhões) de ciclos por entrada
+
+private:
+    struct Par {
+        uint32_t e;
+        uint32_t ou;
+    };
+
+    size_t capacidade;
+    std::vector<std::vector<Par>> aneis;        // um anel por nível
+    uint64_t completos[Niveis] = {};            // entradas já fechadas em cada nível (o nível 0 inclui o ciclo aberto)
+    Par acumulado[Niveis] = {};                 // entrada em formação em cada nível >= 1
+    unsigned contagem[Niveis] = {};
+
+    uint64_t primeiroCiclo = 0;
+    uint32_t ultima = 0;
+
+    static uint64_t tamanho(unsigned nivel) {
+        return uint64_t(1) << (3 * nivel);
+    }
+
+    bool disponivel(unsigned nivel, uint64_t b) const {
+        uint64_t n = completos[nivel];
+        return b < n && b + capacidade >= n;
+    }
+
+    const Par& entrada(unsigned nivel, uint64_t b) const {
+        return aneis[nivel][b % capacidade];
+    }
+
+    // Junta uma entrada fechada do nível 'nivel - 1' na entrada em formação do nível 'nivel'
+    void dobrar(unsigned nivel, Par p) {
+        if (nivel >= Niveis) {
+            return;
+        }
+        Par& a = acumulado[nivel];
+        if (contagem[nivel] == 0) {
+            a = p;
+        } else {
+            a.e &= p.e;
+            a.ou |= p.ou;
+        }
+        if (++contagem[nivel] == Fator) {
+            aneis[nivel][completos[nivel] % capacidade] = a;
+            completos[nivel]++;
+            contagem[nivel] = 0;
+            dobrar(nivel + 1, a);
+        }
+    }
+
+    /*
+        Junta 'k' entradas iguais a 'p' do nível 'nivel - 1' no nível 'nivel': completa a entrada em formação, grava
+        as entradas inteiras de uma vez (só as que cabem no anel) e repete a conta no nível de cima com elas.
+    */
+    void dobrarVarias(unsigned nivel, uint64_t k, Par p) {
+        if (nivel >= Niveis) {
+            return;
+        }
+        for (; k > 0 && contagem[nivel] != 0; --k) {
+            dobrar(nivel, p);
+        }
+        uint64_t inteiras = k / Fator;
+        if (inteiras > 0) {
+            uint64_t gravar = std::min<uint64_t>(inteiras, capacidade);
+            for (uint64_t b = completos[nivel] + inteiras - gravar; b < completos[nivel] + inteiras; ++b) {
+                aneis[nivel][b % capacidade] = p;
+            }
+            completos[nivel] += inteiras;
+            dobrarVarias(nivel + 1, inteiras, p);
+        }
+        for (k %= Fator; k > 0; --k) {
+            dobrar(nivel, p);
+        }
+    }
+
+public:
+    explicit TracoMipmap(size_t capacidadePorNivel = 1 << 16)
+        : capacidade(capacidadePorNivel), aneis(Niveis, std::vector<Par>(capacidadePorNivel)) {
+        if (capacidadePorNivel < Fator) {
+            throw std::invalid_argument("o traço precisa guardar pelo menos 8 entradas por nível");
+        }
+    }
+
+    /*
+        Acrescenta o ciclo 'ciclo'. O primeiro define o início do traço; se algum ciclo faltar (fila cheia), os
+        intermediários repetem a última palavra conhecida.
+    */
+    void append(uint64_t ciclo, uint32_t palavra) {
+        appendBlock(ciclo, 1, palavra, palavra);
+    }
+
+    /*
+        Acrescenta os ciclos [ciclo, ciclo + n), todos resumidos pelo mesmo E e OU (um lote aplicado em forma fechada,
+        ou um trecho parado). O custo depende de quantas entradas cabem nos anéis, não de n: cada nível recebe as
+        entradas inteiras de uma vez. Só um bloco constante (e == ou) muda a última palavra conhecida; quem resume um
+        lote acrescenta depois o ciclo final com append().
+    */
+    void appendBlock(uint64_t ciclo, uint64_t n, uint32_t e, uint32_t ou) {
+        if (n == 0) {
+            return;
+        }
+        if (completos[0] == 0) {
+            primeiroCiclo = ciclo;
+        } else {
+            if (ciclo + n <= endCycle()) {
+                return;
+            }
+            if (ciclo < endCycle()) {
+                n -= endCycle() - ciclo;
+                ciclo = endCycle();
+            }
+            if (ciclo > endCycle()) {
+                appendBlock(endCycle(), ciclo - endCycle(), ultima, ultima);
+            }
+            // o ciclo anterior acabou de fechar: só agora entra nos níveis de cima (um reset ainda podia mudá-lo)
+            dobrar(1, entrada(0, completos[0] - 1));
+        }
+        const Par p{e, ou};
+        uint64_t gravar = std::min<uint64_t>(n, capacidade);
+        for (uint64_t b = completos[0] + n - gravar; b < completos[0] + n; ++b) {
+            aneis[0][b % capacidade] = p;
+        }
+        completos[0] += n;
+        dobrarVarias(1, n - 1, p);      // o último ciclo fica aberto, como no append()
+        if (e == ou) {
+            ultima = e;
+        }
+    }
+
+    // Troca a palavra do ciclo aberto (reset entre dois pulsos)
+    void replaceLast(uint32_t palavra) {
+        if (completos[0] == 0) {
+            return;
+        }
+        Par& p = aneis[0][(completos[0] - 1) % capacidade];
+        p.e &= palavra;
+        p.ou |= palavra;
+        ultima = palavra;
+    }
+
+    // E e OU das palavras dos ciclos [c0, c1)
+    FaixaSinais query(uint64_t c0, uint64_t c1) const {
+        FaixaSinais r;
+        if (completos[0] == 0) {
+            return r;
+        }
+        c0 = std::max(c0, primeiroCiclo);
+        c1 = std::min(c1, endCycle());
+        if (c0 >= c1) {
+            return r;
+        }
+
+        uint64_t c = c0 - primeiroCiclo;
+        uint64_t fim = c1 - primeiroCiclo;
+        while (c < fim) {
+            // maior nível alinhado que cabe no que falta
+            unsigned n = 0;
+            while (n + 1 < Niveis && c % tamanho(n + 1) == 0 && c + tamanho(n + 1) <= fim) {
+                n++;
+            }
+            // dados recentes ainda não fecharam o bloco deste nível: desce
+            while (n > 0 && c / tamanho(n) >= completos[n]) {
+                n--;
+            }
+            if (disponivel(n, c / tamanho(n))) {
+                const Par& p = entrada(n, c / tamanho(n));
+                r.juntar(p.e, p.ou);
+                c += tamanho(n);
+                continue;
+            }
+            // trecho antigo demais para este nível: usa o primeiro nível de cima que ainda o guarda
+            unsigned m = n + 1;
+            while (m < Niveis && !disponivel(m, c / tamanho(m))) {
+                m++;
+            }
+            uint64_t bloco = tamanho(std::min(m, Niveis - 1));
+            if (m < Niveis) {
+                const Par& p = entrada(m, c / bloco);
+                r.juntar(p.e, p.ou);
+            }
+            c = std::min(fim, (c / bloco + 1) * bloco);
+        }
+        return r;
+    }
+
+    // Primeiro ciclo gravado e um depois do último
+    uint64_t firstCycle() const {
+        return primeiroCiclo;
+    }
+
+    uint64_t endCycle() const {
+        return primeiroCiclo + completos[0];
+    }
+
+    bool empty() const {
+        return completos[0] == 0;
+    }
+
+    uint32_t last() const {
+        return ultima;
+    }
+
+    void clear() {
+        std::fill(std::begin(completos), std::end(completos), 0);
+        std::fill(std::begin(contagem), std::end(contagem), 0u);
+        primeiroCiclo = 0;
+        ultima = 0;
+    }
+
+    size_t bytes() const {
+        return Niveis * capacidade * sizeof(Par);
+    }
+};
@@ -0,0 +1,189 @@
+/*
+    Modelo analógico do 555 astável: a tensão do capacitor, em vez da onda quadrada ideal de Chip555.
+
+    O capacitor carrega por R1 + R2 em direção a Vcc até o limiar (2/3 Vcc, ou a tensão do pino CTRL) e descarrega
+    por R2 até o disparo (metade do limiar). Na descarga, o transistor do pino DIS tem resistência própria: visto do
+    capacitor, R2 fica em série com R1 || Rdis, e a tensão para a qual ele descarrega não é 0, mas o divisor
+    Vcc * Rdis / (R1 + Rdis). Cada trecho é uma exponencial exata, v(t) = vFinal + (v0 - vFinal) e^(-t/tau), então os
+    tempos saem em forma fechada (sem o 0.693 arredondado e sem integrar passo a passo):
+
+        tHigh = (R1 + R2) C ln((Vcc - vDisparo) / (Vcc - vLimiar))
+        tLow  = (R2 + R1 || Rdis) C ln((vLimiar - vDescarga) / (vDisparo - vDescarga))
+
+    O primeiro ciclo depois de ligar é mais longo: o capacitor parte de 0 V, não do disparo. A partir dele a forma de
+    onda é periódica, e o motor de tempo virtual usa tHigh e tLow exatos no lugar dos do Chip555 (MotorVirtual::
+    setModelo555), com o mesmo custo por ciclo.
+*/
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+
+// Parâmetros elétricos além de R1, R2 e C
+struct ParametrosAnalogicos555 {
+    double vcc = 9.0;           // tensão de alimentação (V)
+    double rDescarga = 15.0;    // resistência do transistor de descarga saturado (ohms; ~0.15 V a 10 mA no NE555)
+    double vControle = 0.0;     // tensão imposta no pino CTRL (V); 0 = divisor interno, 2/3 Vcc
+};
+
+
+class Modelo555Analogico {
+private:
+    ParametrosAnalogicos555 p;
+    double vLimiar = 0.0;       // fim da carga (pino THR)
+    double vDisparo = 0.0;      // fim da descarga (pino TRIG)
+    double vDescarga = 0.0;     // tensão para a qual o capacitor tende durante a descarga
+    double tauCarga = 0.0;
+    double tauDescarga = 0.0;
+    double tHigh = 0.0;
+    double tLow = 0.0;
+    double tPrimeiro = 0.0;     // primeira carga, de 0 V até o limiar
+
+    // Trecho de exponencial: tensão 'v0' no início, tendendo a 'vFinal' com constante 'tau'
+    struct Trecho {
+        double inicio;
+        double fim;
+        double v0;
+        double vFinal;
+        double tau;
+        bool carga;             // saída alta enquanto o capacitor carrega
+    };
+
+    // Trecho que contém o instante 't' (segundos desde que a placa foi ligada)
+    Trecho trechoEm(double t) const {
+        if (t < tPrimeiro) {
+            return Trecho{0.0, tPrimeiro, 0.0, p.vcc, tauCarga, true};
+        }
+        double periodo = tHigh + tLow;
+        double k = std::floor((t - tPrimeiro) / periodo);
+        double inicio = tPrimeiro + k * periodo;
+        if (t < inicio + tLow) {
+            return Trecho{inicio, inicio + tLow, vLimiar, vDescarga, tauDescarga, false};
+        }
+        return Trecho{inicio + tLow, inicio + periodo, vDisparo, p.vcc, tauCarga, true};
+    }
+
+public:
+    Modelo555Analogico(double r1, double r2, double c, const ParametrosAnalogicos555& parametros = ParametrosAnalogicos555())
+        : p(parametros) {
+        if (r1 <= 0 || r2 <= 0 || c <= 0) {
+            throw std::invalid_argument("R1, R2 e C precisam ser > 0");
+        }
+        if (p.vcc <= 0 || p.rDescarga < 0) {
+            throw std::invalid_argument("Vcc precisa ser > 0 e a resistência de descarga >= 0");
+        }
+        if (p.vControle < 0 || p.vControle >= p.vcc) {
+            throw std::invalid_argument("a tensão de controle precisa estar entre 0 e Vcc");
+        }
+        vLimiar = (p.vControle > 0) ? p.vControle : p.vcc * 2.0 / 3.0;
+        vDisparo = vLimiar / 2.0;
+        vDescarga = p.vcc * p.rDescarga / (r1 + p.rDescarga);
+        if (vDescarga >= vDisparo) {
+            throw std::invalid_argument("com essa resistência de descarga o capacitor nunca chega ao disparo");
+        }
+
+        tauCarga = (r1 + r2) * c;
+        tauDescarga = (r2 + r1 * p.rDescarga / (r1 + p.rDescarga)) * c;
+        tHigh = tauCarga * std::log((p.vcc - vDisparo) / (p.vcc - vLimiar));
+        tLow = tauDescarga * std::log((vLimiar - vDescarga) / (vDisparo - vDescarga));
+        tPrimeiro = tauCarga * std::log(p.vcc / (p.vcc - vLimiar));
+    }
+
+    // Tensão no capacitor 't' segundos depois de ligar a placa
+    double voltage(double t) const {
+        if (t <= 0) {
+            return 0.0;
+        }
+        Trecho s = trechoEm(t);
+        return s.vFinal + (s.v0 - s.vFinal) * std::exp(-(t - s.inicio) / s.tau);
+    }
+
+    // Saída (pino 3) no instante 't': alta enquanto o capacitor carrega
+    bool output(double t) const {
+        return t >= 0 && trechoEm(t).carga;
+    }
+
+    /*
+        'n' amostras da tensão a partir de 't0', espaçadas de 'dt' (para desenhar a forma de onda). Dentro de cada
+        trecho, a amostra seguinte é a anterior multiplicada por e^(-dt/tau) (relativa a vFinal); o laço guarda 8
+        amostras independentes que avançam juntas com e^(-8 dt/tau), então o compilador o vetoriza e só há uma
+        exponencial por trecho, não por amostra.
+    */
+    void sample(double t0, double dt, size_t n, double* destino) const {
+        constexpr size_t Faixas = 8;
+        size_t i = 0;
+        while (i < n && t0 + i * dt <= 0) {
+            destino[i++] = 0.0;
+        }
+        while (i < n) {
+            double t = t0 + i * dt;
+            Trecho s = trechoEm(t);
+            // amostras até o fim do trecho (pelo menos uma, para não parar por arredondamento na borda)
+            size_t fim = i + 1;
+            double restante = (s.fim - t) / dt;
+            if (restante > 1.0) {
+                fim = std::min(n, i + static_cast<size_t>(std::ceil(restante)));
+            }
+
+            double passo = std::exp(-dt / s.tau);
+            double salto = std::pow(passo, static_cast<double>(Faixas));
+            double d[Faixas];
+            d[0] = (s.v0 - s.vFinal) * std::exp(-(t - s.inicio) / s.tau);
+            for (size_t k = 1; k < Faixas; ++k) {
+                d[k] = d[k - 1] * passo;
+            }
+            size_t j = i;
+            for (; j + Faixas <= fim; j += Faixas) {
+                for (size_t k = 0; k < Faixas; ++k) {
+                    destino[j + k] = s.vFinal + d[k];
+                    d[k] *= salto;
+                }
+            }
+            for (size_t k = 0; j < fim; ++j, ++k) {
+                destino[j] = s.vFinal + d[k];
+            }
+            i = fim;
+        }
+    }
+
+    double getTHigh() const {
+        return tHigh;
+    }
+
+    double getTLow() const {
+        return tLow;
+    }
+
+    double getPeriod() const {
+        return tHigh + tLow;
+    }
+
+    double getFrequency() const {
+        return 1.0 / (tHigh + tLow);
+    }
+
+    // Fração do período com a saída alta
+    double getDutyCycle() const {
+        return tHigh / (tHigh + tLow);
+    }
+
+    // Duração do primeiro nível alto depois de ligar (o capacitor parte de 0 V)
+    double getFirstHigh() const {
+        return tPrimeiro;
+    }
+
+    double getVLimiar() const {
+        return vLimiar;
+    }
+
+    double getVDisparo() const {
+        return vDisparo;
+    }
+
+    const ParametrosAnalogicos555& getParametros() const {
+        return p;
+    }
+};
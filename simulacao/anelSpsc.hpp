@@ -0,0 +1,80 @@
+/*
+    Fila circular sem trava de um produtor para um consumidor (SPSC).
+
+    O produtor só escreve 'cauda' e o consumidor só escreve 'cabeca', cada um na sua linha de cache; nenhuma operação
+    espera pela outra thread. A capacidade é fixa (potência de 2), então a memória usada é limitada: quando a fila
+    enche, quem produz decide se espera ou descarta (ver GravadorVcd).
+*/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+
+template<typename T>
+class AnelSpsc {
+    static_assert(std::is_trivially_copyable<T>::value, "AnelSpsc guarda apenas tipos copiáveis com memcpy");
+
+private:
+    std::vector<T> itens;
+    size_t mascara;
+
+    alignas(64) std::atomic<size_t> cabeca{0};      // próxima posição a ler (consumidor)
+    alignas(64) size_t cabecaVista = 0;             // cópia da cabeça lida pelo produtor (evita tocar a linha dela)
+    alignas(64) std::atomic<size_t> cauda{0};       // próxima posição a escrever (produtor)
+    alignas(64) size_t caudaVista = 0;              // cópia da cauda lida pelo consumidor
+
+public:
+    explicit AnelSpsc(size_t capacidade) {
+        if (capacidade < 2 || (capacidade & (capacidade - 1)) != 0) {
+            throw std::invalid_argument("capacidade do anel precisa ser potência de 2");
+        }
+        itens.resize(capacidade);
+        mascara = capacidade - 1;
+    }
+
+    AnelSpsc(const AnelSpsc&) = delete;
+    AnelSpsc& operator=(const AnelSpsc&) = delete;
+
+    // Produtor: retorna false se a fila estiver cheia
+    bool tryPush(const T& item) {
+        size_t c = cauda.load(std::memory_order_relaxed);
+        if (c - cabecaVista > mascara) {
+            cabecaVista = cabeca.load(std::memory_order_acquire);
+            if (c - cabecaVista > mascara) {
+                return false;
+            }
+        }
+        itens[c & mascara] = item;
+        cauda.store(c + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor: copia até 'max' itens para 'destino' e retorna quantos copiou
+    size_t popBatch(T* destino, size_t max) {
+        size_t h = cabeca.load(std::memory_order_relaxed);
+        if (caudaVista == h) {
+            caudaVista = cauda.load(std::memory_order_acquire);
+        }
+        size_t n = caudaVista - h;
+        n = (n < max) ? n : max;
+        for (size_t i = 0; i < n; ++i) {
+            destino[i] = itens[(h + i) & mascara];
+        }
+        cabeca.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    // Aproximado quando chamado com as duas threads ativas
+    bool empty() const {
+        return cabeca.load(std::memory_order_acquire) == cauda.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return mascara + 1;
+    }
+};
@@ -0,0 +1,718 @@
+/*
+    Modelo de temporização da placa: atrasos de propagação dos CD4017 e CD4026, que dependem da tensão de
+    alimentação, numa roda de tempo.
+
+    No MotorVirtual e na PlacaEventos cada subida do clock muda todos os chips no mesmo instante, numa ordem fixa. Na
+    placa real cada saída muda um pouco depois da entrada que a causou, e é isso que aparece no osciloscópio: o
+    display das dezenas só muda depois que o carry das unidades subiu (o "ripple" da cascata), e a saída do CD4017
+    ligada ao RESET acende por algumas centenas de nanossegundos antes de o contador voltar a O0. Aqui cada mudança
+    de saída é um evento agendado para (instante da causa + atraso do datasheet), com ticks de 1 ps. Os atrasos são
+    de transporte: um pulso mais curto que o atraso não é filtrado, para que os glitches apareçam.
+
+    As bordas do clock e o botão, que podem estar a segundos de distância, vão para a RodaDeTempo. As mudanças de
+    saída acontecem no máximo alguns microssegundos depois da causa e há só algumas em voo por vez: elas ficam numa
+    fila curta em ordem de tempo, fora da roda, e cada passo atende a mais cedo das duas.
+
+    O que é registrado:
+        glitch              um sinal que muda duas vezes pela mesma causa (a mesma subida do clock ou o mesmo aperto
+                            do botão): o pulso na saída do CD4017 ligada ao RESET e os valores de passagem do display
+                            durante o ripple (09 -> 00 -> 10)
+        violação            uma entrada fora dos tempos mínimos do datasheet: pulso de clock estreito demais, clock
+                            acima da frequência máxima, pulso de RESET curto demais, subida do clock com o RESET
+                            da realimentação ainda alto ou antes do tempo de remoção do RESET. A placa trata o pulso
+                            de clock de uma violação de RESET como perdido (o datasheet não garante a contagem).
+
+    Cada subida do 555 gera em média uns 4 eventos (as duas bordas, a saída do CD4017 e os segmentos das unidades)
+    contra 2 na PlacaEventos, mas só as bordas passam pela roda: o custo por ciclo fica perto de 2 vezes o da
+    simulação sem atrasos, e o benchmark falha acima de 3 vezes (make bench BENCH_ARGS="--filtro atrasos").
+
+    A placa modelada é a original: um CD4017 (até 10 LEDs) e dois CD4026.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "chips.hpp"
+#include "rodaTempo.hpp"
+#include "placaEventos.hpp"
+
+
+// Valores típicos ou máximos (pior caso) do datasheet; nos CD40xxB o máximo é o dobro do típico
+enum class CantoAtrasos { Tipico, Maximo };
+
+
+/*
+    Tempos dos CD4017B e CD4026B (25 °C, carga de 50 pF) em segundos, para uma tensão de alimentação. Os datasheets
+    dão os valores típicos em 5, 10 e 15 V; entre eles o tempo é interpolado em 1/VDD (o atraso das portas CMOS cai
+    mais ou menos com o inverso da tensão) e fora deles o trecho mais próximo é estendido, de 3 a 18 V.
+*/
+struct AtrasosCmos {
+    static constexpr double VddMin = 3.0;
+    static constexpr double VddMax = 18.0;
+
+    double vdd = 5.0;
+
+    // CD4017
+    double clockSaida4017 = 0.0;        // CLOCK -> saída decodificada
+    double resetSaida4017 = 0.0;        // RESET -> saída decodificada
+    double larguraClock4017 = 0.0;      // largura mínima do pulso de clock (alto e baixo)
+    double periodoMin4017 = 0.0;        // 1 / frequência máxima de clock
+    double larguraReset4017 = 0.0;      // largura mínima do pulso de RESET
+    double remocaoReset4017 = 0.0;      // descida do RESET até a próxima subida do clock
+
+    // CD4026
+    double clockSegmentos4026 = 0.0;    // CLOCK -> segmentos a..g
+    double clockCarry4026 = 0.0;        // CLOCK -> CARRY OUT
+    double resetSaida4026 = 0.0;        // RESET -> segmentos e CARRY OUT
+    double larguraClock4026 = 0.0;
+    double periodoMin4026 = 0.0;
+    double remocaoReset4026 = 0.0;
+
+    static AtrasosCmos datasheet(double vdd, CantoAtrasos canto = CantoAtrasos::Tipico) {
+        if (!(vdd >= VddMin && vdd <= VddMax)) {
+            throw std::invalid_argument("os CD40xx funcionam de 3 a 18 V");
+        }
+        const double escala = (canto == CantoAtrasos::Maximo ? 2.0 : 1.0) * 1e-9;
+        auto tempo = [&](double em5, double em10, double em15) {
+            return interpolar(vdd, em5, em10, em15) * escala;
+        };
+
+        AtrasosCmos a;
+        a.vdd = vdd;
+        a.clockSaida4017     = tempo(325, 135, 85);
+        a.resetSaida4017     = tempo(265, 115, 85);
+        a.larguraClock4017   = tempo(100, 40, 30);
+        a.periodoMin4017     = tempo(200, 83, 62);          // 5, 12 e 16 MHz
+        a.larguraReset4017   = tempo(130, 60, 40);
+        a.remocaoReset4017   = tempo(200, 70, 55);
+
+        a.clockSegmentos4026 = tempo(500, 200, 140);
+        a.clockCarry4026     = tempo(250, 100, 75);
+        a.resetSaida4026     = tempo(300, 125, 90);
+        a.larguraClock4026   = tempo(125, 60, 45);
+        a.periodoMin4026     = tempo(400, 200, 154);        // 2.5, 5 e 6.5 MHz
+        a.remocaoReset4026   = tempo(150, 60, 45);
+        return a;
+    }
+
+private:
+    // Interpolação em 1/VDD entre os pontos de 5, 10 e 15 V
+    static double interpolar(double vdd, double em5, double em10, double em15) {
+        double x = 1.0 / vdd;
+        if (vdd <= 10.0) {
+            return em10 + (em5 - em10) * (x - 0.1) / (0.2 - 0.1);
+        }
+        return em15 + (em10 - em15) * (x - 1.0 / 15.0) / (0.1 - 1.0 / 15.0);
+    }
+};
+
+
+class PlacaComAtrasos {
+public:
+    static constexpr double Resolucao = 1e-12;          // 1 tick = 1 ps
+    static constexpr size_t MaxRegistros = 1000;        // glitches e violações guardados um a um (o resto só é contado)
+
+    enum class Sinal : uint8_t {
+        Saida4017,          // uma saída O0..O9 do CD4017
+        Carry,              // CARRY OUT das unidades (CLOCK das dezenas)
+        Unidades,           // segmentos do CD4026 das unidades
+        Dezenas,            // segmentos do CD4026 das dezenas
+        Display             // o número de dois dígitos que os displays mostram
+    };
+    static constexpr unsigned QtSinais = 5;
+
+    enum class Violacao : uint8_t {
+        LarguraClock,       // pulso de clock (alto ou baixo) mais estreito que o mínimo
+        FrequenciaMaxima,   // duas subidas do clock mais próximas que 1 / fmax
+        LarguraReset,       // pulso de RESET mais curto que o mínimo
+        ClockDuranteReset,  // subida do clock com o RESET da realimentação do CD4017 alto: a contagem se perde
+        RemocaoReset        // subida do clock antes do tempo de remoção do RESET: a contagem se perde
+    };
+    static constexpr unsigned QtViolacoes = 5;
+
+    enum class Chip : uint8_t { C4017, Unidades, Dezenas };
+
+    struct Glitch {
+        double instante = 0.0;      // início do pulso (s)
+        double largura = 0.0;       // duração do pulso (s)
+        Sinal sinal = Sinal::Saida4017;
+        uint8_t valor = 0;          // saída do CD4017, ou o dígito/número que ficou visível só durante o pulso
+    };
+
+    struct RegistroViolacao {
+        double instante = 0.0;      // subida do clock ou descida do RESET (s)
+        double medido = 0.0;        // largura, período ou folga medida (s); 0 para ClockDuranteReset
+        double minimo = 0.0;        // valor mínimo do datasheet (s)
+        Violacao tipo = Violacao::LarguraClock;
+        Chip chip = Chip::C4017;
+    };
+
+private:
+    // Eventos da roda
+    enum TipoEvento : uint32_t {
+        EventoClock,
+        EventoBotao
+    };
+
+    // Mudanças de saída, na fila curta
+    enum class Saida : uint8_t {
+        C4017,
+        Carry,
+        Unidades,
+        Dezenas
+    };
+
+    struct Propagacao {
+        uint64_t tempo;
+        uint32_t causa;
+        Saida saida;
+        uint8_t valor;
+    };
+
+    // Causa de uma mudança: cada subida do clock e cada aperto do botão ganha um número
+    static constexpr uint32_t SemCausa = ~0u;
+    static constexpr size_t HistoricoCausas = 256;
+
+    // Última mudança de um sinal e a causa dela
+    struct Rede {
+        uint64_t mudanca = 0;
+        uint32_t causa = SemCausa;
+    };
+
+    // Atrasos e mínimos já em ticks
+    struct Ticks {
+        uint64_t clockSaida4017, resetSaida4017, larguraClock4017, periodoMin4017, larguraReset4017, remocaoReset4017;
+        uint64_t clockSegmentos4026, clockCarry4026, resetSaida4026, larguraClock4026, periodoMin4026, remocaoReset4026;
+    };
+
+    Chip555 chip555;
+    unsigned limite;
+    AtrasosCmos atrasos;
+    Ticks t;
+
+    RodaDeTempo roda;
+    std::vector<Propagacao> fila;           // em ordem de tempo a partir de 'inicioFila'
+    size_t inicioFila = 0;
+    std::unique_ptr<FonteClock> clock;
+    RodaDeTempo::No* noClock = nullptr;
+    bool clk = false;
+    bool clkProximo = false;
+    uint64_t agora = 0;
+    uint64_t eventos = 0;
+    uint64_t subidas = 0;
+
+    uint32_t causa = 0;
+    uint64_t instanteCausa[HistoricoCausas] = {};
+
+    // Bordas do CLK (555) e do carry, para as larguras e os períodos
+    uint64_t ultimaSubida = 0, ultimaDescida = 0;
+    bool temSubida = false, temDescida = false;
+
+    // CD4017: estado dos flip-flops (muda na borda) e a saída visível (muda depois do atraso)
+    unsigned estado4017 = 0;
+    unsigned saida4017 = 0;
+    bool resetRealimentacao = false;
+    uint64_t inicioReset4017 = 0, fimReset4017 = 0;
+    bool temFimReset4017 = false;
+    Rede saidas[10];
+
+    // CD4026
+    unsigned estadoUnidades = 0, estadoDezenas = 0;
+    unsigned saidaUnidades = 0, saidaDezenas = 0;
+    bool carryInterno = true;       // CARRY OUT = /Q5: alto de 0 a 4
+    bool carryPino = true;
+    Rede redeCarry, redeUnidades, redeDezenas, redeDisplay;
+    bool carryMudou = false;
+
+    // Botão R: RESET de todos os chips enquanto apertado
+    bool botao = false;
+    uint64_t fimBotao = 0;
+    bool temFimBotao = false;
+
+    // Relatório
+    uint64_t glitches[QtSinais] = {};
+    uint64_t violacoes[QtViolacoes] = {};
+    std::vector<Glitch> registroGlitches;
+    std::vector<RegistroViolacao> registroViolacoes;
+    uint64_t acomodacaoLeds = 0;        // maior atraso entre a causa e a última mudança dos LEDs
+    uint64_t acomodacaoDisplay = 0;     // idem para o display (o ripple das unidades até as dezenas)
+
+    static uint64_t paraTicks(double segundos) {
+        if (!(segundos >= 0)) {
+            throw std::invalid_argument("instante negativo na simulação com atrasos");
+        }
+        return static_cast<uint64_t>(segundos / Resolucao + 0.5);
+    }
+
+    static double paraSegundos(uint64_t ticks) {
+        return ticks * Resolucao;
+    }
+
+    // Agenda a mudança de uma saída; quase sempre ela é a mais tardia da fila e entra no fim
+    void agendar(Saida saida, unsigned valor, uint32_t c, uint64_t instante) {
+        if (inicioFila == fila.size()) {
+            fila.clear();
+            inicioFila = 0;
+        } else if (inicioFila > 64 && inicioFila * 2 > fila.size()) {
+            fila.erase(fila.begin(), fila.begin() + static_cast<std::ptrdiff_t>(inicioFila));
+            inicioFila = 0;
+        }
+        fila.push_back(Propagacao{instante, c, saida, static_cast<uint8_t>(valor)});
+        for (size_t i = fila.size() - 1; i > inicioFila && fila[i - 1].tempo > instante; --i) {
+            std::swap(fila[i - 1], fila[i]);
+        }
+    }
+
+    void agendarClock() {
+        double instante = 0.0;
+        if (!clock->nextEdge(instante, clkProximo)) {
+            roda.release(noClock);
+            noClock = nullptr;
+            return;
+        }
+        uint64_t tick = paraTicks(instante);
+        if (tick < agora) {
+            throw std::invalid_argument("fonte de clock entregou uma borda antes da anterior");
+        }
+        roda.schedule(noClock, tick);
+    }
+
+    uint32_t novaCausa() {
+        causa = (causa + 1 == SemCausa) ? 0 : causa + 1;
+        instanteCausa[causa % HistoricoCausas] = agora;
+        return causa;
+    }
+
+    uint64_t desdeCausa(uint32_t c) const {
+        return agora - instanteCausa[c % HistoricoCausas];
+    }
+
+    void glitch(Sinal s, uint64_t inicio, unsigned valor) {
+        glitches[static_cast<unsigned>(s)]++;
+        if (registroGlitches.size() < MaxRegistros) {
+            Glitch g;
+            g.instante = paraSegundos(inicio);
+            g.largura = paraSegundos(agora - inicio);
+            g.sinal = s;
+            g.valor = static_cast<uint8_t>(valor);
+            registroGlitches.push_back(g);
+        }
+    }
+
+    // Muda a rede agora pela causa 'c'; se a mudança anterior teve a mesma causa, o nível anterior foi um glitch
+    void mudar(Rede& r, Sinal s, uint32_t c, unsigned valorAnterior) {
+        if (r.causa == c) {
+            glitch(s, r.mudanca, valorAnterior);
+        }
+        r.mudanca = agora;
+        r.causa = c;
+    }
+
+    void violacao(Violacao tipo, Chip chip, uint64_t medido, uint64_t minimo) {
+        violacoes[static_cast<unsigned>(tipo)]++;
+        if (registroViolacoes.size() < MaxRegistros) {
+            RegistroViolacao v;
+            v.instante = paraSegundos(agora);
+            v.medido = paraSegundos(medido);
+            v.minimo = paraSegundos(minimo);
+            v.tipo = tipo;
+            v.chip = chip;
+            registroViolacoes.push_back(v);
+        }
+    }
+
+    // Confere uma largura ou um período contra o mínimo dos dois chips que o CLK do 555 alimenta
+    void conferirClock(Violacao tipo, uint64_t medido, uint64_t min4017, uint64_t min4026) {
+        if (medido < min4017) {
+            violacao(tipo, Chip::C4017, medido, min4017);
+        }
+        if (medido < min4026) {
+            violacao(tipo, Chip::Unidades, medido, min4026);
+        }
+    }
+
+    void subidaClock() {
+        uint32_t c = novaCausa();
+        subidas++;
+        if (temSubida) {
+            conferirClock(Violacao::FrequenciaMaxima, agora - ultimaSubida, t.periodoMin4017, t.periodoMin4026);
+        }
+        if (temDescida) {
+            conferirClock(Violacao::LarguraClock, agora - ultimaDescida, t.larguraClock4017, t.larguraClock4026);
+        }
+        ultimaSubida = agora;
+        temSubida = true;
+        clock4017(c);
+        clockUnidades(c);
+    }
+
+    void descidaClock() {
+        if (temSubida) {
+            conferirClock(Violacao::LarguraClock, agora - ultimaSubida, t.larguraClock4017, t.larguraClock4026);
+        }
+        ultimaDescida = agora;
+        temDescida = true;
+    }
+
+    void clock4017(uint32_t c) {
+        if (botao) {
+            return;                             // o botão segura o RESET: o clock é ignorado, como esperado
+        }
+        if (resetRealimentacao) {
+            violacao(Violacao::ClockDuranteReset, Chip::C4017, 0, t.remocaoReset4017);
+            return;
+        }
+        if (temFimReset4017 && agora - fimReset4017 < t.remocaoReset4017) {
+            violacao(Violacao::RemocaoReset, Chip::C4017, agora - fimReset4017, t.remocaoReset4017);
+            return;
+        }
+        estado4017 = (estado4017 + 1) % 10;
+        agendar(Saida::C4017, estado4017, c, agora + t.clockSaida4017);
+    }
+
+    // Um CD4026 recebe uma subida: conta e agenda os segmentos (e o carry, nas unidades)
+    bool podeContar(Chip chip) {
+        if (botao) {
+            return false;
+        }
+        if (temFimBotao && agora - fimBotao < t.remocaoReset4026) {
+            violacao(Violacao::RemocaoReset, chip, agora - fimBotao, t.remocaoReset4026);
+            return false;
+        }
+        return true;
+    }
+
+    void clockUnidades(uint32_t c) {
+        if (!podeContar(Chip::Unidades)) {
+            return;
+        }
+        estadoUnidades = (estadoUnidades + 1) % 10;
+        agendar(Saida::Unidades, estadoUnidades, c, agora + t.clockSegmentos4026);
+        bool co = estadoUnidades < 5;
+        if (co != carryInterno) {
+            carryInterno = co;
+            agendar(Saida::Carry, co, c, agora + t.clockCarry4026);
+        }
+    }
+
+    void clockDezenas(uint32_t c) {
+        if (!podeContar(Chip::Dezenas)) {
+            return;
+        }
+        estadoDezenas = (estadoDezenas + 1) % 10;
+        agendar(Saida::Dezenas, estadoDezenas, c, agora + t.clockSegmentos4026);
+    }
+
+    void saida4017Mudou(unsigned p, uint32_t c) {
+        if (p == saida4017) {
+            return;
+        }
+        mudar(saidas[saida4017], Sinal::Saida4017, c, saida4017);
+        mudar(saidas[p], Sinal::Saida4017, c, p);
+        saida4017 = p;
+        acomodacaoLeds = std::max(acomodacaoLeds, desdeCausa(c));
+
+        // A saída O(limite) está ligada ao RESET: o contador volta para O0 enquanto ela estiver alta
+        bool realimenta = limite < 10 && p == limite;
+        if (realimenta && !resetRealimentacao) {
+            resetRealimentacao = true;
+            inicioReset4017 = agora;
+            estado4017 = 0;
+            agendar(Saida::C4017, 0, c, agora + t.resetSaida4017);
+        } else if (!realimenta && resetRealimentacao) {
+            resetRealimentacao = false;
+            if (agora - inicioReset4017 < t.larguraReset4017) {
+                violacao(Violacao::LarguraReset, Chip::C4017, agora - inicioReset4017, t.larguraReset4017);
+            }
+            fimReset4017 = agora;
+            temFimReset4017 = true;
+        }
+    }
+
+    void carryMudouPara(bool nivel, uint32_t c) {
+        if (nivel == carryPino) {
+            return;
+        }
+        if (carryMudou && agora - redeCarry.mudanca < t.larguraClock4026) {
+            violacao(Violacao::LarguraClock, Chip::Dezenas, agora - redeCarry.mudanca, t.larguraClock4026);
+        }
+        mudar(redeCarry, Sinal::Carry, c, carryPino);
+        carryMudou = true;
+        carryPino = nivel;
+        if (nivel) {
+            clockDezenas(c);
+        }
+    }
+
+    void displayMudou(bool unidades, unsigned digito, uint32_t c) {
+        unsigned& saida = unidades ? saidaUnidades : saidaDezenas;
+        if (digito == saida) {
+            return;
+        }
+        unsigned numeroAnterior = saidaDezenas * 10 + saidaUnidades;
+        mudar(unidades ? redeUnidades : redeDezenas, unidades ? Sinal::Unidades : Sinal::Dezenas, c, saida);
+        mudar(redeDisplay, Sinal::Display, c, numeroAnterior);
+        saida = digito;
+        acomodacaoDisplay = std::max(acomodacaoDisplay, desdeCausa(c));
+    }
+
+    void botaoMudou(bool apertado) {
+        if (apertado == botao) {
+            return;
+        }
+        botao = apertado;
+        if (!apertado) {
+            fimBotao = agora;
+            temFimBotao = true;
+            fimReset4017 = agora;
+            temFimReset4017 = true;
+            return;
+        }
+        uint32_t c = novaCausa();
+        estado4017 = 0;
+        estadoUnidades = 0;
+        estadoDezenas = 0;
+        agendar(Saida::C4017, 0, c, agora + t.resetSaida4017);
+        agendar(Saida::Unidades, 0, c, agora + t.resetSaida4026);
+        agendar(Saida::Dezenas, 0, c, agora + t.resetSaida4026);
+        if (!carryInterno) {
+            carryInterno = true;
+            agendar(Saida::Carry, 1, c, agora + t.resetSaida4026);
+        }
+    }
+
+    void processar(RodaDeTempo::No* no) {
+        eventos++;
+        if (no->tipo == EventoClock) {
+            bool subida = clkProximo && !clk;
+            bool descida = !clkProximo && clk;
+            clk = clkProximo;
+            if (subida) {
+                subidaClock();
+            } else if (descida) {
+                descidaClock();
+            }
+            agendarClock();
+            return;
+        }
+        botaoMudou(no->fonte != 0);
+        roda.release(no);
+    }
+
+    void propagar(const Propagacao& p) {
+        eventos++;
+        switch (p.saida) {
+            case Saida::C4017:    saida4017Mudou(p.valor, p.causa); break;
+            case Saida::Carry:    carryMudouPara(p.valor != 0, p.causa); break;
+            case Saida::Unidades: displayMudou(true, p.valor, p.causa); break;
+            case Saida::Dezenas:  displayMudou(false, p.valor, p.causa); break;
+        }
+    }
+
+    void definirTicks() {
+        const AtrasosCmos& a = atrasos;
+        t = Ticks{
+            paraTicks(a.clockSaida4017), paraTicks(a.resetSaida4017), paraTicks(a.larguraClock4017),
+            paraTicks(a.periodoMin4017), paraTicks(a.larguraReset4017), paraTicks(a.remocaoReset4017),
+            paraTicks(a.clockSegmentos4026), paraTicks(a.clockCarry4026), paraTicks(a.resetSaida4026),
+            paraTicks(a.larguraClock4026), paraTicks(a.periodoMin4026), paraTicks(a.remocaoReset4026)
+        };
+    }
+
+public:
+    // A placa com o 555 de R1, R2 e C e os CD40xx alimentados com 'vdd' volts
+    PlacaComAtrasos(unsigned leds, double r1, double r2, double c, double vdd, CantoAtrasos canto = CantoAtrasos::Tipico)
+        : chip555(r1, r2, c), limite(leds), atrasos(AtrasosCmos::datasheet(vdd, canto)) {
+        if (leds < 1 || leds > 10) {
+            throw std::invalid_argument("o modo com atrasos simula a placa com um CD4017: de 1 a 10 LEDs");
+        }
+        definirTicks();
+        setClock(std::make_unique<Oscilador>(chip555));
+    }
+
+    PlacaComAtrasos(const PlacaComAtrasos&) = delete;
+    PlacaComAtrasos& operator=(const PlacaComAtrasos&) = delete;
+
+    // Troca a fonte do CLK (por exemplo, os tempos do 555 analógico ou um clock rápido); a primeira borda é pedida já
+    void setClock(std::unique_ptr<FonteClock> fonte) {
+        if (!fonte) {
+            throw std::invalid_argument("fonte de clock vazia");
+        }
+        if (noClock) {
+            roda.cancel(noClock);
+        } else {
+            noClock = roda.acquire();
+            noClock->tipo = EventoClock;
+        }
+        clock = std::move(fonte);
+        agendarClock();
+    }
+
+    // Aperta o botão R em 'instante' e o solta 'duracao' segundos depois (RESET dos três chips enquanto apertado)
+    void scheduleReset(double instante, double duracao = 1e-3) {
+        uint64_t inicio = paraTicks(instante);
+        if (inicio < agora || !(duracao > 0)) {
+            throw std::invalid_argument("o botão precisa ser apertado depois do instante atual, por um tempo > 0");
+        }
+        for (uint32_t apertado = 0; apertado < 2; ++apertado) {
+            RodaDeTempo::No* no = roda.acquire();
+            no->tipo = EventoBotao;
+            no->fonte = apertado;
+            roda.schedule(no, apertado ? inicio : inicio + std::max<uint64_t>(paraTicks(duracao), 1));
+        }
+    }
+
+    // Processa todos os eventos até 'instante' (inclusive) e para nele; retorna quantos eventos foram processados
+    uint64_t runUntil(double instante) {
+        uint64_t fim = paraTicks(instante);
+        if (fim < agora) {
+            return 0;
+        }
+        uint64_t antes = eventos;
+        uint64_t proximaRoda = roda.nextTime();     // só muda quando a roda é mexida
+        while (true) {
+            // o mais cedo entre a roda e a fila; no mesmo tick, a mudança de saída vai antes
+            uint64_t proxima = (inicioFila < fila.size()) ? fila[inicioFila].tempo : UINT64_MAX;
+            if (proximaRoda < proxima) {
+                if (proximaRoda > fim) {
+                    break;
+                }
+                RodaDeTempo::No* no = roda.popUntil(fim);
+                agora = no->tempo;
+                processar(no);
+                proximaRoda = roda.nextTime();
+                continue;
+            }
+            if (proxima > fim) {
+                break;
+            }
+            agora = proxima;
+            Propagacao p = fila[inicioFila++];
+            propagar(p);
+        }
+        agora = fim;
+        return eventos - antes;
+    }
+
+    const AtrasosCmos& getAtrasos() const {
+        return atrasos;
+    }
+
+    const Chip555& getChip555() const {
+        return chip555;
+    }
+
+    // Saídas visíveis agora, na convenção do Chip4017::getOut() (O0 = bit limite - 1)
+    uint32_t getLeds() const {
+        return (saida4017 < limite) ? 1u << (limite - 1 - saida4017) : 0u;
+    }
+
+    unsigned getPosition() const {
+        return saida4017;
+    }
+
+    unsigned getUnidade() const {
+        return saidaUnidades;
+    }
+
+    unsigned getDezena() const {
+        return saidaDezenas;
+    }
+
+    bool getCarry() const {
+        return carryPino;
+    }
+
+    std::string getDisplay() const {
+        return std::string(1, static_cast<char>('0' + saidaDezenas)) + static_cast<char>('0' + saidaUnidades);
+    }
+
+    double getTime() const {
+        return paraSegundos(agora);
+    }
+
+    uint64_t getEventos() const {
+        return eventos;
+    }
+
+    // Subidas do CLK entregues até agora
+    uint64_t getSubidas() const {
+        return subidas;
+    }
+
+    uint64_t getGlitches(Sinal s) const {
+        return glitches[static_cast<unsigned>(s)];
+    }
+
+    uint64_t getViolacoes(Violacao v) const {
+        return violacoes[static_cast<unsigned>(v)];
+    }
+
+    uint64_t getTotalGlitches() const {
+        uint64_t n = 0;
+        for (uint64_t g : glitches) {
+            n += g;
+        }
+        return n;
+    }
+
+    uint64_t getTotalViolacoes() const {
+        uint64_t n = 0;
+        for (uint64_t v : violacoes) {
+            n += v;
+        }
+        return n;
+    }
+
+    // Os primeiros MaxRegistros glitches e violações, em ordem de tempo
+    const std::vector<Glitch>& getRegistroGlitches() const {
+        return registroGlitches;
+    }
+
+    const std::vector<RegistroViolacao>& getRegistroViolacoes() const {
+        return registroViolacoes;
+    }
+
+    // Maior tempo entre uma causa (subida do clock, botão) e a última mudança que ela provocou nos LEDs e no display
+    double getAcomodacaoLeds() const {
+        return paraSegundos(acomodacaoLeds);
+    }
+
+    double getAcomodacaoDisplay() const {
+        return paraSegundos(acomodacaoDisplay);
+    }
+
+    static const char* nome(Sinal s) {
+        switch (s) {
+            case Sinal::Saida4017: return "saída do CD4017";
+            case Sinal::Carry:     return "carry das unidades";
+            case Sinal::Unidades:  return "display das unidades";
+            case Sinal::Dezenas:   return "display das dezenas";
+            default:               return "display";
+        }
+    }
+
+    static const char* nome(Violacao v) {
+        switch (v) {
+            case Violacao::LarguraClock:      return "largura do pulso de clock";
+            case Violacao::FrequenciaMaxima:  return "frequência de clock acima da máxima";
+            case Violacao::LarguraReset:      return "largura do pulso de RESET";
+            case Violacao::ClockDuranteReset: return "clock com o RESET da realimentação alto";
+            default:                          return "tempo de remoção do RESET";
+        }
+    }
+
+    static const char* nome(Chip c) {
+        switch (c) {
+            case Chip::C4017:    return "CD4017";
+            case Chip::Unidades: return "CD4026 das unidades";
+            default:             return "CD4026 das dezenas";
+        }
+    }
+};
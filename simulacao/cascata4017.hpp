@@ -0,0 +1,111 @@
+/*
+    Vários CD4017 em cascata formando um único anel de LEDs (sequencial de centenas ou milhares de LEDs).
+
+    Na montagem real, o CO de cada CD4017 habilita o seguinte e o último volta para o primeiro: só uma saída da
+    cascata inteira fica alta por vez, e cada pulso a passa para a próxima. Aqui as saídas formam um conjunto de bits
+    em várias palavras de 64 bits, com a mesma convenção do Chip4017: logo após o reset o bit mais significativo
+    (LED L1) está aceso e cada pulso o desloca para a direita. O deslocamento é uma rotação em nível de palavra: só a
+    palavra que contém o bit aceso é tocada, e quando o bit sai dela passa para o topo da palavra de baixo (ou, na
+    última saída, volta para o topo da primeira). Um pulso custa o mesmo com 10 ou 10 mil LEDs.
+
+    Com até 10 saídas o comportamento e getOut() são idênticos aos do Chip4017.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+
+class Cascata4017 {
+public:
+    static constexpr unsigned SaidasPorChip = 10;
+
+private:
+    unsigned saidas;
+    std::vector<uint64_t> palavras;     // bit b = saída na posição saidas - 1 - b (como Chip4017::getOut())
+    size_t ativa = 0;                   // palavra que contém o bit aceso
+    unsigned posicao = 0;               // pulsos desde o reset, módulo 'saidas'
+
+    // Acende só a saída da posição 'pos'
+    void acender(unsigned pos) {
+        palavras[ativa] = 0;
+        unsigned bit = saidas - 1 - pos;
+        ativa = bit / 64;
+        palavras[ativa] = uint64_t(1) << (bit % 64);
+        posicao = pos;
+    }
+
+public:
+    explicit Cascata4017(unsigned qtSaidas)
+        : saidas(qtSaidas), palavras((qtSaidas + 63) / 64, 0) {
+        if (saidas < 1) {
+            throw std::invalid_argument("A cascata precisa de pelo menos uma saída.");
+        }
+        reset();
+    }
+
+    // Um pulso de clock; retorna true quando o anel volta para a primeira saída (L1)
+    bool shift() {
+        uint64_t& p = palavras[ativa];
+        p >>= 1;
+        posicao++;
+        if (p != 0) {
+            return false;                       // caso comum: o bit andou dentro da palavra
+        }
+        if (ativa == 0) {
+            acender(0);
+            return true;
+        }
+        palavras[--ativa] = uint64_t(1) << 63;
+        return false;
+    }
+
+    void reset() {
+        acender(0);
+    }
+
+    // Equivale a 'cycles' chamadas de shift()
+    void advance(uint64_t cycles) {
+        acender(static_cast<unsigned>((posicao + cycles % saidas) % saidas));
+    }
+
+    // Posição da saída acesa (0 = L1, a primeira após o reset)
+    unsigned getPosition() const {
+        return posicao;
+    }
+
+    // A saída na posição 'pos' está alta?
+    bool test(unsigned pos) const {
+        unsigned bit = saidas - 1 - pos;
+        return (palavras[bit / 64] >> (bit % 64)) & 1u;
+    }
+
+    // As 32 saídas de baixo, no formato de Chip4017::getOut() (a cascata inteira se tiver até 32 saídas)
+    uint32_t getOut() const {
+        return static_cast<uint32_t>(palavras[0]);
+    }
+
+    // CD4017 da cascata que está com a saída alta e a saída dele (Q0 a Q9)
+    unsigned getChipAtivo() const {
+        return posicao / SaidasPorChip;
+    }
+
+    unsigned getSaidaNoChip() const {
+        return posicao % SaidasPorChip;
+    }
+
+    unsigned getChips() const {
+        return (saidas + SaidasPorChip - 1) / SaidasPorChip;
+    }
+
+    // Número total de saídas (o LimitReset do anel inteiro)
+    unsigned getLimitReset() const {
+        return saidas;
+    }
+
+    const std::vector<uint64_t>& words() const {
+        return palavras;
+    }
+};
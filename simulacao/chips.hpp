@@ -0,0 +1,326 @@
+/*
+    Modelos dos circuitos integrados da placa Apple Juice (CD4026, NE555 e CD4017).
+
+    Este arquivo não depende da raylib: ele é compartilhado entre o simulador gráfico (apple-juice.cpp),
+    o motor de simulação sem interface (apple-juice-sim.cpp) e os testes.
+*/
+#pragma once
+
+#include <cstdint>                // Tipos inteiros com tamanho fixo (uint32_t, int64_t, etc.)
+#include <atomic>                 // Variáveis atômicas para comunicação segura entre threads (std::atomic)
+#include <stdexcept>              // Exceções padrão (std::invalid_argument)
+#include <thread>                 // Threads do C++ (std::thread)
+#include <chrono>                 // Controle de tempo e delays (std::chrono::duration, sleep_for)
+
+
+
+/*
+    Classe base que simula o funcionamento de um display decodificador CD4026, responsável por incrementar a contagem 
+    de 0 a 9 e gerar um sinal de carry quando a contagem reinicia (Out volta a 0). 
+
+    A aplicação do modificador 'virtual' permite o polimorfismo, possibilitando que métodos da classe base sejam 
+    sobrescritos pelas classes derivadas.
+*/
+class Chip4026 {
+protected:
+    bool carryOut = false;      // Indica se houve estouro da contagem (Out voltou a 0)
+    unsigned int Out = 0;       // Valor atual do display (0 a 9)
+    bool displayEnable = true;  // Pino DISPLAY ENABLE IN (ligado no alto na placa)
+
+public:
+    virtual ~Chip4026() = default;
+
+    // Incrementa a contagem. Se atingir 9, reinicia e ativa carryOut
+    virtual void add() {
+        if (Out == 9) {
+            Out = 0;
+            carryOut = true;
+        } else {
+            Out++;
+            carryOut = false;
+        }
+    }
+
+    /*
+        Avança 'cycles' pulsos de uma só vez, em forma fechada (aritmética módulo 10), e retorna quantos carries
+        foram gerados no caminho. O carryOut final é o mesmo que seria deixado pelo último add().
+    */
+    virtual uint64_t advance(uint64_t cycles) {
+        if (cycles == 0) {
+            return 0;
+        }
+        uint64_t total = Out + cycles;
+        Out = static_cast<unsigned int>(total % 10);
+        carryOut = (Out == 0);
+        return total / 10;
+    }
+
+    // Reseta o display e desativa o carry
+    virtual void reset() {
+        Out = 0;
+        carryOut = false;
+    }
+
+    // Retorna o valor atual do display
+    unsigned int getOut() const { 
+        return Out; 
+    }
+
+    // Retorna se houve carry na última contagem
+    bool getCarryOut() const { 
+        return carryOut; 
+    }
+
+    // DISPLAY ENABLE IN: baixo apaga os segmentos sem parar a contagem; o reset não mexe nele
+    void setDisplayEnable(bool nivel) {
+        displayEnable = nivel;
+    }
+
+    // DISPLAY ENABLE OUT repete o DISPLAY ENABLE IN
+    bool getDisplayEnable() const {
+        return displayEnable;
+    }
+
+    // Segmentos acesos pelo decodificador interno do CD4026 (ver decodificarSegmentos), já com o DISPLAY ENABLE
+    uint8_t getSegments() const;
+
+    // Pino UNGATED "C" SEGMENT: o segmento c antes da porta do DISPLAY ENABLE
+    bool getUngatedC() const;
+};
+
+
+
+/*
+    Decodificador de 7 segmentos do CD4026: um bit por segmento, na ordem do datasheet (a = bit 0 ... g = bit 6).
+    A tabela é constexpr, então decodificar um dígito é um único acesso à memória, sem desvios.
+*/
+inline constexpr uint8_t TabelaSegmentos[10] = {
+    0x3F,   // 0: a b c d e f
+    0x06,   // 1: b c
+    0x5B,   // 2: a b d e g
+    0x4F,   // 3: a b c d g
+    0x66,   // 4: b c f g
+    0x6D,   // 5: a c d f g
+    0x7D,   // 6: a c d e f g
+    0x07,   // 7: a b c
+    0x7F,   // 8: a b c d e f g
+    0x6F    // 9: a b c d f g
+};
+
+// Valores fora de 0 a 9 apagam o display
+constexpr uint8_t decodificarSegmentos(unsigned int valor) {
+    return (valor < 10) ? TabelaSegmentos[valor] : 0;
+}
+
+inline uint8_t Chip4026::getSegments() const {
+    return displayEnable ? decodificarSegmentos(Out) : 0;
+}
+
+inline bool Chip4026::getUngatedC() const {
+    return (decodificarSegmentos(Out) >> 2) & 1u;
+}
+
+
+
+/*
+    Classe que representa o display das unidades.
+    Herda Chip4026 e mantém comportamento padrão da contagem de 0 a 9.
+*/
+class Unidade : public Chip4026 {
+public:
+    // O override indica que este método sobrescreve uma função virtual da classe base, assim o polimorfismo funciona em tempo de execução
+    void add() override {
+        Chip4026::add();
+    }
+};
+
+
+
+/*
+    Classe que representa o display das dezenas.
+    Herda Chip4026 e adiciona a funcionalidade de incrementar apenas quando recebe um carry da unidade anterior.
+*/
+class Dezena : public Chip4026 {
+public:
+    void addOnCarry(bool carryIn) {
+        if (carryIn) {
+            add(); 
+        }
+    }
+
+    // Versão em lote do addOnCarry: recebe de uma vez todos os carries da unidade e repassa os próprios carries
+    uint64_t advanceOnCarries(uint64_t carriesIn) {
+        return advance(carriesIn);
+    }
+};
+
+
+
+/*
+    Simulação do Chip555 configurado em modo astável
+    Consulte a seção de Astable Mode (Free‑Running) no datasheet do NE555 / LM555 aproximadamente nas páginas 7–8, onde são apresentadas as
+    fórmulas e explicações para tHigh, tLow, período e frequência da oscilação.
+*/
+class Chip555 {
+public:
+    // logarítmo natural de 2 (arredondado, como na fórmula do datasheet; usado também nos lotes de Monte Carlo)
+    static constexpr double Ln2 = 0.693;
+
+private:
+    double R1, R2, C;
+    double tHigh = 0.0;
+    double tLow  = 0.0;
+    double period = 0.0;
+    double freq   = 0.0;
+
+    std::atomic<bool> stateHigh{false};
+
+    void calcTimings() {
+        // Modo astável (aprox): tH = 0.693*(R1+R2)*C; tL = 0.693*R2*C
+        tHigh = Ln2 * (R1 + R2) * C;
+        tLow  = Ln2 * (R2) * C;
+        period = tHigh + tLow;
+        freq = (period > 0) ? (1.0 / period) : 0.0;
+    }
+
+public:
+    /*
+        Esse construtor cria um objeto Chip555, inicializa seus parâmetros R1, R2 e C, verifica 
+        se eles são válidos, e calcula os tempos de pulso e frequência para o sinal astável.
+    */
+    Chip555(double r1Ohms, double r2Ohms, double cFarads)
+        : R1(r1Ohms), R2(r2Ohms), C(cFarads) {
+        if (R1 <= 0 || R2 <= 0 || C <= 0) {
+            throw std::invalid_argument("R1, R2 e C precisam ser > 0");
+        }
+        calcTimings();
+    }
+
+    // Simula um ciclo de clock (HIGH e LOW) com delays
+    void pulse() {
+        stateHigh = true;
+        std::this_thread::sleep_for(std::chrono::duration<double>(tHigh));
+
+        stateHigh = false;
+        std::this_thread::sleep_for(std::chrono::duration<double>(tLow));
+    }
+
+    /*
+        Troca os tempos da aproximação 0.693 pelos de um modelo mais fiel (ver Modelo555Analogico, que inclui a
+        alimentação e a resistência do transistor de descarga).
+    */
+    void setTimings(double tHighSegundos, double tLowSegundos) {
+        if (tHighSegundos <= 0 || tLowSegundos <= 0) {
+            throw std::invalid_argument("tHigh e tLow precisam ser > 0");
+        }
+        tHigh = tHighSegundos;
+        tLow = tLowSegundos;
+        period = tHigh + tLow;
+        freq = 1.0 / period;
+    }
+
+    // Altera o nível da saída sem esperar: usado pelo motor de tempo virtual, que controla o relógio por conta própria
+    void setHigh(bool high) {
+        stateHigh = high;
+    }
+
+    // estes métodos apenas acessam os valores sem alterá-los (const foi usado aqui como uma aplicação de segurança)
+    bool isHigh() const { 
+        return stateHigh; 
+    }
+
+    double getFrequency() const { 
+        return freq; 
+    }
+
+    double getPeriod() const { 
+        return period; 
+    }
+
+    double getTHigh() const {
+        return tHigh;
+    }
+
+    double getTLow() const {
+        return tLow;
+    }
+
+    double getR1() const {
+        return R1;
+    }
+
+    double getR2() const {
+        return R2;
+    }
+
+    double getC() const {
+        return C;
+    }
+};
+
+
+
+// Chip4017 (contador johnsson)
+// Consulte o datasheet do CD4017 para informações mais detalhadas a respeito de seu funcionamento.
+class Chip4017 {
+private:
+    unsigned LimitReset;
+    uint32_t Out{0};
+
+public:
+    explicit Chip4017(unsigned limitReset)
+        : LimitReset(limitReset) {
+        if (LimitReset < 1 || LimitReset > 10) {
+            throw std::invalid_argument("LimitReset precisa estar entre 1 e 10.");
+        }
+        reset();
+    }
+
+    // método que reage ao pulso do clock deslocando o bit mais significativo para a direita
+    void shift() {
+        Out >>= 1;
+        if (Out == 0) {
+            Out = 1u << (LimitReset - 1);
+        }
+    }
+
+    // método para aplicar o reset no chips
+    void reset() {
+        Out = 1u << (LimitReset - 1);
+    }
+
+    /*
+        Equivale a chamar shift() 'cycles' vezes: a posição do bit no anel é (posição + cycles) mod LimitReset.
+        A posição 0 é a saída logo após o reset (bit mais significativo).
+    */
+    void advance(uint64_t cycles) {
+        unsigned pos = (getPosition() + static_cast<unsigned>(cycles % LimitReset)) % LimitReset;
+        Out = 1u << (LimitReset - 1 - pos);
+    }
+
+    // Quantos shifts se passaram desde o reset (módulo LimitReset)
+    unsigned getPosition() const {
+        unsigned bit = 0;
+        while ((Out >> bit) > 1u) {
+            bit++;
+        }
+        return (LimitReset - 1) - bit;
+    }
+
+    // apenas retornam - não podem alterar o valor
+    uint32_t getOut() const { 
+        return Out;
+    }
+
+    unsigned getLimitReset() const { 
+        return LimitReset;                          
+    }
+};
+
+
+
+// Posição da chave da placa que escolhe o clock dos CD4026: a saída do 555 ou a entrada de clock externo
+enum class ChaveClock {
+    Interno555,
+    Externo
+};
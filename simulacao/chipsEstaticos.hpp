@@ -0,0 +1,241 @@
+/*
+    Versões dos chips com despacho estático, para os laços quentes que simulam muitos pulsos (varredura, lotes).
+
+    Em chips.hpp, Chip4026 tem add() e reset() virtuais e Dezena chama add() a cada carry: é a API polimórfica
+    usada pela interface e pelo MotorVirtual. Aqui nada é virtual. O LimitReset do CD4017 é argumento de template
+    (o valor de recarga vira constante) e os estágios BCD de uma cascata são compostos em tempo de compilação, então
+    o compilador enxerga o pulso inteiro e o expande em linha. Os resultados são os mesmos dos chips de chips.hpp.
+*/
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+
+// CD4017 com LimitReset fixo na compilação (mesmo comportamento de Chip4017)
+template<unsigned LimitReset>
+class Anel4017 {
+    static_assert(LimitReset >= 1 && LimitReset <= 10, "LimitReset precisa estar entre 1 e 10.");
+
+    static constexpr uint32_t Recarga = 1u << (LimitReset - 1);
+    uint32_t Out = Recarga;
+
+public:
+    // Desloca o bit; retorna true quando o anel volta para a primeira saída (borda de subida do CO)
+    bool shift() {
+        uint32_t a = Out >> 1;
+        bool volta = (a == 0);
+        Out = volta ? Recarga : a;
+        return volta;
+    }
+
+    void reset() {
+        Out = Recarga;
+    }
+
+    // Equivale a 'cycles' chamadas de shift()
+    void advance(uint64_t cycles) {
+        unsigned pos = (getPosition() + static_cast<unsigned>(cycles % LimitReset)) % LimitReset;
+        Out = 1u << (LimitReset - 1 - pos);
+    }
+
+    unsigned getPosition() const {
+        unsigned bit = 0;
+        while ((Out >> bit) > 1u) {
+            bit++;
+        }
+        return (LimitReset - 1) - bit;
+    }
+
+    uint32_t getOut() const {
+        return Out;
+    }
+
+    static constexpr unsigned getLimitReset() {
+        return LimitReset;
+    }
+};
+
+
+// Um estágio CD4026 sem métodos virtuais (mesmo comportamento de Chip4026)
+class Contador4026 {
+private:
+    unsigned int Out = 0;
+    bool carryOut = false;
+
+public:
+    // Incrementa e retorna o carry (9 -> 0)
+    bool add() {
+        carryOut = (Out == 9);
+        Out = carryOut ? 0 : Out + 1;
+        return carryOut;
+    }
+
+    uint64_t advance(uint64_t cycles) {
+        if (cycles == 0) {
+            return 0;
+        }
+        uint64_t total = Out + cycles;
+        Out = static_cast<unsigned int>(total % 10);
+        carryOut = (Out == 0);
+        return total / 10;
+    }
+
+    void reset() {
+        Out = 0;
+        carryOut = false;
+    }
+
+    unsigned int getOut() const {
+        return Out;
+    }
+
+    bool getCarryOut() const {
+        return carryOut;
+    }
+};
+
+
+/*
+    'Digitos' estágios CD4026 em cascata: o carry de cada um é o clock do seguinte, como Unidade -> Dezena na placa.
+    O estágio i + 1 só é tocado no carry do estágio i; a recursão acontece na compilação, não em tempo de execução.
+*/
+template<unsigned Digitos>
+class CascataBcd {
+    static_assert(Digitos >= 1, "a cascata precisa de pelo menos um dígito");
+
+private:
+    Contador4026 estagios[Digitos];
+
+    template<unsigned I>
+    bool propagar() {
+        if constexpr (I + 1 == Digitos) {
+            return estagios[I].add();
+        } else {
+            return estagios[I].add() && propagar<I + 1>();
+        }
+    }
+
+public:
+    // Um pulso no primeiro estágio; retorna true se o último estourou
+    bool add() {
+        return propagar<0>();
+    }
+
+    // Equivale a 'cycles' chamadas de add(); retorna quantas vezes o último estágio estourou
+    uint64_t advance(uint64_t cycles) {
+        for (auto& e : estagios) {
+            cycles = e.advance(cycles);
+        }
+        return cycles;
+    }
+
+    void reset() {
+        for (auto& e : estagios) {
+            e.reset();
+        }
+    }
+
+    // Estágio 'i' (0 = unidades)
+    const Contador4026& operator[](unsigned i) const {
+        return estagios[i];
+    }
+
+    static constexpr unsigned size() {
+        return Digitos;
+    }
+};
+
+
+/*
+    Placa Apple Juice montada na compilação: 555 -> Anel4017 e 555 -> cascata de 'Digitos' CD4026.
+    Com Digitos = 2 é a mesma fiação de MotorVirtual::applyPulse(), sem o 555 (quem usa conta o tempo).
+*/
+template<unsigned LimitReset, unsigned Digitos = 2>
+class PlacaEstatica {
+private:
+    Anel4017<LimitReset> anel;
+    CascataBcd<Digitos> displays;
+    uint64_t ciclos = 0;
+
+public:
+    // Um pulso de clock; retorna true se o último dígito estourou
+    bool step() {
+        anel.shift();
+        ciclos++;
+        return displays.add();
+    }
+
+    // Executa 'n' pulsos, um a um; retorna quantas vezes o último dígito estourou
+    uint64_t stepCycles(uint64_t n) {
+        uint64_t estouros = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            estouros += step() ? 1 : 0;
+        }
+        return estouros;
+    }
+
+    // Salta 'n' pulsos em forma fechada (mesmo resultado de stepCycles)
+    uint64_t advance(uint64_t n) {
+        anel.advance(n);
+        ciclos += n;
+        return displays.advance(n);
+    }
+
+    void reset() {
+        anel.reset();
+        displays.reset();
+    }
+
+    void resetDisplays() {
+        displays.reset();
+    }
+
+    const Anel4017<LimitReset>& getChip4017() const {
+        return anel;
+    }
+
+    const Contador4026& getDigito(unsigned i) const {
+        return displays[i];
+    }
+
+    const Contador4026& getUnidade() const {
+        return displays[0];
+    }
+
+    // Com Digitos = 1 não há dezenas: retorna o próprio estágio das unidades
+    const Contador4026& getDezena() const {
+        return displays[Digitos > 1 ? 1 : 0];
+    }
+
+    uint64_t getCiclos() const {
+        return ciclos;
+    }
+};
+
+
+// Procura L = limitReset de 1 a 10 (a comparação é em tempo de execução; cada ramo instancia uma placa diferente)
+template<unsigned L, unsigned Digitos, typename Funcao>
+auto despacharLimite(unsigned limitReset, Funcao& f) -> std::invoke_result_t<Funcao&, PlacaEstatica<1, Digitos>&> {
+    if constexpr (L > 10) {
+        throw std::invalid_argument("LimitReset precisa estar entre 1 e 10.");
+    } else {
+        if (limitReset == L) {
+            PlacaEstatica<L, Digitos> placa;
+            return f(placa);
+        }
+        return despacharLimite<L + 1, Digitos>(limitReset, f);
+    }
+}
+
+
+/*
+    Escolhe uma vez, em tempo de execução, a especialização de LimitReset e chama 'f' com uma placa nova dela.
+    'f' é um lambda genérico ([](auto& placa) { ... }) instanciado para os 10 tipos; todos precisam retornar o
+    mesmo tipo. Lança invalid_argument se o LimitReset estiver fora de 1 a 10.
+*/
+template<unsigned Digitos = 2, typename Funcao>
+auto comPlacaEstatica(unsigned limitReset, Funcao&& f) {
+    return despacharLimite<1, Digitos>(limitReset, f);
+}
@@ -0,0 +1,497 @@
+/*
+    Entrada de clock externo alimentada por um fluxo de instantes: arquivo, FIFO (pipe com nome) ou a entrada padrão.
+
+    Cada instante é uma borda de subida, em segundos desde o início, e os instantes precisam ser crescentes. Dois
+    formatos são aceitos, reconhecidos pelos primeiros bytes:
+
+        texto     um instante por linha em segundos com ponto decimal ("0.000125"); linhas vazias e o que vem depois
+                  de '#' são ignorados. A resolução é 1 ns: dígitos além do nono depois do ponto são descartados.
+
+        binário   "AJCK", um byte de versão (1) e depois, para cada borda, a distância até a anterior em ns (a
+                  primeira conta a partir de 0) como inteiro sem sinal LEB128: 7 bits por byte, o bit 7 indica que
+                  há mais bytes. Um clock de 1 MHz gasta 2 bytes por borda.
+
+    A leitura é por blocos grandes com fread (1 MiB), e os números são convertidos direto do bloco, sem strtod nem
+    cópia por linha: só o pedaço de linha (ou de número binário) que cruza o fim de um bloco é movido para o início
+    do seguinte. O arquivo não é mapeado em memória porque pipes e a entrada padrão não podem ser mapeados e o mesmo
+    código precisa compilar no MinGW; com o bloco grande, o custo fica no próprio parser.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "placaEventos.hpp"
+
+
+// Lê os instantes das bordas (em ns) de um fluxo de texto ou binário, em lotes
+class LeitorBordas {
+public:
+    static constexpr size_t TamanhoBloco = size_t(1) << 20;
+    static constexpr char Magico[4] = { 'A', 'J', 'C', 'K' };
+    static constexpr uint8_t Versao = 1;
+
+private:
+    std::FILE* arquivo = nullptr;
+    bool fechar = false;            // false para a entrada padrão
+    std::string nome;
+
+    std::vector<char> bloco;
+    size_t pos = 0;
+    size_t fim = 0;
+    bool acabou = false;            // fread não tem mais nada a entregar
+    bool binario = false;
+
+    uint64_t ultimo = 0;            // instante da última borda entregue
+    uint64_t lidas = 0;
+    uint64_t linha = 0;             // linha atual, no formato texto (para as mensagens de erro)
+
+    std::invalid_argument erro(const std::string& msg) const {
+        if (binario) {
+            return std::invalid_argument(nome + ", borda " + std::to_string(lidas + 1) + ": " + msg);
+        }
+        return std::invalid_argument(nome + ", linha " + std::to_string(linha) + ": " + msg);
+    }
+
+    // Move o que sobrou do bloco para o início e completa com o fluxo; false se não veio nada novo
+    bool recarregar() {
+        if (acabou) {
+            return false;
+        }
+        size_t resto = fim - pos;
+        if (resto && pos) {
+            std::memmove(bloco.data(), bloco.data() + pos, resto);
+        }
+        pos = 0;
+        fim = resto;
+        size_t n = std::fread(bloco.data() + fim, 1, bloco.size() - fim, arquivo);
+        if (n == 0) {
+            if (std::ferror(arquivo)) {
+                throw std::runtime_error("erro lendo " + nome);
+            }
+            acabou = true;
+            return false;
+        }
+        fim += n;
+        return true;
+    }
+
+    void aceitar(uint64_t instante) {
+        if (lidas && instante <= ultimo) {
+            throw erro("instante fora de ordem (as bordas precisam ser crescentes)");
+        }
+        ultimo = instante;
+        lidas++;
+    }
+
+    // Uma linha [p, q) do formato texto; false se ela não tem instante (vazia ou só comentário)
+    bool lerLinha(const char* p, const char* q, uint64_t& instante) {
+        while (p < q && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+        if (p == q || *p == '#' || *p == '\r') {
+            return false;
+        }
+
+        // segundos inteiros: até 10 dígitos, para que o valor em ns caiba em 64 bits
+        uint64_t segundos = 0;
+        const char* inicio = p;
+        while (p < q && static_cast<unsigned>(*p - '0') < 10) {
+            segundos = segundos * 10 + static_cast<unsigned>(*p - '0');
+            p++;
+        }
+        if (p - inicio > 10) {
+            throw erro("instante grande demais");
+        }
+        bool temDigito = p > inicio;
+
+        // fração: os 9 primeiros dígitos viram ns, o resto só é pulado
+        uint64_t ns = 0;
+        if (p < q && *p == '.') {
+            p++;
+            unsigned casas = 0;
+            for (; p < q && static_cast<unsigned>(*p - '0') < 10; ++p, temDigito = true) {
+                if (casas < 9) {
+                    ns = ns * 10 + static_cast<unsigned>(*p - '0');
+                    casas++;
+                }
+            }
+            for (; casas < 9; ++casas) {
+                ns *= 10;
+            }
+        }
+        if (!temDigito) {
+            throw erro("instante inválido");
+        }
+
+        while (p < q && (*p == ' ' || *p == '\t' || *p == '\r')) {
+            p++;
+        }
+        if (p < q && *p != '#') {
+            throw erro("instante inválido");
+        }
+        instante = segundos * 1000000000u + ns;
+        return true;
+    }
+
+    size_t lerTexto(uint64_t* destino, size_t max) {
+        size_t n = 0;
+        while (n < max) {
+            const char* p = bloco.data() + pos;
+            const char* q = static_cast<const char*>(std::memchr(p, '\n', fim - pos));
+            if (!q) {
+                // linha incompleta: completa o bloco; no fim do fluxo, a última linha não precisa de '\n'
+                if (fim - pos == bloco.size()) {
+                    throw erro("linha longa demais");
+                }
+                if (recarregar()) {
+                    continue;
+                }
+                if (pos == fim) {
+                    break;
+                }
+                p = bloco.data() + pos;
+                q = bloco.data() + fim;
+            }
+            linha++;
+            uint64_t instante = 0;
+            if (lerLinha(p, q, instante)) {
+                aceitar(instante);
+                destino[n++] = instante;
+            }
+            pos = std::min(fim, static_cast<size_t>(q - bloco.data()) + 1);
+        }
+        return n;
+    }
+
+    size_t lerBinario(uint64_t* destino, size_t max) {
+        const unsigned char* b = reinterpret_cast<const unsigned char*>(bloco.data());
+        size_t n = 0;
+        while (n < max) {
+            // um número LEB128 de 64 bits tem no máximo 10 bytes: com menos que isso no bloco, completa antes
+            if (fim - pos < 10 && !acabou) {
+                recarregar();
+                b = reinterpret_cast<const unsigned char*>(bloco.data());
+            }
+            if (pos == fim) {
+                break;
+            }
+            uint64_t delta = 0;
+            unsigned desloc = 0;
+            size_t p = pos;
+            while (true) {
+                if (p == fim) {
+                    throw erro("fluxo binário truncado");
+                }
+                unsigned char byte = b[p++];
+                if (desloc == 63 && byte > 1) {
+                    throw erro("distância grande demais");
+                }
+                delta |= static_cast<uint64_t>(byte & 0x7F) << desloc;
+                if (!(byte & 0x80)) {
+                    break;
+                }
+                desloc += 7;
+                if (desloc > 63) {
+                    throw erro("distância grande demais");
+                }
+            }
+            pos = p;
+            if (delta == 0 && lidas) {
+                throw erro("distância nula (as bordas precisam ser crescentes)");
+            }
+            if (delta > UINT64_MAX - ultimo) {
+                throw erro("instante grande demais");
+            }
+            uint64_t instante = ultimo + delta;
+            ultimo = instante;
+            lidas++;
+            destino[n++] = instante;
+        }
+        return n;
+    }
+
+public:
+    // Abre 'caminho' ("-" é a entrada padrão) e reconhece o formato; lança runtime_error se não conseguir ler
+    explicit LeitorBordas(const std::string& caminho) : nome(caminho), bloco(TamanhoBloco) {
+        if (caminho == "-") {
+            arquivo = stdin;
+            nome = "entrada padrão";
+        } else {
+            arquivo = std::fopen(caminho.c_str(), "rb");
+            fechar = true;
+        }
+        if (!arquivo) {
+            throw std::runtime_error("não foi possível abrir " + caminho);
+        }
+        try {
+            iniciar();
+        } catch (...) {
+            fecharArquivo();
+            throw;
+        }
+    }
+
+    // Lê de um FILE* já aberto (que continua sendo de quem chamou)
+    LeitorBordas(std::FILE* fluxo, const std::string& descricao) : arquivo(fluxo), nome(descricao), bloco(TamanhoBloco) {
+        if (!arquivo) {
+            throw std::invalid_argument("fluxo de bordas nulo");
+        }
+        iniciar();
+    }
+
+    LeitorBordas(const LeitorBordas&) = delete;
+    LeitorBordas& operator=(const LeitorBordas&) = delete;
+
+    ~LeitorBordas() {
+        fecharArquivo();
+    }
+
+    /*
+        Até 'max' instantes (em ns, crescentes) em 'destino'; retorna quantos vieram, 0 no fim do fluxo. Lança
+        invalid_argument se o conteúdo for inválido, com a linha (texto) ou o número da borda (binário).
+    */
+    size_t read(uint64_t* destino, size_t max) {
+        return binario ? lerBinario(destino, max) : lerTexto(destino, max);
+    }
+
+    bool isBinary() const {
+        return binario;
+    }
+
+    // Bordas entregues até agora
+    uint64_t count() const {
+        return lidas;
+    }
+
+private:
+    void iniciar() {
+        recarregar();
+        while (fim < sizeof(Magico) + 1 && recarregar()) {
+        }
+        binario = fim >= sizeof(Magico) && std::memcmp(bloco.data(), Magico, sizeof(Magico)) == 0;
+        if (binario) {
+            if (fim < sizeof(Magico) + 1 || static_cast<uint8_t>(bloco[sizeof(Magico)]) != Versao) {
+                throw std::runtime_error(nome + ": versão de clock binário não suportada");
+            }
+            pos = sizeof(Magico) + 1;
+        }
+    }
+
+    void fecharArquivo() {
+        if (fechar && arquivo) {
+            std::fclose(arquivo);
+        }
+        arquivo = nullptr;
+    }
+};
+
+
+// Grava instantes de bordas (em ns, crescentes) no formato binário que LeitorBordas lê
+class EscritorBordas {
+private:
+    std::FILE* arquivo = nullptr;
+    bool fechar = false;
+    std::string nome;
+    std::vector<unsigned char> buffer;
+    uint64_t ultimo = 0;
+    uint64_t escritas = 0;
+
+    void esvaziar() {
+        if (!buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), arquivo) != buffer.size()) {
+            throw std::runtime_error("erro gravando " + nome);
+        }
+        buffer.clear();
+    }
+
+public:
+    // "-" é a saída padrão; lança runtime_error se não conseguir criar o arquivo
+    explicit EscritorBordas(const std::string& caminho) : nome(caminho) {
+        if (caminho == "-") {
+            arquivo = stdout;
+        } else {
+            arquivo = std::fopen(caminho.c_str(), "wb");
+            fechar = true;
+        }
+        if (!arquivo) {
+            throw std::runtime_error("não foi possível criar " + caminho);
+        }
+        buffer.reserve(LeitorBordas::TamanhoBloco);
+        buffer.insert(buffer.end(), LeitorBordas::Magico, LeitorBordas::Magico + sizeof(LeitorBordas::Magico));
+        buffer.push_back(LeitorBordas::Versao);
+    }
+
+    EscritorBordas(const EscritorBordas&) = delete;
+    EscritorBordas& operator=(const EscritorBordas&) = delete;
+
+    ~EscritorBordas() {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+
+    void write(uint64_t instante) {
+        if (escritas && instante <= ultimo) {
+            throw std::invalid_argument("instante fora de ordem (as bordas precisam ser crescentes)");
+        }
+        uint64_t delta = instante - ultimo;
+        do {
+            unsigned char byte = delta & 0x7F;
+            delta >>= 7;
+            buffer.push_back(delta ? (byte | 0x80) : byte);
+        } while (delta);
+        ultimo = instante;
+        escritas++;
+        if (buffer.size() >= LeitorBordas::TamanhoBloco - 16) {
+            esvaziar();
+        }
+    }
+
+    void close() {
+        if (!arquivo) {
+            return;
+        }
+        esvaziar();
+        std::fflush(arquivo);
+        if (fechar) {
+            std::fclose(arquivo);
+        }
+        arquivo = nullptr;
+    }
+
+    uint64_t count() const {
+        return escritas;
+    }
+};
+
+
+/*
+    Clock externo da placa a partir de um fluxo de bordas de subida. A descida de cada pulso fica no meio do caminho
+    até a subida seguinte (ciclo de trabalho de 50%); a do último pulso repete a meia largura do anterior.
+
+    Os instantes são lidos em lotes para um buffer, e skipBefore() consome de uma vez todos os pulsos antes de um
+    limite com uma busca binária no lote: com a chave em EXT, a PlacaEventos aplica esses pulsos aos CD4026 em forma
+    fechada, então o custo por borda é o do parser.
+*/
+class ClockExterno : public FonteClock {
+public:
+    static constexpr size_t TamanhoLote = 1u << 14;
+
+private:
+    std::unique_ptr<LeitorBordas> leitor;
+    std::vector<uint64_t> instantes;    // subidas lidas e ainda não consumidas em [pos, fim)
+    size_t pos = 0;
+    size_t fim = 0;
+    bool alto = false;                  // a subida de instantes[pos] já foi entregue, falta a descida
+    uint64_t meiaLargura = 0;           // da última descida calculada, para o último pulso do fluxo
+
+    static constexpr double SegundosPorNs = 1e-9;
+    static constexpr double NsPorSegundo = 1e9;
+
+    // Garante 'n' subidas no buffer a partir de 'pos' (menos, se o fluxo acabou)
+    bool disponivel(size_t n) {
+        if (fim - pos >= n) {
+            return true;
+        }
+        size_t resto = fim - pos;
+        std::copy(instantes.begin() + pos, instantes.begin() + fim, instantes.begin());
+        pos = 0;
+        fim = resto;
+        while (fim < n) {
+            size_t lidos = leitor->read(instantes.data() + fim, instantes.size() - fim);
+            if (lidos == 0) {
+                return false;
+            }
+            fim += lidos;
+        }
+        return true;
+    }
+
+    // Descida do pulso que sobe em instantes[pos]
+    uint64_t descida() {
+        if (disponivel(2)) {
+            meiaLargura = (instantes[pos + 1] - instantes[pos]) / 2;
+        }
+        return instantes[pos] + meiaLargura;
+    }
+
+public:
+    explicit ClockExterno(std::unique_ptr<LeitorBordas> fluxo) : leitor(std::move(fluxo)), instantes(TamanhoLote) {
+        if (!leitor) {
+            throw std::invalid_argument("fluxo de bordas vazio");
+        }
+    }
+
+    // Arquivo, FIFO ou "-" (entrada padrão), em texto ou binário
+    explicit ClockExterno(const std::string& caminho) : ClockExterno(std::make_unique<LeitorBordas>(caminho)) {}
+
+    bool nextEdge(double& instante, bool& nivel) override {
+        if (!alto) {
+            if (!disponivel(1)) {
+                return false;
+            }
+            instante = instantes[pos] * SegundosPorNs;
+        } else {
+            instante = descida() * SegundosPorNs;
+            pos++;
+        }
+        alto = !alto;
+        nivel = alto;
+        return true;
+    }
+
+    uint64_t skipBefore(double limite, uint64_t& subidas, bool& nivel) override {
+        // bordas com instante < limite, em ns inteiros: instante < ceil(limite em ns)
+        double limiteNs = std::ceil(limite * NsPorSegundo);
+        uint64_t fronteira = (limiteNs >= 1.8e19) ? UINT64_MAX : (limiteNs > 0 ? static_cast<uint64_t>(limiteNs) : 0);
+
+        uint64_t bordas = 0;
+        while (disponivel(1)) {
+            if (alto) {
+                if (descida() >= fronteira) {
+                    break;
+                }
+                alto = false;
+                pos++;
+                bordas++;
+                continue;
+            }
+            if (instantes[pos] >= fronteira) {
+                break;
+            }
+            // pulsos inteiros antes da fronteira: a descida de um vem antes da subida do seguinte
+            size_t m = std::lower_bound(instantes.begin() + pos, instantes.begin() + fim, fronteira) - instantes.begin();
+            size_t completos = m - 1 - pos;
+            if (completos) {
+                meiaLargura = (instantes[m - 1] - instantes[m - 2]) / 2;
+                pos = m - 1;
+                bordas += 2 * completos;
+                subidas += completos;
+            }
+            // o pulso de 'pos' sobe antes da fronteira; a descida dele é vista na volta seguinte
+            alto = true;
+            bordas++;
+            subidas++;
+        }
+        nivel = alto;
+        return bordas;
+    }
+
+    // Subidas lidas do fluxo até agora (incluindo as que estão no buffer)
+    uint64_t getLidas() const {
+        return leitor->count();
+    }
+
+    bool isBinary() const {
+        return leitor->isBinary();
+    }
+};
@@ -0,0 +1,172 @@
+/*
+    Cascata de N CD4026 guardada em BCD compactado.
+
+    Em vez de um objeto por dígito, cada dígito ocupa 4 bits de uma palavra de 64 bits (15 dígitos por palavra; o
+    nibble de cima recebe o carry que sai do último dígito). Um pulso soma 1 à palavra inteira com o truque clássico
+    de soma BCD: soma-se 6 a todos os dígitos, de modo que um dígito que passa de 9 gera carry binário para o nibble
+    seguinte, e depois tira-se o 6 de volta dos dígitos que não geraram carry. O carry atravessa os 15 dígitos numa
+    única soma de 64 bits, sem percorrer dígito a dígito; só o estouro de uma palavra inteira (uma vez a cada 10^15
+    pulsos) passa para a palavra seguinte.
+
+    O resultado é o mesmo de N CD4026 ligados em cascata (carry de um no clock do seguinte), como Unidade -> Dezena.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "chips.hpp"
+
+
+class ContadorBcd {
+public:
+    static constexpr unsigned DigitosPorPalavra = 15;
+
+private:
+    static constexpr uint64_t Seis = 0x0666666666666666ull;        // 6 em cada um dos 15 dígitos
+    static constexpr uint64_t CarryDigito = 0x1111111111111110ull; // bit 4(i+1): carry que saiu do dígito i
+
+    unsigned digitos;
+    unsigned digitosPrimeira;           // dígitos da palavra 0, a única tocada em quase todos os pulsos
+    std::vector<uint64_t> palavras;
+    bool carryOut = false;
+
+    // Dígitos guardados na palavra 'w' (a última pode estar incompleta)
+    unsigned digitosNaPalavra(size_t w) const {
+        return (w + 1 < palavras.size()) ? DigitosPorPalavra : digitos - DigitosPorPalavra * static_cast<unsigned>(w);
+    }
+
+    /*
+        Soma BCD de 'a' + 'b' + 'vem' nos 'n' dígitos de baixo (a e b já em BCD); 'vai' recebe o carry que sai do
+        dígito n - 1. 'carries' tem, em cada bit, o carry binário que entrou naquela posição: num nibble de dígito
+        sem carry de saída a soma ficou com 6 a mais, que é descontado de uma vez só.
+    */
+    static uint64_t somar(uint64_t a, uint64_t b, unsigned vem, unsigned n, unsigned& vai) {
+        uint64_t t1 = a + Seis;
+        uint64_t t2 = t1 + b + vem;
+        uint64_t carries = t2 ^ t1 ^ b;
+        uint64_t semCarry = ~carries & CarryDigito;
+        uint64_t r = t2 - ((semCarry >> 2) | (semCarry >> 3));
+        vai = static_cast<unsigned>((r >> (4 * n)) & 1u);
+        return r & ((uint64_t(1) << (4 * n)) - 1);
+    }
+
+    static uint64_t potenciaDeDez(unsigned n) {
+        uint64_t p = 1;
+        for (unsigned i = 0; i < n; ++i) {
+            p *= 10;
+        }
+        return p;
+    }
+
+public:
+    // Com zero dígitos a cascata fica vazia: todo pulso sai direto como estouro
+    explicit ContadorBcd(unsigned qtDigitos = 2)
+        : digitos(qtDigitos), digitosPrimeira(std::min(qtDigitos, DigitosPorPalavra)), palavras((qtDigitos + DigitosPorPalavra - 1) / DigitosPorPalavra, 0) {}
+
+    // Um pulso no primeiro dígito; retorna true se o último estourou (o contador voltou a zero)
+    bool add() {
+        if (digitos == 0) {
+            return carryOut = true;
+        }
+        unsigned vai;
+        palavras[0] = somar(palavras[0], 0, 1, digitosPrimeira, vai);
+        for (size_t w = 1; w < palavras.size() && vai; ++w) {
+            palavras[w] = somar(palavras[w], 0, 1, digitosNaPalavra(w), vai);
+        }
+        carryOut = (vai != 0);
+        return carryOut;
+    }
+
+    /*
+        Equivale a 'cycles' chamadas de add(); retorna quantas vezes o último dígito estourou. 'cycles' é convertido
+        para BCD (no máximo 20 dígitos) e somado palavra a palavra.
+    */
+    uint64_t advance(uint64_t cycles) {
+        if (cycles == 0) {
+            return 0;
+        }
+        uint64_t estouros = 0;
+        if (digitos < 20) {
+            uint64_t modulo = potenciaDeDez(digitos);
+            estouros = cycles / modulo;
+            cycles %= modulo;
+        }
+        unsigned vem = 0;
+        for (size_t w = 0; w < palavras.size() && (cycles || vem); ++w) {
+            uint64_t b = 0;
+            for (unsigned d = 0; d < DigitosPorPalavra && cycles; ++d) {
+                b |= (cycles % 10) << (4 * d);
+                cycles /= 10;
+            }
+            palavras[w] = somar(palavras[w], b, vem, digitosNaPalavra(w), vem);
+        }
+        carryOut = (vem != 0);
+        return estouros + vem;
+    }
+
+    void reset() {
+        std::fill(palavras.begin(), palavras.end(), 0);
+        carryOut = false;
+    }
+
+    // Dígito 'i' (0 = o menos significativo)
+    unsigned digit(unsigned i) const {
+        return static_cast<unsigned>((palavras[i / DigitosPorPalavra] >> (4 * (i % DigitosPorPalavra))) & 0xFu);
+    }
+
+    // Segmentos acesos no dígito 'i' (mesma tabela do decodificador do CD4026)
+    uint8_t segments(unsigned i) const {
+        return decodificarSegmentos(digit(i));
+    }
+
+    /*
+        Segmentos de todos os dígitos de uma vez, do mais significativo para o menos (a ordem em que são desenhados);
+        percorre as palavras nibble a nibble, sem recalcular a posição de cada dígito.
+    */
+    void segments(std::vector<uint8_t>& destino) const {
+        destino.resize(digitos);
+        size_t i = digitos;
+        for (size_t w = 0; w < palavras.size(); ++w) {
+            uint64_t p = palavras[w];
+            for (unsigned d = digitosNaPalavra(w); d > 0; --d) {
+                destino[--i] = TabelaSegmentos[p & 0xFu];
+                p >>= 4;
+            }
+        }
+    }
+
+    // Valor do contador; só é exato com até 19 dígitos (acima disso, os dígitos de cima são descartados)
+    uint64_t value() const {
+        uint64_t v = 0;
+        for (unsigned i = std::min(digitos, 19u); i > 0; --i) {
+            v = v * 10 + digit(i - 1);
+        }
+        return v;
+    }
+
+    // Os dígitos como texto, com zeros à esquerda (como aparecem no display)
+    std::string text() const {
+        std::string s(digitos, '0');
+        for (unsigned i = 0; i < digitos; ++i) {
+            s[digitos - 1 - i] = static_cast<char>('0' + digit(i));
+        }
+        return s;
+    }
+
+    // Palavra 'w' em BCD compactado (dígitos 15w a 15w + 14)
+    uint64_t word(size_t w) const {
+        return (w < palavras.size()) ? palavras[w] : 0;
+    }
+
+    bool getCarryOut() const {
+        return carryOut;
+    }
+
+    unsigned size() const {
+        return digitos;
+    }
+};
@@ -0,0 +1,257 @@
+/*
+    Instrumentação de tempo do simulador: histogramas sem trava do erro do clock, tempo de quadro, leitura do estado
+    e latência entre a entrada do usuário e a tela.
+
+    Cada histograma tem um único escritor (a thread que mede) e pode ser lido a qualquer momento por outra thread
+    (o HUD ou o relatório de saída). As classes são logarítmicas: 8 subdivisões por potência de 2, de 1 ns até o
+    máximo de 64 bits, com erro relativo de no máximo 12,5%. Registrar um valor custa algumas instruções e nenhuma
+    operação atômica de leitura-modificação-escrita.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <chrono>
+
+
+// Resumo de um histograma, em microssegundos
+struct ResumoHistograma {
+    uint64_t contagem = 0;
+    double minimo = 0.0;
+    double media = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+    double maximo = 0.0;
+};
+
+
+class Histograma {
+public:
+    static constexpr unsigned SubClasses = 8;                       // subdivisões de cada potência de 2
+    static constexpr unsigned Classes = (64 - 2) * SubClasses;      // cobre todos os valores de 64 bits
+
+private:
+    std::atomic<uint64_t> contagens[Classes];
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> soma{0};
+    std::atomic<uint64_t> minimo{UINT64_MAX};
+    std::atomic<uint64_t> maximo{0};
+
+    // Só o escritor altera os contadores, então load + store basta (sem instruções com trava)
+    static void somar(std::atomic<uint64_t>& a, uint64_t v) {
+        a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    }
+
+public:
+    Histograma() {
+        clear();
+    }
+
+    Histograma(const Histograma&) = delete;
+    Histograma& operator=(const Histograma&) = delete;
+
+    // Classe de um valor: os 8 primeiros valores têm classe própria; acima disso, 8 classes por potência de 2
+    static unsigned classe(uint64_t v) {
+        if (v < SubClasses) {
+            return static_cast<unsigned>(v);
+        }
+        unsigned msb = 63;
+        while (!(v >> msb)) {
+            --msb;
+        }
+        unsigned sub = static_cast<unsigned>((v >> (msb - 3)) & (SubClasses - 1));
+        return (msb - 2) * SubClasses + sub;
+    }
+
+    // Menor valor que cai na classe 'k'
+    static uint64_t limiteInferior(unsigned k) {
+        if (k < SubClasses) {
+            return k;
+        }
+        unsigned msb = k / SubClasses + 2;
+        return (uint64_t(1) << msb) | (uint64_t(k % SubClasses) << (msb - 3));
+    }
+
+    // Registra um valor em nanossegundos (apenas a thread dona do histograma)
+    void record(uint64_t ns) {
+        somar(contagens[classe(ns)], 1);
+        somar(total, 1);
+        somar(soma, ns);
+        if (ns < minimo.load(std::memory_order_relaxed)) {
+            minimo.store(ns, std::memory_order_relaxed);
+        }
+        if (ns > maximo.load(std::memory_order_relaxed)) {
+            maximo.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    void recordSeconds(double s) {
+        record(s > 0 ? static_cast<uint64_t>(s * 1e9 + 0.5) : 0);
+    }
+
+    template<typename Duracao>
+    void recordDuration(Duracao d) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+    }
+
+    // Zera tudo (apenas a thread dona, ou com o escritor parado)
+    void clear() {
+        for (auto& c : contagens) {
+            c.store(0, std::memory_order_relaxed);
+        }
+        total.store(0, std::memory_order_relaxed);
+        soma.store(0, std::memory_order_relaxed);
+        minimo.store(UINT64_MAX, std::memory_order_relaxed);
+        maximo.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    // Classes não vazias: (limite inferior em ns, contagem)
+    std::vector<std::pair<uint64_t, uint64_t>> buckets() const {
+        std::vector<std::pair<uint64_t, uint64_t>> r;
+        for (unsigned k = 0; k < Classes; ++k) {
+            uint64_t c = contagens[k].load(std::memory_order_relaxed);
+            if (c) {
+                r.emplace_back(limiteInferior(k), c);
+            }
+        }
+        return r;
+    }
+
+    /*
+        Resumo em microssegundos. Lido enquanto o escritor trabalha, pode misturar registros de instantes vizinhos,
+        o que não importa para estatística; os percentis usam o ponto médio da classe.
+    */
+    ResumoHistograma summary() const {
+        ResumoHistograma r;
+        uint64_t copia[Classes];
+        uint64_t n = 0;
+        for (unsigned k = 0; k < Classes; ++k) {
+            copia[k] = contagens[k].load(std::memory_order_relaxed);
+            n += copia[k];
+        }
+        if (n == 0) {
+            return r;
+        }
+        r.contagem = n;
+        r.minimo = minimo.load(std::memory_order_relaxed) / 1e3;
+        r.maximo = maximo.load(std::memory_order_relaxed) / 1e3;
+        r.media = static_cast<double>(soma.load(std::memory_order_relaxed)) / static_cast<double>(std::max<uint64_t>(total.load(std::memory_order_relaxed), 1)) / 1e3;
+
+        auto percentil = [&](double p) {
+            uint64_t alvo = static_cast<uint64_t>(p * static_cast<double>(n - 1)) + 1;
+            uint64_t acumulado = 0;
+            for (unsigned k = 0; k < Classes; ++k) {
+                acumulado += copia[k];
+                if (acumulado >= alvo) {
+                    double inf = static_cast<double>(limiteInferior(k));
+                    double sup = (k + 1 < Classes) ? static_cast<double>(limiteInferior(k + 1)) : inf;
+                    double meio = (k < SubClasses) ? inf : 0.5 * (inf + sup);
+                    return std::clamp(meio / 1e3, r.minimo, r.maximo);
+                }
+            }
+            return r.maximo;
+        };
+        r.p50 = percentil(0.50);
+        r.p90 = percentil(0.90);
+        r.p99 = percentil(0.99);
+        r.p999 = percentil(0.999);
+        return r;
+    }
+};
+
+
+/*
+    Conjunto de medidas do simulador. Escritores:
+        erroPulso       thread do motor: |intervalo entre subidas do clock - período nominal|
+        tempoQuadro     laço de renderização: intervalo entre quadros desenhados em sequência
+        leituraEstado   laço de renderização: tempo para obter uma cópia consistente do estado (SeqLock::load)
+        latenciaEntrada laço de renderização: da tecla/clique até o fim do primeiro quadro desenhado depois dela
+*/
+struct Instrumentacao {
+    Histograma erroPulso;
+    Histograma tempoQuadro;
+    Histograma leituraEstado;
+    Histograma latenciaEntrada;
+
+    std::vector<std::pair<std::string, const Histograma*>> todos() const {
+        return {
+            {"erro_pulso", &erroPulso},
+            {"tempo_quadro", &tempoQuadro},
+            {"leitura_estado", &leituraEstado},
+            {"latencia_entrada", &latenciaEntrada},
+        };
+    }
+};
+
+
+// Uma linha por medida; tempos em microssegundos
+inline void salvarMetricasCsv(const Instrumentacao& inst, const std::string& caminho) {
+    std::ofstream out(caminho);
+    if (!out) {
+        throw std::runtime_error("não foi possível criar " + caminho);
+    }
+    out << "metrica,contagem,min_us,media_us,p50_us,p90_us,p99_us,p999_us,max_us\n";
+    for (const auto& [nome, h] : inst.todos()) {
+        ResumoHistograma r = h->summary();
+        out << nome << ',' << r.contagem << ',' << r.minimo << ',' << r.media << ',' << r.p50 << ','
+            << r.p90 << ',' << r.p99 << ',' << r.p999 << ',' << r.maximo << '\n';
+    }
+}
+
+
+// Resumo e classes não vazias de cada medida; 'descricao' identifica a execução (parâmetros da placa, máquina...)
+inline void salvarMetricasJson(const Instrumentacao& inst, const std::string& caminho, const std::string& descricao = "") {
+    std::ofstream out(caminho);
+    if (!out) {
+        throw std::runtime_error("não foi possível criar " + caminho);
+    }
+    std::string desc;
+    for (char ch : descricao) {
+        if (ch == '"' || ch == '\\') {
+            desc += '\\';
+        }
+        desc += ch;
+    }
+
+    out << "{\n  \"descricao\": \"" << desc << "\",\n  \"unidade\": \"us\",\n  \"metricas\": {";
+    bool primeira = true;
+    for (const auto& [nome, h] : inst.todos()) {
+        ResumoHistograma r = h->summary();
+        out << (primeira ? "\n" : ",\n") << "    \"" << nome << "\": {"
+            << "\"contagem\": " << r.contagem << ", \"min\": " << r.minimo << ", \"media\": " << r.media
+            << ", \"p50\": " << r.p50 << ", \"p90\": " << r.p90 << ", \"p99\": " << r.p99
+            << ", \"p999\": " << r.p999 << ", \"max\": " << r.maximo << ",\n      \"classes_ns\": [";
+        bool primeiraClasse = true;
+        for (const auto& [inicio, contagem] : h->buckets()) {
+            out << (primeiraClasse ? "" : ", ") << '[' << inicio << ", " << contagem << ']';
+            primeiraClasse = false;
+        }
+        out << "]}";
+        primeira = false;
+    }
+    out << "\n  }\n}\n";
+}
+
+
+// Escolhe o formato pela extensão (.csv ou .json)
+inline void salvarMetricas(const Instrumentacao& inst, const std::string& caminho, const std::string& descricao = "") {
+    bool csv = caminho.size() >= 4 && caminho.compare(caminho.size() - 4, 4, ".csv") == 0;
+    if (csv) {
+        salvarMetricasCsv(inst, caminho);
+    } else {
+        salvarMetricasJson(inst, caminho, descricao);
+    }
+}
@@ -0,0 +1,169 @@
+/*
+    Simulação em lote de muitas placas Apple Juice independentes (por exemplo, uma sala inteira com LimitReset diferentes).
+
+    Em vez de um objeto por chip (com chamadas virtuais), os estados ficam em estrutura de arrays (SoA):
+    um array com o anel de cada CD4017, outro com as unidades, outro com as dezenas. Assim um único laço
+    avança 8 placas por instrução com AVX2, 4 com SSE2, ou uma por vez no fallback escalar.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+    #include <immintrin.h>
+#endif
+
+
+class LotePlacas {
+private:
+    // Largura do preenchimento: os arrays sempre têm um múltiplo de 8 posições, então o kernel nunca trata sobras
+    static constexpr size_t Lanes = 8;
+
+    size_t qtPlacas = 0;
+    std::vector<uint32_t> anel;        // saídas do CD4017 de cada placa (um bit aceso)
+    std::vector<uint32_t> recarga;     // valor após o reset: 1 << (LimitReset - 1)
+    std::vector<uint32_t> unidade;     // dígito das unidades (0 a 9)
+    std::vector<uint32_t> dezena;      // dígito das dezenas (0 a 9)
+
+    static size_t arredonda(size_t n) {
+        return (n + Lanes - 1) / Lanes * Lanes;
+    }
+
+public:
+    // Cria uma placa por elemento de 'limites' (o LimitReset do CD4017 de cada uma)
+    explicit LotePlacas(const std::vector<unsigned>& limites)
+        : qtPlacas(limites.size()) {
+        size_t total = arredonda(qtPlacas);
+        anel.assign(total, 1u);
+        recarga.assign(total, 1u);      // as posições de preenchimento se comportam como LimitReset = 1
+        unidade.assign(total, 0u);
+        dezena.assign(total, 0u);
+
+        for (size_t i = 0; i < qtPlacas; ++i) {
+            if (limites[i] < 1 || limites[i] > 10) {
+                throw std::invalid_argument("LimitReset precisa estar entre 1 e 10.");
+            }
+            recarga[i] = 1u << (limites[i] - 1);
+        }
+        reset();
+    }
+
+    // Reseta todas as placas (CD4017 e displays)
+    void reset() {
+        anel = recarga;
+        std::fill(unidade.begin(), unidade.end(), 0u);
+        std::fill(dezena.begin(), dezena.end(), 0u);
+    }
+
+    /*
+        Um pulso de clock em todas as placas: mesma fiação de MotorVirtual::applyPulse(),
+        escrita sem desvios para que cada caminho seja uma sequência de instruções vetoriais.
+    */
+    void step() {
+        const size_t total = anel.size();
+        uint32_t* a = anel.data();
+        const uint32_t* r = recarga.data();
+        uint32_t* u = unidade.data();
+        uint32_t* d = dezena.data();
+
+#if defined(__AVX2__)
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i um   = _mm256_set1_epi32(1);
+        const __m256i nove = _mm256_set1_epi32(9);
+        for (size_t i = 0; i < total; i += 8) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vr = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r + i));
+            __m256i vu = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(u + i));
+            __m256i vd = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d + i));
+
+            // CD4017: desloca e, se o bit saiu do anel, recarrega o bit do LimitReset
+            va = _mm256_srli_epi32(va, 1);
+            va = _mm256_or_si256(va, _mm256_and_si256(_mm256_cmpeq_epi32(va, zero), vr));
+
+            // CD4026 das unidades: 9 -> 0 gera carry (máscara com todos os bits em 1)
+            __m256i carry = _mm256_cmpeq_epi32(vu, nove);
+            vu = _mm256_andnot_si256(carry, _mm256_add_epi32(vu, um));
+
+            // CD4026 das dezenas: soma o carry (subtrair -1 == somar 1) e volta a 0 depois do 9
+            __m256i estouro = _mm256_and_si256(carry, _mm256_cmpeq_epi32(vd, nove));
+            vd = _mm256_andnot_si256(estouro, _mm256_sub_epi32(vd, carry));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + i), va);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(u + i), vu);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), vd);
+        }
+#elif defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i um   = _mm_set1_epi32(1);
+        const __m128i nove = _mm_set1_epi32(9);
+        for (size_t i = 0; i < total; i += 4) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r + i));
+            __m128i vu = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + i));
+            __m128i vd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i));
+
+            va = _mm_srli_epi32(va, 1);
+            va = _mm_or_si128(va, _mm_and_si128(_mm_cmpeq_epi32(va, zero), vr));
+
+            __m128i carry = _mm_cmpeq_epi32(vu, nove);
+            vu = _mm_andnot_si128(carry, _mm_add_epi32(vu, um));
+
+            __m128i estouro = _mm_and_si128(carry, _mm_cmpeq_epi32(vd, nove));
+            vd = _mm_andnot_si128(estouro, _mm_sub_epi32(vd, carry));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(a + i), va);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(u + i), vu);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), vd);
+        }
+#else
+        for (size_t i = 0; i < total; ++i) {
+            uint32_t novo = a[i] >> 1;
+            a[i] = novo ? novo : r[i];
+
+            bool carry = (u[i] == 9);
+            u[i] = carry ? 0 : u[i] + 1;
+            if (carry) {
+                d[i] = (d[i] == 9) ? 0 : d[i] + 1;
+            }
+        }
+#endif
+    }
+
+    // Executa 'n' pulsos em todas as placas
+    void stepCycles(uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            step();
+        }
+    }
+
+    // Nome do kernel escolhido na compilação (útil para os relatórios de desempenho)
+    static const char* kernel() {
+#if defined(__AVX2__)
+        return "AVX2";
+#elif defined(__SSE2__)
+        return "SSE2";
+#else
+        return "escalar";
+#endif
+    }
+
+    size_t size() const {
+        return qtPlacas;
+    }
+
+    uint32_t getOut(size_t placa) const {
+        return anel[placa];
+    }
+
+    unsigned getUnidade(size_t placa) const {
+        return unidade[placa];
+    }
+
+    unsigned getDezena(size_t placa) const {
+        return dezena[placa];
+    }
+};
@@ -0,0 +1,388 @@
+/*
+    Análise de Monte Carlo das tolerâncias dos componentes do 555.
+
+    Os R1, R2 e C de verdade não têm o valor nominal: resistores costumam ter 5% de tolerância e eletrolíticos 20%,
+    então a frequência da placa montada pelo aluno nunca é exatamente o f= mostrado. Aqui milhões de conjuntos de
+    componentes são sorteados dentro das tolerâncias e cada um passa pelas fórmulas do Chip555, dando a distribuição
+    da frequência, do período e do duty cycle (histogramas e percentis).
+
+    As amostras são divididas em blocos de tamanho fixo e cada bloco tem o seu próprio fluxo de números aleatórios,
+    semeado a partir da semente e do índice do bloco. Assim o resultado só depende da semente: é o mesmo com 1 ou 64
+    threads e em qualquer ordem de execução. Dentro do bloco, os componentes são sorteados em lotes e os tempos do
+    lote inteiro são calculados num laço sem desvios, que o compilador vetoriza.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <algorithm>
+
+#include "chips.hpp"
+#include "poolThreads.hpp"
+
+
+/*
+    Gerador xoshiro256** (Blackman e Vigna): rápido, com período 2^256 - 1 e o mesmo resultado em qualquer
+    compilador (ao contrário das distribuições da biblioteca padrão). O estado inicial vem do splitmix64.
+*/
+class GeradorAleatorio {
+private:
+    uint64_t s[4];
+    double reserva = 0.0;       // segundo valor do último par do Box-Muller
+    bool temReserva = false;
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    static uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+public:
+    // Fluxo 'fluxo' da semente 'semente': fluxos diferentes são sequências independentes
+    explicit GeradorAleatorio(uint64_t semente, uint64_t fluxo = 0) {
+        uint64_t x = semente ^ (fluxo * 0xD1B54A32D192ED03ull);
+        splitmix64(x);
+        for (uint64_t& v : s) {
+            v = splitmix64(x);
+        }
+    }
+
+    uint64_t next() {
+        uint64_t r = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return r;
+    }
+
+    // Uniforme em [0, 1), com os 53 bits da mantissa
+    double uniform() {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+
+    // Normal padrão (média 0, desvio 1) pelo Box-Muller, que dá dois valores por par de uniformes
+    double normal() {
+        if (temReserva) {
+            temReserva = false;
+            return reserva;
+        }
+        double raio = std::sqrt(-2.0 * std::log(1.0 - uniform()));
+        double angulo = 6.283185307179586 * uniform();
+        reserva = raio * std::sin(angulo);
+        temReserva = true;
+        return raio * std::cos(angulo);
+    }
+};
+
+
+// Como o valor de um componente se distribui dentro da tolerância
+enum class Distribuicao {
+    Normal,         // tolerância = 3 desvios padrão, truncada na tolerância (o fabricante descarta o resto)
+    Uniforme        // qualquer valor dentro da tolerância com a mesma chance
+};
+
+
+struct ConfigMonteCarlo {
+    double r1 = 1000.0;
+    double r2 = 10000.0;
+    double c = 7.37e-6;
+    double tolR1 = 0.05;            // tolerâncias relativas (0.05 = ±5%)
+    double tolR2 = 0.05;
+    double tolC = 0.20;
+    Distribuicao distribuicao = Distribuicao::Normal;
+    uint64_t amostras = 1000000;
+    uint64_t semente = 1;
+    unsigned classes = 1000;        // classes de cada histograma
+};
+
+
+/*
+    Histograma de classes iguais numa faixa fixa [inicio, fim]. Os percentis interpolam dentro da classe, então o
+    erro é de no máximo uma largura de classe ((fim - inicio) / classes).
+*/
+class HistogramaFaixa {
+private:
+    double inicio = 0.0;
+    double fim = 1.0;
+    double escala = 1.0;            // classes por unidade
+    std::vector<uint64_t> contagens;
+    uint64_t total = 0;
+    double menor = 0.0;
+    double maior = 0.0;
+
+public:
+    HistogramaFaixa() = default;
+
+    HistogramaFaixa(double inicioFaixa, double fimFaixa, unsigned qtClasses)
+        : inicio(inicioFaixa), fim(fimFaixa), contagens(qtClasses, 0) {
+        if (qtClasses < 1 || !(fim > inicio)) {
+            throw std::invalid_argument("o histograma precisa de pelo menos uma classe e de uma faixa não vazia");
+        }
+        escala = qtClasses / (fim - inicio);
+    }
+
+    // Valores fora da faixa caem na primeira ou na última classe
+    void add(double v) {
+        double k = (v - inicio) * escala;
+        size_t classe = (k <= 0) ? 0 : std::min(contagens.size() - 1, static_cast<size_t>(k));
+        contagens[classe]++;
+        if (total == 0 || v < menor) {
+            menor = v;
+        }
+        if (total == 0 || v > maior) {
+            maior = v;
+        }
+        total++;
+    }
+
+    // Soma as contagens de outro histograma com a mesma faixa e as mesmas classes
+    void merge(const HistogramaFaixa& outro) {
+        if (outro.total == 0) {
+            return;
+        }
+        for (size_t k = 0; k < contagens.size(); ++k) {
+            contagens[k] += outro.contagens[k];
+        }
+        menor = (total == 0) ? outro.menor : std::min(menor, outro.menor);
+        maior = (total == 0) ? outro.maior : std::max(maior, outro.maior);
+        total += outro.total;
+    }
+
+    // Valor abaixo do qual está a fração 'p' das amostras (0 a 1)
+    double percentile(double p) const {
+        if (total == 0) {
+            return 0.0;
+        }
+        double alvo = p * static_cast<double>(total);
+        uint64_t acumulado = 0;
+        for (size_t k = 0; k < contagens.size(); ++k) {
+            if (contagens[k] && static_cast<double>(acumulado + contagens[k]) >= alvo) {
+                double dentro = (alvo - static_cast<double>(acumulado)) / static_cast<double>(contagens[k]);
+                return std::clamp(inicio + (k + dentro) / escala, menor, maior);
+            }
+            acumulado += contagens[k];
+        }
+        return maior;
+    }
+
+    uint64_t count() const {
+        return total;
+    }
+
+    unsigned size() const {
+        return static_cast<unsigned>(contagens.size());
+    }
+
+    uint64_t at(unsigned k) const {
+        return contagens[k];
+    }
+
+    // Limite inferior da classe 'k' (classStart(size()) é o fim da faixa)
+    double classStart(unsigned k) const {
+        return inicio + k / escala;
+    }
+
+    double getMinimo() const {
+        return menor;
+    }
+
+    double getMaximo() const {
+        return maior;
+    }
+};
+
+
+// Distribuição de uma grandeza (frequência, período ou duty cycle) nas placas sorteadas
+struct EstatisticaMonteCarlo {
+    double nominal = 0.0;           // com os componentes nos valores nominais
+    double media = 0.0;
+    double desvioPadrao = 0.0;
+    HistogramaFaixa histograma;
+
+    double percentile(double p) const {
+        return histograma.percentile(p);
+    }
+};
+
+
+struct ResultadoMonteCarlo {
+    uint64_t amostras = 0;
+    EstatisticaMonteCarlo frequencia;   // Hz
+    EstatisticaMonteCarlo periodo;      // s
+    EstatisticaMonteCarlo duty;         // tHigh / período
+};
+
+
+// Amostras por fluxo de números aleatórios; fixo para que o resultado não dependa do número de threads
+constexpr uint64_t BlocoMonteCarlo = 65536;
+
+// Componentes sorteados por vez antes do laço vetorizado
+constexpr size_t LoteMonteCarlo = 256;
+
+
+// Desvio relativo de um componente em unidades da tolerância, em [-1, 1]
+inline double sortearDesvio(GeradorAleatorio& g, Distribuicao d) {
+    if (d == Distribuicao::Uniforme) {
+        return 2.0 * g.uniform() - 1.0;
+    }
+    // a tolerância é 3 desvios padrão e valores além dela são sorteados de novo (0,3% das vezes)
+    while (true) {
+        double z = g.normal();
+        if (std::fabs(z) <= 3.0) {
+            return z / 3.0;
+        }
+    }
+}
+
+
+/*
+    Sorteia cfg.amostras conjuntos de componentes e junta as distribuições. Os histogramas cobrem exatamente os
+    extremos possíveis (todos os componentes nos limites da tolerância), então nenhuma amostra fica fora deles.
+*/
+inline ResultadoMonteCarlo executarMonteCarlo(const ConfigMonteCarlo& cfg, PoolThreads& pool) {
+    if (cfg.amostras == 0) {
+        throw std::invalid_argument("o Monte Carlo precisa de pelo menos uma amostra");
+    }
+    for (double tol : {cfg.tolR1, cfg.tolR2, cfg.tolC}) {
+        if (!(tol >= 0.0 && tol < 1.0)) {
+            throw std::invalid_argument("as tolerâncias precisam estar entre 0 e 100% (exclusive)");
+        }
+    }
+    Chip555 nominal(cfg.r1, cfg.r2, cfg.c);
+
+    // Faixas dos histogramas pelos extremos dos componentes; com tolerância zero, uma faixa mínima em volta do nominal
+    const double r1Min = cfg.r1 * (1 - cfg.tolR1), r1Max = cfg.r1 * (1 + cfg.tolR1);
+    const double r2Min = cfg.r2 * (1 - cfg.tolR2), r2Max = cfg.r2 * (1 + cfg.tolR2);
+    const double cMin = cfg.c * (1 - cfg.tolC), cMax = cfg.c * (1 + cfg.tolC);
+    auto faixa = [&cfg](double a, double b) {
+        double folga = 1e-9 * std::max(std::fabs(a), std::fabs(b));
+        return HistogramaFaixa(a - folga, b + folga, cfg.classes);
+    };
+    const double tMin = Chip555::Ln2 * (r1Min + 2 * r2Min) * cMin;
+    const double tMax = Chip555::Ln2 * (r1Max + 2 * r2Max) * cMax;
+
+    ResultadoMonteCarlo r;
+    r.amostras = cfg.amostras;
+    r.periodo.nominal = nominal.getPeriod();
+    r.periodo.histograma = faixa(tMin, tMax);
+    r.frequencia.nominal = nominal.getFrequency();
+    r.frequencia.histograma = faixa(1.0 / tMax, 1.0 / tMin);
+    r.duty.nominal = nominal.getTHigh() / nominal.getPeriod();
+    r.duty.histograma = faixa((r1Min + r2Max) / (r1Min + 2 * r2Max), (r1Max + r2Min) / (r1Max + 2 * r2Min));
+
+    /*
+        Somas de cada bloco, juntadas na ordem dos blocos no final (a soma em ponto flutuante depende da ordem). São
+        somas dos desvios em relação ao nominal, para a variância não se perder no cancelamento de dois números grandes.
+    */
+    struct Somas {
+        double f = 0.0, f2 = 0.0, t = 0.0, t2 = 0.0, d = 0.0, d2 = 0.0;
+    };
+    const size_t qtBlocos = static_cast<size_t>((cfg.amostras + BlocoMonteCarlo - 1) / BlocoMonteCarlo);
+    std::vector<Somas> somas(qtBlocos);
+    std::mutex mtx;
+    const HistogramaFaixa vazioF = r.frequencia.histograma, vazioT = r.periodo.histograma, vazioD = r.duty.histograma;
+    const double fN = r.frequencia.nominal, tN = r.periodo.nominal, dN = r.duty.nominal;
+
+    size_t blocosPorTarefa = std::max<size_t>(1, qtBlocos / (pool.size() * 4));
+    pool.parallelFor(qtBlocos, blocosPorTarefa, [&](size_t primeiro, size_t ultimo) {
+        HistogramaFaixa hf = vazioF, ht = vazioT, hd = vazioD;
+        double r1[LoteMonteCarlo], r2[LoteMonteCarlo], c[LoteMonteCarlo];
+        double f[LoteMonteCarlo], t[LoteMonteCarlo], d[LoteMonteCarlo];
+
+        for (size_t b = primeiro; b < ultimo; ++b) {
+            GeradorAleatorio g(cfg.semente, b);
+            uint64_t inicio = b * BlocoMonteCarlo;
+            uint64_t fim = std::min(cfg.amostras, inicio + BlocoMonteCarlo);
+            Somas& s = somas[b];
+
+            for (uint64_t i = inicio; i < fim; i += LoteMonteCarlo) {
+                size_t n = static_cast<size_t>(std::min<uint64_t>(LoteMonteCarlo, fim - i));
+                for (size_t k = 0; k < n; ++k) {
+                    r1[k] = cfg.r1 * (1 + cfg.tolR1 * sortearDesvio(g, cfg.distribuicao));
+                    r2[k] = cfg.r2 * (1 + cfg.tolR2 * sortearDesvio(g, cfg.distribuicao));
+                    c[k] = cfg.c * (1 + cfg.tolC * sortearDesvio(g, cfg.distribuicao));
+                }
+                // As fórmulas do Chip555 para o lote inteiro (sem desvios: vetorizado)
+                for (size_t k = 0; k < n; ++k) {
+                    double tHigh = Chip555::Ln2 * (r1[k] + r2[k]) * c[k];
+                    double tLow = Chip555::Ln2 * r2[k] * c[k];
+                    t[k] = tHigh + tLow;
+                    f[k] = 1.0 / t[k];
+                    d[k] = tHigh / t[k];
+                }
+                for (size_t k = 0; k < n; ++k) {
+                    hf.add(f[k]);
+                    ht.add(t[k]);
+                    hd.add(d[k]);
+                    double df = f[k] - fN, dt = t[k] - tN, dd = d[k] - dN;
+                    s.f += df;
+                    s.f2 += df * df;
+                    s.t += dt;
+                    s.t2 += dt * dt;
+                    s.d += dd;
+                    s.d2 += dd * dd;
+                }
+            }
+        }
+
+        // As contagens são inteiras: juntá-las em qualquer ordem dá o mesmo resultado
+        std::lock_guard<std::mutex> lock(mtx);
+        r.frequencia.histograma.merge(hf);
+        r.periodo.histograma.merge(ht);
+        r.duty.histograma.merge(hd);
+    });
+
+    Somas total;
+    for (const Somas& s : somas) {
+        total.f += s.f;
+        total.f2 += s.f2;
+        total.t += s.t;
+        total.t2 += s.t2;
+        total.d += s.d;
+        total.d2 += s.d2;
+    }
+    const double n = static_cast<double>(cfg.amostras);
+    auto resumir = [n](EstatisticaMonteCarlo& e, double soma, double somaQuadrados) {
+        double desvioMedio = soma / n;
+        e.media = e.nominal + desvioMedio;
+        e.desvioPadrao = std::sqrt(std::max(0.0, somaQuadrados / n - desvioMedio * desvioMedio));
+    };
+    resumir(r.frequencia, total.f, total.f2);
+    resumir(r.periodo, total.t, total.t2);
+    resumir(r.duty, total.d, total.d2);
+    return r;
+}
+
+
+// Histogramas em CSV: uma linha por classe de cada grandeza (grandeza, início, fim, contagem)
+inline void salvarHistogramasCsv(const ResultadoMonteCarlo& r, const std::string& caminho) {
+    std::ofstream out(caminho);
+    if (!out) {
+        throw std::runtime_error("não foi possível criar " + caminho);
+    }
+    out.precision(10);
+    out << "grandeza,inicio,fim,contagem\n";
+    auto escrever = [&out](const char* nome, const HistogramaFaixa& h) {
+        for (unsigned k = 0; k < h.size(); ++k) {
+            out << nome << ',' << h.classStart(k) << ',' << h.classStart(k + 1) << ',' << h.at(k) << '\n';
+        }
+    };
+    escrever("frequencia_hz", r.frequencia.histograma);
+    escrever("periodo_s", r.periodo.histograma);
+    escrever("duty_cycle", r.duty.histograma);
+}
@@ -0,0 +1,595 @@
+/*
+    Motor de simulação da placa Apple Juice desacoplado da interface gráfica.
+
+    No modo virtual, o relógio é apenas um contador de tempo simulado: cada ciclo do 555 soma tHigh + tLow ao tempo
+    e atualiza os chips imediatamente, sem dormir. Assim uma hora de placa é simulada tão rápido quanto a CPU permite.
+    No modo de tempo real, o motor espera os tempos do 555 de verdade (é o modo usado pela interface gráfica).
+*/
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <stdexcept>
+
+#include "chips.hpp"
+#include "contadorBcd.hpp"
+#include "cascata4017.hpp"
+#include "analogico555.hpp"
+#include "seqlock.hpp"
+#include "relogio.hpp"
+#include "instrumentacao.hpp"
+#include "vcd.hpp"
+#include "rastroPeriodico.hpp"
+
+
+// Modo de avanço do relógio
+enum class ModoTempo {
+    Virtual,        // o mais rápido possível
+    TempoReal       // respeita tHigh e tLow do 555
+};
+
+
+// Resultado de uma execução do motor
+struct RelatorioSimulacao {
+    uint64_t ciclos = 0;            // ciclos completos do 555 executados
+    double tempoSimulado = 0.0;     // segundos de placa
+    double tempoReal = 0.0;         // segundos de relógio de parede gastos
+    double ciclosPorSegundo = 0.0;  // ciclos simulados por segundo real
+};
+
+
+/*
+    Fotografia do estado visível da placa, publicada a cada mudança pelo motor e lida pela interface gráfica
+    sem travas (ver SeqLock). Os campos vêm sempre do mesmo instante: o display nunca mostra um estado rasgado.
+*/
+struct EstadoPlaca {
+    uint32_t leds = 0;          // saídas do CD4017 (as 32 de baixo, numa cascata maior)
+    uint32_t ledAceso = 0;      // posição do LED aceso (0 = L1), para qualquer número de LEDs
+    uint8_t unidade = 0;        // dígito das unidades
+    uint8_t dezena = 0;         // dígito das dezenas
+    uint8_t segUnidade = 0;     // pinos a..g do CD4026 das unidades (bit 0 = a), como saem do chip
+    uint8_t segDezena = 0;      // pinos a..g do CD4026 das dezenas
+    bool carry = false;         // linha de carry entre os dois CD4026
+    uint64_t altos = 0;         // dígitos acima das dezenas em BCD compactado (os 15 primeiros; ver ContadorBcd)
+    bool clock = false;         // nível da saída do 555
+    uint64_t ciclos = 0;        // pulsos aplicados desde o início
+    double frequenciaMedida = 0.0;  // frequência efetiva no modo de tempo real (Hz)
+};
+
+
+/*
+    Conjunto de chips da placa ligado exatamente como na placa real:
+    555 -> CD4017 (LEDs) e 555 -> CD4026 das unidades -> carry -> CD4026 das dezenas.
+    Com mais de dois dígitos, o carry das dezenas alimenta a cascata dos dígitos de cima (centenas em diante).
+    Com mais de 10 LEDs, o CD4017 vira uma cascata de vários (ver Cascata4017).
+*/
+class MotorVirtual {
+private:
+    Chip555  chip555;
+    Cascata4017 chip4017;   // um CD4017 com até 10 LEDs; acima disso, vários em cascata
+    Unidade  unidade;
+    Dezena   dezena;
+    ContadorBcd altos;      // dígitos acima das dezenas (vazio na placa original, de dois dígitos)
+
+    ModoTempo modo;
+    uint64_t ciclos = 0;
+    double tempoSimulado = 0.0;
+
+    // Modo de tempo real: prazos absolutos contados a partir do último resync()
+    RelogioTempoReal relogio;
+    uint64_t ciclosRelogio = 0;     // ciclos entregues desde o último resync()
+
+    SeqLock<EstadoPlaca>* publicador = nullptr;     // opcional: quem quer acompanhar a placa de outra thread
+
+    // Resets pedidos por outra thread (botões da interface); aplicados pela thread do motor assim que chegam
+    static constexpr unsigned PedidoReset = 1u;
+    static constexpr unsigned PedidoResetDisplays = 2u;
+    std::atomic<unsigned> pedidos{0};
+
+    /*
+        Chave do clock dos CD4026 e pulsos da entrada de clock externo. Ambos podem vir de outras threads (o botão da
+        interface e quem lê o fluxo do clock externo); os pulsos se acumulam e o motor os aplica em lote junto com os
+        resets. Com a chave em 555, pulsos externos não chegam a lugar nenhum e são descartados.
+    */
+    std::atomic<ChaveClock> chave{ChaveClock::Interno555};
+    std::atomic<uint64_t> pulsosExternos{0};
+    uint64_t externosAplicados = 0;
+
+    // Acorda a thread do motor no meio da espera de uma borda quando chega um pedido (ver dormirAte)
+    std::mutex travaPedidos;
+    std::condition_variable avisoPedidos;
+
+    // Opcional: erro de cada intervalo entre subidas do clock no modo de tempo real (ver Instrumentacao)
+    Histograma* histogramaPulso = nullptr;
+    RelogioTempoReal::Relogio::time_point ultimaSubida;
+    bool temSubida = false;                         // falso depois de resync() ou de um lote: não há intervalo válido
+
+    GravadorVcd* rastro = nullptr;                  // opcional: gravação dos sinais em VCD
+    RastroPeriodico* historico = nullptr;           // opcional: histórico compacto com acesso a qualquer ciclo
+    AnelSpsc<EventoVcd>* sonda = nullptr;           // opcional: eventos para outra thread (analisador lógico)
+
+    bool rastreando() const {
+        return rastro || historico || sonda;
+    }
+
+    // A partir deste tamanho, um salto vai para a sonda como um único evento Lote (todas as saídas já acenderam)
+    static constexpr uint64_t MinimoLoteSonda = 64;
+
+    EventoVcd evento(TipoEventoVcd tipo) const {
+        EventoVcd e;
+        e.ciclo = ciclos;
+        e.leds = chip4017.getOut();
+        e.unidade = static_cast<uint8_t>(unidade.getOut());
+        e.dezena = static_cast<uint8_t>(dezena.getOut());
+        e.segUnidade = unidade.getSegments();
+        e.segDezena = dezena.getSegments();
+        e.carry = unidade.getCarryOut() ? 1 : 0;
+        e.tipo = tipo;
+        return e;
+    }
+
+    AmostraPlaca amostra() const {
+        AmostraPlaca a;
+        a.leds = chip4017.getOut();
+        a.unidade = static_cast<uint8_t>(unidade.getOut());
+        a.dezena = static_cast<uint8_t>(dezena.getOut());
+        a.carry = unidade.getCarryOut();
+        return a;
+    }
+
+    void rastrear(TipoEventoVcd tipo) {
+        if (rastro) {
+            rastro->record(evento(tipo));
+        }
+        if (sonda) {
+            sonda->tryPush(evento(tipo));   // fila cheia: o evento se perde, mas o motor nunca espera
+        }
+        if (historico) {
+            if (tipo == TipoEventoVcd::Reset) {
+                historico->replaceLast(amostra());
+            } else {
+                historico->append(ciclos, amostra());
+            }
+        }
+    }
+
+    // Eventos e amostras guardam as saídas numa palavra de 32 bits: só servem para a placa com um CD4017
+    void exigirUmChip(const void* destino) const {
+        if (destino && chip4017.getLimitReset() > 10) {
+            throw std::invalid_argument("o VCD, a sonda e o histórico guardam de 1 a 10 saídas do CD4017");
+        }
+    }
+
+    void publicar() {
+        if (publicador) {
+            publicador->store(getEstado());
+        }
+    }
+
+    // A trava em volta do notify garante que o motor não perca o aviso entre testar os pedidos e dormir
+    void avisarMotor() {
+        { std::lock_guard<std::mutex> l(travaPedidos); }
+        avisoPedidos.notify_one();
+    }
+
+    // Espera até o prazo absoluto 'alvo', aplicando os pedidos assim que chegam em vez de só na próxima borda
+    RelogioTempoReal::Relogio::time_point dormirAte(RelogioTempoReal::Relogio::time_point alvo) {
+        return relogio.sleepUntil(alvo, travaPedidos, avisoPedidos,
+                                  [this] { return hasRequests(); }, [this] { processRequests(); });
+    }
+
+    bool contadorNo555() const {
+        return chave.load(std::memory_order_relaxed) == ChaveClock::Interno555;
+    }
+
+    // 'n' pulsos nos CD4026 em forma fechada; retorna quantas vezes o display inteiro estourou
+    uint64_t contar(uint64_t n) {
+        uint64_t carriesUnidade = unidade.advance(n);
+        uint64_t carriesDezena = dezena.advanceOnCarries(carriesUnidade);
+        return altos.size() ? altos.advance(carriesDezena) : carriesDezena;
+    }
+
+    /*
+        Aplica de uma vez todos os ciclos cujo prazo já passou (até 'limite'). Usado quando a frequência é alta demais
+        para mostrar cada borda, ou quando o sistema atrasou a thread em mais de um ciclo.
+    */
+    uint64_t catchUp(uint64_t limite) {
+        uint64_t devidos = relogio.cyclesElapsed();
+        uint64_t n = (devidos > ciclosRelogio) ? std::min(devidos - ciclosRelogio, limite) : 0;
+        ciclosRelogio += n;
+        temSubida = false;
+        chip555.setHigh(relogio.highNow());
+        advance(n);
+        return n;
+    }
+
+public:
+    // Abaixo deste período o modo de tempo real trabalha em lotes: dorme um quantum e aplica os ciclos vencidos
+    static constexpr double QuantumLote = 1e-3;
+
+    MotorVirtual(unsigned leds, double r1, double r2, double c, ModoTempo modoTempo = ModoTempo::Virtual,
+                 unsigned digitos = 2)
+        : chip555(r1, r2, c), chip4017(leds), altos(digitos > 2 ? digitos - 2 : 0), modo(modoTempo),
+          relogio(chip555.getTHigh(), chip555.getPeriod()) {
+        if (digitos < 2) {
+            throw std::invalid_argument("O display precisa de pelo menos 2 dígitos.");
+        }
+    }
+
+    /*
+        Gera um ciclo de clock: no modo real espera as bordas de subida e descida em prazos absolutos (sem deriva),
+        no virtual apenas avança o tempo simulado.
+    */
+    void waitPulse() {
+        if (modo == ModoTempo::TempoReal) {
+            // mesmo comportamento de Chip555::pulse(), mas publicando cada mudança de nível do clock
+            processRequests();
+            auto subida = dormirAte(relogio.edge(ciclosRelogio, 0.0));
+            if (histogramaPulso) {
+                if (temSubida) {
+                    std::chrono::duration<double> intervalo = subida - ultimaSubida;
+                    histogramaPulso->recordSeconds(std::abs(intervalo.count() - chip555.getPeriod()));
+                }
+                ultimaSubida = subida;
+                temSubida = true;
+            }
+            chip555.setHigh(true);
+            publicar();
+
+            dormirAte(relogio.fallingEdge(ciclosRelogio));
+            processRequests();
+            chip555.setHigh(false);
+            publicar();
+
+            dormirAte(relogio.edge(ciclosRelogio + 1, 0.0));
+            ciclosRelogio++;
+        }
+        tempoSimulado += chip555.getPeriod();
+    }
+
+    // Recomeça o relógio de tempo real a partir de agora (ao ligar a placa), sem recuperar o tempo em que esteve parada
+    void resync() {
+        ciclosRelogio = 0;
+        temSubida = false;
+        relogio.restart(0);
+    }
+
+    // Aplica o pulso do clock aos chips (a fiação da placa)
+    void applyPulse() {
+        chip4017.shift();
+        if (contadorNo555()) {
+            unidade.add();
+            dezena.addOnCarry(unidade.getCarryOut());
+            if (altos.size() && unidade.getCarryOut() && dezena.getOut() == 0) {
+                altos.add();
+            }
+        }
+        ciclos++;
+        if (rastreando()) {
+            rastrear(TipoEventoVcd::Pulso);
+        }
+        publicar();
+    }
+
+    /*
+        Um ciclo completo: clock + atualização dos chips. No modo de tempo real pode aplicar vários ciclos de uma vez
+        (até 'limite'), quando a frequência passa do que dá para mostrar; retorna quantos ciclos foram aplicados.
+    */
+    uint64_t step(uint64_t limite = UINT64_MAX) {
+        if (modo == ModoTempo::TempoReal) {
+            uint64_t n = 0;
+            if (chip555.getPeriod() < QuantumLote) {
+                // a precisão do quantum não importa: os ciclos vêm dos prazos absolutos, então basta um sleep comum
+                // (interrompido por um pedido, que é aplicado já e encerra o quantum mais cedo)
+                processRequests();
+                {
+                    std::unique_lock<std::mutex> l(travaPedidos);
+                    avisoPedidos.wait_for(l, std::chrono::duration<double>(QuantumLote), [this] { return hasRequests(); });
+                }
+                processRequests();
+                n = catchUp(limite);
+            } else if (relogio.cyclesElapsed() > ciclosRelogio + 1) {
+                processRequests();
+                n = catchUp(limite);          // a thread ficou mais de um ciclo para trás: recupera sem deriva
+            } else {
+                waitPulse();
+                applyPulse();
+                n = 1;
+            }
+            relogio.measure(ciclosRelogio);
+            return n;
+        }
+
+        waitPulse();
+        applyPulse();
+        return 1;
+    }
+
+    /*
+        Salta 'cycles' ciclos em tempo constante: o resultado é idêntico a chamar step() 'cycles' vezes no modo virtual.
+        Só o VCD e o histórico exigem ir ciclo a ciclo; a sonda recebe um evento Lote por salto.
+        Retorna quantas vezes o display inteiro estourou (o último dígito passou de 9 para 0) no intervalo; com a
+        chave em EXT o 555 só avança o CD4017 e o retorno é 0.
+    */
+    uint64_t advance(uint64_t cycles) {
+        const bool contador = contadorNo555();
+        if (rastro || historico || (sonda && cycles < MinimoLoteSonda)) {
+            // com gravação de rastro cada pulso precisa aparecer nele: aplica ciclo a ciclo
+            uint64_t estouros = 0;
+            for (uint64_t i = 0; i < cycles; ++i) {
+                chip4017.shift();
+                if (!contador) {
+                    ciclos++;
+                    rastrear(TipoEventoVcd::Pulso);
+                    continue;
+                }
+                unidade.add();
+                bool carry = unidade.getCarryOut();
+                dezena.addOnCarry(carry);
+                bool estouroDezena = carry && dezena.getOut() == 0;
+                estouros += (estouroDezena && (altos.size() == 0 || altos.add())) ? 1 : 0;
+                ciclos++;
+                rastrear(TipoEventoVcd::Pulso);
+            }
+            tempoSimulado += cycles * chip555.getPeriod();
+            publicar();
+            return estouros;
+        }
+
+        chip4017.advance(cycles);
+        uint64_t estouros = contador ? contar(cycles) : 0;
+        ciclos += cycles;
+        tempoSimulado += cycles * chip555.getPeriod();
+        if (sonda) {
+            // o analisador só precisa do resumo: o estado final e o que variou no caminho
+            EventoVcd e = evento(TipoEventoVcd::Lote);
+            e.lote = static_cast<uint32_t>(std::min<uint64_t>(cycles, UINT32_MAX));
+            e.carryVariou = contador ? 1 : 0;       // 64 pulsos ou mais dão várias voltas nas unidades
+            sonda->tryPush(e);
+        }
+        publicar();
+        return estouros;
+    }
+
+    // Salta para o estado que a placa teria após mais 'segundos' de tempo simulado
+    uint64_t advanceFor(double segundos) {
+        uint64_t n = (segundos > 0) ? static_cast<uint64_t>(segundos / chip555.getPeriod()) : 0;
+        return advance(n);
+    }
+
+    /*
+        Executa 'n' ciclos e mede o desempenho alcançado.
+        O ponteiro 'continuar' permite interromper a execução a partir de outra thread.
+    */
+    RelatorioSimulacao runCycles(uint64_t n, const std::atomic<bool>* continuar = nullptr) {
+        const uint64_t ciclosIniciais = ciclos;
+        const double tempoInicial = tempoSimulado;
+        auto inicio = std::chrono::steady_clock::now();
+
+        for (uint64_t feitos = 0; feitos < n; ) {
+            if (continuar && !continuar->load(std::memory_order_relaxed)) {
+                break;
+            }
+            feitos += step(n - feitos);
+        }
+
+        std::chrono::duration<double> gasto = std::chrono::steady_clock::now() - inicio;
+
+        RelatorioSimulacao r;
+        r.ciclos = ciclos - ciclosIniciais;
+        r.tempoSimulado = tempoSimulado - tempoInicial;
+        r.tempoReal = gasto.count();
+        r.ciclosPorSegundo = (r.tempoReal > 0) ? (r.ciclos / r.tempoReal) : 0.0;
+        return r;
+    }
+
+    // Executa quantos ciclos completos couberem em 'segundos' de tempo simulado
+    RelatorioSimulacao runFor(double segundos, const std::atomic<bool>* continuar = nullptr) {
+        uint64_t n = (segundos > 0) ? static_cast<uint64_t>(segundos / chip555.getPeriod()) : 0;
+        return runCycles(n, continuar);
+    }
+
+    // Reset geral (botão R): CD4017 e displays
+    void reset() {
+        chip4017.reset();
+        resetDisplays();
+    }
+
+    // Reset apenas dos CD4026 (botão "Reset Display")
+    void resetDisplays() {
+        unidade.reset();
+        dezena.reset();
+        altos.reset();
+        if (rastreando()) {
+            rastrear(TipoEventoVcd::Reset);
+        }
+        publicar();
+    }
+
+    // Pedidos de reset feitos por outras threads: não tocam nos chips, apenas marcam o que deve ser feito
+    void requestReset() {
+        pedidos.fetch_or(PedidoReset, std::memory_order_release);
+        avisarMotor();
+    }
+
+    void requestResetDisplays() {
+        pedidos.fetch_or(PedidoResetDisplays, std::memory_order_release);
+        avisarMotor();
+    }
+
+    // Posição da chave do display (pode ser chamada de qualquer thread; vale a partir do próximo pulso)
+    void setSwitch(ChaveClock posicao) {
+        chave.store(posicao, std::memory_order_relaxed);
+    }
+
+    ChaveClock getSwitch() const {
+        return chave.load(std::memory_order_relaxed);
+    }
+
+    /*
+        Entrega 'n' subidas da entrada de clock externo (de qualquer thread). O motor as aplica aos CD4026 no próximo
+        processRequests(), de uma vez e em forma fechada; o VCD e o analisador continuam registrando só os pulsos do
+        555, com os dígitos já atualizados.
+    */
+    void addExternalPulses(uint64_t n) {
+        pulsosExternos.fetch_add(n, std::memory_order_release);
+        avisarMotor();
+    }
+
+    bool hasRequests() const {
+        return pedidos.load(std::memory_order_relaxed) != 0 || pulsosExternos.load(std::memory_order_relaxed) != 0;
+    }
+
+    // Aplica os resets e os pulsos externos pendentes (somente na thread dona dos chips); retorna true se havia algum
+    bool processRequests() {
+        if (!hasRequests()) {
+            return false;
+        }
+        if (pulsosExternos.load(std::memory_order_relaxed) != 0) {
+            uint64_t n = pulsosExternos.exchange(0, std::memory_order_acquire);
+            if (!contadorNo555()) {
+                contar(n);
+                externosAplicados += n;
+                publicar();
+            }
+        }
+        unsigned p = pedidos.exchange(0, std::memory_order_acquire);
+        if (p & PedidoReset) {
+            reset();
+        } else if (p & PedidoResetDisplays) {
+            resetDisplays();
+        }
+        return true;
+    }
+
+    /*
+        Passa a usar os tempos exatos do modelo analógico do 555 (com os R1, R2 e C da placa) em vez da aproximação
+        0.693. Deve ser chamado antes de rodar: o relógio de tempo real e o tempo simulado seguem o novo período.
+    */
+    Modelo555Analogico setModelo555(const ParametrosAnalogicos555& parametros) {
+        Modelo555Analogico modelo(chip555.getR1(), chip555.getR2(), chip555.getC(), parametros);
+        chip555.setTimings(modelo.getTHigh(), modelo.getTLow());
+        relogio = RelogioTempoReal(chip555.getTHigh(), chip555.getPeriod());
+        return modelo;
+    }
+
+    // Passa a registrar o erro dos intervalos do clock (só no modo de tempo real, borda a borda); nullptr desliga
+    void setHistogramaPulso(Histograma* destino) {
+        histogramaPulso = destino;
+        temSubida = false;
+    }
+
+    // Passa a gravar cada pulso e reset em 'destino' (VCD), começando pelo estado atual; nullptr desliga
+    void setRastro(GravadorVcd* destino) {
+        exigirUmChip(destino);
+        rastro = destino;
+        if (rastro) {
+            rastro->record(evento(TipoEventoVcd::Inicial));
+        }
+    }
+
+    /*
+        Passa a entregar cada pulso e reset em 'destino' (outra thread), começando pelo estado atual; nullptr desliga.
+        Saltos grandes (advance, lotes do tempo real) chegam como um único evento Lote.
+    */
+    void setSonda(AnelSpsc<EventoVcd>* destino) {
+        exigirUmChip(destino);
+        sonda = destino;
+        if (sonda) {
+            sonda->tryPush(evento(TipoEventoVcd::Inicial));
+        }
+    }
+
+    // Passa a guardar cada ciclo em 'destino' (histórico compacto), começando pelo estado atual; nullptr desliga
+    void setHistorico(RastroPeriodico* destino) {
+        exigirUmChip(destino);
+        historico = destino;
+        if (historico) {
+            historico->append(ciclos, amostra());
+        }
+    }
+
+    // Passa a publicar o estado em 'destino' a cada mudança (nullptr desliga)
+    void setPublicador(SeqLock<EstadoPlaca>* destino) {
+        publicador = destino;
+        publicar();
+    }
+
+    EstadoPlaca getEstado() const {
+        EstadoPlaca e;
+        e.leds = chip4017.getOut();
+        e.ledAceso = chip4017.getPosition();
+        e.unidade = static_cast<uint8_t>(unidade.getOut());
+        e.dezena = static_cast<uint8_t>(dezena.getOut());
+        e.segUnidade = unidade.getSegments();
+        e.segDezena = dezena.getSegments();
+        e.carry = unidade.getCarryOut();
+        e.altos = altos.word(0);
+        e.clock = chip555.isHigh();
+        e.ciclos = ciclos;
+        e.frequenciaMedida = relogio.getMeasuredFrequency();
+        return e;
+    }
+
+    void setModo(ModoTempo m) {
+        modo = m;
+    }
+
+    ModoTempo getModo() const {
+        return modo;
+    }
+
+    const Chip555& getChip555() const {
+        return chip555;
+    }
+
+    const Cascata4017& getChip4017() const {
+        return chip4017;
+    }
+
+    const Unidade& getUnidade() const {
+        return unidade;
+    }
+
+    const Dezena& getDezena() const {
+        return dezena;
+    }
+
+    // Dígitos acima das dezenas (centenas em diante)
+    const ContadorBcd& getAltos() const {
+        return altos;
+    }
+
+    unsigned getDigitos() const {
+        return 2 + altos.size();
+    }
+
+    // O display inteiro como texto, do dígito mais significativo para as unidades
+    std::string getDisplay() const {
+        return altos.text() + static_cast<char>('0' + dezena.getOut()) + static_cast<char>('0' + unidade.getOut());
+    }
+
+    uint64_t getCiclos() const {
+        return ciclos;
+    }
+
+    // Pulsos do clock externo que chegaram aos CD4026 (com a chave em EXT)
+    uint64_t getPulsosExternos() const {
+        return externosAplicados;
+    }
+
+    double getTempoSimulado() const {
+        return tempoSimulado;
+    }
+
+    double getMeasuredFrequency() const {
+        return relogio.getMeasuredFrequency();
+    }
+};
@@ -0,0 +1,415 @@
+/*
+    Placas descritas por netlist: um arquivo de texto com os chips, os pinos e as redes (nets) que os ligam, lido uma
+    vez e compilado num vetor plano de operações.
+
+    Formato: uma declaração por linha, '#' inicia comentário.
+
+        <tipo> <nome> [pino=rede | parâmetro=valor]...
+
+        555   osc      out=clk r1=1000 r2=10000 c=7.37e-6     fonte de clock (exatamente uma por placa)
+        4017  leds     clk=clk co=volta limite=4              co sobe quando o anel volta à saída q0
+        4026  unidade  clk=clk co=carry                       co sobe quando o dígito passa de 9 para 0
+        4026  dezena   clk=carry
+
+    Cada rede tem um único pino que a dirige (out ou co) e todo pino clk precisa estar ligado; laços são recusados.
+    A leitura e a compilação acontecem uma vez: depois disso um pulso percorre um vetor de operações com índices,
+    sem mapas, ponteiros nem chamadas virtuais (ver CircuitoCompilado).
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <map>
+#include <istream>
+#include <sstream>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+
+#include "chips.hpp"
+
+
+// Netlist da placa Apple Juice, ligada como em MotorVirtual::applyPulse()
+inline const char* NetlistAppleJuice =
+    "555   osc      out=clk r1=1000 r2=10000 c=7.37e-6\n"
+    "4017  leds     clk=clk limite=4\n"
+    "4026  unidade  clk=clk co=carry\n"
+    "4026  dezena   clk=carry\n";
+
+
+// Uma linha da netlist, ainda sem validação das ligações
+struct DeclaracaoChip {
+    std::string tipo;
+    std::string nome;
+    std::map<std::string, std::string> atributos;      // pinos e parâmetros
+    unsigned linha = 0;
+};
+
+
+class Netlist {
+private:
+    std::vector<DeclaracaoChip> declaracoes;
+
+    static std::invalid_argument erro(unsigned linha, const std::string& msg) {
+        return std::invalid_argument("netlist, linha " + std::to_string(linha) + ": " + msg);
+    }
+
+public:
+    // Lê as declarações; lança invalid_argument (com o número da linha) se alguma estiver malformada
+    static Netlist read(std::istream& in) {
+        Netlist n;
+        std::map<std::string, unsigned> nomes;
+        std::string texto;
+        unsigned linha = 0;
+        while (std::getline(in, texto)) {
+            linha++;
+            size_t comentario = texto.find('#');
+            if (comentario != std::string::npos) {
+                texto.erase(comentario);
+            }
+            std::istringstream campos(texto);
+            DeclaracaoChip d;
+            if (!(campos >> d.tipo)) {
+                continue;
+            }
+            if (!(campos >> d.nome) || d.nome.find('=') != std::string::npos) {
+                throw erro(linha, "faltou o nome do chip " + d.tipo);
+            }
+            if (d.tipo != "555" && d.tipo != "4017" && d.tipo != "4026") {
+                throw erro(linha, "chip desconhecido: " + d.tipo + " (use 555, 4017 ou 4026)");
+            }
+            if (!nomes.emplace(d.nome, linha).second) {
+                throw erro(linha, "o nome " + d.nome + " já foi usado na linha " + std::to_string(nomes[d.nome]));
+            }
+            std::string atributo;
+            while (campos >> atributo) {
+                size_t igual = atributo.find('=');
+                if (igual == std::string::npos || igual == 0 || igual + 1 == atributo.size()) {
+                    throw erro(linha, "esperava pino=rede ou parâmetro=valor, encontrei " + atributo);
+                }
+                if (!d.atributos.emplace(atributo.substr(0, igual), atributo.substr(igual + 1)).second) {
+                    throw erro(linha, "atributo repetido: " + atributo.substr(0, igual));
+                }
+            }
+            d.linha = linha;
+            n.declaracoes.push_back(d);
+        }
+        return n;
+    }
+
+    static Netlist readText(const std::string& texto) {
+        std::istringstream in(texto);
+        return read(in);
+    }
+
+    static Netlist readFile(const std::string& caminho) {
+        std::ifstream in(caminho);
+        if (!in) {
+            throw std::runtime_error("não foi possível abrir " + caminho);
+        }
+        return read(in);
+    }
+
+    const std::vector<DeclaracaoChip>& chips() const {
+        return declaracoes;
+    }
+};
+
+
+/*
+    Netlist compilada. Os dois tipos de chip viram a mesma operação, um contador módulo m que gera borda em co quando
+    volta a 0, e o estado de todos fica num único vetor de uint32_t. Como cada chip tem uma única entrada de clock,
+    as ligações formam uma árvore com raiz no 555: as operações ficam em pré-ordem (cada chip depois de quem o
+    dirige, ou seja, em ordem topológica) e cada uma guarda onde termina a sua subárvore. Um pulso percorre o vetor
+    e, quando um chip não gera borda em co, pula tudo o que depende dele: como na fiação à mão, as dezenas só são
+    avaliadas no carry das unidades.
+*/
+class CircuitoCompilado {
+public:
+    enum class TipoChip : uint8_t { Chip4017, Chip4026 };
+
+private:
+    // Os dois chips são contadores módulo m: o CD4017 conta a posição do bit no anel (m = limite), o CD4026 o dígito
+    struct Operacao {
+        uint32_t modulo;
+        uint32_t fim;           // primeira operação fora da subárvore deste chip
+    };
+
+    static constexpr uint32_t RedeClock = UINT32_MAX;     // em 'driverRede': rede ligada à saída do 555
+
+    std::vector<Operacao> operacoes;
+    std::vector<uint32_t> estado;       // paralelo a 'operacoes': contagem de 0 a modulo - 1
+    std::vector<TipoChip> tipos;
+    std::vector<uint64_t> disparo;      // último pulso (contado a partir de 1) em que o chip gerou borda em co
+    std::vector<std::string> nomes;
+    std::map<std::string, uint32_t> driverRede;
+    unsigned niveis = 0;
+
+    double periodo = 0.0;
+    double tHigh = 0.0;
+    uint64_t ciclos = 0;
+
+    static std::invalid_argument erro(const DeclaracaoChip& d, const std::string& msg) {
+        return std::invalid_argument("netlist, linha " + std::to_string(d.linha) + " (" + d.nome + "): " + msg);
+    }
+
+    static double numero(const DeclaracaoChip& d, const std::string& chave) {
+        auto it = d.atributos.find(chave);
+        if (it == d.atributos.end()) {
+            throw erro(d, "faltou o parâmetro " + chave);
+        }
+        try {
+            size_t usados = 0;
+            double v = std::stod(it->second, &usados);
+            if (usados == it->second.size()) {
+                return v;
+            }
+        } catch (const std::logic_error&) {
+        }
+        throw erro(d, "valor inválido para " + chave + ": " + it->second);
+    }
+
+    // Recusa atributos que o chip não tem (um erro de digitação viraria um pino solto em silêncio)
+    static void conferirAtributos(const DeclaracaoChip& d, std::initializer_list<const char*> validos) {
+        for (const auto& [chave, valor] : d.atributos) {
+            bool conhecido = false;
+            for (const char* v : validos) {
+                conhecido = conhecido || chave == v;
+            }
+            if (!conhecido) {
+                throw erro(d, "o chip " + d.tipo + " não tem o pino ou parâmetro " + chave);
+            }
+        }
+    }
+
+public:
+    explicit CircuitoCompilado(const Netlist& netlist) {
+        const auto& decl = netlist.chips();
+
+        // Fonte de clock e quem dirige cada rede
+        size_t fonte = decl.size();
+        std::map<std::string, size_t> driver;           // rede -> declaração que a dirige
+        for (size_t i = 0; i < decl.size(); ++i) {
+            const DeclaracaoChip& d = decl[i];
+            if (d.tipo == "555") {
+                conferirAtributos(d, {"out", "r1", "r2", "c"});
+                if (fonte < decl.size()) {
+                    throw erro(d, "a placa aceita uma única fonte de clock (a primeira está na linha " + std::to_string(decl[fonte].linha) + ")");
+                }
+                fonte = i;
+            } else if (d.tipo == "4017") {
+                conferirAtributos(d, {"clk", "co", "limite"});
+            } else {
+                conferirAtributos(d, {"clk", "co"});
+            }
+            auto saida = d.atributos.find(d.tipo == "555" ? "out" : "co");
+            if (saida != d.atributos.end()) {
+                auto [it, novo] = driver.emplace(saida->second, i);
+                if (!novo) {
+                    throw erro(d, "a rede " + saida->second + " já é dirigida por " + decl[it->second].nome);
+                }
+            }
+        }
+        if (fonte == decl.size()) {
+            throw std::invalid_argument("netlist sem fonte de clock (declare um 555)");
+        }
+        if (decl[fonte].atributos.count("out") == 0) {
+            throw erro(decl[fonte], "faltou o pino out");
+        }
+        Chip555 chip555(numero(decl[fonte], "r1"), numero(decl[fonte], "r2"), numero(decl[fonte], "c"));
+        periodo = chip555.getPeriod();
+        tHigh = chip555.getTHigh();
+
+        // Árvore de clock: os filhos de cada declaração, na ordem do arquivo
+        std::vector<std::vector<size_t>> filhos(decl.size());
+        for (size_t i = 0; i < decl.size(); ++i) {
+            const DeclaracaoChip& d = decl[i];
+            if (i == fonte) {
+                continue;
+            }
+            auto clk = d.atributos.find("clk");
+            if (clk == d.atributos.end()) {
+                throw erro(d, "faltou o pino clk");
+            }
+            auto pai = driver.find(clk->second);
+            if (pai == driver.end()) {
+                throw erro(d, "a rede " + clk->second + " não é dirigida por nenhum chip");
+            }
+            filhos[pai->second].push_back(i);
+        }
+
+        // Pré-ordem a partir do 555, com pilha explícita (cascatas longas não estouram a pilha de chamadas)
+        std::vector<uint32_t> operacaoDe(decl.size(), UINT32_MAX);
+        std::vector<std::pair<size_t, unsigned>> pilha;     // (declaração, profundidade)
+        for (auto it = filhos[fonte].rbegin(); it != filhos[fonte].rend(); ++it) {
+            pilha.emplace_back(*it, 1u);
+        }
+        while (!pilha.empty()) {
+            auto [i, profundidade] = pilha.back();
+            pilha.pop_back();
+            const DeclaracaoChip& d = decl[i];
+
+            Operacao op;
+            op.modulo = 10;
+            op.fim = 0;
+            if (d.tipo == "4017") {
+                double limite = d.atributos.count("limite") ? numero(d, "limite") : 10.0;
+                if (limite < 1 || limite > 10 || limite != static_cast<unsigned>(limite)) {
+                    throw erro(d, "limite precisa ser um inteiro entre 1 e 10");
+                }
+                op.modulo = static_cast<uint32_t>(limite);
+            }
+            operacaoDe[i] = static_cast<uint32_t>(operacoes.size());
+            operacoes.push_back(op);
+            tipos.push_back(d.tipo == "4017" ? TipoChip::Chip4017 : TipoChip::Chip4026);
+            nomes.push_back(d.nome);
+            niveis = std::max(niveis, profundidade);
+            for (auto it = filhos[i].rbegin(); it != filhos[i].rend(); ++it) {
+                pilha.emplace_back(*it, profundidade + 1);
+            }
+        }
+
+        // Quem não foi alcançado a partir do 555 está num laço (a saída volta para a própria entrada)
+        for (size_t i = 0; i < decl.size(); ++i) {
+            if (i != fonte && operacaoDe[i] == UINT32_MAX) {
+                throw erro(decl[i], "laço nas ligações de clock (a saída volta para a própria entrada)");
+            }
+        }
+
+        // Fim de cada subárvore: o próximo chip em pré-ordem que não descende deste
+        std::vector<size_t> ordem(operacoes.size());
+        for (size_t i = 0; i < decl.size(); ++i) {
+            if (i != fonte) {
+                ordem[operacaoDe[i]] = i;
+            }
+        }
+        for (size_t k = operacoes.size(); k-- > 0; ) {
+            uint32_t fim = static_cast<uint32_t>(k + 1);
+            for (size_t filho : filhos[ordem[k]]) {
+                fim = std::max(fim, operacoes[operacaoDe[filho]].fim);
+            }
+            operacoes[k].fim = fim;
+        }
+
+        for (const auto& [rede, i] : driver) {
+            driverRede[rede] = (i == fonte) ? RedeClock : operacaoDe[i];
+        }
+        estado.resize(operacoes.size());
+        disparo.resize(operacoes.size());
+        reset();
+    }
+
+    // Um pulso do clock em todos os chips
+    void step() {
+        const Operacao* op = operacoes.data();
+        uint32_t* s = estado.data();
+        uint64_t* d = disparo.data();
+        const size_t n = operacoes.size();
+        const uint64_t agora = ++ciclos;
+        size_t i = 0;
+        while (i < n) {
+            // só se chega a uma operação se quem a dirige acabou de gerar borda: o clock dela subiu
+            uint32_t v = s[i] + 1;
+            bool volta = (v == op[i].modulo);
+            s[i] = volta ? 0 : v;
+            if (volta) {
+                d[i] = agora;
+                i++;
+            } else {
+                i = op[i].fim;
+            }
+        }
+    }
+
+    void stepCycles(uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            step();
+        }
+    }
+
+    // Reset geral: anéis dos CD4017 e dígitos dos CD4026
+    void reset() {
+        for (size_t i = 0; i < operacoes.size(); ++i) {
+            estado[i] = 0;
+            disparo[i] = 0;
+        }
+    }
+
+    // Reset apenas dos CD4026 (botão "Reset Display")
+    void resetDisplays() {
+        for (size_t i = 0; i < operacoes.size(); ++i) {
+            if (tipos[i] == TipoChip::Chip4026) {
+                estado[i] = 0;
+                disparo[i] = 0;
+            }
+        }
+    }
+
+    // Índice do chip 'nome' (ordem de avaliação); lança invalid_argument se não existir
+    size_t find(const std::string& nome) const {
+        for (size_t i = 0; i < nomes.size(); ++i) {
+            if (nomes[i] == nome) {
+                return i;
+            }
+        }
+        throw std::invalid_argument("a netlist não tem o chip " + nome);
+    }
+
+    // Saídas do CD4017 (o mesmo que Chip4017::getOut()) ou dígito do CD4026
+    uint32_t value(size_t chip) const {
+        if (tipos[chip] == TipoChip::Chip4017) {
+            return 1u << (operacoes[chip].modulo - 1 - estado[chip]);
+        }
+        return estado[chip];
+    }
+
+    // A rede teve borda de subida no último pulso? (o clock sempre teve)
+    bool edge(const std::string& rede) const {
+        auto it = driverRede.find(rede);
+        if (it == driverRede.end()) {
+            throw std::invalid_argument("a netlist não tem a rede " + rede);
+        }
+        if (it->second == RedeClock) {
+            return ciclos > 0;
+        }
+        return ciclos > 0 && disparo[it->second] == ciclos;
+    }
+
+    size_t size() const {
+        return operacoes.size();
+    }
+
+    TipoChip type(size_t chip) const {
+        return tipos[chip];
+    }
+
+    const std::string& name(size_t chip) const {
+        return nomes[chip];
+    }
+
+    // CD4017: número de saídas do anel (o LimitReset)
+    unsigned limit(size_t chip) const {
+        return operacoes[chip].modulo;
+    }
+
+    // Profundidade da cascata: 1 para chips ligados direto ao 555
+    unsigned levels() const {
+        return niveis;
+    }
+
+    double getPeriod() const {
+        return periodo;
+    }
+
+    double getTHigh() const {
+        return tHigh;
+    }
+
+    uint64_t getCiclos() const {
+        return ciclos;
+    }
+};
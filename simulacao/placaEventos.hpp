@@ -0,0 +1,436 @@
+/*
+    Placa simulada por eventos discretos: várias fontes de clock assíncronas numa única thread.
+
+    No MotorVirtual só existe um clock, o 555, e tudo anda no ritmo dele. A placa real tem também a entrada de clock
+    externo e a chave que escolhe quem alimenta os CD4026, além dos botões de reset, que chegam em instantes
+    quaisquer. Aqui cada um desses é uma fonte de eventos numa roda de tempo (ver RodaDeTempo): o 555, o clock
+    externo e osciladores extras entregam as suas bordas, e os resets e as mudanças da chave são eventos agendados.
+    Os eventos são processados em ordem de tempo; cada fonte reagenda o seu próprio nó, então o custo por borda é
+    constante e nada é alocado durante a simulação. Uma fonte no clock externo que saiba saltar (ver ClockExterno)
+    entrega de uma vez as bordas até o próximo evento das outras, aplicadas aos CD4026 em forma fechada.
+
+    O 555 sempre alimenta o CD4017 (LEDs). Os CD4026 (display) contam as subidas do 555 com a chave em "555" e as do
+    clock externo com a chave em "EXT", como na placa.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "chips.hpp"
+#include "contadorBcd.hpp"
+#include "cascata4017.hpp"
+#include "rodaTempo.hpp"
+
+
+// Uma fonte de bordas de clock (o 555, o clock externo, um oscilador extra)
+class FonteClock {
+public:
+    virtual ~FonteClock() = default;
+
+    /*
+        Próxima mudança de nível depois das já entregues: 'instante' em segundos desde o início da simulação e
+        'nivel' o nível depois dela. Retorna false quando a fonte não tem mais bordas.
+    */
+    virtual bool nextEdge(double& instante, bool& nivel) = 0;
+
+    /*
+        Caminho rápido opcional: consome de uma vez as bordas seguintes com instante < 'limite' segundos, como se
+        nextEdge() fosse chamado para cada uma. Retorna quantas bordas foram consumidas, soma as subidas entre elas em
+        'subidas' e deixa em 'nivel' o nível depois da última. A fonte que não sabe saltar consome nenhuma.
+    */
+    virtual uint64_t skipBefore(double /*limite*/, uint64_t& /*subidas*/, bool& /*nivel*/) {
+        return 0;
+    }
+};
+
+
+// Onda quadrada periódica com prazos absolutos: a borda k não acumula o erro de arredondamento das anteriores
+class Oscilador : public FonteClock {
+private:
+    double tHigh;
+    double periodo;
+    double fase;                // instante da primeira subida
+    uint64_t ciclo = 0;
+    bool alto = false;
+
+public:
+    Oscilador(double tHighSegundos, double periodoSegundos, double faseSegundos = 0.0)
+        : tHigh(tHighSegundos), periodo(periodoSegundos), fase(faseSegundos) {
+        if (!(periodo > 0) || !(tHigh > 0) || tHigh >= periodo || fase < 0) {
+            throw std::invalid_argument("o oscilador precisa de 0 < tHigh < período e fase >= 0");
+        }
+    }
+
+    // Com os tempos do 555 (os da aproximação 0.693 ou os que setTimings() definiu)
+    explicit Oscilador(const Chip555& chip, double faseSegundos = 0.0)
+        : Oscilador(chip.getTHigh(), chip.getPeriod(), faseSegundos) {}
+
+    bool nextEdge(double& instante, bool& nivel) override {
+        if (!alto) {
+            instante = fase + ciclo * periodo;
+        } else {
+            instante = fase + ciclo * periodo + tHigh;
+            ciclo++;
+        }
+        alto = !alto;
+        nivel = alto;
+        return true;
+    }
+
+    double getPeriod() const {
+        return periodo;
+    }
+};
+
+
+// O que as subidas de um oscilador extra alimentam (pode combinar os dois)
+constexpr unsigned DestinoSequencial = 1u;     // CD4017 (LEDs)
+constexpr unsigned DestinoContador = 2u;       // CD4026 (display)
+
+
+class PlacaEventos {
+public:
+    static constexpr double ResolucaoPadrao = 1e-9;     // 1 tick = 1 ns
+
+private:
+    enum class Papel {
+        Interno555,
+        Externo,
+        Extra
+    };
+
+    enum TipoEvento : uint32_t {
+        EventoBorda,
+        EventoReset,
+        EventoResetDisplays,
+        EventoChave
+    };
+
+    struct Fonte {
+        std::unique_ptr<FonteClock> clock;
+        Papel papel;
+        unsigned destino;               // para as extras: DestinoSequencial e/ou DestinoContador
+        RodaDeTempo::No* no = nullptr;  // nó reaproveitado a cada borda (nullptr quando a fonte terminou)
+        bool nivel = false;             // nível atual
+        bool proximoNivel = false;      // nível depois da borda agendada
+        uint64_t subidas = 0;
+    };
+
+    Chip555 chip555;
+    Cascata4017 chip4017;
+    Unidade unidade;
+    Dezena dezena;
+    ContadorBcd altos;
+
+    RodaDeTempo roda;
+    double resolucao;
+    double ticksPorSegundo;
+    std::vector<Fonte> fontes;
+    ChaveClock chave = ChaveClock::Interno555;
+
+    uint64_t agora = 0;             // tick atual
+    uint64_t limiteLote = 0;        // primeiro tick fora da execução atual (o clock externo não salta até ele)
+    uint64_t eventos = 0;
+    uint64_t pulsosSequencial = 0;
+    uint64_t pulsosContador = 0;
+
+    uint64_t paraTicks(double segundos) const {
+        if (!(segundos >= 0)) {
+            throw std::invalid_argument("instante negativo na simulação por eventos");
+        }
+        return static_cast<uint64_t>(segundos * ticksPorSegundo + 0.5);
+    }
+
+    // Pede a próxima borda da fonte 'i' e a agenda no nó dela; a fonte que terminou devolve o nó ao pool
+    void agendarBorda(size_t i) {
+        Fonte& f = fontes[i];
+        double instante = 0.0;
+        if (!f.clock->nextEdge(instante, f.proximoNivel)) {
+            roda.release(f.no);
+            f.no = nullptr;
+            return;
+        }
+        uint64_t tick = paraTicks(instante);
+        if (tick < agora) {
+            throw std::invalid_argument("fonte de clock entregou uma borda antes da anterior");
+        }
+        roda.schedule(f.no, tick);
+    }
+
+    void agendar(TipoEvento tipo, uint32_t dado, double segundos) {
+        uint64_t tick = paraTicks(segundos);
+        if (tick < agora) {
+            throw std::invalid_argument("evento agendado para antes do instante atual da placa");
+        }
+        RodaDeTempo::No* no = roda.acquire();
+        no->tipo = tipo;
+        no->fonte = dado;
+        roda.schedule(no, tick);
+    }
+
+    size_t adicionar(std::unique_ptr<FonteClock> clock, Papel papel, unsigned destino) {
+        if (!clock) {
+            throw std::invalid_argument("fonte de clock vazia");
+        }
+        Fonte f;
+        f.clock = std::move(clock);
+        f.papel = papel;
+        f.destino = destino;
+        f.no = roda.acquire();
+        f.no->tipo = EventoBorda;
+        f.no->fonte = static_cast<uint32_t>(fontes.size());
+        fontes.push_back(std::move(f));
+        agendarBorda(fontes.size() - 1);
+        return fontes.size() - 1;
+    }
+
+    // Subida num clock: quais seções ela alimenta depende do papel da fonte e da chave
+    unsigned destinoDe(const Fonte& f) const {
+        switch (f.papel) {
+            case Papel::Interno555:
+                return DestinoSequencial | (chave == ChaveClock::Interno555 ? DestinoContador : 0u);
+            case Papel::Externo:
+                return (chave == ChaveClock::Externo) ? DestinoContador : 0u;
+            default:
+                return f.destino;
+        }
+    }
+
+    // Um pulso nos CD4026: mesma fiação do MotorVirtual (unidades -> dezenas -> dígitos de cima)
+    void pulsoContador() {
+        unidade.add();
+        dezena.addOnCarry(unidade.getCarryOut());
+        if (altos.size() && unidade.getCarryOut() && dezena.getOut() == 0) {
+            altos.add();
+        }
+        pulsosContador++;
+    }
+
+    // Vários pulsos nos CD4026 de uma vez, em forma fechada (o mesmo que chamar pulsoContador() 'n' vezes)
+    void pulsosContadorEmLote(uint64_t n) {
+        uint64_t carriesDezena = dezena.advanceOnCarries(unidade.advance(n));
+        if (altos.size()) {
+            altos.advance(carriesDezena);
+        }
+        pulsosContador += n;
+    }
+
+    /*
+        O clock externo só chega aos CD4026, e nada mais acontece na placa até o próximo evento de outra fonte: as
+        bordas dele antes desse evento (e dentro do runUntil atual) são consumidas de uma vez pela fonte, se ela souber
+        saltar, e aplicadas em lote. Na mesma ordem de tempo, o resultado é o mesmo de processar borda a borda.
+    */
+    void saltarExterno(Fonte& f) {
+        uint64_t fronteira = std::min(roda.nextTime(), limiteLote);
+        if (fronteira <= agora) {
+            return;
+        }
+        // bordas que arredondam para um tick < fronteira (ver paraTicks)
+        uint64_t subidas = 0;
+        bool nivel = f.nivel;
+        uint64_t n = f.clock->skipBefore((fronteira - 0.5) * resolucao, subidas, nivel);
+        if (n == 0) {
+            return;
+        }
+        eventos += n;
+        f.nivel = nivel;
+        f.subidas += subidas;
+        if (destinoDe(f) & DestinoContador) {
+            pulsosContadorEmLote(subidas);
+        }
+    }
+
+    void processar(RodaDeTempo::No* no) {
+        eventos++;
+        switch (no->tipo) {
+            case EventoBorda: {
+                Fonte& f = fontes[no->fonte];
+                bool subida = f.proximoNivel && !f.nivel;
+                f.nivel = f.proximoNivel;
+                if (subida) {
+                    f.subidas++;
+                    unsigned destino = destinoDe(f);
+                    if (destino & DestinoSequencial) {
+                        chip4017.shift();
+                        pulsosSequencial++;
+                    }
+                    if (destino & DestinoContador) {
+                        pulsoContador();
+                    }
+                }
+                if (f.papel == Papel::Externo) {
+                    saltarExterno(f);
+                }
+                agendarBorda(no->fonte);
+                return;
+            }
+            case EventoReset:
+                chip4017.reset();
+                resetDisplays();
+                break;
+            case EventoResetDisplays:
+                resetDisplays();
+                break;
+            case EventoChave:
+                chave = static_cast<ChaveClock>(no->fonte);
+                break;
+        }
+        roda.release(no);
+    }
+
+public:
+    PlacaEventos(unsigned leds, double r1, double r2, double c, unsigned digitos = 2, double resolucaoSegundos = ResolucaoPadrao)
+        : chip555(r1, r2, c), chip4017(leds), altos(digitos > 2 ? digitos - 2 : 0), resolucao(resolucaoSegundos),
+          ticksPorSegundo(1.0 / resolucaoSegundos) {
+        if (digitos < 2) {
+            throw std::invalid_argument("O display precisa de pelo menos 2 dígitos.");
+        }
+        if (!(resolucao > 0)) {
+            throw std::invalid_argument("a resolução do tempo precisa ser > 0");
+        }
+        adicionar(std::make_unique<Oscilador>(chip555), Papel::Interno555, 0);
+    }
+
+    PlacaEventos(const PlacaEventos&) = delete;
+    PlacaEventos& operator=(const PlacaEventos&) = delete;
+
+    // Liga uma fonte na entrada de clock externo (substitui a anterior); a primeira borda é pedida já
+    void setExternalClock(std::unique_ptr<FonteClock> clock) {
+        for (Fonte& f : fontes) {
+            if (f.papel == Papel::Externo && f.no) {
+                roda.cancel(f.no);
+                roda.release(f.no);
+                f.no = nullptr;         // a fonte antiga fica desligada, sem bordas agendadas
+            }
+        }
+        adicionar(std::move(clock), Papel::Externo, 0);
+    }
+
+    // Oscilador extra ligado direto em 'destino' (DestinoSequencial e/ou DestinoContador); retorna o índice dele
+    size_t addSource(std::unique_ptr<FonteClock> clock, unsigned destino) {
+        return adicionar(std::move(clock), Papel::Extra, destino);
+    }
+
+    void setSwitch(ChaveClock posicao) {
+        chave = posicao;
+    }
+
+    // Botões e chave em instantes futuros (segundos desde o início)
+    void scheduleReset(double instante) {
+        agendar(EventoReset, 0, instante);
+    }
+
+    void scheduleResetDisplays(double instante) {
+        agendar(EventoResetDisplays, 0, instante);
+    }
+
+    void scheduleSwitch(double instante, ChaveClock posicao) {
+        agendar(EventoChave, static_cast<uint32_t>(posicao), instante);
+    }
+
+    // Processa todos os eventos até 'instante' (inclusive) e para nele; retorna quantos eventos foram processados
+    uint64_t runUntil(double instante) {
+        uint64_t limite = paraTicks(instante);
+        if (limite < agora) {
+            return 0;
+        }
+        uint64_t antes = eventos;
+        limiteLote = (limite == UINT64_MAX) ? limite : limite + 1;
+        while (RodaDeTempo::No* no = roda.popUntil(limite)) {
+            agora = no->tempo;
+            processar(no);
+        }
+        agora = limite;
+        return eventos - antes;
+    }
+
+    // Processa só o próximo evento; false quando não há mais nenhum
+    bool step() {
+        RodaDeTempo::No* no = roda.popUntil(UINT64_MAX);
+        if (!no) {
+            return false;
+        }
+        agora = no->tempo;
+        limiteLote = agora;             // um evento por vez: o clock externo não salta
+        processar(no);
+        return true;
+    }
+
+    void reset() {
+        chip4017.reset();
+        resetDisplays();
+    }
+
+    void resetDisplays() {
+        unidade.reset();
+        dezena.reset();
+        altos.reset();
+    }
+
+    const Chip555& getChip555() const {
+        return chip555;
+    }
+
+    const Cascata4017& getChip4017() const {
+        return chip4017;
+    }
+
+    const Unidade& getUnidade() const {
+        return unidade;
+    }
+
+    const Dezena& getDezena() const {
+        return dezena;
+    }
+
+    const ContadorBcd& getAltos() const {
+        return altos;
+    }
+
+    std::string getDisplay() const {
+        return altos.text() + static_cast<char>('0' + dezena.getOut()) + static_cast<char>('0' + unidade.getOut());
+    }
+
+    ChaveClock getSwitch() const {
+        return chave;
+    }
+
+    // Instante atual em segundos
+    double getTime() const {
+        return agora * resolucao;
+    }
+
+    uint64_t getEventos() const {
+        return eventos;
+    }
+
+    // Subidas que chegaram ao CD4017 e aos CD4026
+    uint64_t getPulsosSequencial() const {
+        return pulsosSequencial;
+    }
+
+    uint64_t getPulsosContador() const {
+        return pulsosContador;
+    }
+
+    // Subidas entregues pela fonte 'i' (0 = o 555), alimentando algo ou não
+    uint64_t getSubidas(size_t i) const {
+        return fontes[i].subidas;
+    }
+
+    size_t getFontes() const {
+        return fontes.size();
+    }
+
+    // Nós do pool de eventos (não cresce depois que todas as fontes e eventos pendentes couberam)
+    size_t getCapacidadeEventos() const {
+        return roda.capacity();
+    }
+};
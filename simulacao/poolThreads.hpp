@@ -0,0 +1,126 @@
+/*
+    Pool de threads simples: um número fixo de workers consome uma fila de tarefas.
+
+    Usado pelas execuções em lote (varredura de parâmetros, Monte Carlo), que dividem o trabalho em blocos
+    independentes. A primeira exceção lançada por uma tarefa é guardada e relançada em wait().
+*/
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+
+
+class PoolThreads {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> fila;
+
+    std::mutex mtx;
+    std::condition_variable temTarefa;
+    std::condition_variable terminou;
+
+    size_t pendentes = 0;       // tarefas na fila ou em execução
+    bool parar = false;
+    std::exception_ptr erro;
+
+    void worker() {
+        while (true) {
+            std::function<void()> tarefa;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                temTarefa.wait(lock, [this] { return parar || !fila.empty(); });
+                if (parar && fila.empty()) {
+                    return;
+                }
+                tarefa = std::move(fila.front());
+                fila.pop();
+            }
+
+            try {
+                tarefa();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (!erro) {
+                    erro = std::current_exception();
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mtx);
+            if (--pendentes == 0) {
+                terminou.notify_all();
+            }
+        }
+    }
+
+public:
+    // Com 0 threads, usa todos os núcleos da máquina
+    explicit PoolThreads(unsigned qtThreads = 0) {
+        if (qtThreads == 0) {
+            qtThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned i = 0; i < qtThreads; ++i) {
+            workers.emplace_back([this] { worker(); });
+        }
+    }
+
+    ~PoolThreads() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            parar = true;
+        }
+        temTarefa.notify_all();
+        for (std::thread& t : workers) {
+            t.join();
+        }
+    }
+
+    PoolThreads(const PoolThreads&) = delete;
+    PoolThreads& operator=(const PoolThreads&) = delete;
+
+    void submit(std::function<void()> tarefa) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            fila.push(std::move(tarefa));
+            pendentes++;
+        }
+        temTarefa.notify_one();
+    }
+
+    // Espera todas as tarefas terminarem; relança a primeira exceção, se houver
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        terminou.wait(lock, [this] { return pendentes == 0; });
+        if (erro) {
+            std::exception_ptr e = erro;
+            erro = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    /*
+        Divide o intervalo [0, total) em blocos de 'bloco' índices e chama f(inicio, fim) para cada um nos workers.
+        Blocos grandes o bastante mantêm a fila fora do caminho crítico; retorna quando todos terminarem.
+    */
+    template<typename Funcao>
+    void parallelFor(size_t total, size_t bloco, Funcao f) {
+        if (bloco == 0) {
+            bloco = 1;
+        }
+        for (size_t inicio = 0; inicio < total; inicio += bloco) {
+            size_t fim = std::min(total, inicio + bloco);
+            submit([f, inicio, fim] { f(inicio, fim); });
+        }
+        wait();
+    }
+
+    unsigned size() const {
+        return static_cast<unsigned>(workers.size());
+    }
+};
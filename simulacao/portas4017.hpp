@@ -0,0 +1,209 @@
+/*
+    CD4017 em nível de portas lógicas, avaliado em fatias de bits: 64 placas por palavra de 64 bits.
+
+    Por dentro, o CD4017 é um contador Johnson de 5 estágios (flip-flops D Q1..Q5, com D1 = /Q5) e 10 portas AND de
+    duas entradas que decodificam os 10 estados do contador nas saídas O0..O9:
+
+        estado  Q1..Q5   saída alta          estado  Q1..Q5   saída alta
+        0       00000    O0 = /Q1 /Q5        5       11111    O5 = Q1 Q5
+        1       10000    O1 = Q1 /Q2         6       01111    O6 = /Q1 Q2
+        2       11000    O2 = Q2 /Q3         7       00111    O7 = /Q2 Q3
+        3       11100    O3 = Q3 /Q4         8       00011    O8 = /Q3 Q4
+        4       11110    O4 = Q4 /Q5         9       00001    O9 = /Q4 Q5
+
+    CARRY OUT é /Q5: alto nas contagens 0 a 4 e baixo de 5 a 9, então sobe a cada 10 pulsos (cascata). Os flip-flops
+    disparam na subida do clock interno, CLOCK AND /CLOCK INHIBIT: a subida de CLOCK com o INHIBIT baixo avança, e
+    também a descida do INHIBIT com CLOCK alto (como avisa o datasheet). RESET é assíncrono e zera os flip-flops.
+    Dos 32 estados dos flip-flops só 10 são válidos; a entrada do terceiro estágio tem a correção do CI,
+    D3 = Q2 (Q1 + Q3), que não muda a sequência válida e leva qualquer estado inválido (ligar a placa com os
+    flip-flops em estado aleatório) de volta a ela em poucos pulsos.
+
+    Na placa Apple Juice, a saída O(LimitReset) é ligada ao RESET: ao chegar nela o contador volta na hora a O0, e o
+    anel tem LimitReset saídas (com 10, não há ligação e o contador dá a volta sozinho). Aqui essa realimentação é
+    uma máscara por saída com as placas que a usam.
+
+    Fatiado em bits, cada sinal é uma palavra com um bit por placa e cada porta é uma instrução lógica: um pulso nas
+    64 placas custa algumas dezenas de instruções sem desvios, e por placa sai mais barato que o Chip4017::shift()
+    (ver make bench BENCH_ARGS="--filtro portas").
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+
+
+class Lote4017Portas {
+public:
+    static constexpr unsigned Placas = 64;
+    static constexpr unsigned Estagios = 5;
+    static constexpr unsigned Saidas = 10;
+
+private:
+    size_t qtPlacas;
+    uint64_t placas;                    // máscara das placas em uso
+    std::vector<unsigned> limites;
+
+    uint64_t q[Estagios] = {};          // flip-flops Q1..Q5 (índices 0..4)
+    uint64_t pinoClock = 0;
+    uint64_t pinoInibe = 0;
+    uint64_t pinoReset = 0;
+    uint64_t clockInterno = 0;          // CLOCK AND /INHIBIT depois do último evento
+    uint64_t realimentacao[Saidas] = {};    // placas cuja saída k está ligada ao RESET
+
+    // Dispara os flip-flops das placas em 'borda' e deixa o RESET assentar
+    void disparar(uint64_t borda) {
+        const uint64_t q1 = q[0], q2 = q[1], q3 = q[2], q4 = q[3], q5 = q[4];
+        const uint64_t d[Estagios] = { ~q5, q1, q2 & (q1 | q3), q3, q4 };
+        for (unsigned i = 0; i < Estagios; ++i) {
+            q[i] = (d[i] & borda) | (q[i] & ~borda);
+        }
+        assentar();
+    }
+
+    // RESET assíncrono: o pino externo e a saída ligada a ele; depois de zerar, O0 sobe e a realimentação solta
+    void assentar() {
+        const uint64_t q1 = q[0], q2 = q[1], q3 = q[2], q4 = q[3], q5 = q[4];
+        const uint64_t* r = realimentacao;
+        uint64_t reset = pinoReset
+                       | (q1 & ~q2 & r[1]) | (q2 & ~q3 & r[2]) | (q3 & ~q4 & r[3]) | (q4 & ~q5 & r[4])
+                       | (q1 & q5 & r[5]) | (~q1 & q2 & r[6]) | (~q2 & q3 & r[7]) | (~q3 & q4 & r[8]) | (~q4 & q5 & r[9]);
+        for (uint64_t& estagio : q) {
+            estagio &= ~reset;
+        }
+    }
+
+    uint64_t validar(size_t placa) const {
+        if (placa >= qtPlacas) {
+            throw std::out_of_range("placa fora do lote");
+        }
+        return uint64_t(1) << placa;
+    }
+
+public:
+    // Uma placa por elemento de 'limites' (o LimitReset do CD4017 de cada uma, de 1 a 10), no máximo 64
+    explicit Lote4017Portas(const std::vector<unsigned>& limitesReset)
+        : qtPlacas(limitesReset.size()), limites(limitesReset) {
+        if (qtPlacas == 0 || qtPlacas > Placas) {
+            throw std::invalid_argument("o lote em portas tem de 1 a 64 placas");
+        }
+        placas = (qtPlacas == Placas) ? ~uint64_t(0) : (uint64_t(1) << qtPlacas) - 1;
+        for (size_t i = 0; i < qtPlacas; ++i) {
+            if (limites[i] < 1 || limites[i] > 10) {
+                throw std::invalid_argument("LimitReset precisa estar entre 1 e 10.");
+            }
+            if (limites[i] < Saidas) {
+                realimentacao[limites[i]] |= uint64_t(1) << i;
+            }
+        }
+    }
+
+    /*
+        Nível do pino CLOCK de cada placa (bit i = placa i). As placas em que o clock interno sobe avançam uma
+        contagem. Retorna a máscara das que avançaram.
+    */
+    uint64_t clock(uint64_t nivel) {
+        pinoClock = nivel & placas;
+        uint64_t interno = pinoClock & ~pinoInibe;
+        uint64_t borda = interno & ~clockInterno;
+        clockInterno = interno;
+        if (borda) {
+            disparar(borda);
+        }
+        return borda;
+    }
+
+    // Um pulso completo (subida e descida) no CLOCK das placas em 'mascara'
+    uint64_t pulse(uint64_t mascara = ~uint64_t(0)) {
+        uint64_t borda = clock(pinoClock | mascara);
+        clock(pinoClock & ~mascara);
+        return borda;
+    }
+
+    // CLOCK INHIBIT: a descida dele com CLOCK alto também é uma subida do clock interno
+    uint64_t setClockInhibit(uint64_t nivel) {
+        pinoInibe = nivel & placas;
+        return clock(pinoClock);
+    }
+
+    // RESET externo: enquanto alto, segura o contador em O0 e ignora o clock
+    void setReset(uint64_t nivel) {
+        pinoReset = nivel & placas;
+        assentar();
+    }
+
+    // Pulso no RESET de todas as placas (o pino volta para baixo)
+    void reset() {
+        setReset(placas);
+        setReset(0);
+    }
+
+    // Força os flip-flops (por exemplo, um estado aleatório ao ligar); o RESET ligado a uma saída assenta em seguida
+    void setStage(unsigned estagio, uint64_t valor) {
+        if (estagio >= Estagios) {
+            throw std::out_of_range("o CD4017 tem 5 estágios");
+        }
+        q[estagio] = valor & placas;
+        assentar();
+    }
+
+    // Flip-flop Q(estagio + 1) de todas as placas
+    uint64_t stage(unsigned estagio) const {
+        return q[estagio];
+    }
+
+    // Saída decodificada Ok de todas as placas (as duas entradas da porta AND dela)
+    uint64_t output(unsigned k) const {
+        const uint64_t q1 = q[0], q2 = q[1], q3 = q[2], q4 = q[3], q5 = q[4];
+        switch (k) {
+            case 0:  return ~q1 & ~q5 & placas;
+            case 1:  return q1 & ~q2;
+            case 2:  return q2 & ~q3;
+            case 3:  return q3 & ~q4;
+            case 4:  return q4 & ~q5;
+            case 5:  return q1 & q5;
+            case 6:  return ~q1 & q2;
+            case 7:  return ~q2 & q3;
+            case 8:  return ~q3 & q4;
+            case 9:  return ~q4 & q5;
+            default: throw std::out_of_range("o CD4017 tem as saídas O0 a O9");
+        }
+    }
+
+    // CARRY OUT (/Q5) de todas as placas
+    uint64_t carryOut() const {
+        return ~q[4] & placas;
+    }
+
+    // Primeira saída alta da placa (0 a 9); Saidas se nenhuma estiver (só num estado inválido dos flip-flops)
+    unsigned getPosition(size_t placa) const {
+        uint64_t b = validar(placa);
+        for (unsigned k = 0; k < Saidas; ++k) {
+            if (output(k) & b) {
+                return k;
+            }
+        }
+        return Saidas;
+    }
+
+    // Saídas da placa na convenção do Chip4017::getOut() (O0 = bit LimitReset - 1)
+    uint32_t getOut(size_t placa) const {
+        unsigned pos = getPosition(placa);
+        return (pos < limites[placa]) ? 1u << (limites[placa] - 1 - pos) : 0u;
+    }
+
+    unsigned getLimitReset(size_t placa) const {
+        validar(placa);
+        return limites[placa];
+    }
+
+    size_t size() const {
+        return qtPlacas;
+    }
+
+    // Máscara com um bit por placa em uso
+    uint64_t mask() const {
+        return placas;
+    }
+};
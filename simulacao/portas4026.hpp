@@ -0,0 +1,194 @@
+/*
+    CD4026 em nível de portas lógicas, avaliado em fatias de bits: 64 chips por palavra de 64 bits.
+
+    O contador do CD4026 é o mesmo do CD4017 (contador Johnson de 5 estágios com a correção D3 = Q2 (Q1 + Q3),
+    CLOCK INHIBIT, RESET assíncrono e CARRY OUT = /Q5; ver portas4017.hpp), sem saída ligada ao RESET. No lugar das
+    10 saídas, o decodificador interno acende os 7 segmentos: o segmento s é o OU das saídas do contador nos dígitos
+    em que ele acende. Quais dígitos são esses sai da TabelaSegmentos (chips.hpp), transposta na compilação para a
+    tabela DigitosDoSegmento, então o decodificador em portas e o Chip4026::getSegments() nunca divergem.
+
+    Pinos do display:
+        a..g                    segmentos depois de uma porta AND com DISPLAY ENABLE IN (baixo apaga o display sem
+                                parar a contagem)
+        DISPLAY ENABLE OUT      repete o DISPLAY ENABLE IN, para encadear o próximo chip
+        UNGATED "C" SEGMENT     o segmento c antes dessa porta: só fica baixo no dígito 2
+
+    Cascata4026Portas liga dois lotes como na placa: o CARRY OUT das unidades é o CLOCK das dezenas.
+*/
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+
+#include "chips.hpp"
+#include "portas4017.hpp"
+
+
+// Bit d = o segmento acende no dígito d (a = índice 0 ... g = índice 6), montada a partir da TabelaSegmentos
+constexpr std::array<uint16_t, 7> montarDigitosDoSegmento() {
+    std::array<uint16_t, 7> t = {};
+    for (unsigned d = 0; d < 10; ++d) {
+        for (unsigned s = 0; s < 7; ++s) {
+            if ((TabelaSegmentos[d] >> s) & 1u) {
+                t[s] = static_cast<uint16_t>(t[s] | (1u << d));
+            }
+        }
+    }
+    return t;
+}
+
+inline constexpr std::array<uint16_t, 7> DigitosDoSegmento = montarDigitosDoSegmento();
+
+
+class Lote4026Portas {
+public:
+    static constexpr unsigned Chips = Lote4017Portas::Placas;
+    static constexpr unsigned Segmentos = 7;
+
+private:
+    Lote4017Portas contador;            // o contador Johnson e o decodificador de 10 saídas
+    uint64_t pinoHabilita;              // DISPLAY ENABLE IN
+
+    uint64_t validar(size_t chip) const {
+        if (chip >= contador.size()) {
+            throw std::out_of_range("chip fora do lote");
+        }
+        return uint64_t(1) << chip;
+    }
+
+public:
+    // 'chips' CD4026 (de 1 a 64), com o DISPLAY ENABLE IN ligado no alto como na placa
+    explicit Lote4026Portas(size_t chips)
+        : contador(std::vector<unsigned>(chips, 10)), pinoHabilita(contador.mask()) {
+    }
+
+    // Pinos de entrada do contador, com o mesmo comportamento do Lote4017Portas (retornam as máscaras que avançaram)
+    uint64_t clock(uint64_t nivel)              { return contador.clock(nivel); }
+    uint64_t pulse(uint64_t mascara = ~uint64_t(0)) { return contador.pulse(mascara); }
+    uint64_t setClockInhibit(uint64_t nivel)    { return contador.setClockInhibit(nivel); }
+    void setReset(uint64_t nivel)               { contador.setReset(nivel); }
+    void reset()                                { contador.reset(); }
+    void setStage(unsigned estagio, uint64_t v) { contador.setStage(estagio, v); }
+    uint64_t stage(unsigned estagio) const      { return contador.stage(estagio); }
+
+    void setDisplayEnable(uint64_t nivel) {
+        pinoHabilita = nivel & contador.mask();
+    }
+
+    // DISPLAY ENABLE OUT de todos os chips
+    uint64_t displayEnableOut() const {
+        return pinoHabilita;
+    }
+
+    // CARRY OUT (/Q5): sobe quando a contagem volta de 9 para 0
+    uint64_t carryOut() const {
+        return contador.carryOut();
+    }
+
+    // Os 7 segmentos antes da porta do DISPLAY ENABLE: cada um é o OU das saídas decodificadas dos seus dígitos
+    void ungatedSegments(uint64_t destino[Segmentos]) const {
+        uint64_t o[10];
+        for (unsigned d = 0; d < 10; ++d) {
+            o[d] = contador.output(d);
+        }
+        for (unsigned s = 0; s < Segmentos; ++s) {
+            uint64_t v = 0;
+            for (unsigned d = 0; d < 10; ++d) {
+                if ((DigitosDoSegmento[s] >> d) & 1u) {
+                    v |= o[d];
+                }
+            }
+            destino[s] = v;
+        }
+    }
+
+    // Pinos a..g de todos os chips (a = destino[0])
+    void segments(uint64_t destino[Segmentos]) const {
+        ungatedSegments(destino);
+        for (unsigned s = 0; s < Segmentos; ++s) {
+            destino[s] &= pinoHabilita;
+        }
+    }
+
+    // Pino UNGATED "C" SEGMENT: apagado só no dígito 2, qualquer que seja o DISPLAY ENABLE
+    uint64_t ungatedC() const {
+        return contador.output(2) ^ contador.mask();
+    }
+
+    // Segmentos acesos do chip na convenção do Chip4026::getSegments() (bit 0 = a ... bit 6 = g)
+    uint8_t getSegments(size_t chip) const {
+        validar(chip);
+        uint64_t s[Segmentos];
+        segments(s);
+        uint8_t acesos = 0;
+        for (unsigned i = 0; i < Segmentos; ++i) {
+            acesos = static_cast<uint8_t>(acesos | (((s[i] >> chip) & 1u) << i));
+        }
+        return acesos;
+    }
+
+    // Dígito contado pelo chip (0 a 9); 10 num estado inválido dos flip-flops
+    unsigned getOut(size_t chip) const {
+        return contador.getPosition(chip);
+    }
+
+    bool getCarryOut(size_t chip) const {
+        return (carryOut() & validar(chip)) != 0;
+    }
+
+    size_t size() const {
+        return contador.size();
+    }
+
+    uint64_t mask() const {
+        return contador.mask();
+    }
+};
+
+
+
+/*
+    Unidades e dezenas de até 64 placas: o CARRY OUT de cada CD4026 das unidades é o CLOCK do das dezenas. Ao ligar,
+    o carry das unidades já está alto (contagem 0); o construtor assenta esse nível nas dezenas com o RESET alto, como
+    o reset de ligar a placa, para que ele não conte como uma subida.
+*/
+class Cascata4026Portas {
+private:
+    Lote4026Portas un;
+    Lote4026Portas dez;
+
+    void propagar() {
+        dez.clock(un.carryOut());
+    }
+
+public:
+    explicit Cascata4026Portas(size_t placas) : un(placas), dez(placas) {
+        dez.setReset(dez.mask());
+        propagar();
+        dez.setReset(0);
+    }
+
+    // Um pulso do 555 nas placas em 'mascara'; retorna as placas em que as dezenas avançaram
+    uint64_t pulse(uint64_t mascara = ~uint64_t(0)) {
+        un.clock(mascara);
+        uint64_t dezenas = dez.clock(un.carryOut());
+        un.clock(0);
+        return dezenas;
+    }
+
+    // RESET dos dois displays (o botão da placa)
+    void reset() {
+        un.reset();
+        dez.setReset(dez.mask());
+        propagar();
+        dez.setReset(0);
+    }
+
+    Lote4026Portas& unidades() { return un; }
+    Lote4026Portas& dezenas() { return dez; }
+    const Lote4026Portas& unidades() const { return un; }
+    const Lote4026Portas& dezenas() const { return dez; }
+};
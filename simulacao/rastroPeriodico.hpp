@@ -0,0 +1,350 @@
+/*
+    Histórico compacto dos sinais da placa, aproveitando que ela é periódica.
+
+    Cada sinal (LEDs do CD4017, unidades, dezenas e carry) vira uma trilha de corridas (valor, duração em ciclos).
+    As corridas fechadas passam por uma detecção de período incremental (função de prefixo, como no KMP): quando a
+    sequência já se repetiu duas vezes, o padrão de um período é guardado uma vez e o trecho passa a ser só
+    (início, quantas corridas). Um reset quebra o padrão e começa um trecho novo. Assim uma execução de 24 h a
+    1 kHz ocupa alguns kilobytes, e o estado de qualquer ciclo sai por busca binária, sem descompactar nada.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+
+// Estado da placa ao fim de um ciclo (até o próximo pulso)
+struct AmostraPlaca {
+    uint32_t leds = 0;
+    uint8_t unidade = 0;
+    uint8_t dezena = 0;
+    bool carry = false;
+
+    bool operator==(const AmostraPlaca& o) const {
+        return leds == o.leds && unidade == o.unidade && dezena == o.dezena && carry == o.carry;
+    }
+};
+
+
+/*
+    Histórico de um sinal. Os trechos fechados ficam em 'trechos' (um trecho literal é só um trecho cujo período é
+    ele mesmo); depois deles vêm o trecho periódico em andamento, as corridas ainda em aprendizado e a corrida aberta.
+*/
+class TrilhaPeriodica {
+public:
+    static constexpr size_t MaxPeriodo = 1024;      // maior período procurado, em corridas
+
+private:
+    struct Corrida {
+        uint32_t valor;
+        uint64_t duracao;
+
+        bool operator==(const Corrida& o) const {
+            return valor == o.valor && duracao == o.duracao;
+        }
+    };
+
+    struct Trecho {
+        uint64_t cicloInicial = 0;
+        uint64_t ciclos = 0;            // duração total
+        uint64_t corridas = 0;          // corridas cobertas (pode não ser múltiplo do período)
+        uint32_t inicioPadrao = 0;      // posição do padrão em 'padroes'
+        uint32_t periodo = 0;           // corridas por período
+        uint64_t ciclosPeriodo = 0;     // duração de um período
+    };
+
+    std::vector<Corrida> padroes;       // padrões de todos os trechos, em sequência
+    std::vector<uint64_t> inicioNoPadrao;   // ciclo de início de cada corrida dentro do seu padrão
+    std::vector<Trecho> trechos;
+
+    bool emPeriodo = false;
+    Trecho atual;
+
+    /*
+        Aprendizado: corridas ainda sem período, com a função de prefixo a partir da primeira e a partir da segunda
+        corrida. A segunda cobre o caso comum de a gravação começar (ou voltar depois de um reset) no meio de uma
+        corrida: a primeira fica mais curta e quebraria a periodicidade do buffer inteiro.
+    */
+    std::vector<Corrida> aprendendo;
+    std::vector<uint32_t> prefixo;
+    std::vector<uint32_t> prefixoSemPrimeira;
+    uint64_t cicloAprendendo = 0;
+
+    Corrida aberta{0, 0};
+    uint64_t total = 0;
+
+    void adicionarAoPadrao(const Corrida& c, uint64_t inicio) {
+        padroes.push_back(c);
+        inicioNoPadrao.push_back(inicio);
+    }
+
+    // Grava uma corrida como trecho literal, emendando no trecho literal anterior quando possível
+    void emitirLiteral(const Corrida& c, uint64_t ciclo) {
+        if (!trechos.empty()) {
+            Trecho& t = trechos.back();
+            bool literal = t.corridas == t.periodo && t.inicioPadrao + t.periodo == padroes.size();
+            if (literal && t.cicloInicial + t.ciclos == ciclo) {
+                adicionarAoPadrao(c, t.ciclosPeriodo);
+                t.periodo++;
+                t.corridas++;
+                t.ciclos += c.duracao;
+                t.ciclosPeriodo += c.duracao;
+                return;
+            }
+        }
+        Trecho t;
+        t.cicloInicial = ciclo;
+        t.ciclos = c.duracao;
+        t.corridas = 1;
+        t.inicioPadrao = static_cast<uint32_t>(padroes.size());
+        t.periodo = 1;
+        t.ciclosPeriodo = c.duracao;
+        adicionarAoPadrao(c, 0);
+        trechos.push_back(t);
+    }
+
+    // Estende a função de prefixo 'pi' (de aprendendo[base..]) com a última corrida
+    void estenderPrefixo(std::vector<uint32_t>& pi, size_t base) {
+        const Corrida* s = aprendendo.data() + base;
+        size_t i = aprendendo.size() - 1 - base;
+        uint32_t k = (i == 0) ? 0 : pi[i - 1];
+        while (i > 0 && k > 0 && !(s[i] == s[k])) {
+            k = pi[k - 1];
+        }
+        if (i > 0 && s[i] == s[k]) {
+            k++;
+        }
+        pi.push_back(k);
+    }
+
+    // Menor período de uma sequência de 'n' corridas, se ela já se repetiu pelo menos duas vezes (0 se não)
+    static size_t periodoRepetido(const std::vector<uint32_t>& pi) {
+        size_t n = pi.size();
+        size_t p = (n == 0) ? 0 : n - pi[n - 1];
+        return (p < n && n >= 2 * p) ? p : 0;
+    }
+
+    // Tira a primeira corrida do aprendizado como literal e refaz as funções de prefixo do resto
+    void descartarPrimeira() {
+        emitirLiteral(aprendendo.front(), cicloAprendendo);
+        cicloAprendendo += aprendendo.front().duracao;
+        std::vector<Corrida> resto(aprendendo.begin() + 1, aprendendo.end());
+        aprendendo.clear();
+        prefixo.clear();
+        prefixoSemPrimeira.clear();
+        for (const Corrida& r : resto) {
+            aprendendo.push_back(r);
+            estenderPrefixo(prefixo, 0);
+            if (aprendendo.size() > 1) {
+                estenderPrefixo(prefixoSemPrimeira, 1);
+            }
+        }
+    }
+
+    // O buffer de aprendizado inteiro tem período 'p': vira o trecho periódico em andamento
+    void virarPeriodico(size_t p) {
+        atual = Trecho();
+        atual.cicloInicial = cicloAprendendo;
+        atual.inicioPadrao = static_cast<uint32_t>(padroes.size());
+        atual.periodo = static_cast<uint32_t>(p);
+        for (size_t i = 0; i < p; ++i) {
+            adicionarAoPadrao(aprendendo[i], atual.ciclosPeriodo);
+            atual.ciclosPeriodo += aprendendo[i].duracao;
+        }
+        for (const Corrida& r : aprendendo) {
+            atual.ciclos += r.duracao;
+        }
+        atual.corridas = aprendendo.size();
+        emPeriodo = true;
+        aprendendo.clear();
+        prefixo.clear();
+        prefixoSemPrimeira.clear();
+    }
+
+    void aprender(const Corrida& c) {
+        if (aprendendo.empty()) {
+            cicloAprendendo = total - aberta.duracao - c.duracao;
+        }
+        aprendendo.push_back(c);
+        estenderPrefixo(prefixo, 0);
+        if (aprendendo.size() > 1) {
+            estenderPrefixo(prefixoSemPrimeira, 1);
+        }
+
+        // a sequência já se repetiu duas vezes, desde a primeira corrida ou desde a segunda
+        if (size_t p = periodoRepetido(prefixo)) {
+            virarPeriodico(p);
+            return;
+        }
+        if (size_t p = periodoRepetido(prefixoSemPrimeira)) {
+            descartarPrimeira();
+            virarPeriodico(p);
+            return;
+        }
+
+        if (aprendendo.size() >= 2 * MaxPeriodo) {
+            // sem período desde o início do buffer: a primeira corrida vira literal e a busca recomeça na seguinte
+            descartarPrimeira();
+        }
+    }
+
+    void fecharCorrida(const Corrida& c) {
+        if (emPeriodo) {
+            if (c == padroes[atual.inicioPadrao + atual.corridas % atual.periodo]) {
+                atual.corridas++;
+                atual.ciclos += c.duracao;
+                return;
+            }
+            // o padrão quebrou (em geral um reset cortou esta corrida): ela fica literal e o aprendizado recomeça depois
+            trechos.push_back(atual);
+            emPeriodo = false;
+            emitirLiteral(c, atual.cicloInicial + atual.ciclos);
+            return;
+        }
+        aprender(c);
+    }
+
+    // Valor no deslocamento 'o' (em ciclos) de um trecho
+    uint32_t valorNoTrecho(const Trecho& t, uint64_t o) const {
+        uint64_t r = o % t.ciclosPeriodo;
+        auto inicio = inicioNoPadrao.begin() + t.inicioPadrao;
+        auto fim = inicio + t.periodo;
+        size_t k = static_cast<size_t>(std::upper_bound(inicio, fim, r) - inicio) - 1;
+        return padroes[t.inicioPadrao + k].valor;
+    }
+
+public:
+    void append(uint32_t v) {
+        if (aberta.duracao > 0 && aberta.valor == v) {
+            aberta.duracao++;
+            total++;
+            return;
+        }
+        Corrida anterior = aberta;
+        aberta = {v, 1};
+        total++;
+        if (anterior.duracao > 0) {
+            fecharCorrida(anterior);
+        }
+    }
+
+    // Troca o valor do último ciclo (reset entre dois pulsos)
+    void replaceLast(uint32_t v) {
+        if (total == 0 || aberta.valor == v) {
+            return;
+        }
+        if (aberta.duracao > 1) {
+            aberta.duracao--;
+            total--;
+            append(v);
+        } else {
+            aberta.valor = v;
+        }
+    }
+
+    // Valor no ciclo 'c' (0 = primeiro ciclo gravado)
+    uint32_t at(uint64_t c) const {
+        if (c >= total) {
+            throw std::out_of_range("ciclo fora do histórico");
+        }
+        if (c >= total - aberta.duracao) {
+            return aberta.valor;
+        }
+        if (!trechos.empty() && c < trechos.back().cicloInicial + trechos.back().ciclos) {
+            auto it = std::upper_bound(trechos.begin(), trechos.end(), c,
+                                       [](uint64_t ciclo, const Trecho& t) { return ciclo < t.cicloInicial; });
+            const Trecho& t = *(it - 1);
+            return valorNoTrecho(t, c - t.cicloInicial);
+        }
+        if (emPeriodo) {
+            return valorNoTrecho(atual, c - atual.cicloInicial);
+        }
+        uint64_t ciclo = cicloAprendendo;
+        for (const Corrida& r : aprendendo) {
+            if (c < ciclo + r.duracao) {
+                return r.valor;
+            }
+            ciclo += r.duracao;
+        }
+        return aberta.valor;
+    }
+
+    uint64_t size() const {
+        return total;
+    }
+
+    // Trechos fechados mais o periódico em andamento
+    size_t segments() const {
+        return trechos.size() + (emPeriodo ? 1 : 0);
+    }
+
+    // Memória ocupada pelos dados (sem contar a folga dos vetores)
+    size_t bytes() const {
+        return padroes.size() * (sizeof(Corrida) + sizeof(uint64_t)) + trechos.size() * sizeof(Trecho)
+             + aprendendo.size() * (sizeof(Corrida) + 2 * sizeof(uint32_t)) + sizeof(*this);
+    }
+};
+
+
+/*
+    Histórico da placa inteira: uma trilha por sinal. O primeiro append() define o ciclo inicial; os seguintes devem
+    vir um por ciclo, em ordem.
+*/
+class RastroPeriodico {
+private:
+    TrilhaPeriodica leds, unidade, dezena, carry;
+    uint64_t primeiroCiclo = 0;
+
+public:
+    void append(uint64_t ciclo, const AmostraPlaca& a) {
+        if (leds.size() == 0) {
+            primeiroCiclo = ciclo;
+        } else if (ciclo != primeiroCiclo + leds.size()) {
+            throw std::invalid_argument("o histórico recebe um ciclo por vez, em ordem");
+        }
+        leds.append(a.leds);
+        unidade.append(a.unidade);
+        dezena.append(a.dezena);
+        carry.append(a.carry);
+    }
+
+    void replaceLast(const AmostraPlaca& a) {
+        leds.replaceLast(a.leds);
+        unidade.replaceLast(a.unidade);
+        dezena.replaceLast(a.dezena);
+        carry.replaceLast(a.carry);
+    }
+
+    // Estado ao fim do ciclo 'ciclo' (numeração do motor)
+    AmostraPlaca at(uint64_t ciclo) const {
+        if (ciclo < primeiroCiclo) {
+            throw std::out_of_range("ciclo anterior ao início do histórico");
+        }
+        uint64_t c = ciclo - primeiroCiclo;
+        AmostraPlaca a;
+        a.leds = leds.at(c);
+        a.unidade = static_cast<uint8_t>(unidade.at(c));
+        a.dezena = static_cast<uint8_t>(dezena.at(c));
+        a.carry = carry.at(c) != 0;
+        return a;
+    }
+
+    uint64_t firstCycle() const {
+        return primeiroCiclo;
+    }
+
+    uint64_t size() const {
+        return leds.size();
+    }
+
+    size_t segments() const {
+        return leds.segments() + unidade.segments() + dezena.segments() + carry.segments();
+    }
+
+    size_t bytes() const {
+        return leds.bytes() + unidade.bytes() + dezena.bytes() + carry.bytes();
+    }
+};
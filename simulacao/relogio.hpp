@@ -0,0 +1,146 @@
+/*
+    Escalonador de tempo real do clock do 555 com prazos absolutos.
+
+    Cada borda do ciclo k acontece em t0 + k * período (subida) e t0 + k * período + tHigh (descida), sempre medidas
+    a partir do mesmo t0. Assim o atraso de um sleep não se acumula nos ciclos seguintes (sem deriva). Para acertar
+    o prazo, a thread dorme até um pouco antes dele e termina em espera ativa (yield); essa margem se adapta ao
+    atraso típico que o sistema operacional impõe aos sleeps.
+*/
+#pragma once
+
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <algorithm>
+
+
+class RelogioTempoReal {
+public:
+    using Relogio = std::chrono::steady_clock;
+
+private:
+    Relogio::time_point t0;
+    double tHigh;
+    double periodo;
+
+    double atrasoSleep = 100e-6;        // média móvel do atraso dos sleeps (s)
+    double margem = 200e-6;             // quanto antes do prazo a thread acorda (s)
+
+    // Medição da frequência efetiva em janelas de ~0,5 s
+    Relogio::time_point inicioJanela;
+    uint64_t ciclosJanela = 0;
+    double frequenciaMedida = 0.0;
+
+public:
+    RelogioTempoReal(double tHighSegundos, double periodoSegundos)
+        : tHigh(tHighSegundos), periodo(periodoSegundos) {
+        restart(0);
+    }
+
+    // Recomeça a contagem a partir de agora (por exemplo, quando a placa é ligada); 'ciclos' vira o ciclo 0
+    void restart(uint64_t ciclos) {
+        t0 = Relogio::now();
+        inicioJanela = t0;
+        ciclosJanela = ciclos;
+        frequenciaMedida = 0.0;
+    }
+
+    // Instante de uma borda: 'fase' = 0 para a subida, tHigh para a descida
+    Relogio::time_point edge(uint64_t ciclo, double fase) const {
+        return t0 + std::chrono::duration_cast<Relogio::duration>(std::chrono::duration<double>(ciclo * periodo + fase));
+    }
+
+    Relogio::time_point fallingEdge(uint64_t ciclo) const {
+        return edge(ciclo, tHigh);
+    }
+
+private:
+    Relogio::time_point inicioDaMargem(Relogio::time_point alvo) const {
+        return alvo - std::chrono::duration_cast<Relogio::duration>(std::chrono::duration<double>(margem));
+    }
+
+    void ajustarMargem(Relogio::time_point acordar) {
+        double atraso = std::chrono::duration<double>(Relogio::now() - acordar).count();
+        atrasoSleep = 0.9 * atrasoSleep + 0.1 * atraso;
+        margem = std::clamp(2.0 * atrasoSleep + 20e-6, 20e-6, 2e-3);
+    }
+
+    static Relogio::time_point esperaAtiva(Relogio::time_point alvo) {
+        auto agora = Relogio::now();
+        while (agora < alvo) {
+            std::this_thread::yield();
+            agora = Relogio::now();
+        }
+        return agora;
+    }
+
+public:
+    // Dorme até perto do prazo e termina em espera ativa; ajusta a margem conforme o atraso observado.
+    // Retorna o instante em que a espera terminou.
+    Relogio::time_point sleepUntil(Relogio::time_point alvo) {
+        auto acordar = inicioDaMargem(alvo);
+        if (Relogio::now() < acordar) {
+            std::this_thread::sleep_until(acordar);
+            ajustarMargem(acordar);
+        }
+        return esperaAtiva(alvo);
+    }
+
+    /*
+        Como sleepUntil(), mas o trecho dormido é um wait_until em 'aviso': quando 'pendente()' fica verdadeiro a
+        thread acorda na hora, chama 'atender()' (fora da trava) e volta a dormir até o mesmo prazo absoluto. Quem
+        cria o pedido precisa tomar 'trava' antes do notify, para o aviso não se perder entre o teste e a espera.
+    */
+    template <typename Pendente, typename Atender>
+    Relogio::time_point sleepUntil(Relogio::time_point alvo, std::mutex& trava, std::condition_variable& aviso,
+                                   Pendente pendente, Atender atender) {
+        auto acordar = inicioDaMargem(alvo);
+        while (Relogio::now() < acordar) {
+            bool pedido;
+            {
+                std::unique_lock<std::mutex> l(trava);
+                pedido = aviso.wait_until(l, acordar, pendente);
+            }
+            if (!pedido) {
+                ajustarMargem(acordar);
+                break;
+            }
+            atender();
+        }
+        return esperaAtiva(alvo);
+    }
+
+    // Ciclos completos decorridos desde t0 (relativos ao ciclo passado em restart)
+    uint64_t cyclesElapsed() const {
+        double decorrido = std::chrono::duration<double>(Relogio::now() - t0).count();
+        return static_cast<uint64_t>(decorrido / periodo);
+    }
+
+    // Nível que a saída do 555 tem agora, pela fase do ciclo atual
+    bool highNow() const {
+        double decorrido = std::chrono::duration<double>(Relogio::now() - t0).count();
+        double fase = decorrido - static_cast<double>(static_cast<uint64_t>(decorrido / periodo)) * periodo;
+        return fase < tHigh;
+    }
+
+    // Atualiza a frequência medida; 'ciclos' é o total de ciclos entregues até agora
+    void measure(uint64_t ciclos) {
+        auto agora = Relogio::now();
+        double dt = std::chrono::duration<double>(agora - inicioJanela).count();
+        if (dt >= 0.5) {
+            frequenciaMedida = (ciclos - ciclosJanela) / dt;
+            ciclosJanela = ciclos;
+            inicioJanela = agora;
+        }
+    }
+
+    double getMeasuredFrequency() const {
+        return frequenciaMedida;
+    }
+
+    double getMargin() const {
+        return margem;
+    }
+};
@@ -0,0 +1,284 @@
+/*
+    Roda de tempo hierárquica (timing wheel) para a simulação por eventos discretos.
+
+    O tempo é contado em ticks inteiros de 64 bits. A roda tem 8 níveis de 256 posições: o nível n guarda os eventos
+    cujo instante difere do cursor, pela primeira vez, no n-ésimo grupo de 8 bits (contando do menos significativo).
+    Agendar é só calcular o nível e a posição e ligar o evento numa lista (O(1)); cancelar é desligá-lo (O(1)). Para
+    achar o próximo evento, um mapa de bits por nível aponta a primeira posição ocupada, e quando o nível 0 esvazia a
+    primeira posição ocupada do nível mais baixo com eventos é redistribuída nos níveis de baixo, com o cursor já no
+    mais cedo deles. Cada evento desce no máximo 7 vezes, então o custo por evento é constante, e longos intervalos
+    sem eventos (ou uma única fonte lenta) são saltados de uma vez.
+
+    Os nós dos eventos vêm de um pool: a fonte que gerou um evento costuma reagendar o mesmo nó para a sua próxima
+    borda, e nós devolvidos são reaproveitados, então a simulação não aloca memória depois de aquecida. No mesmo
+    instante, os eventos saem na ordem em que chegaram ao nível 0.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+
+class RodaDeTempo {
+public:
+    static constexpr unsigned BitsNivel = 8;
+    static constexpr unsigned Posicoes = 1u << BitsNivel;
+    static constexpr unsigned Niveis = 64 / BitsNivel;
+
+    // Evento agendado; 'fonte' e 'tipo' são livres para quem usa a roda
+    struct No {
+        uint64_t tempo = 0;
+        uint32_t fonte = 0;
+        uint32_t tipo = 0;
+        No* prox = nullptr;
+        No* ant = nullptr;
+        uint8_t nivel = 0;
+        uint8_t posicao = 0;
+        bool agendado = false;
+    };
+
+private:
+    struct Lista {
+        No* primeiro = nullptr;
+        No* ultimo = nullptr;
+    };
+
+    static constexpr size_t NosPorBloco = 256;
+
+    Lista listas[Niveis][Posicoes];
+    uint64_t ocupadas[Niveis][Posicoes / 64] = {};     // bit p = a posição p do nível tem eventos
+    unsigned palavrasOcupadas[Niveis] = {};             // bit w = ocupadas[nivel][w] não é zero
+    size_t porNivel[Niveis] = {};                       // eventos em cada nível
+    unsigned niveisOcupados = 0;                        // bit n = o nível n tem eventos
+    uint64_t cursor = 0;                                // nenhum evento agendado é anterior a ele
+    size_t pendentes = 0;
+
+    std::vector<std::unique_ptr<No[]>> blocos;
+    No* livres = nullptr;
+
+    // Índice do bit 1 mais baixo e do mais alto ('v' diferente de zero)
+    static unsigned primeiroBit(uint64_t v) {
+#if defined(__GNUC__)
+        return static_cast<unsigned>(__builtin_ctzll(v));
+#else
+        unsigned b = 0;
+        while (!((v >> b) & 1u)) {
+            b++;
+        }
+        return b;
+#endif
+    }
+
+    static unsigned ultimoBit(uint64_t v) {
+#if defined(__GNUC__)
+        return 63 - static_cast<unsigned>(__builtin_clzll(v));
+#else
+        unsigned b = 63;
+        while (!(v >> b)) {
+            b--;
+        }
+        return b;
+#endif
+    }
+
+    void inserir(No* no) {
+        uint64_t diferenca = no->tempo ^ cursor;
+        unsigned nivel = diferenca ? ultimoBit(diferenca) / BitsNivel : 0;
+        unsigned posicao = static_cast<unsigned>(no->tempo >> (nivel * BitsNivel)) & (Posicoes - 1);
+        no->nivel = static_cast<uint8_t>(nivel);
+        no->posicao = static_cast<uint8_t>(posicao);
+
+        porNivel[nivel]++;
+        niveisOcupados |= 1u << nivel;
+
+        Lista& l = listas[nivel][posicao];
+        no->prox = nullptr;
+        no->ant = l.ultimo;
+        if (l.ultimo) {
+            l.ultimo->prox = no;
+        } else {
+            l.primeiro = no;
+            ocupadas[nivel][posicao / 64] |= uint64_t(1) << (posicao % 64);
+            palavrasOcupadas[nivel] |= 1u << (posicao / 64);
+        }
+        l.ultimo = no;
+    }
+
+    void desligar(No* no) {
+        Lista& l = listas[no->nivel][no->posicao];
+        (no->ant ? no->ant->prox : l.primeiro) = no->prox;
+        (no->prox ? no->prox->ant : l.ultimo) = no->ant;
+        if (!l.primeiro) {
+            liberarPosicao(no->nivel, no->posicao);
+        }
+        if (--porNivel[no->nivel] == 0) {
+            niveisOcupados &= ~(1u << no->nivel);
+        }
+    }
+
+    void liberarPosicao(unsigned nivel, unsigned posicao) {
+        uint64_t& palavra = ocupadas[nivel][posicao / 64];
+        palavra &= ~(uint64_t(1) << (posicao % 64));
+        if (!palavra) {
+            palavrasOcupadas[nivel] &= ~(1u << (posicao / 64));
+        }
+    }
+
+    // Primeira posição ocupada do nível (Posicoes se estiver vazio), sem percorrer as palavras do mapa
+    unsigned primeiraOcupada(unsigned nivel) const {
+        if (!palavrasOcupadas[nivel]) {
+            return Posicoes;
+        }
+        unsigned w = primeiroBit(palavrasOcupadas[nivel]);
+        return w * 64 + primeiroBit(ocupadas[nivel][w]);
+    }
+
+public:
+    RodaDeTempo() = default;
+    RodaDeTempo(const RodaDeTempo&) = delete;
+    RodaDeTempo& operator=(const RodaDeTempo&) = delete;
+
+    // Nó livre do pool (cresce em blocos só quando todos estão em uso)
+    No* acquire() {
+        if (!livres) {
+            blocos.push_back(std::make_unique<No[]>(NosPorBloco));
+            No* bloco = blocos.back().get();
+            for (size_t i = 0; i < NosPorBloco; ++i) {
+                bloco[i].prox = livres;
+                livres = &bloco[i];
+            }
+        }
+        No* no = livres;
+        livres = no->prox;
+        *no = No();
+        return no;
+    }
+
+    // Devolve ao pool um nó que não está agendado
+    void release(No* no) {
+        no->prox = livres;
+        livres = no;
+    }
+
+    // Agenda 'no' para o tick 'tempo'; lança invalid_argument se o instante já passou
+    void schedule(No* no, uint64_t tempo) {
+        if (tempo < cursor) {
+            throw std::invalid_argument("evento agendado para antes do instante atual da roda de tempo");
+        }
+        if (no->agendado) {
+            desligar(no);
+            pendentes--;
+        }
+        no->tempo = tempo;
+        no->agendado = true;
+        inserir(no);
+        pendentes++;
+    }
+
+    void cancel(No* no) {
+        if (no->agendado) {
+            desligar(no);
+            no->agendado = false;
+            pendentes--;
+        }
+    }
+
+    /*
+        Retira o próximo evento se ele acontece até o tick 'limite' (inclusive); senão retorna nullptr. O cursor
+        avança até o evento retirado, mas nunca além de 'limite', então depois da chamada ainda se pode agendar
+        qualquer instante >= limite.
+    */
+    No* popUntil(uint64_t limite) {
+        while (pendentes) {
+            unsigned p = primeiraOcupada(0);
+            if (p < Posicoes) {
+                uint64_t tempo = (cursor & ~uint64_t(Posicoes - 1)) | p;
+                if (tempo > limite) {
+                    return nullptr;
+                }
+                cursor = tempo;
+                No* no = listas[0][p].primeiro;
+                desligar(no);
+                no->agendado = false;
+                pendentes--;
+                return no;
+            }
+
+            /*
+                Nível 0 vazio: a primeira posição ocupada do nível mais baixo com eventos tem os próximos. O cursor vai
+                direto para o mais cedo deles, que desce para o nível 0 e sai na volta seguinte do laço.
+            */
+            unsigned nivel = primeiroBit(niveisOcupados);
+            p = primeiraOcupada(nivel);
+            Lista l = listas[nivel][p];
+            uint64_t inicio = UINT64_MAX;
+            size_t qt = 0;
+            for (No* no = l.primeiro; no; no = no->prox) {
+                inicio = std::min(inicio, no->tempo);
+                qt++;
+            }
+            if (inicio > limite) {
+                return nullptr;
+            }
+            cursor = inicio;
+            if (qt == 1) {
+                // caso comum com poucas fontes: o único evento da posição é o próximo, sai sem descer de nível
+                No* no = l.primeiro;
+                desligar(no);
+                no->agendado = false;
+                pendentes--;
+                return no;
+            }
+            listas[nivel][p] = Lista();
+            liberarPosicao(nivel, p);
+            if ((porNivel[nivel] -= qt) == 0) {
+                niveisOcupados &= ~(1u << nivel);
+            }
+            for (No* no = l.primeiro; no; ) {
+                No* seguinte = no->prox;
+                inserir(no);
+                no = seguinte;
+            }
+        }
+        return nullptr;
+    }
+
+    /*
+        Instante do próximo evento (UINT64_MAX se não há nenhum), sem retirá-lo nem mover o cursor: no nível 0 a
+        posição já é o instante; acima dele, é o menor da primeira posição ocupada do nível mais baixo com eventos.
+    */
+    uint64_t nextTime() const {
+        if (!pendentes) {
+            return UINT64_MAX;
+        }
+        unsigned p = primeiraOcupada(0);
+        if (p < Posicoes) {
+            return (cursor & ~uint64_t(Posicoes - 1)) | p;
+        }
+        unsigned nivel = primeiroBit(niveisOcupados);
+        uint64_t tempo = UINT64_MAX;
+        for (const No* no = listas[nivel][primeiraOcupada(nivel)].primeiro; no; no = no->prox) {
+            tempo = std::min(tempo, no->tempo);
+        }
+        return tempo;
+    }
+
+    // Tick até o qual a roda já avançou
+    uint64_t now() const {
+        return cursor;
+    }
+
+    // Eventos agendados
+    size_t size() const {
+        return pendentes;
+    }
+
+    // Nós alocados pelo pool (em uso ou livres)
+    size_t capacity() const {
+        return blocos.size() * NosPorBloco;
+    }
+};
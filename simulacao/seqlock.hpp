@@ -0,0 +1,82 @@
+/*
+    Seqlock: publicação sem trava de uma estrutura pequena de um escritor (a thread do motor) para vários leitores
+    (o laço de renderização).
+
+    O escritor nunca espera; o leitor repete a cópia se ela coincidiu com uma escrita, então nunca enxerga um estado
+    pela metade. Os dados ficam em palavras atômicas para que as cópias concorrentes não sejam corrida de dados.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <thread>
+
+
+template<typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock só publica tipos copiáveis com memcpy");
+
+private:
+    static constexpr size_t Palavras = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> sequencia{0};         // ímpar enquanto uma escrita está em andamento
+    std::atomic<uint64_t> dados[Palavras];
+
+public:
+    SeqLock() {
+        store(T{});
+    }
+
+    explicit SeqLock(const T& inicial) {
+        store(inicial);
+    }
+
+    // Apenas uma thread pode escrever
+    void store(const T& valor) {
+        uint64_t buffer[Palavras] = {};
+        std::memcpy(buffer, &valor, sizeof(T));
+
+        uint64_t seq = sequencia.load(std::memory_order_relaxed);
+        sequencia.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < Palavras; ++i) {
+            dados[i].store(buffer[i], std::memory_order_relaxed);
+        }
+
+        sequencia.store(seq + 2, std::memory_order_release);
+    }
+
+    // Qualquer thread pode ler; retorna sempre uma cópia consistente de um único store()
+    T load() const {
+        uint64_t buffer[Palavras];
+        while (true) {
+            uint64_t antes = sequencia.load(std::memory_order_acquire);
+            if (antes & 1u) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (size_t i = 0; i < Palavras; ++i) {
+                buffer[i] = dados[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequencia.load(std::memory_order_relaxed) == antes) {
+                break;
+            }
+        }
+
+        T valor;
+        std::memcpy(&valor, buffer, sizeof(T));
+        return valor;
+    }
+
+    // Número de publicações feitas até agora (permite saber se algo mudou sem copiar os dados)
+    uint64_t version() const {
+        return sequencia.load(std::memory_order_acquire) / 2;
+    }
+};
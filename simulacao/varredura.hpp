@@ -0,0 +1,257 @@
+/*
+    Varredura de parâmetros da placa: grade de R1, R2, C (do 555) e LimitReset (do CD4017).
+
+    Cada ponto da grade é uma placa independente simulada durante o mesmo tempo (MotorVirtual em forma fechada, ou
+    PlacaEstatica ciclo a ciclo, sem chamadas virtuais); os pontos são
+    distribuídos entre os núcleos pelo PoolThreads e cada worker escreve direto na sua posição do vetor de resultados,
+    então não há disputa entre threads e a varredura escala com o número de núcleos.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+
+#include "motorVirtual.hpp"
+#include "chipsEstaticos.hpp"
+#include "poolThreads.hpp"
+
+
+// Faixa de valores de um parâmetro: 'passos' valores de 'inicio' a 'fim' (inclusive), linear ou logarítmica
+struct Faixa {
+    double inicio = 0.0;
+    double fim = 0.0;
+    unsigned passos = 1;
+    bool logaritmica = false;
+
+    double valor(unsigned i) const {
+        if (passos <= 1) {
+            return inicio;
+        }
+        double t = static_cast<double>(i) / (passos - 1);
+        if (logaritmica) {
+            return inicio * std::pow(fim / inicio, t);
+        }
+        return inicio + (fim - inicio) * t;
+    }
+
+    /*
+        Lê "valor", "inicio:fim:passos" ou "inicio:fim:passos:log".
+        Lança invalid_argument quando o texto não segue esse formato.
+    */
+    static Faixa ler(const std::string& texto) {
+        Faixa f;
+        std::vector<std::string> partes;
+        size_t pos = 0;
+        while (true) {
+            size_t sep = texto.find(':', pos);
+            partes.push_back(texto.substr(pos, sep - pos));
+            if (sep == std::string::npos) {
+                break;
+            }
+            pos = sep + 1;
+        }
+
+        try {
+            if (partes.size() == 1) {
+                f.inicio = f.fim = std::stod(partes[0]);
+            } else if (partes.size() == 3 || partes.size() == 4) {
+                f.inicio = std::stod(partes[0]);
+                f.fim = std::stod(partes[1]);
+                f.passos = static_cast<unsigned>(std::stoul(partes[2]));
+                f.logaritmica = (partes.size() == 4);
+                if (f.logaritmica && partes[3] != "log") {
+                    throw std::invalid_argument(partes[3]);
+                }
+            } else {
+                throw std::invalid_argument(texto);
+            }
+        } catch (const std::exception&) {
+            throw std::invalid_argument("faixa inválida '" + texto + "' (use valor ou inicio:fim:passos[:log])");
+        }
+
+        if (f.passos == 0) {
+            throw std::invalid_argument("faixa '" + texto + "' precisa de pelo menos 1 passo");
+        }
+        if (f.logaritmica && (f.inicio <= 0 || f.fim <= 0)) {
+            throw std::invalid_argument("faixa logarítmica '" + texto + "' precisa de valores > 0");
+        }
+        return f;
+    }
+};
+
+
+struct ConfigVarredura {
+    Faixa r1, r2, c;
+    unsigned limiteMin = 1;         // LimitReset inicial
+    unsigned limiteMax = 10;        // LimitReset final (inclusive)
+    double tempo = 3600.0;          // segundos simulados em cada ponto
+    bool passoAPasso = false;       // simula ciclo a ciclo em vez de usar advance() (mesmo resultado, mais lento)
+
+    size_t totalPontos() const {
+        return static_cast<size_t>(r1.passos) * r2.passos * c.passos * (limiteMax - limiteMin + 1);
+    }
+};
+
+
+// Resultado de um ponto da grade
+struct PontoVarredura {
+    double R1 = 0.0, R2 = 0.0, C = 0.0;
+    unsigned limitReset = 0;
+    double frequencia = 0.0;        // Hz
+    double periodo = 0.0;           // s
+    double dutyCycle = 0.0;         // tHigh / período
+    uint64_t ciclos = 0;            // ciclos completos no tempo simulado
+    uint32_t leds = 0;              // saídas finais do CD4017
+    unsigned unidade = 0;
+    unsigned dezena = 0;
+};
+
+
+// Simula um único ponto; o índice é decomposto em (R1, R2, C, LimitReset), com LimitReset variando mais rápido
+inline PontoVarredura simularPonto(const ConfigVarredura& cfg, size_t indice) {
+    const size_t qtLimites = cfg.limiteMax - cfg.limiteMin + 1;
+
+    PontoVarredura p;
+    p.limitReset = cfg.limiteMin + static_cast<unsigned>(indice % qtLimites);
+    indice /= qtLimites;
+    p.C = cfg.c.valor(static_cast<unsigned>(indice % cfg.c.passos));
+    indice /= cfg.c.passos;
+    p.R2 = cfg.r2.valor(static_cast<unsigned>(indice % cfg.r2.passos));
+    indice /= cfg.r2.passos;
+    p.R1 = cfg.r1.valor(static_cast<unsigned>(indice));
+
+    auto lerPlaca = [&p](const auto& placa) {
+        p.ciclos = placa.getCiclos();
+        p.leds = placa.getChip4017().getOut();
+        p.unidade = placa.getUnidade().getOut();
+        p.dezena = placa.getDezena().getOut();
+    };
+
+    Chip555 chip555(p.R1, p.R2, p.C);
+    if (cfg.passoAPasso) {
+        // ciclo a ciclo, o custo está no pulso: a placa especializada no LimitReset não tem chamadas virtuais
+        uint64_t n = (cfg.tempo > 0) ? static_cast<uint64_t>(cfg.tempo / chip555.getPeriod()) : 0;
+        comPlacaEstatica(p.limitReset, [&](auto& placa) {
+            placa.stepCycles(n);
+            lerPlaca(placa);
+        });
+    } else {
+        MotorVirtual placa(p.limitReset, p.R1, p.R2, p.C);
+        placa.advanceFor(cfg.tempo);
+        lerPlaca(placa);
+    }
+
+    p.frequencia = chip555.getFrequency();
+    p.periodo = chip555.getPeriod();
+    p.dutyCycle = chip555.getTHigh() / chip555.getPeriod();
+    return p;
+}
+
+
+// Executa a grade inteira no pool; a ordem do vetor retornado é a ordem dos índices, independente do número de threads
+inline std::vector<PontoVarredura> executarVarredura(const ConfigVarredura& cfg, PoolThreads& pool) {
+    if (cfg.limiteMin < 1 || cfg.limiteMax > 10 || cfg.limiteMin > cfg.limiteMax) {
+        throw std::invalid_argument("LimitReset da varredura precisa estar entre 1 e 10.");
+    }
+
+    const size_t total = cfg.totalPontos();
+    std::vector<PontoVarredura> resultados(total);
+
+    // Blocos pequenos o bastante para balancear a carga, grandes o bastante para não disputar a fila
+    size_t bloco = std::max<size_t>(1, total / (pool.size() * 16));
+    pool.parallelFor(total, bloco, [&cfg, &resultados](size_t inicio, size_t fim) {
+        for (size_t i = inicio; i < fim; ++i) {
+            resultados[i] = simularPonto(cfg, i);
+        }
+    });
+    return resultados;
+}
+
+
+inline void salvarCsv(const std::vector<PontoVarredura>& pontos, const std::string& caminho) {
+    std::ofstream out(caminho);
+    if (!out) {
+        throw std::runtime_error("não foi possível criar " + caminho);
+    }
+    out.precision(10);
+    out << "R1,R2,C,LimitReset,frequencia_hz,periodo_s,duty_cycle,ciclos,leds,unidade,dezena\n";
+    for (const PontoVarredura& p : pontos) {
+        out << p.R1 << ',' << p.R2 << ',' << p.C << ',' << p.limitReset << ','
+            << p.frequencia << ',' << p.periodo << ',' << p.dutyCycle << ',' << p.ciclos << ','
+            << p.leds << ',' << p.unidade << ',' << p.dezena << '\n';
+    }
+}
+
+
+/*
+    Formato binário (little-endian): "AJVR", uint32 versão (1), uint64 quantidade de pontos e, para cada ponto,
+    R1, R2, C, frequência, período, duty (double), ciclos (uint64), leds (uint32), LimitReset, unidade, dezena (uint8).
+*/
+inline void salvarBinario(const std::vector<PontoVarredura>& pontos, const std::string& caminho) {
+    std::ofstream out(caminho, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("não foi possível criar " + caminho);
+    }
+
+    auto escreve = [&out](const auto& valor) {
+        out.write(reinterpret_cast<const char*>(&valor), sizeof(valor));
+    };
+
+    out.write("AJVR", 4);
+    escreve(uint32_t{1});
+    escreve(static_cast<uint64_t>(pontos.size()));
+    for (const PontoVarredura& p : pontos) {
+        escreve(p.R1); escreve(p.R2); escreve(p.C);
+        escreve(p.frequencia); escreve(p.periodo); escreve(p.dutyCycle);
+        escreve(p.ciclos);
+        escreve(p.leds);
+        escreve(static_cast<uint8_t>(p.limitReset));
+        escreve(static_cast<uint8_t>(p.unidade));
+        escreve(static_cast<uint8_t>(p.dezena));
+    }
+}
+
+
+inline std::vector<PontoVarredura> lerBinario(const std::string& caminho) {
+    std::ifstream in(caminho, std::ios::binary);
+    char magico[4] = {};
+    in.read(magico, 4);
+    if (!in || std::string(magico, 4) != "AJVR") {
+        throw std::runtime_error(caminho + " não é uma varredura binária do Apple Juice");
+    }
+
+    auto le = [&in](auto& valor) {
+        in.read(reinterpret_cast<char*>(&valor), sizeof(valor));
+    };
+
+    uint32_t versao = 0;
+    uint64_t quantidade = 0;
+    le(versao);
+    le(quantidade);
+    if (versao != 1) {
+        throw std::runtime_error("versão de varredura binária não suportada");
+    }
+
+    std::vector<PontoVarredura> pontos(quantidade);
+    for (PontoVarredura& p : pontos) {
+        uint8_t limite = 0, unidade = 0, dezena = 0;
+        le(p.R1); le(p.R2); le(p.C);
+        le(p.frequencia); le(p.periodo); le(p.dutyCycle);
+        le(p.ciclos);
+        le(p.leds);
+        le(limite); le(unidade); le(dezena);
+        p.limitReset = limite;
+        p.unidade = unidade;
+        p.dezena = dezena;
+    }
+    if (!in) {
+        throw std::runtime_error(caminho + " está truncado");
+    }
+    return pontos;
+}
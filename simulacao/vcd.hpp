@@ -0,0 +1,309 @@
+/*
+    Gravação dos sinais da placa em Value Change Dump (VCD), o formato aberto pelo GTKWave.
+
+    Sinais: CLK (saída do 555), carry entre os CD4026, os dígitos das unidades e dezenas (4 bits cada), os pinos a..g
+    de cada CD4026 (7 bits, g no bit mais alto, como o chip os entrega ao display) e cada saída do CD4017 (q0 é o
+    primeiro LED, aceso depois do reset). O tempo é o tempo simulado da placa, em nanossegundos:
+    o pulso k sobe em k * período (e os contadores mudam nessa borda) e desce tHigh depois.
+
+    O motor só copia um evento de 24 bytes para uma fila SPSC (AnelSpsc); uma thread de fundo tira os eventos da
+    fila, escreve apenas os sinais que mudaram e grava o arquivo em blocos grandes. A memória é limitada pela
+    capacidade da fila: quando ela enche, a política decide se o motor espera a gravação (Bloquear, para rastros
+    completos do modo virtual) ou descarta o evento e conta (Descartar, para o tempo real nunca atrasar).
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+
+#include "anelSpsc.hpp"
+
+
+enum class TipoEventoVcd : uint8_t {
+    Inicial,        // estado no início da gravação
+    Pulso,          // borda de subida do ciclo 'ciclo' (com o novo estado dos contadores) e a descida seguinte
+    Reset,          // reset pedido entre dois pulsos
+    Lote            // 'lote' ciclos até 'ciclo' aplicados em forma fechada, com o estado do último (só para a sonda)
+};
+
+struct EventoVcd {
+    uint64_t ciclo = 0;         // ciclos aplicados até aqui
+    uint32_t leds = 0;          // saídas do CD4017
+    uint32_t lote = 0;          // evento Lote: ciclos resumidos (satura em 2^32 - 1), todas as saídas do CD4017 acenderam
+    uint8_t unidade = 0;
+    uint8_t dezena = 0;
+    uint8_t segUnidade = 0;     // pinos a..g dos CD4026 (bit 0 = a)
+    uint8_t segDezena = 0;
+    uint8_t carry = 0;
+    uint8_t carryVariou = 0;    // evento Lote: o carry mudou dentro do lote
+    TipoEventoVcd tipo = TipoEventoVcd::Pulso;
+};
+
+
+class GravadorVcd {
+public:
+    enum class Politica { Bloquear, Descartar };
+
+    static constexpr size_t BlocoEscrita = 4 << 20;     // o arquivo é gravado em blocos de 4 MiB
+    static constexpr size_t LoteLeitura = 4096;         // eventos tirados da fila de uma vez
+
+private:
+    std::FILE* arquivo = nullptr;
+    unsigned qtLeds;
+    uint64_t periodoNs;
+    uint64_t tHighNs;
+    Politica politica;
+
+    AnelSpsc<EventoVcd> fila;
+    std::thread escritor;
+    std::atomic<bool> fechando{false};
+    std::atomic<bool> falhou{false};
+    bool fechado = false;
+
+    // Contadores do produtor (motor) e do escritor
+    std::atomic<uint64_t> aceitos{0};
+    std::atomic<uint64_t> perdidos{0};
+    std::atomic<uint64_t> gravados{0};
+
+    // Estado do escritor
+    std::vector<char> buffer;
+    size_t usado = 0;
+    EventoVcd ultimo;
+
+    static char idClk()   { return '!'; }
+    static char idCarry() { return '"'; }
+    static char idUnidade() { return '#'; }
+    static char idDezena()  { return '$'; }
+    static char idLed(unsigned i) { return static_cast<char>('%' + i); }     // '%' a '.'
+    static char idSegUnidade() { return '/'; }
+    static char idSegDezena()  { return ':'; }
+
+    void put(char c) {
+        buffer[usado++] = c;
+    }
+
+    void put(const char* s) {
+        size_t n = std::strlen(s);
+        std::memcpy(&buffer[usado], s, n);
+        usado += n;
+    }
+
+    void putNumero(uint64_t v) {
+        char tmp[20];
+        int n = 0;
+        do {
+            tmp[n++] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        } while (v);
+        while (n) {
+            put(tmp[--n]);
+        }
+    }
+
+    void putTempo(uint64_t ns) {
+        put('#');
+        putNumero(ns);
+        put('\n');
+    }
+
+    void putBit(bool v, char id) {
+        put(v ? '1' : '0');
+        put(id);
+        put('\n');
+    }
+
+    void putVetor(uint8_t v, int bits, char id) {
+        put('b');
+        for (int b = bits - 1; b >= 0; --b) {
+            put(((v >> b) & 1) ? '1' : '0');
+        }
+        put(' ');
+        put(id);
+        put('\n');
+    }
+
+    // Sinais que mudaram entre 'ultimo' e 'e' (todos, se 'tudo')
+    void putMudancas(const EventoVcd& e, bool tudo) {
+        uint32_t diferenca = tudo ? ~0u : (e.leds ^ ultimo.leds);
+        for (unsigned i = 0; i < qtLeds; ++i) {
+            unsigned bit = qtLeds - 1 - i;
+            if ((diferenca >> bit) & 1u) {
+                putBit((e.leds >> bit) & 1u, idLed(i));
+            }
+        }
+        if (tudo || e.unidade != ultimo.unidade) putVetor(e.unidade, 4, idUnidade());
+        if (tudo || e.dezena != ultimo.dezena)   putVetor(e.dezena, 4, idDezena());
+        if (tudo || e.segUnidade != ultimo.segUnidade) putVetor(e.segUnidade, 7, idSegUnidade());
+        if (tudo || e.segDezena != ultimo.segDezena)   putVetor(e.segDezena, 7, idSegDezena());
+        if (tudo || e.carry != ultimo.carry)     putBit(e.carry != 0, idCarry());
+        ultimo = e;
+    }
+
+    void cabecalho() {
+        put("$version Simulador Apple Juice $end\n$timescale 1ns $end\n$scope module apple_juice $end\n");
+        put("$var wire 1 ! clk $end\n$var wire 1 \" carry $end\n");
+        put("$var wire 4 # unidade [3:0] $end\n$var wire 4 $ dezena [3:0] $end\n");
+        put("$var wire 7 / seg_unidade [6:0] $end\n$var wire 7 : seg_dezena [6:0] $end\n");
+        for (unsigned i = 0; i < qtLeds; ++i) {
+            put("$var wire 1 ");
+            put(idLed(i));
+            put(" q");
+            putNumero(i);
+            put(" $end\n");
+        }
+        put("$upscope $end\n$enddefinitions $end\n");
+    }
+
+    void formatar(const EventoVcd& e) {
+        uint64_t base = e.ciclo * periodoNs;
+        switch (e.tipo) {
+            case TipoEventoVcd::Inicial:
+                putTempo(e.ciclo ? base + tHighNs : 0);
+                put("$dumpvars\n");
+                putBit(false, idClk());
+                putMudancas(e, true);
+                put("$end\n");
+                break;
+            case TipoEventoVcd::Pulso:
+                putTempo(base);
+                putBit(true, idClk());
+                putMudancas(e, false);
+                putTempo(base + tHighNs);
+                putBit(false, idClk());
+                break;
+            case TipoEventoVcd::Reset:
+                putTempo(base + (tHighNs + periodoNs) / 2);
+                putMudancas(e, false);
+                break;
+            case TipoEventoVcd::Lote:
+                // o motor não resume lotes quando grava VCD; se chegar um, vira um salto para o estado final
+                putTempo(base);
+                putMudancas(e, false);
+                break;
+        }
+    }
+
+    // Grava os blocos completos; 'tudo' grava também o resto (ao fechar)
+    void descarregar(bool tudo) {
+        size_t n = tudo ? usado : (usado / BlocoEscrita) * BlocoEscrita;
+        if (n == 0) {
+            return;
+        }
+        if (std::fwrite(buffer.data(), 1, n, arquivo) != n) {
+            falhou.store(true);
+        }
+        std::memmove(buffer.data(), buffer.data() + n, usado - n);
+        usado -= n;
+    }
+
+    void executar() {
+        std::vector<EventoVcd> lote(LoteLeitura);
+        cabecalho();
+        while (true) {
+            size_t n = fila.popBatch(lote.data(), lote.size());
+            if (n == 0) {
+                if (fechando.load(std::memory_order_acquire) && fila.empty()) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                continue;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                formatar(lote[i]);
+                // um evento ocupa menos de 200 bytes: a folga de 4 KiB do buffer cobre o que passar do bloco
+                if (usado >= BlocoEscrita) {
+                    descarregar(false);
+                }
+            }
+            gravados.store(gravados.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+        descarregar(true);
+    }
+
+    void finalizar() {
+        if (fechado) {
+            return;
+        }
+        fechado = true;
+        fechando.store(true, std::memory_order_release);
+        if (escritor.joinable()) {
+            escritor.join();
+        }
+        if (std::fclose(arquivo) != 0) {
+            falhou.store(true);
+        }
+    }
+
+public:
+    GravadorVcd(const std::string& caminho, unsigned leds, double periodo, double tHigh,
+                Politica p = Politica::Bloquear, size_t capacidade = 1 << 16)
+        : qtLeds(leds),
+          periodoNs(static_cast<uint64_t>(std::llround(periodo * 1e9))),
+          tHighNs(static_cast<uint64_t>(std::llround(tHigh * 1e9))),
+          politica(p),
+          fila(capacidade),
+          buffer(BlocoEscrita + 4096) {
+        if (leds < 1 || leds > 10) {
+            throw std::invalid_argument("o VCD grava de 1 a 10 saídas do CD4017");
+        }
+        if (periodoNs == 0) {
+            throw std::invalid_argument("período do 555 abaixo da resolução do VCD (1 ns)");
+        }
+        arquivo = std::fopen(caminho.c_str(), "wb");
+        if (!arquivo) {
+            throw std::runtime_error("não foi possível criar " + caminho);
+        }
+        std::setvbuf(arquivo, nullptr, _IONBF, 0);     // os blocos já são grandes: cada um vira uma única escrita
+        escritor = std::thread([this] { executar(); });
+    }
+
+    GravadorVcd(const GravadorVcd&) = delete;
+    GravadorVcd& operator=(const GravadorVcd&) = delete;
+
+    ~GravadorVcd() {
+        finalizar();
+    }
+
+    // Produtor (thread do motor): entrega um evento conforme a política da fila cheia
+    void record(const EventoVcd& e) {
+        // contadores com um único escritor: load + store, sem instruções com trava
+        if (!fila.tryPush(e)) {
+            if (politica == Politica::Descartar) {
+                perdidos.store(perdidos.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return;
+            }
+            while (!fila.tryPush(e)) {
+                std::this_thread::yield();
+            }
+        }
+        aceitos.store(aceitos.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Espera a fila esvaziar, grava o resto e fecha o arquivo; lança runtime_error se alguma escrita falhou
+    void close() {
+        finalizar();
+        if (falhou.load()) {
+            throw std::runtime_error("falha ao gravar o arquivo VCD");
+        }
+    }
+
+    uint64_t events() const {
+        return aceitos.load(std::memory_order_relaxed);
+    }
+
+    uint64_t dropped() const {
+        return perdidos.load(std::memory_order_relaxed);
+    }
+
+    uint64_t written() const {
+        return gravados.load(std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,1769 @@
+/*
+    Testes do motor de simulação — Simulador Apple Juice
+    Diferente de testes.cpp, aqui os chips não são copiados: os testes usam diretamente os headers de simulacao/,
+    que não dependem da raylib.
+
+    Compilação: g++ testes-simulacao.cpp -o testes-simulacao -std=c++17 -lpthread
+    Execução:   ./testes-simulacao
+*/
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <filesystem>
+#ifdef _WIN32
+    #include <process.h>            // _getpid
+#else
+    #include <unistd.h>             // getpid
+#endif
+
+#include "../simulacao/chips.hpp"
+#include "../simulacao/motorVirtual.hpp"
+#include "../simulacao/lote.hpp"
+#include "../simulacao/varredura.hpp"
+#include "../simulacao/poolThreads.hpp"
+#include "../simulacao/seqlock.hpp"
+#include "../simulacao/instrumentacao.hpp"
+#include "../simulacao/vcd.hpp"
+#include "../simulacao/anelSpsc.hpp"
+#include "../simulacao/rastroPeriodico.hpp"
+#include "../simulacao/analisador.hpp"
+#include "../simulacao/netlist.hpp"
+#include "../simulacao/chipsEstaticos.hpp"
+#include "../simulacao/contadorBcd.hpp"
+#include "../simulacao/cascata4017.hpp"
+#include "../simulacao/analogico555.hpp"
+#include "../simulacao/monteCarlo.hpp"
+#include "../simulacao/rodaTempo.hpp"
+#include "../simulacao/placaEventos.hpp"
+#include "../simulacao/clockExterno.hpp"
+#include "../simulacao/portas4017.hpp"
+#include "../simulacao/portas4026.hpp"
+#include "../simulacao/atrasos.hpp"
+
+// ─── Infraestrutura de testes ────────────────────────────────────────────────
+
+static int totalTestes = 0;
+static int totalPassou = 0;
+
+static void check(bool condicao, const std::string& descricao) {
+    totalTestes++;
+    if (condicao) {
+        std::cout << "  [OK] " << descricao << "\n";
+        totalPassou++;
+    } else {
+        std::cout << "  [FALHOU] " << descricao << "\n";
+    }
+}
+
+// Caminho no diretório temporário com o pid no nome: execuções simultâneas dos testes não disputam os arquivos
+static std::string caminhoTemporario(const std::string& nome) {
+#ifdef _WIN32
+    const int pid = _getpid();
+#else
+    const int pid = static_cast<int>(getpid());
+#endif
+    return (std::filesystem::temp_directory_path() / ("apple-juice-" + std::to_string(pid) + "-" + nome)).string();
+}
+
+// ─── Testes ──────────────────────────────────────────────────────────────────
+
+void testarMotorVirtual() {
+    std::cout << "\n[MotorVirtual]\n";
+
+    MotorVirtual m(4, 1000.0, 10000.0, 7.37e-6);
+    double periodo = m.getChip555().getPeriod();
+
+    m.step();
+    check(m.getCiclos() == 1, "step() executa um ciclo");
+    check(m.getChip4017().getOut() == 0b0100, "step() desloca o CD4017");
+    check(m.getUnidade().getOut() == 1, "step() incrementa as unidades");
+
+    // 1 hora de placa (~ 20 mil ciclos) não pode levar 1 hora de verdade
+    RelatorioSimulacao r = m.runFor(3600.0);
+    check(r.ciclos == static_cast<uint64_t>(3600.0 / periodo), "runFor() executa floor(tempo / período) ciclos");
+    check(r.tempoReal < 1.0, "uma hora simulada leva menos de 1 s em modo virtual");
+    check(std::fabs(m.getTempoSimulado() - (r.ciclos + 1) * periodo) < 1e-6, "tempo simulado acumula o período do 555");
+
+    uint64_t total = m.getCiclos();
+    check(m.getUnidade().getOut() == total % 10, "unidades == ciclos mod 10");
+    check(m.getDezena().getOut() == (total / 10) % 10, "dezenas == (ciclos / 10) mod 10");
+    check(m.getChip4017().getOut() == (1u << (3 - total % 4)), "CD4017 na posição ciclos mod LimitReset");
+
+    m.resetDisplays();
+    check(m.getUnidade().getOut() == 0 && m.getDezena().getOut() == 0, "resetDisplays() zera os CD4026");
+
+    m.reset();
+    check(m.getChip4017().getOut() == 0b1000, "reset() restaura o CD4017");
+
+    // No modo de tempo real o motor respeita o período do 555
+    MotorVirtual real(4, 100.0, 100.0, 1e-5, ModoTempo::TempoReal);   // T ~ 2 ms
+    RelatorioSimulacao rr = real.runCycles(5);
+    check(rr.tempoReal >= 0.9 * rr.tempoSimulado, "modo de tempo real não adianta o relógio");
+}
+
+void testarAdvance() {
+    std::cout << "\n[advance() em forma fechada]\n";
+
+    // CD4017: advance(n) deve coincidir com n shifts para todos os LimitReset
+    bool anelOk = true;
+    for (unsigned limite = 1; limite <= 10; ++limite) {
+        for (uint64_t n = 0; n < 37; ++n) {
+            Chip4017 passo(limite), salto(limite);
+            passo.shift();                  // parte de uma posição diferente do reset
+            salto.shift();
+            for (uint64_t i = 0; i < n; ++i) passo.shift();
+            salto.advance(n);
+            anelOk = anelOk && (passo.getOut() == salto.getOut());
+        }
+    }
+    check(anelOk, "Chip4017::advance(n) == n x shift() para LimitReset 1..10");
+
+    Chip4017 grande(7);
+    grande.advance(1000000000ull);
+    check(grande.getPosition() == 1000000000ull % 7, "Chip4017::advance(10^9) cai na posição 10^9 mod 7");
+
+    // CD4026: dígito e quantidade de carries
+    Unidade u;
+    for (int i = 0; i < 3; ++i) u.add();
+    uint64_t carries = u.advance(28);
+    check(u.getOut() == 1 && carries == 3, "Chip4026::advance(28) a partir de 3 -> 1 com 3 carries");
+    check(u.getCarryOut() == false, "carryOut final igual ao do último add()");
+    u.advance(9);
+    check(u.getOut() == 0 && u.getCarryOut() == true, "advance que termina em 0 deixa carryOut ativo");
+    check(u.advance(0) == 0 && u.getOut() == 0 && u.getCarryOut(), "advance(0) não altera o chip");
+
+    Dezena d;
+    check(d.advanceOnCarries(23) == 2 && d.getOut() == 3, "Dezena::advanceOnCarries repassa os próprios carries");
+
+    // Placa inteira: salto e passo a passo devem mostrar o mesmo estado
+    bool placaOk = true;
+    for (unsigned leds = 1; leds <= 10; ++leds) {
+        MotorVirtual passo(leds, 1000.0, 10000.0, 7.37e-6);
+        MotorVirtual salto(leds, 1000.0, 10000.0, 7.37e-6);
+        for (int i = 0; i < 1234; ++i) passo.step();
+        salto.advance(1000);
+        salto.advance(234);
+        placaOk = placaOk && passo.getChip4017().getOut() == salto.getChip4017().getOut()
+                          && passo.getUnidade().getOut() == salto.getUnidade().getOut()
+                          && passo.getDezena().getOut()  == salto.getDezena().getOut()
+                          && passo.getUnidade().getCarryOut() == salto.getUnidade().getCarryOut()
+                          && passo.getCiclos() == salto.getCiclos();
+    }
+    check(placaOk, "MotorVirtual::advance() == step() repetido para todos os LimitReset");
+
+    MotorVirtual m(4, 1000.0, 10000.0, 7.37e-6);
+    uint64_t estouros = m.advance(1000000000ull);
+    check(estouros == 10000000ull, "10^9 ciclos estouram o display 10^7 vezes");
+    check(m.getUnidade().getOut() == 0 && m.getDezena().getOut() == 0, "10^9 ciclos deixam o display em 00");
+    check(std::fabs(m.getTempoSimulado() - 1e9 * m.getChip555().getPeriod()) < 1e-3, "advance() soma o tempo simulado");
+}
+
+void testarLotePlacas() {
+    std::cout << "\n[LotePlacas (" << LotePlacas::kernel() << ")]\n";
+
+    // 37 placas: não é múltiplo da largura do vetor, então o preenchimento também é exercitado
+    std::vector<unsigned> limites;
+    for (unsigned i = 0; i < 37; ++i) limites.push_back(1 + i % 10);
+
+    LotePlacas lote(limites);
+    std::vector<std::unique_ptr<MotorVirtual>> placas;
+    for (unsigned limite : limites) placas.push_back(std::make_unique<MotorVirtual>(limite, 1000.0, 10000.0, 7.37e-6));
+
+    bool iguais = true;
+    for (int c = 0; c < 1234; ++c) {
+        lote.step();
+        for (size_t i = 0; i < placas.size(); ++i) {
+            placas[i]->step();
+            iguais = iguais && placas[i]->getChip4017().getOut() == lote.getOut(i)
+                            && placas[i]->getUnidade().getOut()  == lote.getUnidade(i)
+                            && placas[i]->getDezena().getOut()   == lote.getDezena(i);
+        }
+    }
+    check(lote.size() == 37, "size() ignora o preenchimento");
+    check(iguais, "kernel do lote == MotorVirtual em todos os pulsos");
+
+    lote.reset();
+    check(lote.getOut(9) == (1u << 9) && lote.getUnidade(9) == 0 && lote.getDezena(9) == 0, "reset() restaura todas as placas");
+
+    bool lancou = false;
+    try { LotePlacas invalido({3, 11}); } catch (const std::invalid_argument&) { lancou = true; }
+    check(lancou, "LimitReset fora de 1..10 lança invalid_argument");
+}
+
+void testarVarredura() {
+    std::cout << "\n[Varredura de parâmetros]\n";
+
+    Faixa log = Faixa::ler("1e3:1e5:3:log");
+    check(log.passos == 3 && std::fabs(log.valor(1) - 1e4) < 1e-6, "faixa logarítmica passa pelo meio geométrico");
+    check(Faixa::ler("42").valor(0) == 42.0, "valor único vira faixa de 1 passo");
+
+    bool lancou = false;
+    try { Faixa::ler("1:2"); } catch (const std::invalid_argument&) { lancou = true; }
+    check(lancou, "faixa mal formada lança invalid_argument");
+
+    ConfigVarredura cfg;
+    cfg.r1 = Faixa::ler("1e3:5e3:3");
+    cfg.r2 = Faixa::ler("1e4:2e4:2");
+    cfg.c  = Faixa::ler("1e-6:1e-5:2:log");
+    cfg.limiteMin = 2;
+    cfg.limiteMax = 5;
+    cfg.tempo = 60.0;
+    check(cfg.totalPontos() == 3 * 2 * 2 * 4, "totalPontos() é o produto das faixas");
+
+    PoolThreads um(1), quatro(4);
+    std::vector<PontoVarredura> serial = executarVarredura(cfg, um);
+    std::vector<PontoVarredura> paralela = executarVarredura(cfg, quatro);
+
+    // Cada ponto deve ser idêntico a uma placa simulada isoladamente, passo a passo
+    bool iguais = serial.size() == paralela.size();
+    for (size_t i = 0; iguais && i < serial.size(); ++i) {
+        const PontoVarredura& p = paralela[i];
+        MotorVirtual placa(p.limitReset, p.R1, p.R2, p.C);
+        placa.runFor(cfg.tempo);
+        iguais = p.R1 == serial[i].R1 && p.C == serial[i].C && p.limitReset == serial[i].limitReset
+              && p.ciclos == placa.getCiclos() && p.leds == placa.getChip4017().getOut()
+              && p.unidade == placa.getUnidade().getOut() && p.dezena == placa.getDezena().getOut();
+    }
+    check(iguais, "varredura paralela == serial == MotorVirtual ponto a ponto");
+
+    ConfigVarredura cfgPasso = cfg;
+    cfgPasso.passoAPasso = true;
+    std::vector<PontoVarredura> passo = executarVarredura(cfgPasso, quatro);
+    bool mesmos = passo.size() == serial.size();
+    for (size_t i = 0; mesmos && i < passo.size(); ++i) {
+        mesmos = passo[i].ciclos == serial[i].ciclos && passo[i].leds == serial[i].leds
+              && passo[i].unidade == serial[i].unidade && passo[i].dezena == serial[i].dezena;
+    }
+    check(mesmos, "varredura passo a passo (PlacaEstatica) == forma fechada");
+    check(std::fabs(serial[0].dutyCycle - 11.0 / 21.0) < 1e-9, "duty cycle = (R1 + R2) / (R1 + 2 R2)");
+
+    const std::string arquivo = caminhoTemporario("varredura-teste.bin");
+    std::vector<PontoVarredura> lidos;
+    try {
+        salvarBinario(paralela, arquivo);
+        lidos = lerBinario(arquivo);
+    } catch (const std::exception& e) {
+        std::cout << "  (" << e.what() << ")\n";
+    }
+    std::remove(arquivo.c_str());
+    check(!lidos.empty() && lidos.size() == paralela.size() && lidos.back().R1 == paralela.back().R1
+          && lidos.back().leds == paralela.back().leds && lidos.back().dezena == paralela.back().dezena,
+          "formato binário faz ida e volta sem perdas");
+
+    lancou = false;
+    try {
+        quatro.parallelFor(10, 1, [](size_t inicio, size_t) {
+            if (inicio == 7) throw std::runtime_error("falha no bloco 7");
+        });
+    } catch (const std::runtime_error&) { lancou = true; }
+    check(lancou, "exceção de uma tarefa é relançada por PoolThreads::wait()");
+}
+
+/*
+    Teste de estresse do SeqLock: o motor publica a cada pulso em modo virtual (milhões de pulsos por segundo)
+    enquanto outra thread lê sem parar. Toda cópia lida precisa ser coerente com o seu próprio número de ciclos.
+*/
+void testarSeqLock() {
+    std::cout << "\n[SeqLock / EstadoPlaca sob estresse]\n";
+
+    const unsigned limite = 7;
+    const uint64_t pulsos = 5000000;
+
+    MotorVirtual m(limite, 1000.0, 10000.0, 7.37e-6);
+    SeqLock<EstadoPlaca> estado;
+    m.setPublicador(&estado);
+
+    std::atomic<bool> escrevendo{true};
+    uint64_t leituras = 0, rasgadas = 0, retrocessos = 0, ultimo = 0;
+
+    std::thread leitor([&] {
+        while (escrevendo.load(std::memory_order_relaxed)) {
+            EstadoPlaca e = estado.load();
+            bool coerente = e.unidade == e.ciclos % 10
+                         && e.dezena == (e.ciclos / 10) % 10
+                         && e.leds == (1u << (limite - 1 - e.ciclos % limite))
+                         && e.carry == (e.ciclos > 0 && e.unidade == 0);
+            rasgadas += coerente ? 0 : 1;
+            retrocessos += (e.ciclos < ultimo) ? 1 : 0;
+            ultimo = e.ciclos;
+            leituras++;
+        }
+    });
+
+    RelatorioSimulacao r = m.runCycles(pulsos);
+    escrevendo.store(false);
+    leitor.join();
+
+    std::cout << "  (" << r.ciclosPorSegundo / 1e6 << " M pulsos/s publicados, " << leituras << " leituras)\n";
+    check(r.ciclos == pulsos, "motor publicou todos os pulsos");
+    check(leituras > 0, "leitor conseguiu ler durante as escritas");
+    check(rasgadas == 0, "nenhuma leitura com estado rasgado");
+    check(retrocessos == 0, "o número de ciclos lido nunca volta atrás");
+    check(estado.version() >= pulsos, "version() conta as publicações");
+    check(estado.load().ciclos == pulsos, "última leitura vê o último estado publicado");
+
+    // Pedidos de reset feitos de fora são aplicados pela thread dona dos chips
+    m.requestResetDisplays();
+    check(m.getUnidade().getOut() == pulsos % 10, "pedido de reset não mexe nos chips sozinho");
+    check(m.processRequests() && estado.load().unidade == 0 && estado.load().leds == m.getChip4017().getOut(),
+          "processRequests() aplica e publica o reset dos displays");
+    m.requestReset();
+    m.processRequests();
+    check(estado.load().leds == (1u << (limite - 1)), "processRequests() aplica o reset geral");
+    check(!m.processRequests(), "sem pedidos pendentes, processRequests() não faz nada");
+}
+
+void testarRelogioTempoReal() {
+    std::cout << "\n[Relógio de tempo real com prazos absolutos]\n";
+
+    /*
+        Os limites de tempo de parede aqui são só os que a carga da máquina não quebra: o motor nunca adianta o
+        relógio. Quanto ele atrasa depende do agendador; a precisão do clock é medida no bench e no HUD.
+    */
+
+    // ~100 Hz: caminho borda a borda, com prazos absolutos
+
+    {
+        MotorVirtual m(10, 1000.0, 10000.0, 6.86e-7, ModoTempo::TempoReal);
+        const double periodo = m.getChip555().getPeriod();
+        const uint64_t n = 50;
+        m.resync();
+        RelatorioSimulacao r = m.runCycles(n);
+        double esperado = n * periodo;
+        std::cout << "  (" << n << " ciclos de " << periodo * 1e3 << " ms em " << r.tempoReal << " s)\n";
+        check(r.ciclos == n, "modo real borda a borda entrega todos os ciclos pedidos");
+        check(r.tempoReal >= esperado * 0.99, "modo real borda a borda não termina antes de n * período");
+    }
+
+    // ~100 kHz: caminho em lotes. Os ciclos aplicados seguem o relógio de parede e a frequência medida, a nominal.
+    {
+        MotorVirtual m(10, 1000.0, 10000.0, 6.86e-10, ModoTempo::TempoReal);
+        const double f = m.getChip555().getFrequency();
+        check(m.getChip555().getPeriod() < MotorVirtual::QuantumLote, "período abaixo do quantum usa o caminho em lotes");
+
+        m.resync();
+        RelatorioSimulacao r = m.runFor(0.6);
+        std::cout << "  (" << r.ciclos << " ciclos em " << r.tempoReal << " s, medido "
+                  << m.getMeasuredFrequency() << " Hz de " << f << " Hz)\n";
+        check(r.ciclos == static_cast<uint64_t>(0.6 / m.getChip555().getPeriod()), "modo em lotes entrega exatamente os ciclos pedidos");
+        check(r.ciclos <= r.tempoReal * f + 1, "ciclos aplicados nunca passam de tempo decorrido * f");
+        check(std::abs(m.getMeasuredFrequency() - f) <= 0.25 * f, "frequência medida ~ frequência nominal");
+        check(m.getUnidade().getOut() == r.ciclos % 10 && m.getChip4017().getOut() == (1u << (9 - r.ciclos % 10)),
+              "estado dos chips após os lotes igual ao de n pulsos");
+    }
+
+    // tHigh de ~1 s: um pedido feito no começo da espera pela descida acorda o motor na hora, não na borda
+    {
+        MotorVirtual m(10, 100000.0, 1000.0, 1.4e-5, ModoTempo::TempoReal);
+        SeqLock<EstadoPlaca> estado;
+        m.setPublicador(&estado);
+        m.setSwitch(ChaveClock::Externo);
+        m.resync();
+        std::thread motor([&] { m.runCycles(1); });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto pedido = std::chrono::steady_clock::now();
+        m.addExternalPulses(3);
+        while (estado.load().unidade != 3 && std::chrono::steady_clock::now() - pedido < std::chrono::seconds(2)) {
+            std::this_thread::yield();
+        }
+        std::chrono::duration<double> espera = std::chrono::steady_clock::now() - pedido;
+        motor.join();
+        std::cout << "  (pedido aplicado em " << espera.count() * 1e3 << " ms, tHigh "
+                  << m.getChip555().getTHigh() * 1e3 << " ms)\n";
+        check(m.getUnidade().getOut() == 3, "pulsos externos pedidos durante a espera chegam aos displays");
+        check(espera.count() < m.getChip555().getTHigh() / 2, "pedido aplicado sem esperar a próxima borda do 555");
+    }
+}
+
+void testarInstrumentacao() {
+    std::cout << "\n[Instrumentação: histogramas de tempo]\n";
+
+    // Cada valor cai numa classe cujo limite inferior é <= valor e cujo erro relativo é no máximo 1/8
+    bool classesOk = true;
+    for (uint64_t v : std::vector<uint64_t>{0, 1, 7, 8, 9, 15, 16, 1000, 123456789, uint64_t(1) << 40, UINT64_MAX}) {
+        unsigned k = Histograma::classe(v);
+        uint64_t inf = Histograma::limiteInferior(k);
+        classesOk = classesOk && k < Histograma::Classes && inf <= v && (v - inf) <= v / 8;
+        classesOk = classesOk && (k + 1 >= Histograma::Classes || Histograma::limiteInferior(k + 1) > v);
+    }
+    check(classesOk, "classe() e limiteInferior() são consistentes em toda a faixa de 64 bits");
+
+    // 1..10000 us uniformes: os percentis ficam a no máximo 12,5% do valor exato
+    Histograma h;
+    for (uint64_t us = 1; us <= 10000; ++us) {
+        h.record(us * 1000);
+    }
+    ResumoHistograma r = h.summary();
+    check(r.contagem == 10000 && r.minimo == 1.0 && r.maximo == 10000.0, "contagem, mínimo e máximo exatos");
+    check(std::abs(r.media - 5000.5) < 1e-6, "média exata");
+    check(std::abs(r.p50 - 5000) <= 625 && std::abs(r.p99 - 9900) <= 1238, "p50 e p99 dentro do erro das classes");
+    check(r.p50 <= r.p90 && r.p90 <= r.p99 && r.p99 <= r.p999 && r.p999 <= r.maximo, "percentis em ordem");
+
+    // Um escritor e um leitor simultâneos (como motor e HUD): o leitor nunca vê contagem maior que a escrita
+    Histograma concorrente;
+    std::atomic<bool> escrevendo{true};
+    uint64_t leiturasIncoerentes = 0;
+    std::thread leitor([&] {
+        while (escrevendo.load(std::memory_order_relaxed)) {
+            ResumoHistograma s = concorrente.summary();
+            leiturasIncoerentes += (s.contagem > 1000000) ? 1 : 0;
+        }
+    });
+    for (uint64_t i = 0; i < 1000000; ++i) {
+        concorrente.record(i);
+    }
+    escrevendo.store(false);
+    leitor.join();
+    check(leiturasIncoerentes == 0 && concorrente.count() == 1000000, "registro concorrente com leitura sem travas");
+
+    // No modo de tempo real, o motor registra um erro por intervalo entre subidas do clock
+    Instrumentacao medidas;
+    MotorVirtual m(10, 1000.0, 10000.0, 6.86e-7, ModoTempo::TempoReal);
+    m.setHistogramaPulso(&medidas.erroPulso);
+    m.resync();
+    m.runCycles(20);
+    ResumoHistograma e = medidas.erroPulso.summary();
+    check(e.contagem == 19, "motor registra n - 1 intervalos em n ciclos");
+    check(e.p50 < m.getChip555().getPeriod() * 1e6, "erro mediano menor que um período");
+
+    // Exportação: CSV com uma linha por medida e JSON com resumo e classes
+    const std::string arquivoCsv = caminhoTemporario("metricas_teste.csv");
+    const std::string arquivoJson = caminhoTemporario("metricas_teste.json");
+    try {
+        salvarMetricas(medidas, arquivoCsv);
+        salvarMetricas(medidas, arquivoJson, "teste \"aspas\"");
+    } catch (const std::exception& e) {
+        std::cout << "  (" << e.what() << ")\n";
+    }
+    std::ifstream csv(arquivoCsv);
+    std::string linha;
+    int linhas = 0;
+    bool temPulso = false;
+    while (std::getline(csv, linha)) {
+        linhas++;
+        temPulso = temPulso || linha.rfind("erro_pulso,19,", 0) == 0;
+    }
+    check(linhas == 5 && temPulso, "CSV tem cabeçalho e uma linha por medida");
+    std::ifstream json(arquivoJson);
+    std::string conteudo((std::istreambuf_iterator<char>(json)), std::istreambuf_iterator<char>());
+    check(conteudo.find("\"erro_pulso\": {\"contagem\": 19") != std::string::npos
+          && conteudo.find("teste \\\"aspas\\\"") != std::string::npos, "JSON tem as medidas e escapa a descrição");
+    csv.close();
+    json.close();
+    std::remove(arquivoCsv.c_str());
+    std::remove(arquivoJson.c_str());
+}
+
+void testarVcd() {
+    std::cout << "\n[Fila SPSC e gravação em VCD]\n";
+
+    // A fila entrega tudo, em ordem, entre duas threads, mesmo pequena (produtor espera quando enche)
+    {
+        AnelSpsc<uint64_t> anel(64);
+        const uint64_t total = 2000000;
+        bool emOrdem = true;
+        uint64_t recebidos = 0;
+        std::thread consumidor([&] {
+            uint64_t lote[32];
+            while (recebidos < total) {
+                size_t n = anel.popBatch(lote, 32);
+                for (size_t i = 0; i < n; ++i) {
+                    emOrdem = emOrdem && lote[i] == recebidos + i;
+                }
+                recebidos += n;
+                if (n == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        for (uint64_t i = 0; i < total; ++i) {
+            while (!anel.tryPush(i)) {
+                std::this_thread::yield();
+            }
+        }
+        consumidor.join();
+        check(emOrdem && recebidos == total && anel.empty(), "AnelSpsc entrega todos os itens em ordem");
+
+        bool rejeitou = false;
+        try {
+            AnelSpsc<int> invalido(100);
+        } catch (const std::invalid_argument&) {
+            rejeitou = true;
+        }
+        check(rejeitou, "capacidade que não é potência de 2 lança invalid_argument");
+    }
+
+    const std::string arquivoRastro = caminhoTemporario("rastro_teste.vcd");
+    const std::string arquivoDescarte = caminhoTemporario("rastro_descarte.vcd");
+    const std::string arquivoCascata = caminhoTemporario("rastro_cascata.vcd");
+    try {
+        // Rastro completo (Bloquear) com fila pequena: relendo o VCD chega-se ao mesmo estado do motor
+        {
+            const unsigned limite = 7;
+            MotorVirtual m(limite, 1000.0, 10000.0, 7.37e-6);
+            GravadorVcd vcd(arquivoRastro, limite, m.getChip555().getPeriod(), m.getChip555().getTHigh(),
+                            GravadorVcd::Politica::Bloquear, 256);
+            m.setRastro(&vcd);
+            m.runCycles(12345);
+            m.resetDisplays();
+            m.advance(678);                 // com rastro, advance() também grava cada pulso
+            m.setRastro(nullptr);
+            vcd.close();
+            check(vcd.written() == 1 + 12345 + 1 + 678 && vcd.dropped() == 0, "todos os eventos foram gravados");
+
+            // reconstrói os sinais a partir das mudanças
+            std::ifstream in(arquivoRastro);
+            std::string linha;
+            int clk = -1, subidas = 0;
+            unsigned leds = 0, unidade = 99, dezena = 99, segUnidade = 0, segDezena = 0;
+            uint64_t ultimoTempo = 0;
+            bool tempoCresce = true, definicoes = false;
+            while (std::getline(in, linha)) {
+                if (linha == "$enddefinitions $end") {
+                    definicoes = true;
+                } else if (linha[0] == '#') {
+                    uint64_t t = std::stoull(linha.substr(1));
+                    tempoCresce = tempoCresce && t >= ultimoTempo;
+                    ultimoTempo = t;
+                } else if (linha[0] == 'b') {
+                    size_t espaco = linha.find(' ');
+                    unsigned v = static_cast<unsigned>(std::stoul(linha.substr(1, espaco - 1), nullptr, 2));
+                    char id = linha[espaco + 1];
+                    (id == '#' ? unidade : id == '$' ? dezena : id == '/' ? segUnidade : segDezena) = v;
+                } else if ((linha[0] == '0' || linha[0] == '1') && linha.size() == 2) {
+                    bool v = linha[0] == '1';
+                    char id = linha[1];
+                    if (id == '!') {
+                        subidas += (v && clk == 0) ? 1 : 0;
+                        clk = v;
+                    } else if (id >= '%' && id < '%' + (int)limite) {
+                        unsigned bit = limite - 1 - static_cast<unsigned>(id - '%');
+                        leds = v ? (leds | (1u << bit)) : (leds & ~(1u << bit));
+                    }
+                }
+            }
+            check(definicoes && tempoCresce, "cabeçalho válido e tempos em ordem crescente");
+            check(subidas == 12345 + 678, "uma subida de CLK por pulso");
+            check(leds == m.getChip4017().getOut() && unidade == m.getUnidade().getOut() && dezena == m.getDezena().getOut(),
+                  "estado final relido do VCD igual ao do motor");
+            check(segUnidade == m.getUnidade().getSegments() && segDezena == m.getDezena().getSegments(),
+                  "segmentos a..g dos CD4026 gravados no VCD");
+        }
+
+        // Descartar: o produtor nunca espera; cada evento é gravado ou contado como descartado
+        {
+            MotorVirtual m(4, 1000.0, 10000.0, 7.37e-6);
+            GravadorVcd vcd(arquivoDescarte, 4, m.getChip555().getPeriod(), m.getChip555().getTHigh(),
+                            GravadorVcd::Politica::Descartar, 2);
+            m.setRastro(&vcd);
+            m.runCycles(100000);
+            m.setRastro(nullptr);
+            vcd.close();
+            check(vcd.written() + vcd.dropped() == 100001 && vcd.events() == vcd.written(), "eventos gravados + descartados = produzidos");
+        }
+
+        // O VCD guarda as saídas numa palavra de 32 bits: uma cascata de CD4017 é recusada, como na sonda e no histórico
+        {
+            MotorVirtual m(20, 1000.0, 10000.0, 7.37e-6);
+            GravadorVcd vcd(arquivoCascata, 10, m.getChip555().getPeriod(), m.getChip555().getTHigh());
+            bool lancou = false;
+            try { m.setRastro(&vcd); } catch (const std::invalid_argument&) { lancou = true; }
+            vcd.close();
+            check(lancou, "setRastro() com mais de 10 LEDs lança invalid_argument");
+        }
+    } catch (const std::exception& e) {
+        check(false, std::string("rastro VCD em arquivo: ") + e.what());
+    }
+    std::remove(arquivoRastro.c_str());
+    std::remove(arquivoDescarte.c_str());
+    std::remove(arquivoCascata.c_str());
+}
+
+void testarRastroPeriodico() {
+    std::cout << "\n[Histórico compacto periódico]\n";
+
+    // Com resets no meio, o histórico devolve exatamente o que foi gravado ciclo a ciclo
+    {
+        const unsigned limite = 7;
+        MotorVirtual m(limite, 1000.0, 10000.0, 7.37e-6);
+        RastroPeriodico h;
+        std::vector<AmostraPlaca> bruto;
+        auto amostra = [&] {
+            AmostraPlaca a;
+            a.leds = m.getChip4017().getOut();
+            a.unidade = static_cast<uint8_t>(m.getUnidade().getOut());
+            a.dezena = static_cast<uint8_t>(m.getDezena().getOut());
+            a.carry = m.getUnidade().getCarryOut();
+            return a;
+        };
+
+        m.step();
+        m.setHistorico(&h);
+        bruto.push_back(amostra());
+        for (int trecho = 0; trecho < 6; ++trecho) {
+            uint64_t n = 3000 + 1237 * trecho;
+            for (uint64_t i = 0; i < n; ++i) {
+                m.step();
+                bruto.push_back(amostra());
+            }
+            if (trecho % 2) {
+                m.resetDisplays();
+            } else {
+                m.reset();
+            }
+            bruto.back() = amostra();
+        }
+        m.advance(5000);
+        m.setHistorico(nullptr);
+
+        bool igual = h.size() == bruto.size() + 5000 && h.firstCycle() == 1;
+        for (uint64_t c = 0; c < bruto.size() && igual; ++c) {
+            igual = h.at(c + 1) == bruto[c];
+        }
+        AmostraPlaca fim = h.at(h.firstCycle() + h.size() - 1);
+        check(igual, "estado de cada ciclo igual ao gravado sem compressão, com resets");
+        check(fim.leds == m.getChip4017().getOut() && fim.unidade == m.getUnidade().getOut() && fim.dezena == m.getDezena().getOut(),
+              "último ciclo do histórico igual ao estado do motor");
+        check(h.bytes() < bruto.size() * sizeof(AmostraPlaca) / 10, "histórico com resets ainda é bem menor que o bruto");
+
+        bool foraLancou = false;
+        try {
+            h.at(h.firstCycle() + h.size());
+        } catch (const std::out_of_range&) {
+            foraLancou = true;
+        }
+        check(foraLancou, "ciclo fora do histórico lança out_of_range");
+    }
+
+    // 24 h de placa a ~1 kHz em poucos kilobytes, com acesso direto a qualquer ciclo
+    {
+        MotorVirtual m(7, 1000.0, 10000.0, 6.86e-8);
+        RastroPeriodico h;
+        m.setHistorico(&h);
+        RelatorioSimulacao r = m.runFor(86400.0);
+        m.setHistorico(nullptr);
+        std::cout << "  (" << r.ciclos << " ciclos em " << h.bytes() << " bytes, " << h.segments() << " trechos)\n";
+        check(h.bytes() < 16 * 1024, "24 h a 1 kHz cabem em menos de 16 KiB");
+
+        bool igual = true;
+        uint64_t c = 1;
+        for (int i = 0; i < 200 && igual; ++i) {
+            c = (c * 6364136223846793005ull + 1442695040888963407ull);
+            uint64_t ciclo = c % h.size();
+            MotorVirtual ref(7, 1000.0, 10000.0, 6.86e-8);
+            ref.advance(ciclo);
+            AmostraPlaca a = h.at(ciclo);
+            igual = a.leds == ref.getChip4017().getOut() && a.unidade == ref.getUnidade().getOut()
+                 && a.dezena == ref.getDezena().getOut();
+        }
+        check(igual, "acesso aleatório bate com advance() em 200 ciclos sorteados");
+    }
+}
+
+void testarAnalisador() {
+    std::cout << "\n[Traço multirresolução do analisador lógico]\n";
+
+    // Palavras pseudoaleatórias com bits de frequências diferentes, comparadas com a força bruta
+    const uint64_t inicio = 1000, total = 300000;
+    std::vector<uint32_t> palavras(total);
+    uint64_t x = 88172645463325252ull;
+    for (uint64_t i = 0; i < total; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        uint32_t lento = ((i / 5000) & 1u) << 3;             // bit 3 muda a cada 5000 ciclos
+        palavras[i] = (uint32_t)(x & 0x7u) | lento | (1u << 4);  // bit 4 sempre alto
+    }
+
+    TracoMipmap grande(1 << 19);            // capacidade maior que o teste: nada é esquecido
+    TracoMipmap pequeno(64);                // 64 entradas por nível: o passado só existe nos níveis grossos
+    for (uint64_t i = 0; i < total; ++i) {
+        grande.append(inicio + i, palavras[i]);
+        pequeno.append(inicio + i, palavras[i]);
+    }
+    check(grande.firstCycle() == inicio && grande.endCycle() == inicio + total, "início e fim do traço");
+
+    bool exato = true, conservador = true;
+    uint64_t y = 12345;
+    for (int k = 0; k < 2000; ++k) {
+        y = y * 6364136223846793005ull + 1442695040888963407ull;
+        uint64_t a = (y >> 20) % total;
+        uint64_t len = 1 + ((y >> 45) % ((k % 4 == 0) ? 50000 : 300));
+        uint64_t b = std::min(total, a + len);
+        uint32_t e = ~0u, ou = 0;
+        for (uint64_t i = a; i < b; ++i) {
+            e &= palavras[i];
+            ou |= palavras[i];
+        }
+        FaixaSinais g = grande.query(inicio + a, inicio + b);
+        FaixaSinais p = pequeno.query(inicio + a, inicio + b);
+        exato = exato && g.valido && g.e == e && g.ou == ou;
+        // o traço pequeno pode responder com um intervalo maior: nunca diz "sempre alto" ou "sempre baixo" à toa
+        conservador = conservador && p.valido && (p.e & ~e) == 0 && (ou & ~p.ou) == 0;
+    }
+    check(exato, "consultas de qualquer tamanho iguais à força bruta");
+    check(conservador, "com os níveis finos esquecidos, a resposta continua conservadora");
+    check(grande.query(inicio + total - 100, inicio + total).e == [&] {
+              uint32_t e = ~0u;
+              for (uint64_t i = total - 100; i < total; ++i) e &= palavras[i];
+              return e;
+          }(), "dados recentes ainda nos blocos em formação são consultados pelos níveis finos");
+    check(!grande.query(0, inicio).valido && !grande.query(inicio + total, inicio + total + 10).valido,
+          "fora do traço a consulta vem sem dados");
+    check(pequeno.bytes() < grande.bytes() && TracoMipmap().bytes() <= 6u * 1024 * 1024, "memória limitada pela capacidade dos anéis");
+
+    // Reset dentro do ciclo aberto aparece como mudança naquele ciclo; ciclos perdidos repetem a última palavra
+    TracoMipmap t;
+    t.append(0, 0b01);
+    t.append(1, 0b01);
+    t.replaceLast(0b10);
+    t.append(5, 0b11);
+    FaixaSinais r1 = t.query(1, 2);
+    FaixaSinais buraco = t.query(2, 5);
+    check(r1.nivel(0) == 2 && r1.nivel(1) == 2, "reset no ciclo aberto marca os dois bits como mudando");
+    check(buraco.e == 0b10 && buraco.ou == 0b10 && t.endCycle() == 6, "ciclos que faltaram repetem a última palavra");
+
+    // Consultar ~10^6 ciclos custa o mesmo que poucos: no máximo ~16 entradas por nível (o tempo fica no bench)
+    TracoMipmap longo;
+    for (uint64_t i = 0; i < (1ull << 21); ++i) {
+        longo.append(i, (uint32_t)(i & 1));
+    }
+    unsigned maxPequena = 0, maxGrande = 0;
+    for (int k = 0; k < 1080; ++k) {
+        uint64_t a = (uint64_t)k * ((1ull << 21) - (1ull << 20)) / 1080;
+        maxPequena = std::max(maxPequena, longo.query(a, a + 8).entradas);
+        maxGrande = std::max(maxGrande, longo.query(a, a + (1ull << 20)).entradas);
+    }
+    std::cout << "  (até " << maxPequena << " entradas com 8 ciclos, " << maxGrande << " com 2^20 ciclos)\n";
+    check(maxPequena <= 8 && maxGrande <= 2 * TracoMipmap::Fator * TracoMipmap::Niveis,
+          "consulta de 2^20 ciclos combina no máximo 2 * 8 entradas por nível");
+
+    // Blocos resumidos: o mesmo traço que acrescentar ciclo a ciclo, inclusive maiores que os anéis
+    TracoMipmap porCiclo(64), porBloco(64);
+    const uint64_t blocos[] = { 3, 1, 700, 5, 9, 100000, 2, 64, 513 };
+    uint64_t c = 7;
+    for (uint64_t i = 0; i < sizeof(blocos) / sizeof(blocos[0]); ++i) {
+        uint32_t e = (uint32_t)(i & 1u), ou = e | 0b110;
+        for (uint64_t k = 0; k < blocos[i]; ++k) {
+            porCiclo.append(c + k, e);
+            porCiclo.replaceLast(ou);
+        }
+        porBloco.appendBlock(c, blocos[i], e, ou);
+        c += blocos[i];
+    }
+    bool iguais = porBloco.endCycle() == porCiclo.endCycle();
+    for (uint64_t a = 7; a < c && iguais; a += 997) {
+        for (uint64_t len : { 1ull, 13ull, 4096ull, 90000ull }) {
+            FaixaSinais q1 = porCiclo.query(a, a + len), q2 = porBloco.query(a, a + len);
+            iguais = iguais && q1.valido == q2.valido && q1.e == q2.e && q1.ou == q2.ou;
+        }
+    }
+    check(iguais, "appendBlock() igual a acrescentar os ciclos um a um");
+    porBloco.appendBlock(c + 10, 5, 0b1, 0b1);
+    check(porBloco.query(c, c + 10).ou == 0 && porBloco.query(c + 10, c + 15).e == 0b1, "buraco antes do bloco repete a última palavra");
+
+    // Com só a sonda ligada, advance() manda um evento Lote por salto em vez de um por ciclo
+    MotorVirtual m(10, 1000.0, 10000.0, 1e-6);
+    AnelSpsc<EventoVcd> sonda(1 << 10);
+    m.setSonda(&sonda);
+    m.advance(5);
+    m.advance(1000);
+    EventoVcd eventos[16];
+    size_t n = sonda.popBatch(eventos, 16);
+    check(n == 7 && eventos[0].tipo == TipoEventoVcd::Inicial && eventos[5].tipo == TipoEventoVcd::Pulso,
+          "saltos curtos continuam ciclo a ciclo");
+    check(eventos[6].tipo == TipoEventoVcd::Lote && eventos[6].lote == 1000 && eventos[6].ciclo == 1005 &&
+          eventos[6].carryVariou && eventos[6].unidade == 5 && eventos[6].leds == m.getChip4017().getOut(),
+          "salto longo vira um evento Lote com o estado final");
+    m.advance(1000000000ull);
+    check(sonda.popBatch(eventos, 16) == 1 && eventos[0].lote == 1000000000u && m.getCiclos() == 1000001005ull,
+          "10^9 ciclos com a sonda ligada viram um único evento");
+}
+
+void testarNetlist() {
+    std::cout << "\n[Netlist compilada]\n";
+
+    // A netlist da placa reproduz MotorVirtual pulso a pulso, inclusive com resets no meio
+    CircuitoCompilado placa(Netlist::readText(NetlistAppleJuice));
+    MotorVirtual motor(4, 1000.0, 10000.0, 7.37e-6);
+    size_t leds = placa.find("leds"), unidade = placa.find("unidade"), dezena = placa.find("dezena");
+    bool iguais = true;
+    for (int i = 1; i <= 2500; ++i) {
+        placa.step();
+        motor.step();
+        if (i % 777 == 0) {
+            placa.resetDisplays();
+            motor.resetDisplays();
+        }
+        if (i % 1234 == 0) {
+            placa.reset();
+            motor.reset();
+        }
+        iguais = iguais && placa.value(leds) == motor.getChip4017().getOut()
+                        && placa.value(unidade) == motor.getUnidade().getOut()
+                        && placa.value(dezena) == motor.getDezena().getOut();
+    }
+    check(iguais, "netlist da placa igual ao MotorVirtual em 2500 pulsos com resets");
+    check(placa.levels() == 2 && placa.size() == 3 && placa.limit(leds) == 4, "placa compilada em 2 níveis com 3 chips");
+    check(std::abs(placa.getPeriod() - motor.getChip555().getPeriod()) < 1e-12, "período vem do 555 da netlist");
+
+    // Cascatas descritas fora de ordem: 6 dígitos e dois CD4017 (o segundo conta as voltas do primeiro)
+    const char* cascata =
+        "# relógio de 6 dígitos\n"
+        "4026 d5 clk=c4\n"
+        "4026 d4 clk=c3 co=c4\n"
+        "4026 d3 clk=c2 co=c3\n"
+        "4026 d2 clk=c1 co=c2   # dezenas\n"
+        "4026 d1 clk=c0 co=c1\n"
+        "4026 d0 clk=clk co=c0\n"
+        "4017 voltas clk=fim\n"
+        "4017 anel clk=clk co=fim\n"
+        "555 osc out=clk r1=1000 r2=10000 c=1e-6\n";
+    CircuitoCompilado relogio(Netlist::readText(cascata));
+    const uint64_t n = 123456;
+    relogio.stepCycles(n);
+    uint64_t lido = 0;
+    for (int d = 5; d >= 0; --d) {
+        lido = lido * 10 + relogio.value(relogio.find("d" + std::to_string(d)));
+    }
+    Chip4017 anel(10), voltas(10);
+    anel.advance(n);
+    voltas.advance(n / 10);
+    check(lido == n, "6 dígitos em cascata mostram 123456 após 123456 pulsos");
+    check(relogio.value(relogio.find("anel")) == anel.getOut() && relogio.value(relogio.find("voltas")) == voltas.getOut(),
+          "co do CD4017 sobe a cada volta do anel");
+    check(relogio.levels() == 6 && relogio.find("d0") < relogio.find("d1") && relogio.find("d4") < relogio.find("d5"),
+          "chips ordenados por nível a partir do clock");
+    relogio.step();
+    check(relogio.edge("clk") && !relogio.edge("c0"), "bordas das redes no último pulso");
+
+    // Erros de descrição apontam a linha
+    auto recusa = [](const std::string& texto, const std::string& trecho) {
+        try {
+            CircuitoCompilado c(Netlist::readText(texto));
+        } catch (const std::invalid_argument& e) {
+            return std::string(e.what()).find(trecho) != std::string::npos;
+        }
+        return false;
+    };
+    const std::string osc = "555 osc out=clk r1=1000 r2=10000 c=1e-6\n";
+    check(recusa(osc + "4011 x clk=clk\n", "linha 2"), "chip desconhecido recusado");
+    check(recusa(osc + "4026 x clk=nada\n", "nada"), "rede sem driver recusada");
+    check(recusa(osc + "4026 a clk=clk co=z\n4026 b clk=clk co=z\n", "já é dirigida"), "rede com dois drivers recusada");
+    check(recusa(osc + "4026 a clk=y co=x\n4026 b clk=x co=y\n", "laço"), "laço de clock recusado");
+    check(recusa("4026 a clk=clk\n", "fonte de clock"), "netlist sem 555 recusada");
+    check(recusa(osc + "4026 a clk=clk cout=x\n", "cout"), "pino inexistente recusado");
+    check(recusa(osc + "4017 a clk=clk limite=11\n", "limite"), "limite do CD4017 fora da faixa recusado");
+    check(recusa("555 osc out=clk r1=1k r2=10000 c=1e-6\n", "r1"), "valor numérico inválido recusado");
+    check(recusa(osc + "4026 osc clk=clk\n", "já foi usado"), "nome repetido recusado");
+}
+
+void testarChipsEstaticos() {
+    std::cout << "\n[Chips com despacho estático]\n";
+
+    // Cada especialização de LimitReset pulso a pulso contra o MotorVirtual, com resets no meio
+    bool iguais = true;
+    for (unsigned limite = 1; limite <= 10; ++limite) {
+        iguais = iguais && comPlacaEstatica(limite, [&](auto& placa) {
+            MotorVirtual motor(limite, 1000.0, 10000.0, 7.37e-6);
+            bool ok = placa.getChip4017().getLimitReset() == limite;
+            for (int i = 1; i <= 1500; ++i) {
+                placa.step();
+                motor.step();
+                if (i % 333 == 0) {
+                    placa.resetDisplays();
+                    motor.resetDisplays();
+                }
+                if (i % 700 == 0) {
+                    placa.reset();
+                    motor.reset();
+                }
+                ok = ok && placa.getChip4017().getOut() == motor.getChip4017().getOut()
+                        && placa.getUnidade().getOut() == motor.getUnidade().getOut()
+                        && placa.getDezena().getOut() == motor.getDezena().getOut()
+                        && placa.getUnidade().getCarryOut() == motor.getUnidade().getCarryOut();
+            }
+            return ok;
+        });
+    }
+    check(iguais, "PlacaEstatica<1..10> igual ao MotorVirtual em 1500 pulsos com resets");
+
+    // Cascata de 6 dígitos: passo a passo e em forma fechada
+    PlacaEstatica<7, 6> passo, salto;
+    uint64_t estourosPasso = passo.stepCycles(2345678);
+    uint64_t estourosSalto = salto.advance(2345678);
+    uint64_t lido = 0;
+    for (int d = 5; d >= 0; --d) {
+        lido = lido * 10 + passo.getDigito(static_cast<unsigned>(d)).getOut();
+    }
+    Chip4017 referencia(7);
+    referencia.advance(2345678);
+    check(lido == 345678 && estourosPasso == 2 && estourosSalto == 2, "6 dígitos em cascata: 2345678 pulsos = 345678 e 2 estouros");
+    check(passo.getChip4017().getOut() == referencia.getOut() && salto.getChip4017().getOut() == referencia.getOut(),
+          "Anel4017 igual ao Chip4017, passo a passo e com advance()");
+    bool digitosIguais = true;
+    for (unsigned d = 0; d < 6; ++d) {
+        digitosIguais = digitosIguais && passo.getDigito(d).getOut() == salto.getDigito(d).getOut();
+    }
+    check(digitosIguais && passo.getCiclos() == salto.getCiclos(), "advance() da cascata igual ao passo a passo");
+
+    bool lancou = false;
+    try {
+        comPlacaEstatica(11, [](auto& placa) { return placa.getCiclos(); });
+    } catch (const std::invalid_argument&) {
+        lancou = true;
+    }
+    check(lancou, "LimitReset fora de 1 a 10 lança invalid_argument");
+}
+
+void testarSegmentos() {
+    std::cout << "\n[Decodificador de 7 segmentos]\n";
+
+    // Segmentos acesos por dígito, contados à mão a partir do datasheet do CD4026
+    const unsigned acesos[10] = {6, 2, 5, 5, 4, 5, 6, 3, 7, 6};
+    bool contagens = true;
+    for (unsigned v = 0; v < 10; ++v) {
+        unsigned n = 0;
+        for (unsigned s = 0; s < 7; ++s) {
+            n += (decodificarSegmentos(v) >> s) & 1u;
+        }
+        contagens = contagens && n == acesos[v];
+    }
+    check(contagens, "número de segmentos acesos de 0 a 9");
+    static_assert(decodificarSegmentos(1) == 0x06 && decodificarSegmentos(8) == 0x7F, "tabela avaliada na compilação");
+    check((decodificarSegmentos(7) & 0x40) == 0 && (decodificarSegmentos(0) & 0x40) == 0, "0 e 7 com o segmento g apagado");
+    check(decodificarSegmentos(10) == 0 && decodificarSegmentos(255) == 0, "valores fora de 0 a 9 apagam o display");
+
+    Unidade u;
+    for (int i = 0; i < 13; ++i) {
+        u.add();
+    }
+    check(u.getSegments() == decodificarSegmentos(3), "Chip4026::getSegments() decodifica o dígito atual");
+
+    u.setDisplayEnable(false);
+    u.add();
+    check(u.getSegments() == 0 && u.getOut() == 4 && u.getUngatedC() && !u.getDisplayEnable(),
+          "DISPLAY ENABLE baixo apaga a..g, mas conta e deixa o UNGATED C");
+}
+
+void testarContadorBcd() {
+    std::cout << "\n[Cascata de CD4026 em BCD compactado]\n";
+
+    // Pulso a pulso contra a cascata de objetos (um Contador4026 por dígito), atravessando a divisa das palavras
+    ContadorBcd bcd(17);
+    CascataBcd<17> ref;
+    bool igual = true;
+    bcd.advance(999999999999990ull);       // perto do estouro da primeira palavra (15 noves)
+    ref.advance(999999999999990ull);
+    for (int i = 0; i < 40; ++i) {
+        bool estouroBcd = bcd.add();
+        bool estouroRef = ref.add();
+        igual = igual && estouroBcd == estouroRef;
+        for (unsigned d = 0; d < 17; ++d) {
+            igual = igual && bcd.digit(d) == ref[d].getOut();
+        }
+    }
+    check(igual, "add() igual à cascata de Contador4026, inclusive no carry entre palavras");
+    check(bcd.text() == "01000000000000030" && bcd.value() == 1000000000000030ull, "text() e value() depois do carry entre palavras");
+
+    // advance() em forma fechada: estado e estouros iguais ao passo a passo
+    ContadorBcd salto(3), passo(3);
+    for (int i = 0; i < 987; ++i) {
+        passo.add();
+    }
+    uint64_t e1 = salto.advance(654);
+    uint64_t e2 = salto.advance(333);
+    check(salto.value() == passo.value() && salto.value() == 987 && e1 + e2 == 0, "advance() == add() repetido");
+    check(salto.advance(12345) == 13 && salto.value() == (987 + 12345) % 1000, "advance() conta os estouros do último dígito");
+
+    ContadorBcd doze(12);
+    uint64_t n = 86400ull * 365 * 1000;    // um ano a 1 kHz
+    check(doze.advance(n) == 0 && doze.value() == n, "12 dígitos contam um ano a 1 kHz sem estourar");
+    check(doze.advance(1000000000000ull - n) == 1 && doze.value() == 0 && doze.getCarryOut(), "12 dígitos estouram em 10^12");
+
+    ContadorBcd grande(40);
+    grande.advance(UINT64_MAX);
+    grande.advance(UINT64_MAX);
+    check(grande.text() == std::string(20, '0') + "36893488147419103230", "40 dígitos somam além de 64 bits");
+
+    std::vector<uint8_t> segs;
+    bcd.reset();
+    bcd.advance(1234567890ull);
+    bcd.segments(segs);
+    bool segsOk = segs.size() == 17;
+    for (unsigned i = 0; i < 17 && segsOk; ++i) {
+        segsOk = segs[16 - i] == bcd.segments(i) && bcd.segments(i) == decodificarSegmentos(bcd.digit(i));
+    }
+    check(segsOk, "segments() de todos os dígitos na ordem de desenho");
+
+    // MotorVirtual com 6 dígitos: o carry das dezenas alimenta os dígitos de cima
+    MotorVirtual m6(4, 1000.0, 10000.0, 7.37e-6, ModoTempo::Virtual, 6);
+    MotorVirtual s6(4, 1000.0, 10000.0, 7.37e-6, ModoTempo::Virtual, 6);
+    for (int i = 0; i < 12345; ++i) {
+        m6.step();
+    }
+    uint64_t estouros = s6.advance(12345);
+    check(m6.getDisplay() == "012345" && s6.getDisplay() == "012345" && estouros == 0, "MotorVirtual de 6 dígitos, passo a passo e com advance()");
+    check(s6.advance(1000000 - 12345) == 1 && s6.getDisplay() == "000000", "advance() conta os estouros do display inteiro");
+    check(m6.getEstado().altos == 0x0123, "EstadoPlaca publica os dígitos de cima em BCD");
+    m6.resetDisplays();
+    check(m6.getDisplay() == "000000", "resetDisplays() zera todos os dígitos");
+
+    bool recusou = false;
+    try {
+        MotorVirtual um(4, 1000.0, 10000.0, 7.37e-6, ModoTempo::Virtual, 1);
+    } catch (const std::invalid_argument&) {
+        recusou = true;
+    }
+    check(recusou, "display de 1 dígito é recusado");
+}
+
+void testarCascata4017() {
+    std::cout << "\n[Cascata de CD4017]\n";
+
+    // Até 10 saídas: igual ao Chip4017, pulso a pulso
+    bool igualChip = true;
+    for (unsigned limite = 1; limite <= 10; ++limite) {
+        Chip4017 chip(limite);
+        Cascata4017 cascata(limite);
+        for (int i = 0; i < 25; ++i) {
+            igualChip = igualChip && chip.getOut() == cascata.getOut() && chip.getPosition() == cascata.getPosition();
+            chip.shift();
+            cascata.shift();
+        }
+    }
+    check(igualChip, "Cascata4017 com 1 a 10 saídas igual ao Chip4017");
+
+    // 130 saídas (três palavras, a última incompleta): sempre uma só saída alta, andando uma posição por pulso
+    Cascata4017 anel(130);
+    bool umaSo = true;
+    unsigned voltas = 0;
+    for (unsigned i = 0; i < 2 * 130 + 7; ++i) {
+        unsigned altas = 0;
+        for (unsigned pos = 0; pos < 130; ++pos) {
+            altas += anel.test(pos) ? 1 : 0;
+        }
+        umaSo = umaSo && altas == 1 && anel.test(i % 130) && anel.getPosition() == i % 130;
+        voltas += anel.shift() ? 1 : 0;
+    }
+    check(umaSo && voltas == 2, "130 saídas: uma alta por vez, atravessando as palavras e voltando para L1");
+    check(anel.getChips() == 13 && anel.getChipAtivo() == 0 && anel.getSaidaNoChip() == 7, "chip e saída ativos na cascata");
+
+    Cascata4017 salto(1000), passo(1000);
+    for (int i = 0; i < 2345; ++i) {
+        passo.shift();
+    }
+    salto.advance(1000);
+    salto.advance(1345);
+    check(salto.words() == passo.words() && salto.getPosition() == 345, "advance() == shift() repetido com 1000 saídas");
+
+    // Placa com 1000 LEDs: o estado publicado traz a posição do LED aceso
+    MotorVirtual m(1000, 1000.0, 10000.0, 7.37e-6);
+    for (int i = 0; i < 1234; ++i) {
+        m.step();
+    }
+    check(m.getEstado().ledAceso == 234 && m.getChip4017().test(234), "MotorVirtual com 1000 LEDs publica o LED aceso");
+    bool recusou = false;
+    try {
+        RastroPeriodico historico;
+        m.setHistorico(&historico);
+    } catch (const std::invalid_argument&) {
+        recusou = true;
+    }
+    check(recusou, "histórico recusa mais de 10 LEDs");
+}
+
+void testarAnalogico555() {
+    std::cout << "\n[555 analógico]\n";
+
+    // Sem resistência de descarga e com o divisor interno, os tempos são os do datasheet com ln 2 exato
+    ParametrosAnalogicos555 ideal;
+    ideal.rDescarga = 0.0;
+    Modelo555Analogico m(1000.0, 10000.0, 7.37e-6, ideal);
+    const double ln2 = std::log(2.0);
+    check(std::fabs(m.getTHigh() - ln2 * 11000.0 * 7.37e-6) < 1e-12 && std::fabs(m.getTLow() - ln2 * 10000.0 * 7.37e-6) < 1e-12,
+          "Rdis = 0: tH = ln2 (R1+R2) C e tL = ln2 R2 C");
+    Chip555 aproximado(1000.0, 10000.0, 7.37e-6);
+    check(std::fabs(m.getPeriod() - aproximado.getPeriod()) / m.getPeriod() < 1e-3, "perto da aproximação 0.693 do Chip555");
+    check(std::fabs(m.getFirstHigh() / m.getTHigh() - std::log(3.0) / ln2) < 1e-9, "primeiro nível alto (de 0 V) é ln3/ln2 vezes mais longo");
+
+    // Com Rdis, os tempos batem com a integração numérica da equação do capacitor (Euler com passo pequeno)
+    ParametrosAnalogicos555 real;
+    real.vcc = 5.0;
+    real.rDescarga = 200.0;
+    const double r1 = 1000.0, r2 = 4700.0, c = 1e-6;
+    Modelo555Analogico a(r1, r2, c, real);
+    double v = 0.0, t = 0.0, dt = 1e-9;
+    bool carregando = true;
+    std::vector<double> trocas;
+    while (trocas.size() < 5) {
+        double i = (real.vcc - v) / (r1 + r2);
+        if (!carregando) {
+            // nó do pino DIS: R1 vindo de Vcc, Rdis para a terra e R2 para o capacitor
+            double vNo = (real.vcc / r1 + v / r2) / (1.0 / r1 + 1.0 / real.rDescarga + 1.0 / r2);
+            i = (vNo - v) / r2;
+        }
+        v += i / c * dt;
+        t += dt;
+        if (carregando && v >= a.getVLimiar()) {
+            carregando = false;
+            trocas.push_back(t);
+        } else if (!carregando && v <= a.getVDisparo()) {
+            carregando = true;
+            trocas.push_back(t);
+        }
+    }
+    double tLowNum = trocas[1] - trocas[0], tHighNum = trocas[2] - trocas[1];
+    check(std::fabs(trocas[0] - a.getFirstHigh()) / a.getFirstHigh() < 1e-4 && std::fabs(tLowNum - a.getTLow()) / a.getTLow() < 1e-4
+          && std::fabs(tHighNum - a.getTHigh()) / a.getTHigh() < 1e-4, "tempos em forma fechada == integração numérica (Rdis = 200)");
+    ParametrosAnalogicos555 semRdis = real;
+    semRdis.rDescarga = 0.0;
+    Modelo555Analogico a0(r1, r2, c, semRdis);
+    check(a.getTHigh() == a0.getTHigh() && a.getTLow() > a0.getTLow() && a.getDutyCycle() < a0.getDutyCycle(),
+          "Rdis alonga só o nível baixo");
+
+    // Forma de onda contínua, entre os limiares depois da primeira carga, e sample() igual a voltage()
+    const size_t n = 5000;
+    std::vector<double> amostras(n);
+    const double passo = (a.getFirstHigh() + 4 * a.getPeriod()) / n;
+    a.sample(0.0, passo, n, amostras.data());
+    bool igual = true, dentro = true;
+    for (size_t k = 0; k < n; ++k) {
+        double tk = k * passo;
+        igual = igual && std::fabs(amostras[k] - a.voltage(tk)) < 1e-9;
+        if (tk > a.getFirstHigh()) {
+            dentro = dentro && amostras[k] >= a.getVDisparo() - 1e-9 && amostras[k] <= a.getVLimiar() + 1e-9;
+        }
+    }
+    check(igual, "sample() vetorizado == voltage() amostra a amostra");
+    check(dentro, "depois da primeira carga, o capacitor fica entre 1/3 e 2/3 Vcc");
+    check(a.output(a.getFirstHigh() * 0.5) && !a.output(a.getFirstHigh() + 0.5 * a.getTLow()), "saída alta na carga e baixa na descarga");
+
+    // Tensão no pino CTRL muda os limiares e os tempos
+    ParametrosAnalogicos555 controle = real;
+    controle.vControle = 4.0;
+    Modelo555Analogico b(r1, r2, c, controle);
+    check(b.getVLimiar() == 4.0 && b.getVDisparo() == 2.0 && b.getTHigh() > a.getTHigh(), "CTRL em 4 V: limiares 4 V e 2 V");
+
+    // Motor com o modelo analógico: período exato, mesmo custo por ciclo
+    MotorVirtual motor(4, r1, r2, c);
+    Modelo555Analogico usado = motor.setModelo555(real);
+    motor.advance(1000);
+    check(motor.getChip555().getPeriod() == a.getPeriod() && std::fabs(motor.getTempoSimulado() - 1000 * a.getPeriod()) < 1e-9,
+          "MotorVirtual::setModelo555() troca o período do clock");
+    (void)usado;
+
+    bool recusou = false;
+    try {
+        ParametrosAnalogicos555 ruim = real;
+        ruim.rDescarga = 5000.0;
+        Modelo555Analogico x(r1, r2, c, ruim);
+    } catch (const std::invalid_argument&) {
+        recusou = true;
+    }
+    check(recusou, "Rdis que impede a descarga até o disparo é recusada");
+}
+
+void testarMonteCarlo() {
+    std::cout << "\n[Monte Carlo das tolerâncias]\n";
+
+    ConfigMonteCarlo cfg;
+    cfg.amostras = 300000;          // mais de um bloco, com o último incompleto
+    cfg.semente = 42;
+
+    // O resultado só depende da semente, não do número de threads
+    PoolThreads uma(1), quatro(4);
+    ResultadoMonteCarlo a = executarMonteCarlo(cfg, uma);
+    ResultadoMonteCarlo b = executarMonteCarlo(cfg, quatro);
+    bool iguais = a.frequencia.media == b.frequencia.media && a.periodo.desvioPadrao == b.periodo.desvioPadrao
+               && a.duty.histograma.getMaximo() == b.duty.histograma.getMaximo();
+    for (unsigned k = 0; k < a.frequencia.histograma.size(); ++k) {
+        iguais = iguais && a.frequencia.histograma.at(k) == b.frequencia.histograma.at(k);
+    }
+    check(iguais && a.frequencia.histograma.count() == cfg.amostras, "mesma semente: resultado idêntico com 1 e 4 threads");
+    ConfigMonteCarlo outra = cfg;
+    outra.semente = 43;
+    check(executarMonteCarlo(outra, quatro).frequencia.media != a.frequencia.media, "semente diferente, sorteio diferente");
+
+    // Nenhuma placa fora dos extremos das tolerâncias
+    Chip555 menor(cfg.r1 * 0.95, cfg.r2 * 0.95, cfg.c * 0.8), maior(cfg.r1 * 1.05, cfg.r2 * 1.05, cfg.c * 1.2);
+    check(a.periodo.histograma.getMinimo() >= menor.getPeriod() && a.periodo.histograma.getMaximo() <= maior.getPeriod(),
+          "períodos entre os extremos das tolerâncias");
+
+    // Sem tolerância, todas as placas são a nominal
+    ConfigMonteCarlo exato = cfg;
+    exato.tolR1 = exato.tolR2 = exato.tolC = 0.0;
+    exato.amostras = 1000;
+    ResultadoMonteCarlo e = executarMonteCarlo(exato, quatro);
+    Chip555 nominal(cfg.r1, cfg.r2, cfg.c);
+    check(std::fabs(e.frequencia.media - nominal.getFrequency()) < 1e-9 && e.frequencia.desvioPadrao < 1e-6
+          && std::fabs(e.frequencia.percentile(0.5) - nominal.getFrequency()) < 1e-6, "tolerância zero: só a placa nominal");
+
+    // Só o capacitor variando: o período é proporcional a C, então herda a distribuição dele
+    ConfigMonteCarlo soC = cfg;
+    soC.tolR1 = soC.tolR2 = 0.0;
+    soC.distribuicao = Distribuicao::Uniforme;
+    ResultadoMonteCarlo u = executarMonteCarlo(soC, quatro);
+    double t0 = nominal.getPeriod();
+    check(std::fabs(u.periodo.percentile(0.05) / t0 - 0.82) < 0.003 && std::fabs(u.periodo.percentile(0.5) / t0 - 1.0) < 0.003
+          && std::fabs(u.periodo.percentile(0.95) / t0 - 1.18) < 0.003, "uniforme: percentis 5/50/95 em -18%, 0 e +18%");
+    soC.distribuicao = Distribuicao::Normal;
+    ResultadoMonteCarlo n = executarMonteCarlo(soC, quatro);
+    // desvio padrão 20%/3, um pouco menor por causa do corte em 3 desvios (fator sqrt(0.9733))
+    double esperado = 0.20 / 3.0 * std::sqrt(0.9733);
+    check(std::fabs(n.periodo.desvioPadrao / t0 - esperado) / esperado < 0.01, "normal: desvio padrão de 20%/3 truncado");
+    check(n.periodo.percentile(0.05) > u.periodo.percentile(0.05) && n.periodo.percentile(0.95) < u.periodo.percentile(0.95),
+          "normal concentra mais perto do nominal que a uniforme");
+
+    bool recusou = false;
+    try {
+        ConfigMonteCarlo ruim = cfg;
+        ruim.tolC = 1.0;
+        executarMonteCarlo(ruim, uma);
+    } catch (const std::invalid_argument&) {
+        recusou = true;
+    }
+    check(recusou, "tolerância de 100% é recusada");
+}
+
+void testarRodaDeTempo() {
+    std::cout << "\n[Roda de tempo]\n";
+
+    // Instantes aleatórios em todas as escalas (de ticks a 2^60), alguns cancelados: saem em ordem de tempo
+    RodaDeTempo roda;
+    GeradorAleatorio g(7);
+    std::vector<RodaDeTempo::No*> nos;
+    std::vector<uint64_t> esperados;
+    for (int i = 0; i < 20000; ++i) {
+        RodaDeTempo::No* no = roda.acquire();
+        uint64_t tempo = g.next() >> (4 + g.next() % 60);
+        roda.schedule(no, tempo);
+        nos.push_back(no);
+    }
+    for (size_t i = 0; i < nos.size(); ++i) {
+        if (i % 7 == 0) {
+            roda.cancel(nos[i]);
+        } else {
+            esperados.push_back(nos[i]->tempo);
+        }
+    }
+    std::sort(esperados.begin(), esperados.end());
+    std::vector<uint64_t> saida;
+    while (RodaDeTempo::No* no = roda.popUntil(UINT64_MAX)) {
+        saida.push_back(no->tempo);
+        roda.release(no);
+    }
+    check(saida == esperados && roda.size() == 0, "20000 eventos de 1 a 2^60 ticks saem em ordem, sem os cancelados");
+
+    // popUntil não passa do limite, e depois dele ainda se pode agendar a partir do limite
+    RodaDeTempo r;
+    RodaDeTempo::No* a = r.acquire();
+    RodaDeTempo::No* b = r.acquire();
+    r.schedule(a, 1000000);
+    r.schedule(b, 5);
+    bool ok = r.popUntil(999999) == b && r.popUntil(999999) == nullptr && r.now() <= 999999;
+    RodaDeTempo::No* c = r.acquire();
+    r.schedule(c, 999999);
+    ok = ok && r.popUntil(UINT64_MAX) == c && r.popUntil(UINT64_MAX) == a;
+    check(ok, "popUntil() respeita o limite");
+    bool recusou = false;
+    try {
+        r.schedule(b, 10);
+    } catch (const std::invalid_argument&) {
+        recusou = true;
+    }
+    check(recusou, "agendar antes do instante atual é recusado");
+
+    // Reagendar o mesmo nó não aloca: o pool fica do tamanho do primeiro bloco
+    RodaDeTempo p;
+    RodaDeTempo::No* no = p.acquire();
+    p.schedule(no, 0);
+    for (uint64_t t = 1; t <= 100000; ++t) {
+        RodaDeTempo::No* e = p.popUntil(UINT64_MAX);
+        p.schedule(e, t * 977);
+    }
+    check(p.capacity() == 256 && p.size() == 1, "reagendar o nó da fonte não aloca memória");
+}
+
+void testarPlacaEventos() {
+    std::cout << "\n[Placa por eventos discretos]\n";
+
+    // Só com o 555, a placa por eventos chega ao mesmo estado do MotorVirtual
+    PlacaEventos placa(7, 1000.0, 10000.0, 7.37e-6, 3);
+    MotorVirtual motor(7, 1000.0, 10000.0, 7.37e-6, ModoTempo::Virtual, 3);
+    const uint64_t n = 12345;
+    const double periodo = placa.getChip555().getPeriod();
+    placa.runUntil((n - 0.1) * periodo);          // subidas em 0, T, ..., (n - 1) T, e as descidas delas
+    motor.advance(n);
+    check(placa.getPulsosSequencial() == n && placa.getChip4017().getOut() == motor.getChip4017().getOut()
+          && placa.getDisplay() == motor.getDisplay() && placa.getEventos() == 2 * n,
+          "só o 555: mesmo estado do MotorVirtual (duas bordas por ciclo)");
+
+    // Chave em EXT: o display conta o clock externo e os LEDs continuam no 555
+    PlacaEventos ext(10, 1000.0, 10000.0, 7.37e-6);
+    ext.setExternalClock(std::make_unique<Oscilador>(0.25e-3, 1e-3, 0.1e-3));     // 1 kHz
+    ext.setSwitch(ChaveClock::Externo);
+    ext.runUntil(1.0);
+    uint64_t ciclos555 = static_cast<uint64_t>(1.0 / ext.getChip555().getPeriod()) + 1;
+    check(ext.getPulsosContador() == 1000 && ext.getPulsosSequencial() == ciclos555 && ext.getDisplay() == "00",
+          "chave em EXT: 1000 pulsos externos no display, o 555 só nos LEDs");
+
+    // Chave mudando no meio: cada trecho conta o seu clock
+    PlacaEventos troca(10, 1000.0, 10000.0, 7.37e-6);
+    troca.setExternalClock(std::make_unique<Oscilador>(0.5e-3, 1e-3, 0.5e-3));
+    troca.scheduleSwitch(0.5, ChaveClock::Externo);
+    troca.runUntil(1.0);
+    uint64_t do555 = static_cast<uint64_t>(0.5 / troca.getChip555().getPeriod()) + 1;
+    check(troca.getPulsosContador() == do555 + 500 && troca.getSwitch() == ChaveClock::Externo,
+          "chave agendada: 555 até 0,5 s e depois o externo");
+
+    // Botões em instantes quaisquer, entre as bordas do clock
+    PlacaEventos botoes(10, 1000.0, 10000.0, 7.37e-6);
+    botoes.scheduleResetDisplays(2.5 * periodo);
+    botoes.scheduleReset(100.5 * periodo);
+    botoes.runUntil(104.5 * periodo);
+    check(botoes.getDisplay() == "04" && botoes.getChip4017().getPosition() == 4, "reset agendado zera a placa entre bordas");
+
+    // Oscilador extra ligado direto no CD4017, assíncrono com o 555
+    PlacaEventos extra(10, 1000.0, 10000.0, 7.37e-6);
+    size_t i = extra.addSource(std::make_unique<Oscilador>(1e-3, 3e-3), DestinoSequencial);
+    extra.runUntil(0.3 - 1e-6);
+    check(extra.getSubidas(i) == 100 && extra.getPulsosSequencial() == 100 + extra.getSubidas(0)
+          && extra.getPulsosContador() == extra.getSubidas(0), "oscilador extra soma pulsos só no CD4017");
+
+    // Muitas fontes assíncronas: o pool não cresce depois do início
+    PlacaEventos muitas(10, 1000.0, 10000.0, 7.37e-6);
+    for (int k = 0; k < 100; ++k) {
+        muitas.addSource(std::make_unique<Oscilador>(1e-4, 2e-4 + k * 1e-6, k * 1e-6), DestinoContador);
+    }
+    size_t capacidade = muitas.getCapacidadeEventos();
+    muitas.runUntil(1.0);
+    check(muitas.getCapacidadeEventos() == capacidade && muitas.getEventos() > 700000, "100 osciladores numa thread, sem alocar");
+}
+
+void testarClockExterno() {
+    std::cout << "\n[Clock externo por fluxo de instantes]\n";
+
+    auto gravarTexto = [](const std::string& caminho, const std::string& conteudo) {
+        std::ofstream out(caminho, std::ios::binary);
+        out << conteudo;
+    };
+    auto lerTudo = [](LeitorBordas& leitor) {
+        std::vector<uint64_t> todos;
+        uint64_t lote[7];           // lote pequeno de propósito: o fim de um read() cai no meio das linhas
+        while (size_t n = leitor.read(lote, 7)) {
+            todos.insert(todos.end(), lote, lote + n);
+        }
+        return todos;
+    };
+
+    const std::string arquivoTexto = caminhoTemporario("clock_teste.txt");
+    const std::string arquivoBinario = caminhoTemporario("clock_teste.ajck");
+
+    // Um arquivo que não abre vira uma falha do teste, não um abort do binário inteiro
+    try {
+        // Texto: comentários, linhas vazias, CRLF, mais de 9 casas e a última linha sem '\n'
+        gravarTexto(arquivoTexto, "# clock de teste\n0\n  0.5 # meio segundo\n\n1.0000000019\r\n2.25");
+        {
+            LeitorBordas leitor(arquivoTexto);
+            std::vector<uint64_t> t = lerTudo(leitor);
+            check(!leitor.isBinary() && t == std::vector<uint64_t>({ 0, 500000000, 1000000001, 2250000000ull }),
+                  "texto: instantes exatos em ns, sem strtod");
+        }
+
+        // Erros com a linha: fora de ordem e lixo
+        auto erroEm = [&](const std::string& conteudo, const std::string& trecho) {
+            gravarTexto(arquivoTexto, conteudo);
+            try {
+                LeitorBordas leitor(arquivoTexto);
+                lerTudo(leitor);
+            } catch (const std::invalid_argument& e) {
+                return std::string(e.what()).find(trecho) != std::string::npos;
+            }
+            return false;
+        };
+        check(erroEm("1\n2\n1.5\n", "linha 3"), "texto: instante fora de ordem é recusado com a linha");
+        check(erroEm("1\n2x\n", "linha 2") && erroEm(".\n", "linha 1"), "texto: linha inválida é recusada");
+
+        // Binário: ida e volta pelo EscritorBordas, com mais de um bloco de 1 MiB (o número cruza o fim do bloco)
+        std::vector<uint64_t> esperado;
+        std::string texto;
+        uint64_t instante = 0;
+        for (uint64_t k = 0; k < 600000; ++k) {
+            instante += 1 + (k * 2654435761u) % 5000000;    // distâncias de 1 a 3 bytes em LEB128
+            esperado.push_back(instante);
+            texto += std::to_string(instante / 1000000000) + "." + std::to_string(1000000000 + instante % 1000000000).substr(1) + "\n";
+        }
+        {
+            EscritorBordas escritor(arquivoBinario);
+            for (uint64_t t : esperado) {
+                escritor.write(t);
+            }
+        }
+        gravarTexto(arquivoTexto, texto);
+        {
+            LeitorBordas binario(arquivoBinario);
+            LeitorBordas emTexto(arquivoTexto);
+            check(texto.size() > LeitorBordas::TamanhoBloco, "o fluxo de texto do teste passa de um bloco");
+            check(binario.isBinary() && lerTudo(binario) == esperado, "binário: ida e volta com mais de um bloco");
+            check(lerTudo(emTexto) == esperado, "texto: mesmo fluxo com linhas cruzando o fim do bloco");
+        }
+
+        // Binário truncado no meio de um número
+        {
+            std::ofstream out(arquivoBinario, std::ios::binary);
+            out.write("AJCK\x01\x85", 6);
+        }
+        bool truncado = false;
+        try {
+            LeitorBordas leitor(arquivoBinario);
+            lerTudo(leitor);
+        } catch (const std::invalid_argument&) {
+            truncado = true;
+        }
+        check(truncado, "binário truncado é recusado");
+
+        bool semArquivo = false;
+        try {
+            LeitorBordas leitor(caminhoTemporario("nao_existe.ajck"));
+        } catch (const std::runtime_error&) {
+            semArquivo = true;
+        }
+        check(semArquivo, "arquivo inexistente lança runtime_error");
+
+        // Na placa: as bordas batem com o oscilador equivalente, borda a borda ou em lote
+        std::string kHz;
+        for (int k = 0; k < 5000; ++k) {
+            kHz += "0." + std::to_string(1000000 + k * 200).substr(1) + "\n";      // 5 kHz, subidas em k * 200 us
+        }
+        gravarTexto(arquivoTexto, kHz);
+        PlacaEventos porFluxo(10, 1000.0, 10000.0, 7.37e-6);
+        PlacaEventos porOscilador(10, 1000.0, 10000.0, 7.37e-6);
+        porFluxo.setExternalClock(std::make_unique<ClockExterno>(arquivoTexto));
+        porOscilador.setExternalClock(std::make_unique<Oscilador>(100e-6, 200e-6));
+        for (PlacaEventos* placa : { &porFluxo, &porOscilador }) {
+            placa->setSwitch(ChaveClock::Externo);
+            placa->scheduleSwitch(0.4, ChaveClock::Interno555);
+            placa->scheduleResetDisplays(0.25);
+            placa->runUntil(0.7);
+        }
+        check(porFluxo.getPulsosContador() == porOscilador.getPulsosContador() && porFluxo.getDisplay() == porOscilador.getDisplay()
+              && porFluxo.getEventos() == porOscilador.getEventos() && porFluxo.getSubidas(1) == 3501,
+              "fluxo em lote: mesmo estado e eventos que o oscilador borda a borda");
+
+        // step() não salta: um evento por vez
+        PlacaEventos passo(10, 1000.0, 10000.0, 7.37e-6);
+        passo.setExternalClock(std::make_unique<ClockExterno>(arquivoTexto));
+        passo.setSwitch(ChaveClock::Externo);
+        for (int k = 0; k < 10; ++k) {
+            passo.step();
+        }
+        check(passo.getEventos() == 10, "step() processa uma borda do fluxo por vez");
+
+        // O fluxo acaba: depois da última borda a entrada fica parada
+        PlacaEventos fim(10, 1000.0, 10000.0, 7.37e-6);
+        fim.setExternalClock(std::make_unique<ClockExterno>(arquivoTexto));
+        fim.setSwitch(ChaveClock::Externo);
+        fim.runUntil(10.0);
+        check(fim.getPulsosContador() == 5000 && fim.getDisplay() == "00", "fluxo esgotado: 5000 pulsos e a entrada para");
+    } catch (const std::exception& e) {
+        check(false, std::string("clock externo por arquivo: ") + e.what());
+    }
+    std::remove(arquivoTexto.c_str());
+    std::remove(arquivoBinario.c_str());
+
+    // MotorVirtual: pulsos externos só contam com a chave em EXT, e aí o 555 só avança os LEDs
+    MotorVirtual motor(4, 1000.0, 10000.0, 7.37e-6);
+    motor.addExternalPulses(7);
+    motor.processRequests();
+    check(motor.getDisplay() == "00", "chave em 555: pulsos externos são descartados");
+    motor.setSwitch(ChaveClock::Externo);
+    motor.addExternalPulses(1234);
+    check(motor.hasRequests() && motor.processRequests() && motor.getDisplay() == "34" && motor.getPulsosExternos() == 1234,
+          "chave em EXT: pulsos externos em lote nos CD4026");
+    motor.advance(25);
+    check(motor.getDisplay() == "34" && motor.getChip4017().getPosition() == 25 % 4, "chave em EXT: o 555 só avança o CD4017");
+    motor.setSwitch(ChaveClock::Interno555);
+    motor.step();
+    check(motor.getDisplay() == "35", "de volta ao 555, o display volta a contar o clock interno");
+}
+
+void testarPortas4017() {
+    std::cout << "\n[CD4017 em portas lógicas, 64 placas por palavra]\n";
+
+    // 64 placas com todos os LimitReset, comparadas pulso a pulso com o Chip4017 comportamental
+    std::vector<unsigned> limites(64);
+    std::vector<Chip4017> chips;
+    for (unsigned i = 0; i < 64; ++i) {
+        limites[i] = 1 + i % 10;
+        chips.emplace_back(limites[i]);
+    }
+    Lote4017Portas lote(limites);
+    bool iguais = true;
+    for (int pulso = 0; pulso < 1000 && iguais; ++pulso) {
+        for (unsigned i = 0; i < 64; ++i) {
+            iguais = iguais && lote.getOut(i) == chips[i].getOut() && lote.getPosition(i) == chips[i].getPosition();
+        }
+        lote.pulse();
+        for (Chip4017& c : chips) {
+            c.shift();
+        }
+    }
+    check(iguais, "mesmo anel do Chip4017 em 1000 pulsos, LimitReset de 1 a 10");
+
+    // Sem realimentação (LimitReset 10): sequência Johnson, uma saída por vez e CARRY OUT = /Q5
+    Lote4017Portas dez(std::vector<unsigned>(1, 10));
+    const unsigned johnson[10] = { 0x00, 0x10, 0x18, 0x1C, 0x1E, 0x1F, 0x0F, 0x07, 0x03, 0x01 };     // Q1 no bit 4
+    bool sequencia = true;
+    unsigned subidasCarry = 0;
+    bool carryAnterior = true;
+    for (unsigned pulso = 0; pulso < 30; ++pulso) {
+        unsigned estado = 0;
+        unsigned altas = 0;
+        for (unsigned e = 0; e < 5; ++e) {
+            estado |= static_cast<unsigned>(dez.stage(e) & 1u) << (4 - e);
+        }
+        for (unsigned k = 0; k < 10; ++k) {
+            altas += static_cast<unsigned>(dez.output(k) & 1u);
+        }
+        bool carry = dez.carryOut() & 1u;
+        sequencia = sequencia && estado == johnson[pulso % 10] && altas == 1 && carry == (pulso % 10 < 5);
+        subidasCarry += (carry && !carryAnterior) ? 1 : 0;
+        carryAnterior = carry;
+        dez.pulse();
+    }
+    check(sequencia, "contador Johnson de 5 estágios com uma saída decodificada por vez");
+    check(subidasCarry == 2, "CARRY OUT sobe a cada 10 pulsos");
+
+    // CLOCK INHIBIT: bloqueia a subida do clock; a descida dele com o clock alto avança
+    Lote4017Portas inibe(std::vector<unsigned>(2, 10));
+    inibe.setClockInhibit(1);                   // só a placa 0
+    inibe.pulse();
+    check(inibe.getPosition(0) == 0 && inibe.getPosition(1) == 1, "CLOCK INHIBIT alto ignora o clock");
+    inibe.clock(3);
+    check(inibe.setClockInhibit(0) == 1 && inibe.getPosition(0) == 1, "descida do INHIBIT com o clock alto avança");
+    inibe.clock(0);
+
+    // RESET externo segura em O0
+    inibe.setReset(2);
+    inibe.pulse();
+    inibe.pulse();
+    check(inibe.getPosition(1) == 0 && inibe.getPosition(0) == 3, "RESET alto segura a placa em O0");
+    inibe.setReset(0);
+    inibe.pulse();
+    check(inibe.getPosition(1) == 1, "RESET solto: volta a contar");
+
+    // Estados inválidos: todos os 32 voltam à sequência válida em poucos pulsos
+    Lote4017Portas todos(std::vector<unsigned>(32, 10));
+    for (unsigned e = 0; e < 5; ++e) {
+        uint64_t valor = 0;
+        for (unsigned s = 0; s < 32; ++s) {
+            valor |= static_cast<uint64_t>((s >> (4 - e)) & 1u) << s;
+        }
+        todos.setStage(e, valor);
+    }
+    for (int pulso = 0; pulso < 10; ++pulso) {
+        todos.pulse();
+    }
+    bool validos = true;
+    for (unsigned s = 0; s < 32; ++s) {
+        unsigned altas = 0;
+        for (unsigned k = 0; k < 10; ++k) {
+            altas += static_cast<unsigned>((todos.output(k) >> s) & 1u);
+        }
+        validos = validos && altas == 1;
+    }
+    check(validos, "a correção D3 = Q2 (Q1 + Q3) leva os 32 estados à sequência válida");
+
+    bool recusou = false;
+    try {
+        Lote4017Portas grande(std::vector<unsigned>(65, 4));
+    } catch (const std::invalid_argument&) {
+        recusou = true;
+    }
+    check(recusou, "mais de 64 placas num lote é recusado");
+}
+
+void testarPortas4026() {
+    std::cout << "\n[CD4026 em portas lógicas, 64 chips por palavra]\n";
+
+    static_assert(DigitosDoSegmento[6] == 0x37C && DigitosDoSegmento[2] == 0x3FB, "g apagado em 0, 1 e 7; c só em 2");
+
+    // 64 placas com unidades e dezenas em cascata, cada uma recebendo pulsos num ritmo diferente
+    Cascata4026Portas cascata(64);
+    std::vector<Unidade> unidades(64);
+    std::vector<Dezena> dezenas(64);
+    bool iguais = true;
+    for (unsigned pulso = 0; pulso < 2000 && iguais; ++pulso) {
+        uint64_t mascara = 0;
+        for (unsigned i = 0; i < 64; ++i) {
+            if (pulso % (1 + i % 7) == 0) {
+                mascara |= uint64_t(1) << i;
+                unidades[i].add();
+                dezenas[i].addOnCarry(unidades[i].getCarryOut());
+            }
+        }
+        cascata.pulse(mascara);
+        for (unsigned i = 0; i < 64; ++i) {
+            iguais = iguais && cascata.unidades().getOut(i) == unidades[i].getOut()
+                   && cascata.dezenas().getOut(i) == dezenas[i].getOut()
+                   && cascata.unidades().getSegments(i) == unidades[i].getSegments()
+                   && cascata.dezenas().getSegments(i) == dezenas[i].getSegments();
+        }
+    }
+    check(iguais, "mesmos dígitos e segmentos de Unidade/Dezena em 2000 pulsos, carry das unidades no clock das dezenas");
+
+    // Um chip em cada dígito: os pinos a..g batem com a TabelaSegmentos
+    Lote4026Portas dez(10);
+    for (unsigned i = 0; i < 10; ++i) {
+        for (unsigned p = 0; p < i; ++p) {
+            dez.pulse(uint64_t(1) << i);
+        }
+    }
+    uint64_t seg[Lote4026Portas::Segmentos];
+    dez.segments(seg);
+    bool tabela = true;
+    for (unsigned i = 0; i < 10; ++i) {
+        uint8_t acesos = 0;
+        for (unsigned s = 0; s < 7; ++s) {
+            acesos = static_cast<uint8_t>(acesos | (((seg[s] >> i) & 1u) << s));
+        }
+        tabela = tabela && acesos == TabelaSegmentos[i] && dez.getCarryOut(i) == (i < 5);
+    }
+    check(tabela, "decodificador em portas igual à TabelaSegmentos, CARRY OUT alto de 0 a 4");
+
+    // DISPLAY ENABLE: apaga a..g e passa para o DISPLAY ENABLE OUT; o UNGATED C não depende dele
+    dez.setDisplayEnable(0x155);
+    dez.segments(seg);
+    bool apagados = true;
+    for (unsigned s = 0; s < 7; ++s) {
+        apagados = apagados && (seg[s] & ~uint64_t(0x155)) == 0;
+    }
+    check(apagados && dez.displayEnableOut() == 0x155, "DISPLAY ENABLE IN baixo apaga os segmentos e sai no ENABLE OUT");
+    check(dez.ungatedC() == (0x3FF & ~uint64_t(1 << 2)) && dez.getOut(3) == 3, "UNGATED C só apaga no 2 e a contagem segue");
+
+    // RESET da cascata: zera os dois displays sem contar uma subida de carry nas dezenas
+    for (int p = 0; p < 57; ++p) {
+        cascata.pulse();
+    }
+    cascata.reset();
+    cascata.pulse();
+    check(cascata.unidades().getOut(0) == 1 && cascata.dezenas().getOut(0) == 0, "reset da cascata volta a 00");
+}
+
+void testarAtrasos() {
+    std::cout << "\n[Atrasos de propagação, glitches e violações]\n";
+
+    // Tempos do datasheet: pontos de 5 e 10 V, interpolação entre eles e pior caso com o dobro
+    AtrasosCmos em5 = AtrasosCmos::datasheet(5.0);
+    AtrasosCmos em10 = AtrasosCmos::datasheet(10.0);
+    AtrasosCmos em7 = AtrasosCmos::datasheet(7.5);
+    AtrasosCmos pior = AtrasosCmos::datasheet(5.0, CantoAtrasos::Maximo);
+    check(std::abs(em5.clockSaida4017 - 325e-9) < 1e-12 && std::abs(em10.clockSaida4017 - 135e-9) < 1e-12,
+          "CLOCK -> saída do CD4017: 325 ns em 5 V e 135 ns em 10 V");
+    check(em7.clockSegmentos4026 < em5.clockSegmentos4026 && em7.clockSegmentos4026 > em10.clockSegmentos4026
+          && std::abs(pior.clockCarry4026 - 2 * em5.clockCarry4026) < 1e-15, "atraso cai com a tensão; pior caso = 2x típico");
+    bool recusou = false;
+    try {
+        AtrasosCmos::datasheet(2.0);
+    } catch (const std::invalid_argument&) {
+        recusou = true;
+    }
+    check(recusou, "VDD fora de 3 a 18 V lança invalid_argument");
+
+    // Clock lento: os estados assentam entre as bordas e batem com o motor sem atrasos
+    const uint64_t n = 2345;
+    PlacaComAtrasos placa(4, 1000.0, 10000.0, 7.37e-6, 9.0);
+    MotorVirtual m(4, 1000.0, 10000.0, 7.37e-6);
+    const double periodo = placa.getChip555().getPeriod();
+    placa.runUntil((n - 1) * periodo + periodo / 2);
+    m.runCycles(n);
+    check(placa.getSubidas() == n && placa.getLeds() == m.getChip4017().getOut() && placa.getDisplay() == m.getDisplay(),
+          "com os estados assentados, mesmos LEDs e display do MotorVirtual");
+    check(placa.getTotalViolacoes() == 0, "clock de ~10 Hz não viola nenhum tempo do datasheet");
+    check(placa.getGlitches(PlacaComAtrasos::Sinal::Saida4017) == n / 4,
+          "um glitch na saída ligada ao RESET a cada volta do anel");
+    check(placa.getGlitches(PlacaComAtrasos::Sinal::Display) == n / 10, "um valor de passagem no display a cada carry");
+
+    const AtrasosCmos& a = placa.getAtrasos();
+    bool pulsoReset = false, passagem = false;
+    for (const PlacaComAtrasos::Glitch& g : placa.getRegistroGlitches()) {
+        if (g.sinal == PlacaComAtrasos::Sinal::Saida4017) {
+            pulsoReset = g.valor == 4 && std::abs(g.largura - a.resetSaida4017) < 1e-11;
+        }
+        if (g.sinal == PlacaComAtrasos::Sinal::Display && !passagem) {
+            passagem = g.valor == 0 && std::abs(g.largura - a.clockCarry4026) < 1e-11
+                    && std::abs(g.instante - (9 * periodo + a.clockSegmentos4026)) < 1e-10;
+        }
+    }
+    check(pulsoReset, "o pulso em O4 dura o atraso RESET -> saída");
+    check(passagem, "09 -> 00 -> 10: o 00 fica visível pelo atraso do carry");
+    check(std::abs(placa.getAcomodacaoDisplay() - (a.clockCarry4026 + a.clockSegmentos4026)) < 1e-11
+          && std::abs(placa.getAcomodacaoLeds() - (a.clockSaida4017 + a.resetSaida4017)) < 1e-11,
+          "acomodação: carry + segmentos no display, clock + reset nos LEDs");
+
+    // Clock rápido em 5 V: acima da frequência máxima e com subidas durante o RESET da realimentação
+    PlacaComAtrasos rapida(3, 1000.0, 10000.0, 7.37e-6, 5.0);
+    rapida.setClock(std::make_unique<Oscilador>(90e-9, 180e-9));
+    rapida.runUntil(50e-6);
+    using V = PlacaComAtrasos::Violacao;
+    check(rapida.getViolacoes(V::FrequenciaMaxima) > 0 && rapida.getViolacoes(V::LarguraClock) > 0,
+          "clock de 5.6 MHz em 5 V: frequência e largura de pulso violadas");
+    check(rapida.getViolacoes(V::ClockDuranteReset) > 0, "subidas com o RESET da realimentação alto são perdidas");
+
+    // Botão: subida do clock 20 ns depois de soltar o RESET viola o tempo de remoção
+    PlacaComAtrasos botao(4, 1000.0, 10000.0, 7.37e-6, 5.0);
+    botao.setClock(std::make_unique<Oscilador>(0.5e-3, 1e-3, 0.5e-3 + 20e-9));
+    botao.scheduleReset(0.2e-3, 0.3e-3);
+    botao.runUntil(0.9e-3);
+    check(botao.getViolacoes(V::RemocaoReset) == 2 && botao.getDisplay() == "00" && botao.getPosition() == 0,
+          "remoção do RESET violada no CD4017 e no CD4026: a contagem se perde");
+    botao.runUntil(1.9e-3);
+    check(botao.getDisplay() == "01" && botao.getPosition() == 1, "a borda seguinte conta normalmente");
+}
+
+// ─── Main ────────────────────────────────────────────────────────────────────
+
+int main() {
+    std::cout << "=== Testes do motor — Simulador Apple Juice ===\n";
+
+    testarMotorVirtual();
+    testarAdvance();
+    testarLotePlacas();
+    testarVarredura();
+    testarSeqLock();
+    testarRelogioTempoReal();
+    testarInstrumentacao();
+    testarVcd();
+    testarRastroPeriodico();
+    testarAnalisador();
+    testarNetlist();
+    testarChipsEstaticos();
+    testarSegmentos();
+    testarContadorBcd();
+    testarCascata4017();
+    testarAnalogico555();
+    testarMonteCarlo();
+    testarRodaDeTempo();
+    testarPlacaEventos();
+    testarClockExterno();
+    testarPortas4017();
+    testarPortas4026();
+    testarAtrasos();
+
+    std::cout << "\n──────────────────────────────────────\n";
+    std::cout << "Resultado: " << totalPassou << "/" << totalTestes << " testes passaram.\n";
+
+    return (totalPassou == totalTestes) ? 0 : 1;
+}